@@ -19,6 +19,7 @@
 
 namespace llvm {
 
+class MCAlignFragment;
 class MCAsmLayout;
 class MCAssembler;
 class MCCFIInstruction;
@@ -67,6 +68,11 @@ public:
     return false;
   }
 
+  /// Return true if symbol differences must be emitted as a pair of add/sub
+  /// relocations instead of being folded by the assembler, e.g. because the
+  /// linker may relax the code between the two symbols.
+  virtual bool requiresDiffExpressionRelocations() const { return false; }
+
   /// Apply the \p Value for given \p Fixup into the provided data fragment, at
   /// the offset specified by the fixup and following the fixup kind as
   /// appropriate. Errors (such as an out of range fixup value) should be
@@ -120,6 +126,22 @@ public:
   /// \return - True on success.
   virtual bool writeNopData(uint64_t Count, MCObjectWriter *OW) const = 0;
 
+  /// Hook to check if extra nop bytes must be inserted for alignment
+  /// directive. For some targets this may be necessary in order to support
+  /// linker relaxation. The number of bytes to insert is returned in \p Size.
+  virtual bool shouldInsertExtraNopBytesForCodeAlign(const MCAlignFragment &AF,
+                                                     unsigned &Size) {
+    return false;
+  }
+
+  /// Hook which indicates if the target requires a fixup to be generated when
+  /// handling an align directive in an executable section.
+  virtual bool shouldInsertFixupForCodeAlign(MCAssembler &Asm,
+                                             const MCAsmLayout &Layout,
+                                             MCAlignFragment &AF) {
+    return false;
+  }
+
   /// Give backend an opportunity to finish layout after relaxation
   virtual void finishLayout(MCAssembler const &Asm,
                             MCAsmLayout &Layout) const {}
@@ -65,7 +65,11 @@ public:
     PercentGot_Ofst, PercentGot_Page, PercentGottprel, PercentGp_Rel, PercentHi,
     PercentHigher, PercentHighest, PercentLo, PercentNeg, PercentPcrel_Hi,
     PercentPcrel_Lo, PercentTlsgd, PercentTlsldm, PercentTprel_Hi,
-    PercentTprel_Lo
+    PercentTprel_Lo,
+
+    // RISC-V unary expression operators that MIPS does not have.
+    PercentGot_Pcrel_Hi, PercentTls_Gd_Pcrel_Hi, PercentTls_Ie_Pcrel_Hi,
+    PercentTprel_Add
   };
 
 private:
@@ -669,6 +669,7 @@ AsmToken AsmLexer::LexToken() {
               .StartsWith("got_ofst", {AsmToken::PercentGot_Ofst, 9})
               .StartsWith("got_page", {AsmToken::PercentGot_Page, 9})
               .StartsWith("gottprel", {AsmToken::PercentGottprel, 9})
+              .StartsWith("got_pcrel_hi", {AsmToken::PercentGot_Pcrel_Hi, 13})
               .StartsWith("got", {AsmToken::PercentGot, 4})
               .StartsWith("gp_rel", {AsmToken::PercentGp_Rel, 7})
               .StartsWith("higher", {AsmToken::PercentHigher, 7})
@@ -678,8 +679,13 @@ AsmToken AsmLexer::LexToken() {
               .StartsWith("neg", {AsmToken::PercentNeg, 4})
               .StartsWith("pcrel_hi", {AsmToken::PercentPcrel_Hi, 9})
               .StartsWith("pcrel_lo", {AsmToken::PercentPcrel_Lo, 9})
+              .StartsWith("tls_gd_pcrel_hi",
+                          {AsmToken::PercentTls_Gd_Pcrel_Hi, 16})
+              .StartsWith("tls_ie_pcrel_hi",
+                          {AsmToken::PercentTls_Ie_Pcrel_Hi, 16})
               .StartsWith("tlsgd", {AsmToken::PercentTlsgd, 6})
               .StartsWith("tlsldm", {AsmToken::PercentTlsldm, 7})
+              .StartsWith("tprel_add", {AsmToken::PercentTprel_Add, 10})
               .StartsWith("tprel_hi", {AsmToken::PercentTprel_Hi, 9})
               .StartsWith("tprel_lo", {AsmToken::PercentTprel_Lo, 9})
               .Default({AsmToken::Percent, 1});
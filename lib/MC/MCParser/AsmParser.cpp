@@ -1108,6 +1108,7 @@ bool AsmParser::parsePrimaryExpr(const MCExpr *&Res, SMLoc &EndLoc) {
   case AsmToken::PercentGot_Lo:
   case AsmToken::PercentGot_Ofst:
   case AsmToken::PercentGot_Page:
+  case AsmToken::PercentGot_Pcrel_Hi:
   case AsmToken::PercentGottprel:
   case AsmToken::PercentGp_Rel:
   case AsmToken::PercentHi:
@@ -1118,7 +1119,10 @@ bool AsmParser::parsePrimaryExpr(const MCExpr *&Res, SMLoc &EndLoc) {
   case AsmToken::PercentPcrel_Hi:
   case AsmToken::PercentPcrel_Lo:
   case AsmToken::PercentTlsgd:
+  case AsmToken::PercentTls_Gd_Pcrel_Hi:
+  case AsmToken::PercentTls_Ie_Pcrel_Hi:
   case AsmToken::PercentTlsldm:
+  case AsmToken::PercentTprel_Add:
   case AsmToken::PercentTprel_Hi:
   case AsmToken::PercentTprel_Lo:
     Lex(); // Eat the operator.
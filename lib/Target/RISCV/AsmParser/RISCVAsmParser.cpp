@@ -7,8 +7,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "MCTargetDesc/RISCVBaseInfo.h"
 #include "MCTargetDesc/RISCVMCTargetDesc.h"
 #include "MCTargetDesc/RISCVMCExpr.h"
+#include "RISCVTargetStreamer.h"
 #include "llvm/MC/MCParser/MCAsmLexer.h"
 #include "llvm/MC/MCParser/MCParsedAsmOperand.h"
 #include "llvm/MC/MCParser/MCTargetAsmParser.h"
@@ -21,6 +23,7 @@
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallBitVector.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/TargetRegistry.h"
@@ -92,6 +95,10 @@ class RISCVAsmParser : public MCTargetAsmParser {
                                bool MatchingInlineAsm) override;
 
   Optional<unsigned> matchCPURegisterName(StringRef Symbol, bool Reg32Bit) const;
+  Optional<unsigned> matchFPRegisterName(StringRef Symbol) const;
+
+  unsigned validateTargetOperandClass(MCParsedAsmOperand &Op,
+                                      unsigned Kind) override;
 
   bool ParseRegister(unsigned &RegNo, SMLoc &StartLoc, SMLoc &EndLoc) override;
 
@@ -112,7 +119,10 @@ class RISCVAsmParser : public MCTargetAsmParser {
   ParseResult<const MCExpr*> parseExpression();
   ParseResult<const MCExpr*> parseImmediate();
 
-  bool parseOperand(OperandVector &Operands, bool Reg32Bit);
+  bool parseOperand(OperandVector &Operands, bool Reg32Bit, bool FRMArg);
+  bool parseCallSymbol(OperandVector &Operands);
+
+  std::unique_ptr<RISCVOperand> defaultFRMArgOperands() const;
 
 public:
   enum RISCVMatchResultTy {
@@ -130,6 +140,10 @@ public:
                  const MCInstrInfo &MII, const MCTargetOptions &Options)
       : MCTargetAsmParser(Options, STI) {
     setAvailableFeatures(ComputeAvailableFeatures(STI.getFeatureBits()));
+
+    if (MCTargetStreamer *TS = Parser.getStreamer().getTargetStreamer())
+      static_cast<RISCVTargetStreamer *>(TS)->emitTargetABI(
+          Options.getABIName());
   }
 
   const MCExpr *createTargetUnaryExpr(const MCExpr *E,
@@ -145,6 +159,22 @@ public:
       return RISCVMCExpr::create(E, RISCVMCExpr::VK_RISCV_LO, Ctx);
     case AsmToken::PercentPcrel_Hi:
       return RISCVMCExpr::create(E, RISCVMCExpr::VK_RISCV_PCREL_HI, Ctx);
+    case AsmToken::PercentPcrel_Lo:
+      return RISCVMCExpr::create(E, RISCVMCExpr::VK_RISCV_PCREL_LO, Ctx);
+    case AsmToken::PercentGot_Pcrel_Hi:
+      return RISCVMCExpr::create(E, RISCVMCExpr::VK_RISCV_GOT_HI, Ctx);
+    case AsmToken::PercentTprel_Hi:
+      return RISCVMCExpr::create(E, RISCVMCExpr::VK_RISCV_TPREL_HI, Ctx);
+    case AsmToken::PercentTprel_Lo:
+      return RISCVMCExpr::create(E, RISCVMCExpr::VK_RISCV_TPREL_LO, Ctx);
+    case AsmToken::PercentTprel_Add:
+      return RISCVMCExpr::create(E, RISCVMCExpr::VK_RISCV_TPREL_ADD, Ctx);
+    case AsmToken::PercentTls_Ie_Pcrel_Hi:
+      return RISCVMCExpr::create(E, RISCVMCExpr::VK_RISCV_TLS_GOT_HI, Ctx);
+    case AsmToken::PercentTls_Gd_Pcrel_Hi:
+      return RISCVMCExpr::create(E, RISCVMCExpr::VK_RISCV_TLS_GD_HI, Ctx);
+    case AsmToken::PercentGp_Rel:
+      return RISCVMCExpr::create(E, RISCVMCExpr::VK_RISCV_GPREL, Ctx);
 
     }
   }
@@ -163,6 +193,7 @@ struct RISCVOperand : public MCParsedAsmOperand {
     Register,
     Memory,
     Immediate,
+    RoundingMode,
   } Kind;
 
   SMLoc StartLoc, EndLoc;
@@ -172,6 +203,7 @@ struct RISCVOperand : public MCParsedAsmOperand {
     unsigned Reg;
     const MCExpr* Imm;
     MemTy Mem;
+    RISCVFPRndMode::RoundingMode FRM;
   };
 
   // Constructors
@@ -187,6 +219,9 @@ struct RISCVOperand : public MCParsedAsmOperand {
   explicit RISCVOperand(const MCExpr* Offset, const unsigned Reg, SMLoc S, SMLoc E)
     : Kind(Memory), StartLoc(S), EndLoc(E), Mem{Offset, Reg} {}
 
+  explicit RISCVOperand(RISCVFPRndMode::RoundingMode FRM_, SMLoc S, SMLoc E)
+    : Kind(RoundingMode), StartLoc(S), EndLoc(E), FRM(FRM_) {}
+
   // Copy constructor
   RISCVOperand(const RISCVOperand &rhs)
     : MCParsedAsmOperand(),
@@ -206,6 +241,9 @@ struct RISCVOperand : public MCParsedAsmOperand {
     case Memory:
       Mem = rhs.Mem;
       break;
+    case RoundingMode:
+      FRM = rhs.FRM;
+      break;
     }
   }
 
@@ -224,6 +262,10 @@ struct RISCVOperand : public MCParsedAsmOperand {
 
   // Predicate methods for AsmOperands defined in RISCVInstrInfo.td
 
+  bool isUImm3() const {
+    return (isConstantImm() && isUInt<3>(getConstantImm()));
+  }
+
   bool isUImm4() const {
     return (isConstantImm() && isUInt<4>(getConstantImm()));
   }
@@ -236,6 +278,10 @@ struct RISCVOperand : public MCParsedAsmOperand {
     return (isConstantImm() && isUInt<6>(getConstantImm()));
   }
 
+  bool isUImm7() const {
+    return (isConstantImm() && isUInt<7>(getConstantImm()));
+  }
+
   bool isS12Imm() const {
     return isSImm12();
   }
@@ -261,7 +307,10 @@ struct RISCVOperand : public MCParsedAsmOperand {
       int64_t Addend;
       if (!RISCVAsmParser::classifySymbolRef(getImm(), VK, Addend))
         return false;
-      return VK == RISCVMCExpr::VK_RISCV_LO;
+      return VK == RISCVMCExpr::VK_RISCV_LO ||
+             VK == RISCVMCExpr::VK_RISCV_PCREL_LO ||
+             VK == RISCVMCExpr::VK_RISCV_TPREL_LO ||
+             VK == RISCVMCExpr::VK_RISCV_GPREL;
     }
     return false;
   }
@@ -303,6 +352,17 @@ struct RISCVOperand : public MCParsedAsmOperand {
     return false;
   }
 
+  bool isSImm11Lsb0() const {
+    if (isConstantImm()) {
+      return isShiftedInt<10, 1>(getConstantImm());
+    } else if (isImm()) {
+      RISCVMCExpr::VariantKind VK;
+      int64_t Addend;
+      return RISCVAsmParser::classifySymbolRef(getImm(), VK, Addend);
+    }
+    return false;
+  }
+
   bool isSImm12Lsb0() const {
     if (isConstantImm()) {
       return isShiftedInt<11, 1>(getConstantImm());
@@ -333,11 +393,31 @@ struct RISCVOperand : public MCParsedAsmOperand {
       int64_t Addend;
       if (!RISCVAsmParser::classifySymbolRef(getImm(), VK, Addend))
         return false;
-      return VK == RISCVMCExpr::VK_RISCV_HI || VK == RISCVMCExpr::VK_RISCV_PCREL_HI;
+      return VK == RISCVMCExpr::VK_RISCV_HI ||
+             VK == RISCVMCExpr::VK_RISCV_PCREL_HI ||
+             VK == RISCVMCExpr::VK_RISCV_GOT_HI ||
+             VK == RISCVMCExpr::VK_RISCV_TPREL_HI ||
+             VK == RISCVMCExpr::VK_RISCV_TLS_GOT_HI ||
+             VK == RISCVMCExpr::VK_RISCV_TLS_GD_HI;
     }
     return false;
   }
 
+  bool isCallSymbol() const {
+    if (!isImm())
+      return false;
+    const RISCVMCExpr *RE = dyn_cast<RISCVMCExpr>(getImm());
+    return RE && (RE->getKind() == RISCVMCExpr::VK_RISCV_CALL ||
+                  RE->getKind() == RISCVMCExpr::VK_RISCV_CALL_PLT);
+  }
+
+  bool isTPRelAddSymbol() const {
+    if (!isImm())
+      return false;
+    const RISCVMCExpr *RE = dyn_cast<RISCVMCExpr>(getImm());
+    return RE && RE->getKind() == RISCVMCExpr::VK_RISCV_TPREL_ADD;
+  }
+
   // Reg + imm12s
   bool isAddrRegImm12s() const {
     return isMem();
@@ -401,6 +481,9 @@ struct RISCVOperand : public MCParsedAsmOperand {
     return isUIntN(5 + 3, Val) && (Val % 8 == 0);
   }
 
+  /// Return true if the operand is a valid floating point rounding mode.
+  bool isFRMArg() const { return Kind == RoundingMode; }
+
   bool isSImm21Lsb0() const {
     if (isConstantImm()) {
       return isShiftedInt<20, 1>(getConstantImm());
@@ -412,6 +495,27 @@ struct RISCVOperand : public MCParsedAsmOperand {
     return false;
   }
 
+  // The offset of a gp-relative instruction: a constant with the alignment of
+  // the access, or a symbol, bare or with %gp_rel.
+  template <unsigned N, unsigned S> bool isGPOffset() const {
+    if (isConstantImm()) {
+      return isShiftedInt<N - S, S>(getConstantImm());
+    } else if (isImm()) {
+      RISCVMCExpr::VariantKind VK;
+      int64_t Addend;
+      if (!RISCVAsmParser::classifySymbolRef(getImm(), VK, Addend))
+        return false;
+      return VK == RISCVMCExpr::VK_RISCV_Invalid ||
+             VK == RISCVMCExpr::VK_RISCV_GPREL;
+    }
+    return false;
+  }
+
+  bool isSImm18GP() const { return isGPOffset<18, 0>(); }
+  bool isSImm18Lsb0GP() const { return isGPOffset<18, 1>(); }
+  bool isSImm19Lsb00GP() const { return isGPOffset<19, 2>(); }
+  bool isSImm20Lsb000GP() const { return isGPOffset<20, 3>(); }
+
   /// getStartLoc - Gets location of the first token of this operand
   SMLoc getStartLoc() const override { return StartLoc; }
   /// getEndLoc - Gets location of the last token of this operand
@@ -437,6 +541,11 @@ struct RISCVOperand : public MCParsedAsmOperand {
     return Tok;
   }
 
+  RISCVFPRndMode::RoundingMode getRoundingMode() const {
+    assert(isFRMArg() && "Invalid type access as rounding mode!");
+    return FRM;
+  }
+
   void print(raw_ostream &OS) const override {
     switch (Kind) {
     case Immediate:
@@ -451,6 +560,9 @@ struct RISCVOperand : public MCParsedAsmOperand {
     case Memory:
       OS << "<Mem " << *Mem.Offset << '(' << Mem.Reg << ")>";
       break;
+    case RoundingMode:
+      OS << "<frm " << RISCVFPRndMode::roundingModeToString(FRM) << ">";
+      break;
     }
   }
 
@@ -473,6 +585,11 @@ struct RISCVOperand : public MCParsedAsmOperand {
     addExpr(Inst, getImm());
   }
 
+  void addFRMArgOperands(MCInst &Inst, unsigned N) const {
+    assert(N == 1 && "Invalid number of operands!");
+    Inst.addOperand(MCOperand::createImm(getRoundingMode()));
+  }
+
   void addAddrRegImmOperands(MCInst &Inst, unsigned N) const {
     assert(N == 2 && "Invalid number of operands!");
     Inst.addOperand(MCOperand::createReg(Mem.Reg));
@@ -539,25 +656,69 @@ bool RISCVAsmParser::MatchAndEmitInstruction(SMLoc IDLoc, unsigned &Opcode,
     }
     return Error(ErrorLoc, "invalid operand for instruction");
   }
+  case Match_InvalidUImm3:
+    return generateImmOutOfRangeError(Operands, ErrorInfo, 0, (1 << 3) - 1);
   case Match_InvalidUImm4:
     return generateImmOutOfRangeError(Operands, ErrorInfo, 0, (1 << 4) - 1);
   case Match_InvalidUImm5:
     return generateImmOutOfRangeError(Operands, ErrorInfo, 0, (1 << 5) - 1);
+  case Match_InvalidUImm6:
+    return generateImmOutOfRangeError(Operands, ErrorInfo, 0, (1 << 6) - 1);
+  case Match_InvalidUImm7:
+    return generateImmOutOfRangeError(Operands, ErrorInfo, 0, (1 << 7) - 1);
   case Match_InvalidSImm12:
     return generateImmOutOfRangeError(Operands, ErrorInfo, -(1 << 11),
                                       (1 << 11) - 1);
   case Match_InvalidUImm12:
     return generateImmOutOfRangeError(Operands, ErrorInfo, 0, (1 << 12) - 1);
+  case Match_InvalidSImm11Lsb0:
+    return generateImmOutOfRangeError(
+        Operands, ErrorInfo, -(1 << 10), (1 << 10) - 2,
+        "immediate must be a multiple of 2 bytes in the range");
   case Match_InvalidSImm13Lsb0:
     return generateImmOutOfRangeError(
         Operands, ErrorInfo, -(1 << 12), (1 << 12) - 2,
         "immediate must be a multiple of 2 bytes in the range");
+  case Match_InvalidSImm18GP:
+    return generateImmOutOfRangeError(
+        Operands, ErrorInfo, -(1 << 17), (1 << 17) - 1,
+        "operand must be a symbol or an integer in the range");
+  case Match_InvalidSImm18Lsb0GP:
+    return generateImmOutOfRangeError(
+        Operands, ErrorInfo, -(1 << 17), (1 << 17) - 2,
+        "operand must be a symbol or a multiple of 2 bytes in the range");
+  case Match_InvalidSImm19Lsb00GP:
+    return generateImmOutOfRangeError(
+        Operands, ErrorInfo, -(1 << 18), (1 << 18) - 4,
+        "operand must be a symbol or a multiple of 4 bytes in the range");
+  case Match_InvalidSImm20Lsb000GP:
+    return generateImmOutOfRangeError(
+        Operands, ErrorInfo, -(1 << 19), (1 << 19) - 8,
+        "operand must be a symbol or a multiple of 8 bytes in the range");
   case Match_InvalidUImm20:
     return generateImmOutOfRangeError(Operands, ErrorInfo, 0, (1 << 20) - 1);
   case Match_InvalidSImm21Lsb0:
     return generateImmOutOfRangeError(
         Operands, ErrorInfo, -(1 << 20), (1 << 20) - 2,
         "immediate must be a multiple of 2 bytes in the range");
+  case Match_InvalidCallSymbol: {
+    SMLoc ErrorLoc = ((RISCVOperand &)*Operands[ErrorInfo]).getStartLoc();
+    return Error(ErrorLoc, "operand must be a bare symbol name");
+  }
+  case Match_InvalidFRMArg: {
+    SMLoc ErrorLoc = ((RISCVOperand &)*Operands[ErrorInfo]).getStartLoc();
+    return Error(ErrorLoc, "operand must be a valid floating point rounding "
+                           "mode mnemonic");
+  }
+  case Match_InvalidTPRelAddSymbol: {
+    // Only a symbolic operand is taken for the TP-relative add; anything
+    // else is an extra operand of an ordinary add.
+    RISCVOperand &Op = (RISCVOperand &)*Operands[ErrorInfo];
+    if (!Op.isImm() || Op.isConstantImm())
+      return Error(Op.getStartLoc(), "invalid operand for instruction");
+    return Error(Op.getStartLoc(),
+                 "operand must be a symbol with %tprel_add modifier");
+  }
   }
 
   llvm_unreachable("Unknown match type detected!");
@@ -640,6 +801,60 @@ Optional<unsigned> RISCVAsmParser::matchCPURegisterName(StringRef Name,
   }
 }
 
+// Floating-point registers are always matched as their 64-bit form and
+// narrowed to the 32-bit subregister in validateTargetOperandClass when an
+// FPR32 operand is expected.
+Optional<unsigned> RISCVAsmParser::matchFPRegisterName(StringRef Name) const {
+  return StringSwitch<Optional<unsigned>>(Name)
+           .Cases("ft0" , "f0" , Optional<unsigned>(RISCV::F0_64 ))
+           .Cases("ft1" , "f1" , Optional<unsigned>(RISCV::F1_64 ))
+           .Cases("ft2" , "f2" , Optional<unsigned>(RISCV::F2_64 ))
+           .Cases("ft3" , "f3" , Optional<unsigned>(RISCV::F3_64 ))
+           .Cases("ft4" , "f4" , Optional<unsigned>(RISCV::F4_64 ))
+           .Cases("ft5" , "f5" , Optional<unsigned>(RISCV::F5_64 ))
+           .Cases("ft6" , "f6" , Optional<unsigned>(RISCV::F6_64 ))
+           .Cases("ft7" , "f7" , Optional<unsigned>(RISCV::F7_64 ))
+           .Cases("fs0" , "f8" , Optional<unsigned>(RISCV::F8_64 ))
+           .Cases("fs1" , "f9" , Optional<unsigned>(RISCV::F9_64 ))
+           .Cases("fa0" , "f10", Optional<unsigned>(RISCV::F10_64))
+           .Cases("fa1" , "f11", Optional<unsigned>(RISCV::F11_64))
+           .Cases("fa2" , "f12", Optional<unsigned>(RISCV::F12_64))
+           .Cases("fa3" , "f13", Optional<unsigned>(RISCV::F13_64))
+           .Cases("fa4" , "f14", Optional<unsigned>(RISCV::F14_64))
+           .Cases("fa5" , "f15", Optional<unsigned>(RISCV::F15_64))
+           .Cases("fa6" , "f16", Optional<unsigned>(RISCV::F16_64))
+           .Cases("fa7" , "f17", Optional<unsigned>(RISCV::F17_64))
+           .Cases("fs2" , "f18", Optional<unsigned>(RISCV::F18_64))
+           .Cases("fs3" , "f19", Optional<unsigned>(RISCV::F19_64))
+           .Cases("fs4" , "f20", Optional<unsigned>(RISCV::F20_64))
+           .Cases("fs5" , "f21", Optional<unsigned>(RISCV::F21_64))
+           .Cases("fs6" , "f22", Optional<unsigned>(RISCV::F22_64))
+           .Cases("fs7" , "f23", Optional<unsigned>(RISCV::F23_64))
+           .Cases("fs8" , "f24", Optional<unsigned>(RISCV::F24_64))
+           .Cases("fs9" , "f25", Optional<unsigned>(RISCV::F25_64))
+           .Cases("fs10", "f26", Optional<unsigned>(RISCV::F26_64))
+           .Cases("fs11", "f27", Optional<unsigned>(RISCV::F27_64))
+           .Cases("ft8" , "f28", Optional<unsigned>(RISCV::F28_64))
+           .Cases("ft9" , "f29", Optional<unsigned>(RISCV::F29_64))
+           .Cases("ft10", "f30", Optional<unsigned>(RISCV::F30_64))
+           .Cases("ft11", "f31", Optional<unsigned>(RISCV::F31_64))
+           .Default(None);
+}
+
+unsigned RISCVAsmParser::validateTargetOperandClass(MCParsedAsmOperand &AsmOp,
+                                                    unsigned Kind) {
+  RISCVOperand &Op = static_cast<RISCVOperand &>(AsmOp);
+  if (!Op.isReg() || Kind != MCK_FPR32)
+    return Match_InvalidOperand;
+
+  const MCRegisterInfo *MRI = getContext().getRegisterInfo();
+  if (!MRI->getRegClass(RISCV::FPR64RegClassID).contains(Op.Reg))
+    return Match_InvalidOperand;
+
+  Op.Reg = MRI->getSubReg(Op.Reg, RISCV::sub_32);
+  return Match_Success;
+}
+
 bool RISCVAsmParser::ParseRegister(unsigned &RegNo, SMLoc &StartLoc,
                                    SMLoc &EndLoc) {
   const ParseResult<unsigned> Reg = parseRegister(false);
@@ -692,7 +907,9 @@ ParseResult<StringRef> RISCVAsmParser::parseIdentifier() {
 ParseResult<unsigned> RISCVAsmParser::parseRegister(bool Reg32Bit) {
   const ParseResult<StringRef> Identifier = peekIdentifier();
   if (Identifier) {
-    const Optional<unsigned> Reg = matchCPURegisterName(Identifier->Val, Reg32Bit);
+    Optional<unsigned> Reg = matchCPURegisterName(Identifier->Val, Reg32Bit);
+    if (!Reg)
+      Reg = matchFPRegisterName(Identifier->Val);
     if (Reg) {
         getLexer().Lex();
         return ParseSuccess<unsigned> { *Reg, Identifier->StartLoc, Identifier->EndLoc };
@@ -733,6 +950,14 @@ ParseResult<const MCExpr*> RISCVAsmParser::parseImmediate() {
       }
     }
     case AsmToken::PercentPcrel_Hi:
+    case AsmToken::PercentPcrel_Lo:
+    case AsmToken::PercentGot_Pcrel_Hi:
+    case AsmToken::PercentTprel_Hi:
+    case AsmToken::PercentTprel_Lo:
+    case AsmToken::PercentTprel_Add:
+    case AsmToken::PercentTls_Ie_Pcrel_Hi:
+    case AsmToken::PercentTls_Gd_Pcrel_Hi:
+    case AsmToken::PercentGp_Rel:
     case AsmToken::PercentLo:
     case AsmToken::PercentHi: {
     const MCExpr *Expr;
@@ -750,13 +975,30 @@ ParseResult<const MCExpr*> RISCVAsmParser::parseImmediate() {
 /// Looks at a token type and creates the relevant operand
 /// from this information, adding to Operands.
 /// If operand was parsed, returns false, else true.
-bool RISCVAsmParser::parseOperand(OperandVector &Operands, bool Reg32Bit) {
+bool RISCVAsmParser::parseOperand(OperandVector &Operands, bool Reg32Bit,
+                                  bool FRMArg) {
   const ParseResult<unsigned> Reg = parseRegister(Reg32Bit);
   if (Reg) {
     Operands.push_back(make_unique<RISCVOperand>(Reg->Val, Reg->StartLoc, Reg->EndLoc));
     return false;
   }
 
+  // Only the floating-point instructions that round take a rounding mode.
+  // Other instructions take these names as ordinary symbols.
+  if (FRMArg) {
+    const ParseResult<StringRef> Identifier = peekIdentifier();
+    if (Identifier) {
+      RISCVFPRndMode::RoundingMode FRM =
+          RISCVFPRndMode::stringToRoundingMode(Identifier->Val);
+      if (FRM != RISCVFPRndMode::Invalid) {
+        getLexer().Lex();
+        Operands.push_back(make_unique<RISCVOperand>(FRM, Identifier->StartLoc,
+                                                     Identifier->EndLoc));
+        return false;
+      }
+    }
+  }
+
   const ParseResult<const MCExpr*> Expr = parseImmediate();
   if (const auto Err = Expr.getError())
     return Error(Err->ErrorLoc, Err->ErrorMsg);
@@ -778,6 +1020,49 @@ bool RISCVAsmParser::parseOperand(OperandVector &Operands, bool Reg32Bit) {
   }
 }
 
+/// Parses the target of a call or tail pseudo-instruction: a symbol name,
+/// optionally suffixed with @plt.
+/// If operand was parsed, returns false, else true.
+bool RISCVAsmParser::parseCallSymbol(OperandVector &Operands) {
+  const ParseResult<StringRef> Identifier = parseIdentifier();
+  if (const auto Err = Identifier.getError())
+    return Error(Err->ErrorLoc, Err->ErrorMsg);
+
+  // The lexer keeps the @plt suffix as part of the identifier.
+  StringRef Name, Modifier;
+  std::tie(Name, Modifier) = Identifier->Val.split('@');
+  RISCVMCExpr::VariantKind Kind = RISCVMCExpr::VK_RISCV_CALL;
+  if (Modifier == "plt")
+    Kind = RISCVMCExpr::VK_RISCV_CALL_PLT;
+  else if (!Modifier.empty())
+    return Error(Identifier->StartLoc, "unknown symbol modifier");
+
+  MCSymbol *Sym = getContext().getOrCreateSymbol(Name);
+  const MCExpr *Res = MCSymbolRefExpr::create(Sym, getContext());
+  Res = RISCVMCExpr::create(Res, Kind, getContext());
+  Operands.push_back(make_unique<RISCVOperand>(Res, Identifier->StartLoc,
+                                               Identifier->EndLoc));
+  return false;
+}
+
+/// The rounding mode used when an instruction is written without one.
+std::unique_ptr<RISCVOperand> RISCVAsmParser::defaultFRMArgOperands() const {
+  return make_unique<RISCVOperand>(RISCVFPRndMode::DYN, SMLoc(), SMLoc());
+}
+
+static bool hasRoundingModeOperand(StringRef Name) {
+  return StringSwitch<bool>(Name)
+           .Cases("fadd.s", "fsub.s", "fmul.s", "fdiv.s", "fsqrt.s", true)
+           .Cases("fadd.d", "fsub.d", "fmul.d", "fdiv.d", "fsqrt.d", true)
+           .Cases("fmadd.s", "fmsub.s", "fnmsub.s", "fnmadd.s", true)
+           .Cases("fmadd.d", "fmsub.d", "fnmsub.d", "fnmadd.d", true)
+           .Cases("fcvt.w.s", "fcvt.wu.s", "fcvt.l.s", "fcvt.lu.s", true)
+           .Cases("fcvt.w.d", "fcvt.wu.d", "fcvt.l.d", "fcvt.lu.d", true)
+           .Cases("fcvt.s.w", "fcvt.s.wu", "fcvt.s.l", "fcvt.s.lu", true)
+           .Cases("fcvt.d.l", "fcvt.d.lu", "fcvt.s.d", true)
+           .Default(false);
+}
+
 static bool use32BitReg(StringRef Name) {
   return StringSwitch<bool>(Name)
            .Case("addiw",   true)
@@ -797,6 +1082,31 @@ static bool use32BitReg(StringRef Name) {
            .Case("c.addw",  true)
            .Case("c.subw",  true)
            .Case("c.addiw", true)
+           .Case("rolw",    true)
+           .Case("rorw",    true)
+           .Case("roriw",   true)
+           .Case("clzw",    true)
+           .Case("ctzw",    true)
+           .Case("cpopw",   true)
+           // Floating-point instructions with 32-bit integer operands.
+           .Case("fmv.x.w",   true)
+           .Case("fmv.w.x",   true)
+           .Case("fcvt.w.s",  true)
+           .Case("fcvt.wu.s", true)
+           .Case("fcvt.s.w",  true)
+           .Case("fcvt.s.wu", true)
+           .Case("fcvt.w.d",  true)
+           .Case("fcvt.wu.d", true)
+           .Case("fcvt.d.w",  true)
+           .Case("fcvt.d.wu", true)
+           .Case("feq.s",     true)
+           .Case("flt.s",     true)
+           .Case("fle.s",     true)
+           .Case("feq.d",     true)
+           .Case("flt.d",     true)
+           .Case("fle.d",     true)
+           .Case("fclass.s",  true)
+           .Case("fclass.d",  true)
            .Default(false);
 }
 
@@ -813,9 +1123,13 @@ bool RISCVAsmParser::ParseInstruction(ParseInstructionInfo &Info,
   }
 
   bool Reg32Bit = use32BitReg(Name);
+  bool FRMArg = hasRoundingModeOperand(Name);
 
   // Parse first operand
-  if (parseOperand(Operands, Reg32Bit))
+  if (Name == "call" || Name == "tail") {
+    if (parseCallSymbol(Operands))
+      return true;
+  } else if (parseOperand(Operands, Reg32Bit, FRMArg))
     return true;
 
   // Parse until end of statement, consuming commas between operands
@@ -824,7 +1138,7 @@ bool RISCVAsmParser::ParseInstruction(ParseInstructionInfo &Info,
     getLexer().Lex();
 
     // Parse next operand
-    if (parseOperand(Operands, Reg32Bit))
+    if (parseOperand(Operands, Reg32Bit, FRMArg))
       return true;
   }
 
@@ -12,10 +12,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "RISCVInstPrinter.h"
+#include "MCTargetDesc/RISCVBaseInfo.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCExpr.h"
 #include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/MCSymbol.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FormattedStream.h"
 using namespace llvm;
@@ -25,9 +29,22 @@ using namespace llvm;
 // Include the auto-generated portion of the assembly writer.
 #include "RISCVGenAsmWriter.inc"
 
+#define GEN_UNCOMPRESS_INSTR
+#include "RISCVGenCompressInstEmitter.inc"
+
+static cl::opt<bool>
+NoCompressedAliases("riscv-no-compressed-aliases", cl::Hidden,
+                    cl::init(false),
+                    cl::desc("Print compressed instructions in their 32-bit "
+                             "form"));
+
 void RISCVInstPrinter::printInst(const MCInst *MI, raw_ostream &O,
                                  StringRef Annot, const MCSubtargetInfo &STI) {
-  printInstruction(MI, O);
+  MCInst UncompressedMI;
+  if (NoCompressedAliases && uncompressInst(UncompressedMI, *MI, STI, MRI))
+    printInstruction(&UncompressedMI, O);
+  else
+    printInstruction(MI, O);
   printAnnotation(O, Annot);
 }
 
@@ -81,6 +98,16 @@ void RISCVInstPrinter::printS6ImmOperand(const MCInst *MI, int OpNum,
     printOperand(MI, OpNum, O);
 }
 
+// The dynamic rounding mode is the default and is not printed.
+void RISCVInstPrinter::printFRMArg(const MCInst *MI, unsigned OpNo,
+                                   raw_ostream &O) {
+  auto FRMArg =
+      static_cast<RISCVFPRndMode::RoundingMode>(MI->getOperand(OpNo).getImm());
+  if (FRMArg == RISCVFPRndMode::DYN)
+    return;
+  O << ", " << RISCVFPRndMode::roundingModeToString(FRMArg);
+}
+
 void RISCVInstPrinter::printS12ImmOperand(const MCInst *MI, int OpNum,
                                            raw_ostream &O) {
   if(MI->getOperand(OpNum).isImm()){
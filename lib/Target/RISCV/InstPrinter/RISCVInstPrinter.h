@@ -39,6 +39,8 @@ public:
 
   void printS6ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
 
+  void printFRMArg(const MCInst *MI, unsigned OpNo, raw_ostream &O);
+
   void printS12ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
 
   void printU6ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
@@ -7,90 +7,74 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "MCTargetDesc/RISCVFixupKinds.h"
-#include "MCTargetDesc/RISCVMCTargetDesc.h"
+#include "MCTargetDesc/RISCVAsmBackend.h"
 #include "llvm/ADT/APInt.h"
-#include "llvm/MC/MCAsmBackend.h"
+#include "llvm/MC/MCAsmLayout.h"
 #include "llvm/MC/MCAssembler.h"
+#include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCDirectives.h"
 #include "llvm/MC/MCELFObjectWriter.h"
 #include "llvm/MC/MCExpr.h"
-#include "llvm/MC/MCFixupKindInfo.h"
+#include "llvm/MC/MCInst.h"
 #include "llvm/MC/MCObjectWriter.h"
-#include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/MCSymbol.h"
+#include "llvm/MC/MCValue.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
-namespace {
-class RISCVAsmBackend : public MCAsmBackend {
-  const MCSubtargetInfo *STI;
-  uint8_t OSABI;
-  bool Is64Bit;
+const MCFixupKindInfo &
+RISCVAsmBackend::getFixupKindInfo(MCFixupKind Kind) const {
+  const static MCFixupKindInfo Infos[RISCV::NumTargetFixupKinds] = {
+    // This table *must* be in the order that the fixup_* kinds are defined in
+    // RISCVFixupKinds.h.
+    //
+    // name                    offset bits  flags
+    { "fixup_riscv_hi20",       12,     20,  0 },
+    { "fixup_riscv_lo12_i",     20,     12,  0 },
+    { "fixup_riscv_lo12_s",      0,     32,  0 },
+    { "fixup_riscv_pcrel_hi20", 12,     20,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_pcrel_lo12_i", 20,   12,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_pcrel_lo12_s",  0,   32,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_got_hi20",   12,     20,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_tprel_hi20", 12,     20,  0 },
+    { "fixup_riscv_tprel_lo12_i", 20,   12,  0 },
+    { "fixup_riscv_tprel_lo12_s",  0,   32,  0 },
+    { "fixup_riscv_tprel_add",   0,      0,  0 },
+    { "fixup_riscv_tls_got_hi20", 12,   20,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_tls_gd_hi20", 12,    20,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_gprel_i",    20,     12,  0 },
+    { "fixup_riscv_gprel_s",     0,     32,  0 },
+    { "fixup_riscv_jal",        12,     20,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_rvc_jump",    2,     11,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_rvc_branch",  0,     16,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_branch",      0,     32,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_call",        0,     64,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_call_plt",    0,     64,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_10_pcrel",    0,     32,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_lgp18s0",     0,     32,  0 },
+    { "fixup_riscv_lgp17s1",     0,     32,  0 },
+    { "fixup_riscv_lgp17s2",     0,     32,  0 },
+    { "fixup_riscv_lgp17s3",     0,     32,  0 },
+    { "fixup_riscv_sgp18s0",     0,     32,  0 },
+    { "fixup_riscv_sgp17s1",     0,     32,  0 },
+    { "fixup_riscv_sgp17s2",     0,     32,  0 },
+    { "fixup_riscv_sgp17s3",     0,     32,  0 },
+    { "fixup_riscv_relax",       0,      0,  0 },
+    { "fixup_riscv_align",       0,      0,  0 }
+  };
 
-public:
-  RISCVAsmBackend(const Triple &TT, uint8_t OSABI, bool Is64Bit)
-      : MCAsmBackend(), STI(RISCV_MC::createRISCVMCSubtargetInfo(TT, "", "")),
-        OSABI(OSABI), Is64Bit(Is64Bit) {}
+  if (Kind < FirstTargetFixupKind)
+    return MCAsmBackend::getFixupKindInfo(Kind);
 
-  ~RISCVAsmBackend() override {}
-
-  void applyFixup(const MCAssembler &Asm, const MCFixup &Fixup,
-                  const MCValue &Target, MutableArrayRef<char> Data,
-                  uint64_t Value, bool IsResolved) const override;
-
-  MCObjectWriter *createObjectWriter(raw_pwrite_stream &OS) const override;
-
-  bool fixupNeedsRelaxation(const MCFixup &Fixup, uint64_t Value,
-                            const MCRelaxableFragment *DF,
-                            const MCAsmLayout &Layout) const override {
-    return false;
-  }
-
-  unsigned getNumFixupKinds() const override {
-    return RISCV::NumTargetFixupKinds;
-  }
-
-  const MCFixupKindInfo &getFixupKindInfo(MCFixupKind Kind) const override {
-    const static MCFixupKindInfo Infos[RISCV::NumTargetFixupKinds] = {
-      // This table *must* be in the order that the fixup_* kinds are defined in
-      // RISCVFixupKinds.h.
-      //
-      // name                    offset bits  flags
-      { "fixup_riscv_hi20",       12,     20,  0 },
-      { "fixup_riscv_lo12_i",     20,     12,  0 },
-      { "fixup_riscv_lo12_s",      0,     32,  0 },
-      { "fixup_riscv_pcrel_hi20", 12,     20,  MCFixupKindInfo::FKF_IsPCRel },
-      { "fixup_riscv_jal",        12,     20,  MCFixupKindInfo::FKF_IsPCRel },
-      { "fixup_riscv_rvc_jump",    2,     11,  MCFixupKindInfo::FKF_IsPCRel },
-      { "fixup_riscv_rvc_branch",  2,     11,  MCFixupKindInfo::FKF_IsPCRel },
-      { "fixup_riscv_branch",      0,     32,  MCFixupKindInfo::FKF_IsPCRel }
-    };
-
-
-    if (Kind < FirstTargetFixupKind)
-      return MCAsmBackend::getFixupKindInfo(Kind);
-
-    assert(unsigned(Kind - FirstTargetFixupKind) < getNumFixupKinds() &&
-           "Invalid kind!");
-    return Infos[Kind - FirstTargetFixupKind];
-  }
-
-  bool mayNeedRelaxation(const MCInst &Inst) const override { return false; }
-
-  void relaxInstruction(const MCInst &Inst, const MCSubtargetInfo &STI,
-                        MCInst &Res) const override {
-
-    llvm_unreachable("RISCVAsmBackend::relaxInstruction() unimplemented");
-  }
-
-  bool writeNopData(uint64_t Count, MCObjectWriter *OW) const override;
-};
+  assert(unsigned(Kind - FirstTargetFixupKind) < getNumFixupKinds() &&
+         "Invalid kind!");
+  return Infos[Kind - FirstTargetFixupKind];
+}
 
 bool RISCVAsmBackend::writeNopData(uint64_t Count, MCObjectWriter *OW) const {
-  bool HasC = STI->getFeatureBits()[RISCV::FeatureC];
   if (HasC) {
     if ((Count % 2) != 0)
       return false;
@@ -116,6 +100,124 @@ bool RISCVAsmBackend::writeNopData(uint64_t Count, MCObjectWriter *OW) const {
   return true;
 }
 
+// Compressed branches and jumps whose target is out of range, or not known
+// until link time, are widened back to their 32-bit forms.
+bool RISCVAsmBackend::fixupNeedsRelaxation(const MCFixup &Fixup, uint64_t Value,
+                                           const MCRelaxableFragment *DF,
+                                           const MCAsmLayout &Layout) const {
+  int64_t Offset = int64_t(Value);
+  switch ((unsigned)Fixup.getKind()) {
+  default:
+    return false;
+  case RISCV::fixup_riscv_rvc_branch:
+    return !isInt<9>(Offset);
+  case RISCV::fixup_riscv_rvc_jump:
+    return !isInt<12>(Offset);
+  }
+}
+
+bool RISCVAsmBackend::mayNeedRelaxation(const MCInst &Inst) const {
+  switch (Inst.getOpcode()) {
+  default:
+    return false;
+  case RISCV::CBEQZ:
+  case RISCV::CBNEZ:
+  case RISCV::CBEQZ64:
+  case RISCV::CBNEZ64:
+  case RISCV::CJ:
+  case RISCV::CJ64:
+  case RISCV::CJAL:
+    return true;
+  }
+}
+
+void RISCVAsmBackend::relaxInstruction(const MCInst &Inst,
+                                       const MCSubtargetInfo &STI,
+                                       MCInst &Res) const {
+  switch (Inst.getOpcode()) {
+  default:
+    llvm_unreachable("Opcode not expected!");
+  case RISCV::CBEQZ:
+    Res.setOpcode(RISCV::BEQ);
+    Res.addOperand(Inst.getOperand(0));
+    Res.addOperand(MCOperand::createReg(RISCV::X0_32));
+    Res.addOperand(Inst.getOperand(1));
+    break;
+  case RISCV::CBNEZ:
+    Res.setOpcode(RISCV::BNE);
+    Res.addOperand(Inst.getOperand(0));
+    Res.addOperand(MCOperand::createReg(RISCV::X0_32));
+    Res.addOperand(Inst.getOperand(1));
+    break;
+  case RISCV::CBEQZ64:
+    Res.setOpcode(RISCV::BEQ64);
+    Res.addOperand(Inst.getOperand(0));
+    Res.addOperand(MCOperand::createReg(RISCV::X0_64));
+    Res.addOperand(Inst.getOperand(1));
+    break;
+  case RISCV::CBNEZ64:
+    Res.setOpcode(RISCV::BNE64);
+    Res.addOperand(Inst.getOperand(0));
+    Res.addOperand(MCOperand::createReg(RISCV::X0_64));
+    Res.addOperand(Inst.getOperand(1));
+    break;
+  case RISCV::CJ:
+    Res.setOpcode(RISCV::JAL);
+    Res.addOperand(MCOperand::createReg(RISCV::X0_32));
+    Res.addOperand(Inst.getOperand(0));
+    break;
+  case RISCV::CJ64:
+    Res.setOpcode(RISCV::JAL64);
+    Res.addOperand(MCOperand::createReg(RISCV::X0_64));
+    Res.addOperand(Inst.getOperand(0));
+    break;
+  case RISCV::CJAL:
+    Res.setOpcode(RISCV::JAL);
+    Res.addOperand(MCOperand::createReg(RISCV::X1_32));
+    Res.addOperand(Inst.getOperand(0));
+    break;
+  }
+}
+
+// Linker relaxation may shrink the code before an alignment directive, so
+// reserve the worst-case padding and let the linker delete what it does not
+// need. This is only done when relaxation is enabled.
+bool RISCVAsmBackend::shouldInsertExtraNopBytesForCodeAlign(
+    const MCAlignFragment &AF, unsigned &Size) {
+  if (!willForceRelocations())
+    return false;
+
+  unsigned MinNopLen = HasC ? 2 : 4;
+
+  if (AF.getAlignment() <= MinNopLen)
+    return false;
+
+  Size = AF.getAlignment() - MinNopLen;
+  return true;
+}
+
+// Record an R_RISCV_ALIGN relocation whose addend is the number of padding
+// bytes, so that the linker can restore the alignment after relaxation.
+bool RISCVAsmBackend::shouldInsertFixupForCodeAlign(MCAssembler &Asm,
+                                                    const MCAsmLayout &Layout,
+                                                    MCAlignFragment &AF) {
+  unsigned Count;
+  if (!shouldInsertExtraNopBytesForCodeAlign(AF, Count) || Count == 0)
+    return false;
+
+  MCContext &Ctx = Asm.getContext();
+  const MCExpr *Dummy = MCConstantExpr::create(0, Ctx);
+  MCFixup Fixup =
+      MCFixup::create(0, Dummy, MCFixupKind(RISCV::fixup_riscv_align), SMLoc());
+
+  uint64_t FixedValue = 0;
+  MCValue NopBytes = MCValue::get(Count);
+
+  Asm.getWriter().recordRelocation(Asm, Layout, &AF, Fixup, NopBytes,
+                                   FixedValue);
+  return true;
+}
+
 static uint64_t adjustFixupValue(unsigned Kind, uint64_t Value) {
   switch (Kind) {
   default:
@@ -126,13 +228,44 @@ static uint64_t adjustFixupValue(unsigned Kind, uint64_t Value) {
   case FK_Data_8:
     return Value;
   case RISCV::fixup_riscv_lo12_i:
+  case RISCV::fixup_riscv_pcrel_lo12_i:
     return Value & 0xfff;
   case RISCV::fixup_riscv_lo12_s:
+  case RISCV::fixup_riscv_pcrel_lo12_s:
     return (((Value >> 5) & 0x7f) << 25) | ((Value & 0x1f) << 7);
   case RISCV::fixup_riscv_hi20:
   case RISCV::fixup_riscv_pcrel_hi20:
+  case RISCV::fixup_riscv_got_hi20:
     // Add 1 if bit 11 is 1, to compensate for low 12 bits being negative.
     return ((Value + 0x800) >> 12) & 0xfffff;
+  case RISCV::fixup_riscv_call:
+  case RISCV::fixup_riscv_call_plt: {
+    // The jalr adds the sign-extended low 12 bits, so round the auipc part
+    // up when bit 11 is set. The low part goes into the jalr immediate of
+    // the second instruction word.
+    uint64_t UpperImm = (Value + 0x800ULL) & 0xfffff000ULL;
+    uint64_t LowerImm = Value & 0xfffULL;
+    return UpperImm | ((LowerImm << 20) << 32);
+  }
+  case RISCV::fixup_riscv_relax:
+  case RISCV::fixup_riscv_align:
+  case RISCV::fixup_riscv_tprel_hi20:
+  case RISCV::fixup_riscv_tprel_lo12_i:
+  case RISCV::fixup_riscv_tprel_lo12_s:
+  case RISCV::fixup_riscv_tprel_add:
+  case RISCV::fixup_riscv_tls_got_hi20:
+  case RISCV::fixup_riscv_tls_gd_hi20:
+  case RISCV::fixup_riscv_gprel_i:
+  case RISCV::fixup_riscv_gprel_s:
+  case RISCV::fixup_riscv_lgp18s0:
+  case RISCV::fixup_riscv_lgp17s1:
+  case RISCV::fixup_riscv_lgp17s2:
+  case RISCV::fixup_riscv_lgp17s3:
+  case RISCV::fixup_riscv_sgp18s0:
+  case RISCV::fixup_riscv_sgp17s1:
+  case RISCV::fixup_riscv_sgp17s2:
+  case RISCV::fixup_riscv_sgp17s3:
+    llvm_unreachable("Relocation should be unconditionally forced");
   case RISCV::fixup_riscv_jal: {
     // Need to produce imm[19|10:1|11|19:12] from the 21-bit Value.
     unsigned Sbit = (Value >> 20) & 0x1;
@@ -167,8 +300,8 @@ static uint64_t adjustFixupValue(unsigned Kind, uint64_t Value) {
     unsigned Bit5  = (Value >> 5) & 0x1;
     unsigned Bit4_3 = (Value >> 3) & 0x3;
     unsigned Bit2_1 = (Value >> 1) & 0x3;
-    Value = (Bit8 << 10) | (Bit4_3 << 8) | (Bit7_6 << 3) |
-            (Bit2_1 << 1) | Bit5;
+    Value = (Bit8 << 12) | (Bit4_3 << 10) | (Bit7_6 << 5) |
+            (Bit2_1 << 3) | (Bit5 << 2);
     return Value;
   }
   case RISCV::fixup_riscv_branch: {
@@ -185,17 +318,36 @@ static uint64_t adjustFixupValue(unsigned Kind, uint64_t Value) {
     Value = (Sbit << 31) | (Mid6 << 25) | (Lo4 << 8) | (Hi1 << 7);
     return Value;
   }
+  case RISCV::fixup_riscv_10_pcrel: {
+    // Need to extract imm[10], imm[9:5], imm[4:1] from the 11-bit Value.
+    unsigned Sbit = (Value >> 10) & 0x1;
+    unsigned Mid5 = (Value >> 5) & 0x1f;
+    unsigned Lo4 = (Value >> 1) & 0xf;
+    // Inst{31} = Sbit;
+    // Inst{29-25} = Mid5;
+    // Inst{11-8} = Lo4;
+    Value = (Sbit << 31) | (Mid5 << 25) | (Lo4 << 8);
+    return Value;
+  }
 
   }
 }
 
-static unsigned getSize(unsigned Kind) {
+static unsigned getSize(unsigned Kind, const MCFixupKindInfo &Info) {
+  // Data fixups, such as the entries of a compact jump table, cover exactly
+  // the bytes of their value.
+  if (Kind < FirstTargetFixupKind)
+    return (Info.TargetSize + 7) / 8;
+
   switch (Kind) {
   default:
     break;
   case RISCV::fixup_riscv_rvc_jump:
   case RISCV::fixup_riscv_rvc_branch:
     return 2;
+  case RISCV::fixup_riscv_call:
+  case RISCV::fixup_riscv_call_plt:
+    return 8;
   }
   return 4;
 }
@@ -214,7 +366,7 @@ void RISCVAsmBackend::applyFixup(const MCAssembler &Asm, const MCFixup &Fixup,
   Value <<= Info.TargetOffset;
 
   unsigned Offset = Fixup.getOffset();
-  unsigned FullSize = getSize(Fixup.getKind());
+  unsigned FullSize = getSize(Fixup.getKind(), Info);
 
   // For each byte of the fragment that the fixup touches, mask in the
   // bits from the fixup value.
@@ -230,12 +382,10 @@ RISCVAsmBackend::createObjectWriter(raw_pwrite_stream &OS) const {
   return createRISCVELFObjectWriter(OS, OSABI, Is64Bit);
 }
 
-} // end anonymous namespace
-
 MCAsmBackend *llvm::createRISCVAsmBackend(const Target &T,
                                           const MCRegisterInfo &MRI,
                                           const Triple &TT, StringRef CPU,
                                           const MCTargetOptions &Options) {
   uint8_t OSABI = MCELFObjectTargetWriter::getOSABI(TT.getOS());
-  return new RISCVAsmBackend(TT, OSABI, TT.isArch64Bit());
+  return new RISCVAsmBackend(OSABI, TT.isArch64Bit());
 }
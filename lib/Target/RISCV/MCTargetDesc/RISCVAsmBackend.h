@@ -0,0 +1,122 @@
+//===-- RISCVAsmBackend.h - RISCV Assembler Backend -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_RISCV_MCTARGETDESC_RISCVASMBACKEND_H
+#define LLVM_LIB_TARGET_RISCV_MCTARGETDESC_RISCVASMBACKEND_H
+
+#include "MCTargetDesc/RISCVFixupKinds.h"
+#include "MCTargetDesc/RISCVMCTargetDesc.h"
+#include "llvm/MC/MCAsmBackend.h"
+#include "llvm/MC/MCFixupKindInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/ErrorHandling.h"
+
+namespace llvm {
+class MCAssembler;
+class MCObjectWriter;
+class raw_ostream;
+
+class RISCVAsmBackend : public MCAsmBackend {
+  uint8_t OSABI;
+  bool Is64Bit;
+  // Set when the object is assembled with the C extension, which allows
+  // 2-byte nops.
+  bool HasC = false;
+  // Set when the object is assembled for linker relaxation. Every fixup
+  // that refers to a symbol then becomes a relocation, since the linker may
+  // change the distance between any two locations.
+  bool ForceRelocs = false;
+
+public:
+  RISCVAsmBackend(uint8_t OSABI, bool Is64Bit)
+      : MCAsmBackend(), OSABI(OSABI), Is64Bit(Is64Bit) {}
+
+  ~RISCVAsmBackend() override {}
+
+  void setHasC() { HasC = true; }
+  void setForceRelocs() { ForceRelocs = true; }
+  bool willForceRelocations() const { return ForceRelocs; }
+
+  // Generate diff expression relocations if the relax feature is enabled,
+  // otherwise it is safe for the assembler to calculate these internally.
+  bool requiresDiffExpressionRelocations() const override {
+    return willForceRelocations();
+  }
+
+  // Return Size with extra Nop Bytes for alignment directive in code section.
+  bool shouldInsertExtraNopBytesForCodeAlign(const MCAlignFragment &AF,
+                                             unsigned &Size) override;
+
+  // Insert target specific fixup type for alignment directive in code
+  // section.
+  bool shouldInsertFixupForCodeAlign(MCAssembler &Asm,
+                                     const MCAsmLayout &Layout,
+                                     MCAlignFragment &AF) override;
+
+  void applyFixup(const MCAssembler &Asm, const MCFixup &Fixup,
+                  const MCValue &Target, MutableArrayRef<char> Data,
+                  uint64_t Value, bool IsResolved) const override;
+
+  MCObjectWriter *createObjectWriter(raw_pwrite_stream &OS) const override;
+
+  bool shouldForceRelocation(const MCAssembler &Asm, const MCFixup &Fixup,
+                             const MCValue &Target) override {
+    switch ((unsigned)Fixup.getKind()) {
+    default:
+      break;
+    // The linker resolves a %pcrel_lo by finding the %pcrel_hi or
+    // %got_pcrel_hi relocation at the address of its label operand, so the
+    // two halves must always be left to the linker together.
+    case RISCV::fixup_riscv_pcrel_hi20:
+    case RISCV::fixup_riscv_pcrel_lo12_i:
+    case RISCV::fixup_riscv_pcrel_lo12_s:
+    case RISCV::fixup_riscv_got_hi20:
+    // Thread pointer offsets and TLS GOT entries are only known at link time.
+    case RISCV::fixup_riscv_tprel_hi20:
+    case RISCV::fixup_riscv_tprel_lo12_i:
+    case RISCV::fixup_riscv_tprel_lo12_s:
+    case RISCV::fixup_riscv_tprel_add:
+    case RISCV::fixup_riscv_tls_got_hi20:
+    case RISCV::fixup_riscv_tls_gd_hi20:
+    // The value of gp is only known to the linker.
+    case RISCV::fixup_riscv_gprel_i:
+    case RISCV::fixup_riscv_gprel_s:
+    case RISCV::fixup_riscv_lgp18s0:
+    case RISCV::fixup_riscv_lgp17s1:
+    case RISCV::fixup_riscv_lgp17s2:
+    case RISCV::fixup_riscv_lgp17s3:
+    case RISCV::fixup_riscv_sgp18s0:
+    case RISCV::fixup_riscv_sgp17s1:
+    case RISCV::fixup_riscv_sgp17s2:
+    case RISCV::fixup_riscv_sgp17s3:
+      return true;
+    }
+    return willForceRelocations();
+  }
+
+  bool fixupNeedsRelaxation(const MCFixup &Fixup, uint64_t Value,
+                            const MCRelaxableFragment *DF,
+                            const MCAsmLayout &Layout) const override;
+
+  unsigned getNumFixupKinds() const override {
+    return RISCV::NumTargetFixupKinds;
+  }
+
+  const MCFixupKindInfo &getFixupKindInfo(MCFixupKind Kind) const override;
+
+  bool mayNeedRelaxation(const MCInst &Inst) const override;
+
+  void relaxInstruction(const MCInst &Inst, const MCSubtargetInfo &STI,
+                        MCInst &Res) const override;
+
+  bool writeNopData(uint64_t Count, MCObjectWriter *OW) const override;
+};
+} // end namespace llvm
+
+#endif
@@ -22,6 +22,13 @@ public:
 
   ~RISCVELFObjectWriter() override;
 
+  // Relocations against a section symbol would not follow the symbol when
+  // the linker deletes bytes during relaxation, so always keep the symbol.
+  bool needsRelocateWithSymbol(const MCSymbol &Sym,
+                               unsigned Type) const override {
+    return true;
+  }
+
 protected:
   unsigned getRelocType(MCContext &Ctx, const MCValue &Target,
                         const MCFixup &Fixup, bool IsPCRel) const override;
@@ -46,6 +53,22 @@ unsigned RISCVELFObjectWriter::getRelocType(MCContext &Ctx,
     return ELF::R_RISCV_32;
   case FK_Data_8:
     return ELF::R_RISCV_64;
+  case FK_Data_Add_1:
+    return ELF::R_RISCV_ADD8;
+  case FK_Data_Add_2:
+    return ELF::R_RISCV_ADD16;
+  case FK_Data_Add_4:
+    return ELF::R_RISCV_ADD32;
+  case FK_Data_Add_8:
+    return ELF::R_RISCV_ADD64;
+  case FK_Data_Sub_1:
+    return ELF::R_RISCV_SUB8;
+  case FK_Data_Sub_2:
+    return ELF::R_RISCV_SUB16;
+  case FK_Data_Sub_4:
+    return ELF::R_RISCV_SUB32;
+  case FK_Data_Sub_8:
+    return ELF::R_RISCV_SUB64;
   case RISCV::fixup_riscv_hi20:
     return ELF::R_RISCV_HI20;
   case RISCV::fixup_riscv_lo12_i:
@@ -54,6 +77,28 @@ unsigned RISCVELFObjectWriter::getRelocType(MCContext &Ctx,
     return ELF::R_RISCV_LO12_S;
   case RISCV::fixup_riscv_pcrel_hi20:
     return ELF::R_RISCV_PCREL_HI20;
+  case RISCV::fixup_riscv_pcrel_lo12_i:
+    return ELF::R_RISCV_PCREL_LO12_I;
+  case RISCV::fixup_riscv_pcrel_lo12_s:
+    return ELF::R_RISCV_PCREL_LO12_S;
+  case RISCV::fixup_riscv_got_hi20:
+    return ELF::R_RISCV_GOT_HI20;
+  case RISCV::fixup_riscv_tprel_hi20:
+    return ELF::R_RISCV_TPREL_HI20;
+  case RISCV::fixup_riscv_tprel_lo12_i:
+    return ELF::R_RISCV_TPREL_LO12_I;
+  case RISCV::fixup_riscv_tprel_lo12_s:
+    return ELF::R_RISCV_TPREL_LO12_S;
+  case RISCV::fixup_riscv_tprel_add:
+    return ELF::R_RISCV_TPREL_ADD;
+  case RISCV::fixup_riscv_tls_got_hi20:
+    return ELF::R_RISCV_TLS_GOT_HI20;
+  case RISCV::fixup_riscv_tls_gd_hi20:
+    return ELF::R_RISCV_TLS_GD_HI20;
+  case RISCV::fixup_riscv_gprel_i:
+    return ELF::R_RISCV_GPREL_I;
+  case RISCV::fixup_riscv_gprel_s:
+    return ELF::R_RISCV_GPREL_S;
   case RISCV::fixup_riscv_jal:
     return ELF::R_RISCV_JAL;
   case RISCV::fixup_riscv_rvc_jump:
@@ -62,6 +107,32 @@ unsigned RISCVELFObjectWriter::getRelocType(MCContext &Ctx,
     return ELF::R_RISCV_RVC_BRANCH;
   case RISCV::fixup_riscv_branch:
     return ELF::R_RISCV_BRANCH;
+  case RISCV::fixup_riscv_call:
+    return ELF::R_RISCV_CALL;
+  case RISCV::fixup_riscv_call_plt:
+    return ELF::R_RISCV_CALL_PLT;
+  case RISCV::fixup_riscv_10_pcrel:
+    return ELF::R_RISCV_10_PCREL;
+  case RISCV::fixup_riscv_lgp18s0:
+    return ELF::R_RISCV_LGP18S0;
+  case RISCV::fixup_riscv_lgp17s1:
+    return ELF::R_RISCV_LGP17S1;
+  case RISCV::fixup_riscv_lgp17s2:
+    return ELF::R_RISCV_LGP17S2;
+  case RISCV::fixup_riscv_lgp17s3:
+    return ELF::R_RISCV_LGP17S3;
+  case RISCV::fixup_riscv_sgp18s0:
+    return ELF::R_RISCV_SGP18S0;
+  case RISCV::fixup_riscv_sgp17s1:
+    return ELF::R_RISCV_SGP17S1;
+  case RISCV::fixup_riscv_sgp17s2:
+    return ELF::R_RISCV_SGP17S2;
+  case RISCV::fixup_riscv_sgp17s3:
+    return ELF::R_RISCV_SGP17S3;
+  case RISCV::fixup_riscv_relax:
+    return ELF::R_RISCV_RELAX;
+  case RISCV::fixup_riscv_align:
+    return ELF::R_RISCV_ALIGN;
   }
 }
 
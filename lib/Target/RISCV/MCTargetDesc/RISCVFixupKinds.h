@@ -29,6 +29,39 @@ enum Fixups {
   // fixup_riscv_pcrel_hi20 - 20-bit fixup corresponding to pcrel_hi(foo) for
   // instructions like auipc
   fixup_riscv_pcrel_hi20,
+  // fixup_riscv_pcrel_lo12_i - 12-bit fixup corresponding to pcrel_lo(foo) for
+  // instructions like addi
+  fixup_riscv_pcrel_lo12_i,
+  // fixup_riscv_pcrel_lo12_s - 12-bit fixup corresponding to pcrel_lo(foo) for
+  // the S-type store instructions
+  fixup_riscv_pcrel_lo12_s,
+  // fixup_riscv_got_hi20 - 20-bit fixup corresponding to got_pcrel_hi(foo) for
+  // instructions like auipc
+  fixup_riscv_got_hi20,
+  // fixup_riscv_tprel_hi20 - 20-bit fixup corresponding to tprel_hi(foo) for
+  // instructions like lui
+  fixup_riscv_tprel_hi20,
+  // fixup_riscv_tprel_lo12_i - 12-bit fixup corresponding to tprel_lo(foo) for
+  // instructions like addi
+  fixup_riscv_tprel_lo12_i,
+  // fixup_riscv_tprel_lo12_s - 12-bit fixup corresponding to tprel_lo(foo) for
+  // the S-type store instructions
+  fixup_riscv_tprel_lo12_s,
+  // fixup_riscv_tprel_add - A fixup corresponding to %tprel_add(foo) for the
+  // add_tls instruction. Used to provide a hint to the linker.
+  fixup_riscv_tprel_add,
+  // fixup_riscv_tls_got_hi20 - 20-bit fixup corresponding to
+  // tls_ie_pcrel_hi(foo) for instructions like auipc
+  fixup_riscv_tls_got_hi20,
+  // fixup_riscv_tls_gd_hi20 - 20-bit fixup corresponding to
+  // tls_gd_pcrel_hi(foo) for instructions like auipc
+  fixup_riscv_tls_gd_hi20,
+  // fixup_riscv_gprel_i - 12-bit fixup corresponding to gp_rel(foo) for
+  // instructions like addi
+  fixup_riscv_gprel_i,
+  // fixup_riscv_gprel_s - 12-bit fixup corresponding to gp_rel(foo) for
+  // the S-type store instructions
+  fixup_riscv_gprel_s,
   // fixup_riscv_jal - 20-bit fixup for symbol references in the jal
   // instruction
   fixup_riscv_jal,
@@ -41,6 +74,47 @@ enum Fixups {
   // fixup_riscv_branch - 12-bit fixup for symbol references in the branch
   // instructions
   fixup_riscv_branch,
+  // fixup_riscv_call - A fixup representing a call attached to the auipc
+  // instruction in a pair composed of adjacent auipc+jalr instructions.
+  fixup_riscv_call,
+  // fixup_riscv_call_plt - A fixup representing a procedure linkage table
+  // call attached to the auipc instruction in a pair composed of adjacent
+  // auipc+jalr instructions.
+  fixup_riscv_call_plt,
+  // fixup_riscv_10_pcrel - 10-bit fixup for symbol references in the
+  // AndeStar V5 branch-on-constant and branch-on-bit instructions
+  fixup_riscv_10_pcrel,
+  // fixup_riscv_lgp18s0 - 18-bit gp-relative fixup for the AndeStar V5
+  // byte loads and addigp
+  fixup_riscv_lgp18s0,
+  // fixup_riscv_lgp17s1 - 17-bit gp-relative fixup, scaled by 2, for the
+  // AndeStar V5 halfword loads
+  fixup_riscv_lgp17s1,
+  // fixup_riscv_lgp17s2 - 17-bit gp-relative fixup, scaled by 4, for the
+  // AndeStar V5 word loads
+  fixup_riscv_lgp17s2,
+  // fixup_riscv_lgp17s3 - 17-bit gp-relative fixup, scaled by 8, for the
+  // AndeStar V5 doubleword loads
+  fixup_riscv_lgp17s3,
+  // fixup_riscv_sgp18s0 - 18-bit gp-relative fixup for the AndeStar V5 byte
+  // stores
+  fixup_riscv_sgp18s0,
+  // fixup_riscv_sgp17s1 - 17-bit gp-relative fixup, scaled by 2, for the
+  // AndeStar V5 halfword stores
+  fixup_riscv_sgp17s1,
+  // fixup_riscv_sgp17s2 - 17-bit gp-relative fixup, scaled by 4, for the
+  // AndeStar V5 word stores
+  fixup_riscv_sgp17s2,
+  // fixup_riscv_sgp17s3 - 17-bit gp-relative fixup, scaled by 8, for the
+  // AndeStar V5 doubleword stores
+  fixup_riscv_sgp17s3,
+  // fixup_riscv_relax - Used to generate an R_RISCV_RELAX relocation type,
+  // which indicates the linker may relax the instruction pair.
+  fixup_riscv_relax,
+  // fixup_riscv_align - Used to generate an R_RISCV_ALIGN relocation type,
+  // which indicates the linker should fixup the alignment after linker
+  // relaxation.
+  fixup_riscv_align,
 
   // Marker
   LastTargetFixupKind,
@@ -20,6 +20,7 @@
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCExpr.h"
 #include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstBuilder.h"
 #include "llvm/MC/MCInstrInfo.h"
 #include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/MC/MCSymbol.h"
@@ -57,6 +58,14 @@ public:
   void EmitInstruction(uint64_t Val, unsigned Size, const MCSubtargetInfo &STI,
                        raw_ostream &OS) const;
 
+  void expandFunctionCall(const MCInst &MI, raw_ostream &OS,
+                          SmallVectorImpl<MCFixup> &Fixups,
+                          const MCSubtargetInfo &STI) const;
+
+  void expandAddTPRel(const MCInst &MI, raw_ostream &OS,
+                      SmallVectorImpl<MCFixup> &Fixups,
+                      const MCSubtargetInfo &STI) const;
+
   /// TableGen'erated function for getting the binary encoding for an
   /// instruction.
   uint64_t getBinaryCodeForInstr(const MCInst &MI,
@@ -127,9 +136,98 @@ void RISCVMCCodeEmitter::EmitInstruction(uint64_t Val, unsigned Size,
   }
 }
 
+// Expand PseudoCALL and PseudoTAIL to AUIPC and JALR with a single
+// R_RISCV_CALL(_PLT) relocation on the pair, so that the linker can relax it
+// to a JAL.
+//
+//   call sym  =>  auipc ra, 0        tail sym  =>  auipc t1, 0
+//                 jalr ra, ra, 0                   jalr zero, t1, 0
+//
+// "call rd, sym" links through rd instead of ra.
+void RISCVMCCodeEmitter::expandFunctionCall(const MCInst &MI, raw_ostream &OS,
+                                            SmallVectorImpl<MCFixup> &Fixups,
+                                            const MCSubtargetInfo &STI) const {
+  unsigned Opc = MI.getOpcode();
+  bool Is64Bit = Opc == RISCV::PseudoCALL64 || Opc == RISCV::PseudoTAIL64 ||
+                 Opc == RISCV::PseudoCALLReg64;
+  bool IsTail = Opc == RISCV::PseudoTAIL || Opc == RISCV::PseudoTAIL64;
+  bool HasLinkReg =
+      Opc == RISCV::PseudoCALLReg || Opc == RISCV::PseudoCALLReg64;
+  unsigned Ra;
+  unsigned Link;
+  if (HasLinkReg) {
+    Ra = Link = MI.getOperand(0).getReg();
+  } else if (Is64Bit) {
+    Ra = IsTail ? RISCV::X6_64 : RISCV::X1_64;
+    Link = IsTail ? RISCV::X0_64 : RISCV::X1_64;
+  } else {
+    Ra = IsTail ? RISCV::X6_32 : RISCV::X1_32;
+    Link = IsTail ? RISCV::X0_32 : RISCV::X1_32;
+  }
+
+  const MCOperand &Func = MI.getOperand(HasLinkReg ? 1 : 0);
+  assert(Func.isExpr() && "Expected expression");
+
+  MCInst TmpInst = MCInstBuilder(Is64Bit ? RISCV::AUIPC64 : RISCV::AUIPC)
+                       .addReg(Ra)
+                       .addOperand(Func);
+  // The fixup on the AUIPC covers both instructions.
+  uint32_t Binary = getBinaryCodeForInstr(TmpInst, Fixups, STI);
+  EmitInstruction(Binary, 4, STI, OS);
+
+  TmpInst = MCInstBuilder(Is64Bit ? RISCV::JALR64 : RISCV::JALR)
+                .addReg(Link)
+                .addReg(Ra)
+                .addImm(0);
+  Binary = getBinaryCodeForInstr(TmpInst, Fixups, STI);
+  EmitInstruction(Binary, 4, STI, OS);
+}
+
+// The TP-relative add is an ordinary ADD that also carries an
+// R_RISCV_TPREL_ADD relocation, so the linker can find it when relaxing the
+// local-exec sequence.
+void RISCVMCCodeEmitter::expandAddTPRel(const MCInst &MI, raw_ostream &OS,
+                                        SmallVectorImpl<MCFixup> &Fixups,
+                                        const MCSubtargetInfo &STI) const {
+  bool Is64Bit = MI.getOpcode() == RISCV::PseudoAddTPRel64;
+  const MCOperand &DestReg = MI.getOperand(0);
+  const MCOperand &SrcReg = MI.getOperand(1);
+  const MCOperand &TPReg = MI.getOperand(2);
+  assert(TPReg.isReg() &&
+         TPReg.getReg() == (Is64Bit ? RISCV::X4_64 : RISCV::X4_32) &&
+         "Expected thread pointer as second input to TP-relative add");
+
+  const MCOperand &SrcSymbol = MI.getOperand(3);
+  assert(SrcSymbol.isExpr() &&
+         "Expected expression as third input to TP-relative add");
+  getExprOpValue(MI, SrcSymbol.getExpr(), Fixups, STI);
+
+  MCInst TmpInst = MCInstBuilder(Is64Bit ? RISCV::ADD64 : RISCV::ADD)
+                       .addOperand(DestReg)
+                       .addOperand(SrcReg)
+                       .addOperand(TPReg);
+  uint32_t Binary = getBinaryCodeForInstr(TmpInst, Fixups, STI);
+  EmitInstruction(Binary, 4, STI, OS);
+}
+
 void RISCVMCCodeEmitter::encodeInstruction(const MCInst &MI, raw_ostream &OS,
                                            SmallVectorImpl<MCFixup> &Fixups,
                                            const MCSubtargetInfo &STI) const {
+  unsigned Opc = MI.getOpcode();
+  if (Opc == RISCV::PseudoCALL || Opc == RISCV::PseudoCALL64 ||
+      Opc == RISCV::PseudoCALLReg || Opc == RISCV::PseudoCALLReg64 ||
+      Opc == RISCV::PseudoTAIL || Opc == RISCV::PseudoTAIL64) {
+    expandFunctionCall(MI, OS, Fixups, STI);
+    MCNumEmitted += 2;
+    return;
+  }
+
+  if (Opc == RISCV::PseudoAddTPRel || Opc == RISCV::PseudoAddTPRel64) {
+    expandAddTPRel(MI, OS, Fixups, STI);
+    MCNumEmitted += 1;
+    return;
+  }
+
   MCInst TmpInst = MI;
 
   uint32_t Binary = getBinaryCodeForInstr(TmpInst, Fixups, STI);
@@ -196,6 +294,53 @@ unsigned RISCVMCCodeEmitter::getImmOpValue(const MCInst &MI, unsigned OpNo,
   return getExprOpValue(MI, MO.getExpr(),Fixups, STI);
 }
 
+// Return the gp-relative fixup of an AndeStar V5 gp-implied load or store,
+// or false if Opc is not one of them. The fixup depends on the access size,
+// which sets both the width and the scaling of the immediate.
+static bool getGPFixupKind(unsigned Opc, RISCV::Fixups &FixupKind) {
+  switch (Opc) {
+  default:
+    return false;
+  case RISCV::ADDIGP:
+  case RISCV::ADDIGP64:
+  case RISCV::LBGP:
+  case RISCV::LBGP64:
+  case RISCV::LBUGP:
+  case RISCV::LBUGP64:
+    FixupKind = RISCV::fixup_riscv_lgp18s0;
+    return true;
+  case RISCV::LHGP:
+  case RISCV::LHGP64:
+  case RISCV::LHUGP:
+  case RISCV::LHUGP64:
+    FixupKind = RISCV::fixup_riscv_lgp17s1;
+    return true;
+  case RISCV::LWGP:
+  case RISCV::LWGP64:
+  case RISCV::LWUGP:
+    FixupKind = RISCV::fixup_riscv_lgp17s2;
+    return true;
+  case RISCV::LDGP:
+    FixupKind = RISCV::fixup_riscv_lgp17s3;
+    return true;
+  case RISCV::SBGP:
+  case RISCV::SBGP64:
+    FixupKind = RISCV::fixup_riscv_sgp18s0;
+    return true;
+  case RISCV::SHGP:
+  case RISCV::SHGP64:
+    FixupKind = RISCV::fixup_riscv_sgp17s1;
+    return true;
+  case RISCV::SWGP:
+  case RISCV::SWGP64:
+    FixupKind = RISCV::fixup_riscv_sgp17s2;
+    return true;
+  case RISCV::SDGP:
+    FixupKind = RISCV::fixup_riscv_sgp17s3;
+    return true;
+  }
+}
+
 unsigned RISCVMCCodeEmitter::
 getExprOpValue(const MCInst &MI, const MCExpr *Expr,
                SmallVectorImpl<MCFixup> &Fixups,
@@ -219,9 +364,44 @@ getExprOpValue(const MCInst &MI, const MCExpr *Expr,
     case RISCVMCExpr::VK_RISCV_HI:
       FixupKind = RISCV::fixup_riscv_hi20;
       break;
+    case RISCVMCExpr::VK_RISCV_PCREL_LO:
+      FixupKind = MIFrm == RISCVII::FrmI ? RISCV::fixup_riscv_pcrel_lo12_i
+                                         : RISCV::fixup_riscv_pcrel_lo12_s;
+      break;
     case RISCVMCExpr::VK_RISCV_PCREL_HI:
       FixupKind = RISCV::fixup_riscv_pcrel_hi20;
       break;
+    case RISCVMCExpr::VK_RISCV_GOT_HI:
+      FixupKind = RISCV::fixup_riscv_got_hi20;
+      break;
+    case RISCVMCExpr::VK_RISCV_TPREL_LO:
+      FixupKind = MIFrm == RISCVII::FrmI ? RISCV::fixup_riscv_tprel_lo12_i
+                                         : RISCV::fixup_riscv_tprel_lo12_s;
+      break;
+    case RISCVMCExpr::VK_RISCV_TPREL_HI:
+      FixupKind = RISCV::fixup_riscv_tprel_hi20;
+      break;
+    case RISCVMCExpr::VK_RISCV_TPREL_ADD:
+      FixupKind = RISCV::fixup_riscv_tprel_add;
+      break;
+    case RISCVMCExpr::VK_RISCV_TLS_GOT_HI:
+      FixupKind = RISCV::fixup_riscv_tls_got_hi20;
+      break;
+    case RISCVMCExpr::VK_RISCV_TLS_GD_HI:
+      FixupKind = RISCV::fixup_riscv_tls_gd_hi20;
+      break;
+    case RISCVMCExpr::VK_RISCV_GPREL:
+      if (getGPFixupKind(Desc.getOpcode(), FixupKind))
+        break;
+      FixupKind = MIFrm == RISCVII::FrmI ? RISCV::fixup_riscv_gprel_i
+                                         : RISCV::fixup_riscv_gprel_s;
+      break;
+    case RISCVMCExpr::VK_RISCV_CALL:
+      FixupKind = RISCV::fixup_riscv_call;
+      break;
+    case RISCVMCExpr::VK_RISCV_CALL_PLT:
+      FixupKind = RISCV::fixup_riscv_call_plt;
+      break;
     }
   } else if (Kind == MCExpr::SymbolRef &&
              cast<MCSymbolRefExpr>(Expr)->getKind() == MCSymbolRefExpr::VK_None) {
@@ -238,6 +418,17 @@ getExprOpValue(const MCInst &MI, const MCExpr *Expr,
                Desc.getOpcode() == RISCV::CBEQZ64 ||
                Desc.getOpcode() == RISCV::CBNEZ64) {
       FixupKind = RISCV::fixup_riscv_rvc_branch;
+    } else if (Desc.getOpcode() == RISCV::BEQC ||
+               Desc.getOpcode() == RISCV::BNEC ||
+               Desc.getOpcode() == RISCV::BBC ||
+               Desc.getOpcode() == RISCV::BBS ||
+               Desc.getOpcode() == RISCV::BEQC64 ||
+               Desc.getOpcode() == RISCV::BNEC64 ||
+               Desc.getOpcode() == RISCV::BBC64 ||
+               Desc.getOpcode() == RISCV::BBS64) {
+      FixupKind = RISCV::fixup_riscv_10_pcrel;
+    } else if (getGPFixupKind(Desc.getOpcode(), FixupKind)) {
+      // A bare symbol on a gp-implied access is gp-relative.
     } else {
       llvm_unreachable("Unhandled expression!");
     }
@@ -248,6 +439,29 @@ getExprOpValue(const MCInst &MI, const MCExpr *Expr,
       MCFixup::create(0, Expr, MCFixupKind(FixupKind), MI.getLoc()));
   ++MCNumFixups;
 
+  // Tell the linker that it may relax calls and absolute or PC-relative
+  // address materialisation. The R_RISCV_RELAX must follow the relocation it
+  // applies to.
+  bool RelaxCandidate = FixupKind == RISCV::fixup_riscv_call ||
+                        FixupKind == RISCV::fixup_riscv_call_plt ||
+                        FixupKind == RISCV::fixup_riscv_hi20 ||
+                        FixupKind == RISCV::fixup_riscv_lo12_i ||
+                        FixupKind == RISCV::fixup_riscv_lo12_s ||
+                        FixupKind == RISCV::fixup_riscv_pcrel_hi20 ||
+                        FixupKind == RISCV::fixup_riscv_pcrel_lo12_i ||
+                        FixupKind == RISCV::fixup_riscv_pcrel_lo12_s ||
+                        FixupKind == RISCV::fixup_riscv_got_hi20 ||
+                        FixupKind == RISCV::fixup_riscv_tprel_hi20 ||
+                        FixupKind == RISCV::fixup_riscv_tprel_lo12_i ||
+                        FixupKind == RISCV::fixup_riscv_tprel_lo12_s ||
+                        FixupKind == RISCV::fixup_riscv_tprel_add;
+  if (RelaxCandidate && STI.getFeatureBits()[RISCV::FeatureRelax]) {
+    const MCConstantExpr *Dummy = MCConstantExpr::create(0, Ctx);
+    Fixups.push_back(MCFixup::create(
+        0, Dummy, MCFixupKind(RISCV::fixup_riscv_relax), MI.getLoc()));
+    ++MCNumFixups;
+  }
+
   return 0;
 }
 
@@ -257,7 +471,8 @@ bool RISCVMCCodeEmitter::isLoad(unsigned Opc) const {
       Opc == RISCV::LD  || Opc == RISCV::LH    ||
       Opc == RISCV::LHU || Opc == RISCV::LHU64 ||
       Opc == RISCV::LW  || Opc == RISCV::LW64 ||
-      Opc == RISCV::LWU || Opc == RISCV::LH64)
+      Opc == RISCV::LWU || Opc == RISCV::LH64  ||
+      Opc == RISCV::FLW || Opc == RISCV::FLD)
     return true;
   return false;
 }
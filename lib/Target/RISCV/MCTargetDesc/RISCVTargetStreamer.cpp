@@ -11,9 +11,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "RISCVAsmBackend.h"
 #include "RISCVMCExpr.h"
 #include "RISCVMCTargetDesc.h"
 #include "RISCVTargetStreamer.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCSectionELF.h"
@@ -47,6 +49,28 @@ RISCVTargetELFStreamer::RISCVTargetELFStreamer(MCStreamer &S,
     EFlags |= ELF::EF_RISCV_FLOAT_ABI_SOFT;
 
   MCA.setELFHeaderEFlags(EFlags);
+
+  // The asm backend is created without the subtarget features, so tell it
+  // here whether 2-byte nops are available and whether the object is being
+  // assembled for linker relaxation.
+  RISCVAsmBackend &MAB = static_cast<RISCVAsmBackend &>(MCA.getBackend());
+  if (Features[RISCV::FeatureC])
+    MAB.setHasC();
+  if (Features[RISCV::FeatureRelax])
+    MAB.setForceRelocs();
+}
+
+void RISCVTargetELFStreamer::emitTargetABI(StringRef ABIName) {
+  MCAssembler &MCA = getStreamer().getAssembler();
+
+  unsigned EFlags = MCA.getELFHeaderEFlags();
+
+  EFlags |= StringSwitch<unsigned>(ABIName)
+              .Cases("ilp32f", "lp64f", ELF::EF_RISCV_FLOAT_ABI_SINGLE)
+              .Cases("ilp32d", "lp64d", ELF::EF_RISCV_FLOAT_ABI_DOUBLE)
+              .Default(ELF::EF_RISCV_FLOAT_ABI_SOFT);
+
+  MCA.setELFHeaderEFlags(EFlags);
 }
 
 MCELFStreamer &RISCVTargetELFStreamer::getStreamer() {
@@ -23,6 +23,9 @@
 
 namespace llvm {
 class AsmPrinter;
+class InstructionSelector;
+class RISCVRegisterBankInfo;
+class RISCVSubtarget;
 class RISCVTargetMachine;
 class MCContext;
 class MCInst;
@@ -30,7 +33,9 @@ class MCOperand;
 class MachineInstr;
 class MachineOperand;
 
+FunctionPass *createRISCVCompressJumpTablesPass();
 FunctionPass *createRISCVExpandPseudoPass();
+FunctionPass *createRISCVOptimizeSExtPass();
 
 void LowerRISCVMachineInstrToMCInst(const MachineInstr *MI, MCInst &OutMI,
                                     const AsmPrinter &AP);
@@ -38,6 +43,11 @@ bool LowerRISCVMachineOperandToMCOperand(const MachineOperand &MO,
                                          MCOperand &MCOp, const AsmPrinter &AP);
 
 FunctionPass *createRISCVISelDag(RISCVTargetMachine &TM);
+
+InstructionSelector *
+createRISCVInstructionSelector(const RISCVTargetMachine &TM,
+                               const RISCVSubtarget &STI,
+                               const RISCVRegisterBankInfo &RBI);
 }
 
 #endif
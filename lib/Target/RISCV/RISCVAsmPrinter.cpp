@@ -14,22 +14,36 @@
 
 #include "RISCV.h"
 #include "InstPrinter/RISCVInstPrinter.h"
+#include "MCTargetDesc/RISCVBaseInfo.h"
+#include "MCTargetDesc/RISCVMCExpr.h"
+#include "RISCVMachineFunctionInfo.h"
+#include "RISCVSubtarget.h"
 #include "RISCVTargetMachine.h"
+#include "RISCVTargetStreamer.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/AsmPrinter.h"
 #include "llvm/CodeGen/MachineConstantPool.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstBuilder.h"
 #include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Target/TargetLoweringObjectFile.h"
 #include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
 #define DEBUG_TYPE "asm-printer"
 
+STATISTIC(NumInstrsEmitted, "Number of instructions emitted");
+STATISTIC(NumInstrsCompressed,
+          "Number of instructions emitted in their compressed form");
+
 namespace {
 class RISCVAsmPrinter : public AsmPrinter {
 public:
@@ -39,11 +53,20 @@ public:
 
   StringRef getPassName() const override { return "RISCV Assembly Printer"; }
 
+  void EmitStartOfAsmFile(Module &M) override;
+
   void EmitInstruction(const MachineInstr *MI) override;
 
+  void EmitToStreamer(MCStreamer &S, const MCInst &Inst);
+
   bool emitPseudoExpansionLowering(MCStreamer &OutStreamer,
                                    const MachineInstr *MI);
 
+  void emitPCRelAddress(const MachineInstr *MI);
+
+  void EmitJumpTableInfo() override;
+  void emitJumpTableDest(const MachineInstr *MI);
+
   void printOperand(const MachineInstr *MI, int OpNum,
                     raw_ostream &O, const char* Modifier = nullptr);
   bool PrintAsmOperand(const MachineInstr *MI, unsigned OpNo,
@@ -57,6 +80,13 @@ public:
 };
 }
 
+void RISCVAsmPrinter::EmitStartOfAsmFile(Module &M) {
+  // There is no target streamer when emitting textual assembly.
+  if (MCTargetStreamer *TS = OutStreamer->getTargetStreamer())
+    static_cast<RISCVTargetStreamer *>(TS)->emitTargetABI(
+        TM.Options.MCOptions.getABIName());
+}
+
 void RISCVAsmPrinter::printOperand(const MachineInstr *MI, int OpNum,
                                    raw_ostream &O, const char *Modifier) {
   const MachineOperand &MO = MI->getOperand(OpNum);
@@ -101,15 +131,250 @@ bool RISCVAsmPrinter::PrintAsmOperand(const MachineInstr *MI, unsigned OpNo,
 }
 
 
+#define GEN_COMPRESS_INSTR
+#include "RISCVGenCompressInstEmitter.inc"
+
+// Emit the 16-bit form of Inst when the C extension is available and one of
+// the compress patterns applies.
+void RISCVAsmPrinter::EmitToStreamer(MCStreamer &S, const MCInst &Inst) {
+  MCInst CInst;
+  const MCSubtargetInfo &STI = MF->getSubtarget();
+  ++NumInstrsEmitted;
+  if (compressInst(CInst, Inst, STI, *OutContext.getRegisterInfo())) {
+    ++NumInstrsCompressed;
+    AsmPrinter::EmitToStreamer(S, CInst);
+  } else
+    AsmPrinter::EmitToStreamer(S, Inst);
+}
+
 // Simple pseudo-instructions have their lowering (with expansion to real
 // instructions) auto-generated.
 #include "RISCVGenMCPseudoLowering.inc"
 
+// Expand PseudoLLA, PseudoLA and the TLS variants. The %pcrel_lo of the
+// second instruction names a label on the AUIPC, which is where the linker
+// finds the matching high part.
+void RISCVAsmPrinter::emitPCRelAddress(const MachineInstr *MI) {
+  unsigned HiFlag;
+  bool IsLoad;
+  bool IsRV64 = false;
+  switch (MI->getOpcode()) {
+  default:
+    llvm_unreachable("Unexpected PC-relative address pseudo");
+  case RISCV::PseudoLLA64:
+    IsRV64 = true;
+    LLVM_FALLTHROUGH;
+  case RISCV::PseudoLLA:
+    HiFlag = RISCVII::MO_PCREL_HI;
+    IsLoad = false;
+    break;
+  case RISCV::PseudoLA64:
+    IsRV64 = true;
+    LLVM_FALLTHROUGH;
+  case RISCV::PseudoLA:
+    HiFlag = RISCVII::MO_GOT_HI;
+    IsLoad = true;
+    break;
+  case RISCV::PseudoLA_TLS_IE64:
+    IsRV64 = true;
+    LLVM_FALLTHROUGH;
+  case RISCV::PseudoLA_TLS_IE:
+    HiFlag = RISCVII::MO_TLS_GOT_HI;
+    IsLoad = true;
+    break;
+  case RISCV::PseudoLA_TLS_GD64:
+    IsRV64 = true;
+    LLVM_FALLTHROUGH;
+  case RISCV::PseudoLA_TLS_GD:
+    HiFlag = RISCVII::MO_TLS_GD_HI;
+    IsLoad = false;
+    break;
+  }
+  unsigned DestReg = MI->getOperand(0).getReg();
+
+  MCSymbol *AUIPCLabel = OutContext.createTempSymbol("pcrel_hi", true, false);
+  OutStreamer->EmitLabel(AUIPCLabel);
+
+  MachineOperand HiMO = MI->getOperand(1);
+  HiMO.setTargetFlags(HiFlag);
+  MCOperand Hi;
+  lowerOperand(HiMO, Hi);
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(IsRV64 ? RISCV::AUIPC64 : RISCV::AUIPC)
+                     .addReg(DestReg)
+                     .addOperand(Hi));
+
+  const MCExpr *Lo = RISCVMCExpr::create(
+      MCSymbolRefExpr::create(AUIPCLabel, OutContext),
+      RISCVMCExpr::VK_RISCV_PCREL_LO, OutContext);
+  unsigned SecondOpc;
+  if (IsLoad)
+    SecondOpc = IsRV64 ? RISCV::LD : RISCV::LW;
+  else
+    SecondOpc = IsRV64 ? RISCV::ADDI64 : RISCV::ADDI;
+  EmitToStreamer(*OutStreamer, MCInstBuilder(SecondOpc)
+                                   .addReg(DestReg)
+                                   .addReg(DestReg)
+                                   .addExpr(Lo));
+}
+
+// Compact jump tables go to the read-only section like ordinary ones, but
+// their entries are the distances of the destinations from the table's base
+// block, in units of the instruction alignment. The assembler folds them,
+// so the tables need no relocations.
+void RISCVAsmPrinter::EmitJumpTableInfo() {
+  const MachineJumpTableInfo *MJTI = MF->getJumpTableInfo();
+  if (!MJTI || MJTI->getEntryKind() != MachineJumpTableInfo::EK_Custom32) {
+    AsmPrinter::EmitJumpTableInfo();
+    return;
+  }
+  const std::vector<MachineJumpTableEntry> &JT = MJTI->getJumpTables();
+  if (JT.empty())
+    return;
+
+  const RISCVMachineFunctionInfo *RVFI =
+      MF->getInfo<RISCVMachineFunctionInfo>();
+  unsigned Shift = MF->getSubtarget<RISCVSubtarget>().hasC() ? 1 : 2;
+  OutStreamer->SwitchSection(
+      getObjFileLowering().getSectionForJumpTable(*MF->getFunction(), TM));
+
+  for (unsigned JTI = 0, E = JT.size(); JTI != E; ++JTI) {
+    const std::vector<MachineBasicBlock *> &JTBBs = JT[JTI].MBBs;
+    // If this jump table was deleted, ignore it.
+    if (JTBBs.empty())
+      continue;
+
+    unsigned Size = RVFI->getJumpTableEntrySize(JTI);
+    const MachineBasicBlock *BaseMBB = RVFI->getJumpTableBase(JTI);
+    const MCExpr *Base = MCSymbolRefExpr::create(
+        (BaseMBB ? BaseMBB : JTBBs.front())->getSymbol(), OutContext);
+
+    EmitAlignment(Log2_32(Size));
+    OutStreamer->EmitLabel(GetJTISymbol(JTI));
+    for (const MachineBasicBlock *MBB : JTBBs) {
+      const MCExpr *Diff = MCBinaryExpr::createSub(
+          MCSymbolRefExpr::create(MBB->getSymbol(), OutContext), Base,
+          OutContext);
+      OutStreamer->EmitValue(
+          MCBinaryExpr::createLShr(
+              Diff, MCConstantExpr::create(Shift, OutContext), OutContext),
+          Size);
+    }
+  }
+}
+
+// Expand PseudoJumpTableDest:
+//
+//   slli    scratch, entry, log2(size)      (unless size is 1)
+//   add     scratch, table, scratch
+//   l[bh]u  scratch, 0(scratch)             (lw/lwu for word entries)
+// .Ltmp:
+//   auipc   dst, %pcrel_hi(base)
+//   addi    dst, dst, %pcrel_lo(.Ltmp)
+//   slli    scratch, scratch, shift
+//   add     dst, dst, scratch
+void RISCVAsmPrinter::emitJumpTableDest(const MachineInstr *MI) {
+  bool IsRV64 = MI->getOpcode() == RISCV::PseudoJumpTableDest64;
+  unsigned DestReg = MI->getOperand(0).getReg();
+  unsigned ScratchReg = MI->getOperand(1).getReg();
+  unsigned TableReg = MI->getOperand(2).getReg();
+  unsigned EntryReg = MI->getOperand(3).getReg();
+  unsigned JTI = MI->getOperand(4).getIndex();
+
+  const RISCVMachineFunctionInfo *RVFI =
+      MF->getInfo<RISCVMachineFunctionInfo>();
+  unsigned Size = RVFI->getJumpTableEntrySize(JTI);
+  const MachineBasicBlock *BaseMBB = RVFI->getJumpTableBase(JTI);
+  if (!BaseMBB)
+    BaseMBB = MF->getJumpTableInfo()->getJumpTables()[JTI].MBBs.front();
+  unsigned Shift = MF->getSubtarget<RISCVSubtarget>().hasC() ? 1 : 2;
+
+  unsigned SLLIOpc = IsRV64 ? RISCV::SLLI64 : RISCV::SLLI;
+  unsigned ADDOpc = IsRV64 ? RISCV::ADD64 : RISCV::ADD;
+  unsigned LoadOpc;
+  switch (Size) {
+  default:
+    llvm_unreachable("Unexpected jump table entry size");
+  case 1:
+    LoadOpc = IsRV64 ? RISCV::LBU64 : RISCV::LBU;
+    break;
+  case 2:
+    LoadOpc = IsRV64 ? RISCV::LHU64 : RISCV::LHU;
+    break;
+  case 4:
+    LoadOpc = IsRV64 ? RISCV::LWU : RISCV::LW;
+    break;
+  }
+
+  unsigned IndexReg = EntryReg;
+  if (Size > 1) {
+    EmitToStreamer(*OutStreamer, MCInstBuilder(SLLIOpc)
+                                     .addReg(ScratchReg)
+                                     .addReg(EntryReg)
+                                     .addImm(Log2_32(Size)));
+    IndexReg = ScratchReg;
+  }
+  EmitToStreamer(*OutStreamer, MCInstBuilder(ADDOpc)
+                                   .addReg(ScratchReg)
+                                   .addReg(TableReg)
+                                   .addReg(IndexReg));
+  EmitToStreamer(*OutStreamer, MCInstBuilder(LoadOpc)
+                                   .addReg(ScratchReg)
+                                   .addReg(ScratchReg)
+                                   .addImm(0));
+
+  MCSymbol *AUIPCLabel = OutContext.createTempSymbol("pcrel_hi", true, false);
+  OutStreamer->EmitLabel(AUIPCLabel);
+  const MCExpr *Hi = RISCVMCExpr::create(
+      MCSymbolRefExpr::create(BaseMBB->getSymbol(), OutContext),
+      RISCVMCExpr::VK_RISCV_PCREL_HI, OutContext);
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(IsRV64 ? RISCV::AUIPC64 : RISCV::AUIPC)
+                     .addReg(DestReg)
+                     .addExpr(Hi));
+  const MCExpr *Lo = RISCVMCExpr::create(
+      MCSymbolRefExpr::create(AUIPCLabel, OutContext),
+      RISCVMCExpr::VK_RISCV_PCREL_LO, OutContext);
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(IsRV64 ? RISCV::ADDI64 : RISCV::ADDI)
+                     .addReg(DestReg)
+                     .addReg(DestReg)
+                     .addExpr(Lo));
+
+  EmitToStreamer(*OutStreamer, MCInstBuilder(SLLIOpc)
+                                   .addReg(ScratchReg)
+                                   .addReg(ScratchReg)
+                                   .addImm(Shift));
+  EmitToStreamer(*OutStreamer, MCInstBuilder(ADDOpc)
+                                   .addReg(DestReg)
+                                   .addReg(DestReg)
+                                   .addReg(ScratchReg));
+}
+
 void RISCVAsmPrinter::EmitInstruction(const MachineInstr *MI) {
   // Do any auto-generated pseudo lowerings.
   if (emitPseudoExpansionLowering(*OutStreamer, MI))
     return;
 
+  switch (MI->getOpcode()) {
+  default:
+    break;
+  case RISCV::PseudoLLA:
+  case RISCV::PseudoLLA64:
+  case RISCV::PseudoLA:
+  case RISCV::PseudoLA64:
+  case RISCV::PseudoLA_TLS_IE:
+  case RISCV::PseudoLA_TLS_IE64:
+  case RISCV::PseudoLA_TLS_GD:
+  case RISCV::PseudoLA_TLS_GD64:
+    emitPCRelAddress(MI);
+    return;
+  case RISCV::PseudoJumpTableDest:
+  case RISCV::PseudoJumpTableDest64:
+    emitJumpTableDest(MI);
+    return;
+  }
+
   MCInst TmpInst;
   LowerRISCVMachineInstrToMCInst(MI, TmpInst, *this);
   EmitToStreamer(*OutStreamer, TmpInst);
@@ -0,0 +1,322 @@
+//===-- llvm/lib/Target/RISCV/RISCVCallLowering.cpp - Call lowering -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements the lowering of LLVM calls to machine code calls for
+/// GlobalISel. Only integer and pointer values that are passed in registers
+/// under the standard calling convention are handled; anything else makes
+/// the function fall back to SelectionDAG.
+///
+//===----------------------------------------------------------------------===//
+
+#include "RISCVCallLowering.h"
+
+#include "RISCVISelLowering.h"
+#include "RISCVInstrInfo.h"
+#include "RISCVSubtarget.h"
+
+#include "llvm/CodeGen/Analysis.h"
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/GlobalISel/Utils.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "This shouldn't be built without GISel"
+#endif
+
+RISCVCallLowering::RISCVCallLowering(const RISCVTargetLowering &TLI)
+    : CallLowering(&TLI) {}
+
+bool RISCVCallLowering::prepareArg(ArgInfo &Arg, const DataLayout &DL) const {
+  const RISCVTargetLowering &TLI = *getTLI<RISCVTargetLowering>();
+  EVT VT = TLI.getValueType(DL, Arg.Ty, true);
+  if (!VT.isSimple() || !VT.isInteger() || VT.isVector() ||
+      VT.getSizeInBits() > TLI.getPointerTy(DL).getSizeInBits())
+    return false;
+
+  ISD::ArgFlagsTy Flags = Arg.Flags;
+  if (Flags.isByVal() || Flags.isInReg() || Flags.isSRet() || Flags.isNest() ||
+      Flags.isSwiftSelf() || Flags.isSwiftError())
+    return false;
+
+  Arg.Ty = VT.getTypeForEVT(Arg.Ty->getContext());
+  return true;
+}
+
+namespace {
+/// Helper class for values going out through an ABI boundary (used for handling
+/// function return values and call parameters).
+struct OutgoingValueHandler : public CallLowering::ValueHandler {
+  OutgoingValueHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                       MachineInstrBuilder &MIB, CCAssignFn *AssignFn)
+      : ValueHandler(MIRBuilder, MRI, AssignFn), MIB(MIB) {}
+
+  bool assignArg(unsigned ValNo, MVT ValVT, MVT LocVT,
+                 CCValAssign::LocInfo LocInfo,
+                 const CallLowering::ArgInfo &Info, CCState &State) override {
+    // Values passed on the stack are left to SelectionDAG.
+    return AssignFn(ValNo, ValVT, LocVT, LocInfo, Info.Flags, State) ||
+           State.getNextStackOffset() != 0;
+  }
+
+  unsigned getStackAddress(uint64_t Size, int64_t Offset,
+                           MachinePointerInfo &MPO) override {
+    llvm_unreachable("Stack arguments are rejected by assignArg");
+  }
+
+  void assignValueToAddress(unsigned ValVReg, unsigned Addr, uint64_t Size,
+                            MachinePointerInfo &MPO, CCValAssign &VA) override {
+    llvm_unreachable("Stack arguments are rejected by assignArg");
+  }
+
+  void assignValueToReg(unsigned ValVReg, unsigned PhysReg,
+                        CCValAssign &VA) override {
+    assert(VA.isRegLoc() && "Value shouldn't be assigned to reg");
+    assert(VA.getLocReg() == PhysReg && "Assigning to the wrong reg?");
+
+    // An any-extended value still has to be widened to the size of the
+    // location before it can be copied there.
+    unsigned ExtReg = extendRegister(ValVReg, VA);
+    if (MRI.getType(ExtReg).getSizeInBits() != VA.getLocVT().getSizeInBits()) {
+      unsigned AnyExtReg = MRI.createGenericVirtualRegister(LLT{VA.getLocVT()});
+      MIRBuilder.buildAnyExt(AnyExtReg, ExtReg);
+      ExtReg = AnyExtReg;
+    }
+    MIRBuilder.buildCopy(PhysReg, ExtReg);
+    MIB.addUse(PhysReg, RegState::Implicit);
+  }
+
+  MachineInstrBuilder &MIB;
+};
+} // End anonymous namespace.
+
+bool RISCVCallLowering::lowerReturn(MachineIRBuilder &MIRBuilder,
+                                    const Value *Val, unsigned VReg) const {
+  assert(!Val == !VReg && "Return value without a vreg");
+
+  MachineFunction &MF = MIRBuilder.getMF();
+  const Function &F = *MF.getFunction();
+  const auto &TLI = *getTLI<RISCVTargetLowering>();
+  bool IsRV64 = MF.getSubtarget<RISCVSubtarget>().isRV64();
+
+  // Interrupt handlers are left to SelectionDAG.
+  if (F.getCallingConv() != CallingConv::C || F.isVarArg() ||
+      F.hasFnAttribute("interrupt"))
+    return false;
+
+  auto Ret = MIRBuilder.buildInstrNoInsert(IsRV64 ? RISCV::PseudoRET64
+                                                  : RISCV::PseudoRET);
+
+  if (Val) {
+    const DataLayout &DL = MF.getDataLayout();
+    ArgInfo RetInfo(VReg, Val->getType());
+    setArgFlags(RetInfo, AttributeList::ReturnIndex, DL, F);
+    if (!prepareArg(RetInfo, DL))
+      return false;
+
+    OutgoingValueHandler RetHandler(MIRBuilder, MF.getRegInfo(), Ret,
+                                    TLI.CCAssignFnForReturn());
+    if (!handleAssignments(MIRBuilder, RetInfo, RetHandler))
+      return false;
+  }
+
+  MIRBuilder.insertInstr(Ret);
+  return true;
+}
+
+namespace {
+/// Helper class for values coming in through an ABI boundary (used for handling
+/// formal arguments and call return values).
+struct IncomingValueHandler : public CallLowering::ValueHandler {
+  IncomingValueHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                       CCAssignFn AssignFn)
+      : ValueHandler(MIRBuilder, MRI, AssignFn) {}
+
+  bool assignArg(unsigned ValNo, MVT ValVT, MVT LocVT,
+                 CCValAssign::LocInfo LocInfo,
+                 const CallLowering::ArgInfo &Info, CCState &State) override {
+    // Values passed on the stack are left to SelectionDAG.
+    return AssignFn(ValNo, ValVT, LocVT, LocInfo, Info.Flags, State) ||
+           State.getNextStackOffset() != 0;
+  }
+
+  unsigned getStackAddress(uint64_t Size, int64_t Offset,
+                           MachinePointerInfo &MPO) override {
+    llvm_unreachable("Stack arguments are rejected by assignArg");
+  }
+
+  void assignValueToAddress(unsigned ValVReg, unsigned Addr, uint64_t Size,
+                            MachinePointerInfo &MPO, CCValAssign &VA) override {
+    llvm_unreachable("Stack arguments are rejected by assignArg");
+  }
+
+  void assignValueToReg(unsigned ValVReg, unsigned PhysReg,
+                        CCValAssign &VA) override {
+    assert(VA.isRegLoc() && "Value shouldn't be assigned to reg");
+    assert(VA.getLocReg() == PhysReg && "Assigning to the wrong reg?");
+
+    markPhysRegUsed(PhysReg);
+    unsigned LocSize = VA.getLocVT().getSizeInBits();
+    if (MRI.getType(ValVReg).getSizeInBits() == LocSize) {
+      MIRBuilder.buildCopy(ValVReg, PhysReg);
+      return;
+    }
+
+    // A narrower value arrives extended to the whole location. The
+    // truncation also re-extends an i32 from bit 31 on RV64, as
+    // LowerFormalArguments does.
+    unsigned CopyReg = MRI.createGenericVirtualRegister(LLT::scalar(LocSize));
+    MIRBuilder.buildCopy(CopyReg, PhysReg);
+    MIRBuilder.buildTrunc(ValVReg, CopyReg);
+  }
+
+  /// Marking a physical register as used is different between formal
+  /// parameters, where it's a basic block live-in, and call returns, where it's
+  /// an implicit-def of the call instruction.
+  virtual void markPhysRegUsed(unsigned PhysReg) = 0;
+};
+
+struct FormalArgHandler : public IncomingValueHandler {
+  FormalArgHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                   CCAssignFn AssignFn)
+      : IncomingValueHandler(MIRBuilder, MRI, AssignFn) {}
+
+  void markPhysRegUsed(unsigned PhysReg) override {
+    MIRBuilder.getMBB().addLiveIn(PhysReg);
+  }
+};
+} // End anonymous namespace
+
+bool RISCVCallLowering::lowerFormalArguments(MachineIRBuilder &MIRBuilder,
+                                             const Function &F,
+                                             ArrayRef<unsigned> VRegs) const {
+  if (F.getCallingConv() != CallingConv::C || F.isVarArg() ||
+      F.hasFnAttribute("interrupt"))
+    return false;
+
+  // Quick exit if there aren't any args
+  if (F.arg_empty())
+    return true;
+
+  auto &MF = MIRBuilder.getMF();
+  auto &MBB = MIRBuilder.getMBB();
+  const DataLayout &DL = MF.getDataLayout();
+  const auto &TLI = *getTLI<RISCVTargetLowering>();
+
+  SmallVector<ArgInfo, 8> ArgInfos;
+  unsigned Idx = 0;
+  for (auto &Arg : F.args()) {
+    ArgInfo AInfo(VRegs[Idx], Arg.getType());
+    setArgFlags(AInfo, Idx + AttributeList::FirstArgIndex, DL, F);
+    if (!prepareArg(AInfo, DL))
+      return false;
+    ArgInfos.push_back(AInfo);
+    Idx++;
+  }
+
+  if (!MBB.empty())
+    MIRBuilder.setInstr(*MBB.begin());
+
+  FormalArgHandler ArgHandler(MIRBuilder, MF.getRegInfo(),
+                              TLI.CCAssignFnForCall(/*IsVarArg=*/false));
+  return handleAssignments(MIRBuilder, ArgInfos, ArgHandler);
+}
+
+namespace {
+struct CallReturnHandler : public IncomingValueHandler {
+  CallReturnHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                    MachineInstrBuilder MIB, CCAssignFn *AssignFn)
+      : IncomingValueHandler(MIRBuilder, MRI, AssignFn), MIB(MIB) {}
+
+  void markPhysRegUsed(unsigned PhysReg) override {
+    MIB.addDef(PhysReg, RegState::Implicit);
+  }
+
+  MachineInstrBuilder MIB;
+};
+} // End anonymous namespace.
+
+bool RISCVCallLowering::lowerCall(MachineIRBuilder &MIRBuilder,
+                                  CallingConv::ID CallConv,
+                                  const MachineOperand &Callee,
+                                  const ArgInfo &OrigRet,
+                                  ArrayRef<ArgInfo> OrigArgs) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  const auto &TLI = *getTLI<RISCVTargetLowering>();
+  const DataLayout &DL = MF.getDataLayout();
+  const auto &STI = MF.getSubtarget<RISCVSubtarget>();
+  const TargetRegisterInfo *TRI = STI.getRegisterInfo();
+  const TargetMachine &TM = TLI.getTargetMachine();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  bool IsRV64 = STI.isRV64();
+
+  if (CallConv != CallingConv::C)
+    return false;
+
+  SmallVector<ArgInfo, 8> ArgInfos;
+  for (auto Arg : OrigArgs) {
+    if (!Arg.IsFixed || !prepareArg(Arg, DL))
+      return false;
+    ArgInfos.push_back(Arg);
+  }
+
+  ArgInfo RetInfo = OrigRet;
+  if (!RetInfo.Ty->isVoidTy() && !prepareArg(RetInfo, DL))
+    return false;
+
+  // Every argument is passed in a register, so no outgoing argument area is
+  // needed.
+  MIRBuilder.buildInstr(RISCV::ADJCALLSTACKDOWN).addImm(0).addImm(0);
+
+  // Create the call instruction so we can add the implicit uses of arg
+  // registers, but don't insert it yet. Direct calls are emitted as
+  // "call sym", going through the PLT for symbols that may be preempted.
+  MachineInstrBuilder MIB;
+  if (Callee.isGlobal() || Callee.isSymbol()) {
+    MIB = MIRBuilder.buildInstrNoInsert(IsRV64 ? RISCV::PseudoCALL64
+                                               : RISCV::PseudoCALL);
+    const GlobalValue *GV = Callee.isGlobal() ? Callee.getGlobal() : nullptr;
+    unsigned char OpFlags = RISCVII::MO_CALL;
+    if (!TM.shouldAssumeDSOLocal(*MF.getFunction()->getParent(), GV))
+      OpFlags = RISCVII::MO_PLT;
+    if (GV)
+      MIB.addGlobalAddress(GV, Callee.getOffset(), OpFlags);
+    else
+      MIB.addExternalSymbol(Callee.getSymbolName(), OpFlags);
+  } else if (Callee.isReg()) {
+    MIB = MIRBuilder.buildInstrNoInsert(IsRV64 ? RISCV::PseudoCALLIndirect64
+                                               : RISCV::PseudoCALLIndirect);
+    MIB.add(Callee);
+    MIB->getOperand(0).setReg(constrainOperandRegClass(
+        MF, *TRI, MRI, *STI.getInstrInfo(), *STI.getRegBankInfo(),
+        *MIB.getInstr(), MIB->getDesc(), Callee.getReg(), 0));
+  } else
+    return false;
+  MIB.addRegMask(TRI->getCallPreservedMask(MF, CallConv));
+
+  OutgoingValueHandler ArgHandler(MIRBuilder, MRI, MIB,
+                                  TLI.CCAssignFnForCall(/*IsVarArg=*/false));
+  if (!handleAssignments(MIRBuilder, ArgInfos, ArgHandler))
+    return false;
+
+  // Now we can add the actual call instruction to the correct basic block.
+  MIRBuilder.insertInstr(MIB);
+
+  if (!RetInfo.Ty->isVoidTy()) {
+    CallReturnHandler RetHandler(MIRBuilder, MRI, MIB,
+                                 TLI.CCAssignFnForReturn());
+    if (!handleAssignments(MIRBuilder, RetInfo, RetHandler))
+      return false;
+  }
+
+  MIRBuilder.buildInstr(RISCV::ADJCALLSTACKUP).addImm(0).addImm(0);
+  return true;
+}
@@ -111,6 +111,50 @@ inline bool CC_RISCV_I128Indirect(unsigned &ValNo, MVT &ValVT,
   return true;
 }
 
+// Handle f64 arguments on RV32 that are passed in GPRs, either because they
+// are variadic or because all FPR argument registers are in use. The value is
+// split across two consecutive argument GPRs; only the first one is recorded
+// in the (custom) location, see getNextArgGPR. Variadic doubles use an aligned
+// register pair like i64. If no pair is left the value goes on the stack.
+inline bool CC_RISCV32_F64InGPRs(unsigned &ValNo, MVT &ValVT,
+                                 MVT &LocVT,
+                                 CCValAssign::LocInfo &LocInfo,
+                                 ISD::ArgFlagsTy &ArgFlags,
+                                 CCState &State) {
+  const RISCVSubtarget* Subtarget =
+    &static_cast<const RISCVSubtarget&>(State.getMachineFunction().
+                                              getSubtarget());
+  ArrayRef<MCPhysReg> ArgRegs = getArgRegs(Subtarget);
+  unsigned Idx = State.getFirstUnallocated(ArgRegs);
+
+  if (State.isVarArg() && Idx % 2 != 0 && Idx < ArgRegs.size())
+    State.AllocateReg(ArgRegs[Idx++]);
+
+  if (Idx + 1 >= ArgRegs.size()) {
+    // Don't let later arguments fill in the remaining register.
+    if (State.isVarArg())
+      for (; Idx < ArgRegs.size(); ++Idx)
+        State.AllocateReg(ArgRegs[Idx]);
+    return false;
+  }
+
+  State.AllocateReg(ArgRegs[Idx]);
+  State.AllocateReg(ArgRegs[Idx + 1]);
+  State.addLoc(CCValAssign::getCustomReg(ValNo, ValVT, ArgRegs[Idx],
+                                         MVT::i32, LocInfo));
+  return true;
+}
+
+// Return the argument GPR holding the high half of an f64 assigned by
+// CC_RISCV32_F64InGPRs.
+inline unsigned getNextArgGPR(const RISCVSubtarget *STI, unsigned Reg) {
+  ArrayRef<MCPhysReg> ArgRegs = getArgRegs(STI);
+  const MCPhysReg *I = std::find(ArgRegs.begin(), ArgRegs.end(), Reg);
+  assert(I != ArgRegs.end() && std::next(I) != ArgRegs.end() &&
+         "Not the first register of an argument GPR pair");
+  return *std::next(I);
+}
+
 } // end namespace llvm
 
 #endif
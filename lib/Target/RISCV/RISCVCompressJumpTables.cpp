@@ -0,0 +1,116 @@
+//===-- RISCVCompressJumpTables.cpp - Pick compact jump table sizes -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Compact jump table entries hold the distance of each destination from the
+// earliest destination of the table, divided by the instruction alignment.
+// Once branch relaxation has settled the code, this pass bounds those
+// distances and records for every table the smallest of 1, 2 or 4 bytes per
+// entry that holds them, along with its base block, for
+// PseudoJumpTableDest and the AsmPrinter.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCV.h"
+#include "RISCVInstrInfo.h"
+#include "RISCVMachineFunctionInfo.h"
+#include "RISCVSubtarget.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/Target/TargetMachine.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "riscv-compress-jump-tables"
+
+STATISTIC(NumJT8, "Number of jump tables with 1-byte entries");
+STATISTIC(NumJT16, "Number of jump tables with 2-byte entries");
+STATISTIC(NumJT32, "Number of jump tables with 4-byte entries");
+
+namespace {
+  class RISCVCompressJumpTables : public MachineFunctionPass {
+  public:
+    static char ID;
+    RISCVCompressJumpTables() : MachineFunctionPass(ID) {}
+
+    bool runOnMachineFunction(MachineFunction &MF) override;
+
+    StringRef getPassName() const override {
+      return "RISCV compress jump tables pass";
+    }
+  };
+  char RISCVCompressJumpTables::ID = 0;
+}
+
+bool RISCVCompressJumpTables::runOnMachineFunction(MachineFunction &MF) {
+  const MachineJumpTableInfo *MJTI = MF.getJumpTableInfo();
+  if (!MJTI || MJTI->getEntryKind() != MachineJumpTableInfo::EK_Custom32)
+    return false;
+
+  const RISCVSubtarget &STI = MF.getSubtarget<RISCVSubtarget>();
+  const RISCVInstrInfo *TII = STI.getInstrInfo();
+  const MCAsmInfo *MAI = MF.getTarget().getMCAsmInfo();
+  RISCVMachineFunctionInfo *RVFI = MF.getInfo<RISCVMachineFunctionInfo>();
+
+  // Upper bounds on the block offsets: every instruction is counted at its
+  // uncompressed size, and every aligned block after the largest padding.
+  // Distances between blocks can only come out shorter.
+  unsigned InstAlign = STI.hasC() ? 2 : 4;
+  SmallVector<uint64_t, 32> BlockOffsets(MF.getNumBlockIDs());
+  uint64_t Offset = 0;
+  for (const MachineBasicBlock &MBB : MF) {
+    unsigned Align = 1u << MBB.getAlignment();
+    if (Align > InstAlign)
+      Offset += Align - InstAlign;
+    BlockOffsets[MBB.getNumber()] = Offset;
+    for (const MachineInstr &MI : MBB) {
+      if (MI.isInlineAsm())
+        Offset += TII->getInlineAsmLength(
+            MI.getOperand(0).getSymbolName(), *MAI);
+      else
+        Offset += TII->getInstSizeInBytes(MI);
+    }
+  }
+
+  const std::vector<MachineJumpTableEntry> &JT = MJTI->getJumpTables();
+  for (unsigned JTI = 0, E = JT.size(); JTI != E; ++JTI) {
+    const std::vector<MachineBasicBlock *> &MBBs = JT[JTI].MBBs;
+    if (MBBs.empty())
+      continue;
+
+    const MachineBasicBlock *Base = MBBs.front();
+    uint64_t MaxOffset = 0;
+    for (const MachineBasicBlock *MBB : MBBs) {
+      uint64_t BlockOffset = BlockOffsets[MBB->getNumber()];
+      if (BlockOffset < BlockOffsets[Base->getNumber()])
+        Base = MBB;
+      MaxOffset = std::max(MaxOffset, BlockOffset);
+    }
+
+    uint64_t Span = (MaxOffset - BlockOffsets[Base->getNumber()]) / InstAlign;
+    unsigned Size;
+    if (Span <= UINT8_MAX) {
+      Size = 1;
+      ++NumJT8;
+    } else if (Span <= UINT16_MAX) {
+      Size = 2;
+      ++NumJT16;
+    } else {
+      Size = 4;
+      ++NumJT32;
+    }
+    RVFI->setJumpTableEntryInfo(JTI, Size, Base);
+  }
+  return true;
+}
+
+FunctionPass *llvm::createRISCVCompressJumpTablesPass() {
+  return new RISCVCompressJumpTables();
+}
@@ -62,8 +62,6 @@ namespace {
     }
 
   private:
-    unsigned ADDI, CADDI, LUI, CLUI;
-
     void transferImpOps(MachineInstr &OldMI,
                         MachineInstrBuilder &UseMI, MachineInstrBuilder &DefMI);
     bool expandMI(MachineBasicBlock &MBB,
@@ -74,7 +72,21 @@ namespace {
                            MachineBasicBlock::iterator &MBBI);
     void expandMOV64BitImm(MachineBasicBlock &MBB,
                            MachineBasicBlock::iterator &MBBI);
-    unsigned replaceBy16BitInst(unsigned Opc, int64_t Imm);
+    bool expandAtomicCmpXchg(MachineBasicBlock &MBB,
+                             MachineBasicBlock::iterator MBBI,
+                             MachineBasicBlock::iterator &NextMBBI);
+    void insertMaskedMerge(MachineBasicBlock *MBB, const DebugLoc &DL,
+                           unsigned DestReg, unsigned OldValReg,
+                           unsigned NewValReg, unsigned MaskReg);
+    bool expandMaskedAtomicBinOp(MachineBasicBlock &MBB,
+                                 MachineBasicBlock::iterator MBBI,
+                                 MachineBasicBlock::iterator &NextMBBI);
+    bool expandMaskedAtomicMinMax(MachineBasicBlock &MBB,
+                                  MachineBasicBlock::iterator MBBI,
+                                  MachineBasicBlock::iterator &NextMBBI);
+    bool expandMaskedCmpXchg(MachineBasicBlock &MBB,
+                             MachineBasicBlock::iterator MBBI,
+                             MachineBasicBlock::iterator &NextMBBI);
   };
   char RISCVExpandPseudo::ID = 0;
 }
@@ -111,17 +123,6 @@ void RISCVExpandPseudo::expandMOV32BitImm(MachineBasicBlock &MBB,
   unsigned LO12Opc = STI->isRV32() ? RISCV::ADDI : RISCV::ADDIW;
   unsigned HI20Opc = RISCV::LUI;
 
-  if (STI->hasC()) {
-    if (isUIntN(5, Hi20))
-      HI20Opc = RISCV::CLUI;
-    if (isIntN(6, Lo12)) {
-      if (LO12Opc == RISCV::ADDIW)
-        LO12Opc = RISCV::CADDIW;
-      if (LO12Opc == RISCV::ADDI)
-        LO12Opc = RISCV::CADDI;
-    }
-  }
-
   switch (MO.getType()) {
   case MachineOperand::MO_Immediate: {
     HI20 = BuildMI(MBB, MBBI, MI.getDebugLoc(), TII->get(HI20Opc))
@@ -146,25 +147,9 @@ void RISCVExpandPseudo::expandMOV32BitImm(MachineBasicBlock &MBB,
   MI.eraseFromParent();
 }
 
-unsigned RISCVExpandPseudo::replaceBy16BitInst(unsigned Opc, int64_t Imm) {
-  if (!STI->hasC())
-    return Opc;
-
-  if ((Opc == ADDI) && isInt<6>(Imm))
-    return CADDI;
-  if ((Opc == LUI) && isUInt<5>(Imm))
-    return CLUI;
-  if ((Opc == RISCV::SLLI) && isUInt<5>(Imm))
-    return RISCV::CSLLI;
-  if ((Opc == RISCV::SLLI64) && isUInt<6>(Imm))
-    return RISCV::CSLLI64;
-  return Opc;
-}
-
 void RISCVExpandPseudo::expandMOV64BitImm(MachineBasicBlock &MBB,
                                           MachineBasicBlock::iterator &MBBI) {
   MachineInstr &MI = *MBBI;
-  unsigned Opcode = MI.getOpcode();
   unsigned DstReg = MI.getOperand(0).getReg();
   bool DstIsDead = MI.getOperand(0).isDead();
   const MachineOperand &MO = MI.getOperand(1);
@@ -172,15 +157,24 @@ void RISCVExpandPseudo::expandMOV64BitImm(MachineBasicBlock &MBB,
   int64_t Imm = MO.getImm();
   MachineInstrBuilder MIB1, MIB2;
 
+  // The analyzer finds no sequence for zero; copy it from x0 instead.
+  if (Imm == 0) {
+    MIB1 = BuildMI(MBB, MBBI, MI.getDebugLoc(), TII->get(RISCV::ADDI64))
+           .addReg(DstReg, RegState::Define | getDeadRegState(DstIsDead))
+           .addReg(RISCV::X0_64)
+           .addImm(0);
+    transferImpOps(MI, MIB1, MIB1);
+    MI.eraseFromParent();
+    return;
+  }
+
   const RISCVAnalyzeImmediate::InstSeq &Seq =
     AnalyzeImm.Analyze(Imm, 64, false);
 
   RISCVAnalyzeImmediate::InstSeq::const_iterator Inst = Seq.begin();
 
-  Opcode = replaceBy16BitInst(Inst->Opc, Inst->ImmOpnd);
-
   if (Inst->Opc == RISCV::LUI64) {
-    MIB1 = BuildMI(MBB, MBBI, MI.getDebugLoc(), TII->get(Opcode))
+    MIB1 = BuildMI(MBB, MBBI, MI.getDebugLoc(), TII->get(Inst->Opc))
            .addReg(DstReg, RegState::Define | getDeadRegState(DstIsDead))
            .addImm(Inst->ImmOpnd);
   }
@@ -193,8 +187,7 @@ void RISCVExpandPseudo::expandMOV64BitImm(MachineBasicBlock &MBB,
 
   // The remaining instructions in the sequence are handled here.
   for (++Inst; Inst != Seq.end(); ++Inst) {
-    Opcode = replaceBy16BitInst(Inst->Opc, SignExtend64<12>(Inst->ImmOpnd));
-    MIB2 = BuildMI(MBB, MBBI, MI.getDebugLoc(), TII->get(Opcode))
+    MIB2 = BuildMI(MBB, MBBI, MI.getDebugLoc(), TII->get(Inst->Opc))
            .addReg(DstReg, RegState::Define)
            .addReg(DstReg)
            .addImm(SignExtend64<12>(Inst->ImmOpnd));
@@ -204,6 +197,477 @@ void RISCVExpandPseudo::expandMOV64BitImm(MachineBasicBlock &MBB,
   MI.eraseFromParent();
 }
 
+// The LR and SC flavours used by a pseudo: a word at a 32-bit address, a
+// word at a 64-bit address, or a doubleword.
+static unsigned getLRSCIndex(unsigned Opcode) {
+  switch (Opcode) {
+  case RISCV::PseudoCmpXchg32:
+  case RISCV::PseudoMaskedAtomicSwap32:
+  case RISCV::PseudoMaskedAtomicLoadAdd32:
+  case RISCV::PseudoMaskedAtomicLoadSub32:
+  case RISCV::PseudoMaskedAtomicLoadNand32:
+  case RISCV::PseudoMaskedAtomicLoadMax32:
+  case RISCV::PseudoMaskedAtomicLoadMin32:
+  case RISCV::PseudoMaskedAtomicLoadUMax32:
+  case RISCV::PseudoMaskedAtomicLoadUMin32:
+  case RISCV::PseudoMaskedCmpXchg32:
+    return 0;
+  case RISCV::PseudoCmpXchg64:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+// Pick the LR and SC flavours that give an LR/SC loop the requested
+// ordering. A sequentially consistent LR also sets rl so that it cannot be
+// reordered with an earlier sequentially consistent access.
+static unsigned getLRForOrdering(unsigned Opcode, AtomicOrdering Ordering) {
+  static const unsigned LR[3][4] = {
+    { RISCV::LR_W,   RISCV::LR_W_AQ,   RISCV::LR_W_RL,   RISCV::LR_W_AQ_RL },
+    { RISCV::LR_W64, RISCV::LR_W64_AQ, RISCV::LR_W64_RL, RISCV::LR_W64_AQ_RL },
+    { RISCV::LR_D,   RISCV::LR_D_AQ,   RISCV::LR_D_RL,   RISCV::LR_D_AQ_RL }
+  };
+  unsigned Idx = getLRSCIndex(Opcode);
+  switch (Ordering) {
+  default:
+    llvm_unreachable("Unexpected atomic ordering");
+  case AtomicOrdering::Monotonic:
+  case AtomicOrdering::Release:
+    return LR[Idx][0];
+  case AtomicOrdering::Acquire:
+  case AtomicOrdering::AcquireRelease:
+    return LR[Idx][1];
+  case AtomicOrdering::SequentiallyConsistent:
+    return LR[Idx][3];
+  }
+}
+
+static unsigned getSCForOrdering(unsigned Opcode, AtomicOrdering Ordering) {
+  static const unsigned SC[3][4] = {
+    { RISCV::SC_W,   RISCV::SC_W_AQ,   RISCV::SC_W_RL,   RISCV::SC_W_AQ_RL },
+    { RISCV::SC_W64, RISCV::SC_W64_AQ, RISCV::SC_W64_RL, RISCV::SC_W64_AQ_RL },
+    { RISCV::SC_D,   RISCV::SC_D_AQ,   RISCV::SC_D_RL,   RISCV::SC_D_AQ_RL }
+  };
+  unsigned Idx = getLRSCIndex(Opcode);
+  switch (Ordering) {
+  default:
+    llvm_unreachable("Unexpected atomic ordering");
+  case AtomicOrdering::Monotonic:
+  case AtomicOrdering::Acquire:
+    return SC[Idx][0];
+  case AtomicOrdering::Release:
+  case AtomicOrdering::AcquireRelease:
+  case AtomicOrdering::SequentiallyConsistent:
+    return SC[Idx][2];
+  }
+}
+
+/// expandAtomicCmpXchg - Expand a compare-and-swap pseudo into an LR/SC loop:
+///
+/// .Lloop:
+///     lr    dest, (addr)
+///     bne   dest, cmpval, .Ldone
+///     sc    scratch, newval, (addr)
+///     bne   scratch, zero, .Lloop
+/// .Ldone:
+///
+/// This has to happen after register allocation, as a spill between the LR
+/// and the SC could clear the reservation on every iteration.
+bool RISCVExpandPseudo::expandAtomicCmpXchg(
+    MachineBasicBlock &MBB, MachineBasicBlock::iterator MBBI,
+    MachineBasicBlock::iterator &NextMBBI) {
+  MachineInstr &MI = *MBBI;
+  DebugLoc DL = MI.getDebugLoc();
+  unsigned Opcode = MI.getOpcode();
+  unsigned DestReg = MI.getOperand(0).getReg();
+  unsigned ScratchReg = MI.getOperand(1).getReg();
+  unsigned AddrReg = MI.getOperand(2).getReg();
+  unsigned CmpValReg = MI.getOperand(3).getReg();
+  unsigned NewValReg = MI.getOperand(4).getReg();
+  AtomicOrdering Ordering =
+      static_cast<AtomicOrdering>(MI.getOperand(5).getImm());
+
+  bool Is64 = Opcode == RISCV::PseudoCmpXchg64;
+  unsigned BNEOpc = Is64 ? RISCV::BNE64 : RISCV::BNE;
+  unsigned ZeroReg = Is64 ? RISCV::X0_64 : RISCV::X0_32;
+
+  MachineFunction *MF = MBB.getParent();
+  MachineBasicBlock *LoopHeadMBB =
+      MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+  MachineBasicBlock *LoopTailMBB =
+      MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+  MachineBasicBlock *DoneMBB = MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+
+  MF->insert(++MBB.getIterator(), LoopHeadMBB);
+  MF->insert(++LoopHeadMBB->getIterator(), LoopTailMBB);
+  MF->insert(++LoopTailMBB->getIterator(), DoneMBB);
+
+  BuildMI(LoopHeadMBB, DL, TII->get(getLRForOrdering(Opcode, Ordering)),
+          DestReg)
+      .addReg(AddrReg);
+  BuildMI(LoopHeadMBB, DL, TII->get(BNEOpc))
+      .addReg(DestReg)
+      .addReg(CmpValReg)
+      .addMBB(DoneMBB);
+  LoopHeadMBB->addSuccessor(LoopTailMBB);
+  LoopHeadMBB->addSuccessor(DoneMBB);
+
+  BuildMI(LoopTailMBB, DL, TII->get(getSCForOrdering(Opcode, Ordering)),
+          ScratchReg)
+      .addReg(NewValReg)
+      .addReg(AddrReg);
+  BuildMI(LoopTailMBB, DL, TII->get(BNEOpc))
+      .addReg(ScratchReg, RegState::Kill)
+      .addReg(ZeroReg)
+      .addMBB(LoopHeadMBB);
+  LoopTailMBB->addSuccessor(LoopHeadMBB);
+  LoopTailMBB->addSuccessor(DoneMBB);
+
+  DoneMBB->splice(DoneMBB->end(), &MBB, MI, MBB.end());
+  DoneMBB->transferSuccessors(&MBB);
+  MBB.addSuccessor(LoopHeadMBB);
+
+  NextMBBI = MBB.end();
+  MI.eraseFromParent();
+
+  // Recompute livein lists.
+  const MachineRegisterInfo &MRI = MF->getRegInfo();
+  LivePhysRegs LiveRegs;
+  computeLiveIns(LiveRegs, MRI, *DoneMBB);
+  computeLiveIns(LiveRegs, MRI, *LoopTailMBB);
+  computeLiveIns(LiveRegs, MRI, *LoopHeadMBB);
+  // Do an extra pass around the loop to get loop carried registers right.
+  LoopTailMBB->clearLiveIns();
+  computeLiveIns(LiveRegs, MRI, *LoopTailMBB);
+  LoopHeadMBB->clearLiveIns();
+  computeLiveIns(LiveRegs, MRI, *LoopHeadMBB);
+
+  return true;
+}
+
+// Recompute the live-ins of the blocks of an expanded loop, going round the
+// loop twice to get the loop-carried registers right.
+static void computeLoopLiveIns(MachineFunction &MF,
+                               ArrayRef<MachineBasicBlock *> LoopMBBs,
+                               MachineBasicBlock &DoneMBB) {
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  LivePhysRegs LiveRegs;
+  computeLiveIns(LiveRegs, MRI, DoneMBB);
+  for (unsigned Pass = 0; Pass != 2; ++Pass)
+    for (MachineBasicBlock *LoopMBB : reverse(LoopMBBs)) {
+      LoopMBB->clearLiveIns();
+      computeLiveIns(LiveRegs, MRI, *LoopMBB);
+    }
+}
+
+/// insertMaskedMerge - Set DestReg to OldValReg with the bits under MaskReg
+/// taken from NewValReg:
+///
+///     xor   dest, oldval, newval
+///     and   dest, dest, mask
+///     xor   dest, oldval, dest
+void RISCVExpandPseudo::insertMaskedMerge(MachineBasicBlock *MBB,
+                                          const DebugLoc &DL, unsigned DestReg,
+                                          unsigned OldValReg,
+                                          unsigned NewValReg,
+                                          unsigned MaskReg) {
+  BuildMI(MBB, DL, TII->get(RISCV::XOR), DestReg)
+      .addReg(OldValReg)
+      .addReg(NewValReg);
+  BuildMI(MBB, DL, TII->get(RISCV::AND), DestReg)
+      .addReg(DestReg)
+      .addReg(MaskReg);
+  BuildMI(MBB, DL, TII->get(RISCV::XOR), DestReg)
+      .addReg(OldValReg)
+      .addReg(DestReg);
+}
+
+/// expandMaskedAtomicBinOp - Expand a masked swap, add, sub or nand pseudo
+/// into an LR/SC loop on the containing word:
+///
+/// .Lloop:
+///     lr.w  dest, (addr)
+///     binop scratch, dest, incr          (not for a swap)
+///     <merge the bits of scratch (or incr) under mask into dest, in scratch>
+///     sc.w  scratch, scratch, (addr)
+///     bne   scratch, zero, .Lloop
+bool RISCVExpandPseudo::expandMaskedAtomicBinOp(
+    MachineBasicBlock &MBB, MachineBasicBlock::iterator MBBI,
+    MachineBasicBlock::iterator &NextMBBI) {
+  MachineInstr &MI = *MBBI;
+  DebugLoc DL = MI.getDebugLoc();
+  unsigned Opcode = MI.getOpcode();
+  unsigned DestReg = MI.getOperand(0).getReg();
+  unsigned ScratchReg = MI.getOperand(1).getReg();
+  unsigned AddrReg = MI.getOperand(2).getReg();
+  unsigned IncrReg = MI.getOperand(3).getReg();
+  unsigned MaskReg = MI.getOperand(4).getReg();
+  AtomicOrdering Ordering =
+      static_cast<AtomicOrdering>(MI.getOperand(5).getImm());
+  bool IsRV64 = STI->isRV64();
+
+  MachineFunction *MF = MBB.getParent();
+  MachineBasicBlock *LoopMBB = MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+  MachineBasicBlock *DoneMBB = MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+
+  MF->insert(++MBB.getIterator(), LoopMBB);
+  MF->insert(++LoopMBB->getIterator(), DoneMBB);
+
+  BuildMI(LoopMBB, DL, TII->get(getLRForOrdering(Opcode, Ordering)), DestReg)
+      .addReg(AddrReg);
+  // A swap merges the new value in directly.
+  unsigned NewValReg = ScratchReg;
+  switch (Opcode) {
+  default:
+    llvm_unreachable("Unexpected masked atomic pseudo");
+  case RISCV::PseudoMaskedAtomicSwap32:
+  case RISCV::PseudoMaskedAtomicSwap32_64:
+    NewValReg = IncrReg;
+    break;
+  case RISCV::PseudoMaskedAtomicLoadAdd32:
+  case RISCV::PseudoMaskedAtomicLoadAdd32_64:
+    BuildMI(LoopMBB, DL, TII->get(IsRV64 ? RISCV::ADDW : RISCV::ADD),
+            ScratchReg)
+        .addReg(DestReg)
+        .addReg(IncrReg);
+    break;
+  case RISCV::PseudoMaskedAtomicLoadSub32:
+  case RISCV::PseudoMaskedAtomicLoadSub32_64:
+    BuildMI(LoopMBB, DL, TII->get(IsRV64 ? RISCV::SUBW : RISCV::SUB),
+            ScratchReg)
+        .addReg(DestReg)
+        .addReg(IncrReg);
+    break;
+  case RISCV::PseudoMaskedAtomicLoadNand32:
+  case RISCV::PseudoMaskedAtomicLoadNand32_64:
+    BuildMI(LoopMBB, DL, TII->get(RISCV::AND), ScratchReg)
+        .addReg(DestReg)
+        .addReg(IncrReg);
+    BuildMI(LoopMBB, DL, TII->get(RISCV::XORI), ScratchReg)
+        .addReg(ScratchReg)
+        .addImm(-1);
+    break;
+  }
+  insertMaskedMerge(LoopMBB, DL, ScratchReg, DestReg, NewValReg, MaskReg);
+  BuildMI(LoopMBB, DL, TII->get(getSCForOrdering(Opcode, Ordering)),
+          ScratchReg)
+      .addReg(ScratchReg)
+      .addReg(AddrReg);
+  BuildMI(LoopMBB, DL, TII->get(RISCV::BNE))
+      .addReg(ScratchReg)
+      .addReg(RISCV::X0_32)
+      .addMBB(LoopMBB);
+  LoopMBB->addSuccessor(LoopMBB);
+  LoopMBB->addSuccessor(DoneMBB);
+
+  DoneMBB->splice(DoneMBB->end(), &MBB, MI, MBB.end());
+  DoneMBB->transferSuccessors(&MBB);
+  MBB.addSuccessor(LoopMBB);
+
+  NextMBBI = MBB.end();
+  MI.eraseFromParent();
+
+  computeLoopLiveIns(*MF, {LoopMBB}, *DoneMBB);
+  return true;
+}
+
+/// expandMaskedAtomicMinMax - Expand a masked min or max pseudo into an LR/SC
+/// loop on the containing word that only stores a new field when the
+/// comparison asks for it:
+///
+/// .Lhead:
+///     lr.w  dest, (addr)
+///     and   scratch2, dest, mask
+///     mv    scratch1, dest
+///     [sll  scratch2, scratch2, sextshamt]
+///     [sra  scratch2, scratch2, sextshamt]
+///     bge   scratch2, incr, .Ltail    (bgeu if unsigned; swapped for min)
+/// .Lupdate:
+///     <merge the bits of incr under mask into dest, in scratch1>
+/// .Ltail:
+///     sc.w  scratch1, scratch1, (addr)
+///     bne   scratch1, zero, .Lhead
+bool RISCVExpandPseudo::expandMaskedAtomicMinMax(
+    MachineBasicBlock &MBB, MachineBasicBlock::iterator MBBI,
+    MachineBasicBlock::iterator &NextMBBI) {
+  MachineInstr &MI = *MBBI;
+  DebugLoc DL = MI.getDebugLoc();
+  unsigned Opcode = MI.getOpcode();
+  unsigned DestReg = MI.getOperand(0).getReg();
+  unsigned Scratch1Reg = MI.getOperand(1).getReg();
+  unsigned Scratch2Reg = MI.getOperand(2).getReg();
+  unsigned AddrReg = MI.getOperand(3).getReg();
+  unsigned IncrReg = MI.getOperand(4).getReg();
+  unsigned MaskReg = MI.getOperand(5).getReg();
+  bool IsSigned = false;
+  unsigned SextShamtReg = 0;
+  unsigned OrderingIdx = 6;
+  switch (Opcode) {
+  case RISCV::PseudoMaskedAtomicLoadMax32:
+  case RISCV::PseudoMaskedAtomicLoadMax32_64:
+  case RISCV::PseudoMaskedAtomicLoadMin32:
+  case RISCV::PseudoMaskedAtomicLoadMin32_64:
+    IsSigned = true;
+    SextShamtReg = MI.getOperand(6).getReg();
+    OrderingIdx = 7;
+    break;
+  }
+  AtomicOrdering Ordering =
+      static_cast<AtomicOrdering>(MI.getOperand(OrderingIdx).getImm());
+  bool IsRV64 = STI->isRV64();
+
+  MachineFunction *MF = MBB.getParent();
+  MachineBasicBlock *LoopHeadMBB =
+      MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+  MachineBasicBlock *LoopUpdateMBB =
+      MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+  MachineBasicBlock *LoopTailMBB =
+      MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+  MachineBasicBlock *DoneMBB = MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+
+  MF->insert(++MBB.getIterator(), LoopHeadMBB);
+  MF->insert(++LoopHeadMBB->getIterator(), LoopUpdateMBB);
+  MF->insert(++LoopUpdateMBB->getIterator(), LoopTailMBB);
+  MF->insert(++LoopTailMBB->getIterator(), DoneMBB);
+
+  BuildMI(LoopHeadMBB, DL, TII->get(getLRForOrdering(Opcode, Ordering)),
+          DestReg)
+      .addReg(AddrReg);
+  BuildMI(LoopHeadMBB, DL, TII->get(RISCV::AND), Scratch2Reg)
+      .addReg(DestReg)
+      .addReg(MaskReg);
+  BuildMI(LoopHeadMBB, DL, TII->get(RISCV::OR), Scratch1Reg)
+      .addReg(DestReg)
+      .addReg(RISCV::X0_32);
+  if (IsSigned) {
+    BuildMI(LoopHeadMBB, DL, TII->get(IsRV64 ? RISCV::SLLW : RISCV::SLL),
+            Scratch2Reg)
+        .addReg(Scratch2Reg)
+        .addReg(SextShamtReg);
+    BuildMI(LoopHeadMBB, DL, TII->get(IsRV64 ? RISCV::SRAW : RISCV::SRA),
+            Scratch2Reg)
+        .addReg(Scratch2Reg)
+        .addReg(SextShamtReg);
+  }
+
+  // Keep the old field when it already is the maximum (or minimum).
+  bool IsMax = false;
+  switch (Opcode) {
+  case RISCV::PseudoMaskedAtomicLoadMax32:
+  case RISCV::PseudoMaskedAtomicLoadMax32_64:
+  case RISCV::PseudoMaskedAtomicLoadUMax32:
+  case RISCV::PseudoMaskedAtomicLoadUMax32_64:
+    IsMax = true;
+    break;
+  }
+  BuildMI(LoopHeadMBB, DL, TII->get(IsSigned ? RISCV::BGE : RISCV::BGEU))
+      .addReg(IsMax ? Scratch2Reg : IncrReg)
+      .addReg(IsMax ? IncrReg : Scratch2Reg)
+      .addMBB(LoopTailMBB);
+  LoopHeadMBB->addSuccessor(LoopUpdateMBB);
+  LoopHeadMBB->addSuccessor(LoopTailMBB);
+
+  insertMaskedMerge(LoopUpdateMBB, DL, Scratch1Reg, DestReg, IncrReg, MaskReg);
+  LoopUpdateMBB->addSuccessor(LoopTailMBB);
+
+  BuildMI(LoopTailMBB, DL, TII->get(getSCForOrdering(Opcode, Ordering)),
+          Scratch1Reg)
+      .addReg(Scratch1Reg)
+      .addReg(AddrReg);
+  BuildMI(LoopTailMBB, DL, TII->get(RISCV::BNE))
+      .addReg(Scratch1Reg)
+      .addReg(RISCV::X0_32)
+      .addMBB(LoopHeadMBB);
+  LoopTailMBB->addSuccessor(LoopHeadMBB);
+  LoopTailMBB->addSuccessor(DoneMBB);
+
+  DoneMBB->splice(DoneMBB->end(), &MBB, MI, MBB.end());
+  DoneMBB->transferSuccessors(&MBB);
+  MBB.addSuccessor(LoopHeadMBB);
+
+  NextMBBI = MBB.end();
+  MI.eraseFromParent();
+
+  computeLoopLiveIns(*MF, {LoopHeadMBB, LoopUpdateMBB, LoopTailMBB},
+                     *DoneMBB);
+  return true;
+}
+
+/// expandMaskedCmpXchg - Expand a masked compare-and-swap pseudo into an
+/// LR/SC loop on the containing word:
+///
+/// .Lhead:
+///     lr.w  dest, (addr)
+///     and   scratch, dest, mask
+///     bne   scratch, cmpval, .Ldone
+/// .Ltail:
+///     <merge the bits of newval under mask into dest, in scratch>
+///     sc.w  scratch, scratch, (addr)
+///     bne   scratch, zero, .Lhead
+/// .Ldone:
+bool RISCVExpandPseudo::expandMaskedCmpXchg(
+    MachineBasicBlock &MBB, MachineBasicBlock::iterator MBBI,
+    MachineBasicBlock::iterator &NextMBBI) {
+  MachineInstr &MI = *MBBI;
+  DebugLoc DL = MI.getDebugLoc();
+  unsigned Opcode = MI.getOpcode();
+  unsigned DestReg = MI.getOperand(0).getReg();
+  unsigned ScratchReg = MI.getOperand(1).getReg();
+  unsigned AddrReg = MI.getOperand(2).getReg();
+  unsigned CmpValReg = MI.getOperand(3).getReg();
+  unsigned NewValReg = MI.getOperand(4).getReg();
+  unsigned MaskReg = MI.getOperand(5).getReg();
+  AtomicOrdering Ordering =
+      static_cast<AtomicOrdering>(MI.getOperand(6).getImm());
+
+  MachineFunction *MF = MBB.getParent();
+  MachineBasicBlock *LoopHeadMBB =
+      MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+  MachineBasicBlock *LoopTailMBB =
+      MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+  MachineBasicBlock *DoneMBB = MF->CreateMachineBasicBlock(MBB.getBasicBlock());
+
+  MF->insert(++MBB.getIterator(), LoopHeadMBB);
+  MF->insert(++LoopHeadMBB->getIterator(), LoopTailMBB);
+  MF->insert(++LoopTailMBB->getIterator(), DoneMBB);
+
+  BuildMI(LoopHeadMBB, DL, TII->get(getLRForOrdering(Opcode, Ordering)),
+          DestReg)
+      .addReg(AddrReg);
+  BuildMI(LoopHeadMBB, DL, TII->get(RISCV::AND), ScratchReg)
+      .addReg(DestReg)
+      .addReg(MaskReg);
+  BuildMI(LoopHeadMBB, DL, TII->get(RISCV::BNE))
+      .addReg(ScratchReg)
+      .addReg(CmpValReg)
+      .addMBB(DoneMBB);
+  LoopHeadMBB->addSuccessor(LoopTailMBB);
+  LoopHeadMBB->addSuccessor(DoneMBB);
+
+  insertMaskedMerge(LoopTailMBB, DL, ScratchReg, DestReg, NewValReg, MaskReg);
+  BuildMI(LoopTailMBB, DL, TII->get(getSCForOrdering(Opcode, Ordering)),
+          ScratchReg)
+      .addReg(ScratchReg)
+      .addReg(AddrReg);
+  BuildMI(LoopTailMBB, DL, TII->get(RISCV::BNE))
+      .addReg(ScratchReg)
+      .addReg(RISCV::X0_32)
+      .addMBB(LoopHeadMBB);
+  LoopTailMBB->addSuccessor(LoopHeadMBB);
+  LoopTailMBB->addSuccessor(DoneMBB);
+
+  DoneMBB->splice(DoneMBB->end(), &MBB, MI, MBB.end());
+  DoneMBB->transferSuccessors(&MBB);
+  MBB.addSuccessor(LoopHeadMBB);
+
+  NextMBBI = MBB.end();
+  MI.eraseFromParent();
+
+  computeLoopLiveIns(*MF, {LoopHeadMBB, LoopTailMBB}, *DoneMBB);
+  return true;
+}
+
 bool RISCVExpandPseudo::expandMI(MachineBasicBlock &MBB,
                                  MachineBasicBlock::iterator MBBI,
                                  MachineBasicBlock::iterator &NextMBBI) {
@@ -218,6 +682,31 @@ bool RISCVExpandPseudo::expandMI(MachineBasicBlock &MBB,
     case RISCV::MOVi64imm:
       expandMOV64BitImm(MBB, MBBI);
       return true;
+    case RISCV::PseudoCmpXchg32:
+    case RISCV::PseudoCmpXchg32_64:
+    case RISCV::PseudoCmpXchg64:
+      return expandAtomicCmpXchg(MBB, MBBI, NextMBBI);
+    case RISCV::PseudoMaskedAtomicSwap32:
+    case RISCV::PseudoMaskedAtomicSwap32_64:
+    case RISCV::PseudoMaskedAtomicLoadAdd32:
+    case RISCV::PseudoMaskedAtomicLoadAdd32_64:
+    case RISCV::PseudoMaskedAtomicLoadSub32:
+    case RISCV::PseudoMaskedAtomicLoadSub32_64:
+    case RISCV::PseudoMaskedAtomicLoadNand32:
+    case RISCV::PseudoMaskedAtomicLoadNand32_64:
+      return expandMaskedAtomicBinOp(MBB, MBBI, NextMBBI);
+    case RISCV::PseudoMaskedAtomicLoadMax32:
+    case RISCV::PseudoMaskedAtomicLoadMax32_64:
+    case RISCV::PseudoMaskedAtomicLoadMin32:
+    case RISCV::PseudoMaskedAtomicLoadMin32_64:
+    case RISCV::PseudoMaskedAtomicLoadUMax32:
+    case RISCV::PseudoMaskedAtomicLoadUMax32_64:
+    case RISCV::PseudoMaskedAtomicLoadUMin32:
+    case RISCV::PseudoMaskedAtomicLoadUMin32_64:
+      return expandMaskedAtomicMinMax(MBB, MBBI, NextMBBI);
+    case RISCV::PseudoMaskedCmpXchg32:
+    case RISCV::PseudoMaskedCmpXchg32_64:
+      return expandMaskedCmpXchg(MBB, MBBI, NextMBBI);
     }
 }
 
@@ -239,18 +728,6 @@ bool RISCVExpandPseudo::runOnMachineFunction(MachineFunction &MF) {
   TII = STI->getInstrInfo();
   TRI = STI->getRegisterInfo();
 
-  if (STI->isRV32()) {
-    ADDI = RISCV::ADDI;
-    CADDI = RISCV::CADDI;
-    LUI = RISCV::LUI;
-    CLUI = RISCV::CLUI;
-  } else {
-    ADDI = RISCV::ADDI64;
-    CADDI = RISCV::CADDI64;
-    LUI = RISCV::LUI64;
-    CLUI = RISCV::CLUI64;
-  }
-
   bool Modified = false;
   for (MachineFunction::iterator MFI = MF.begin(), E = MF.end(); MFI != E;
        ++MFI)
@@ -0,0 +1,1045 @@
+//===-- RISCVFastISel.cpp - RISCV FastISel implementation -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the RISCV-specific support for the FastISel class. Some
+// of the target-specific code is generated by tablegen in the file
+// RISCVGenFastISel.inc, which is #included here.
+//
+// FastISel only covers the integer subset of the ISA: arithmetic, loads and
+// stores with a reg+imm address, compares, branches, and calls and returns
+// that follow the standard ABI with every value in a register. Anything else
+// is left to SelectionDAG one instruction at a time.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCV.h"
+#include "RISCVCallingConv.h"
+#include "RISCVISelLowering.h"
+#include "RISCVInstrInfo.h"
+#include "RISCVMachineFunctionInfo.h"
+#include "RISCVSubtarget.h"
+#include "RISCVTargetMachine.h"
+#include "RISCVTargetObjectFile.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/CallingConvLower.h"
+#include "llvm/CodeGen/FastISel.h"
+#include "llvm/CodeGen/FunctionLoweringInfo.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/GetElementPtrTypeIterator.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/Debug.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "riscv-fastisel"
+
+// SelectionDAGISel already counts the instructions FastISel fails on. These
+// say why the most common ones were handed back.
+STATISTIC(NumFastISelCallFallbacks, "Number of calls left to SelectionDAG");
+STATISTIC(NumFastISelRetFallbacks, "Number of returns left to SelectionDAG");
+STATISTIC(NumFastISelMemFallbacks,
+          "Number of loads and stores left to SelectionDAG");
+
+namespace {
+
+class RISCVFastISel final : public FastISel {
+
+  // An address is a base register or a frame index plus a constant offset,
+  // which is the only addressing mode loads and stores have.
+  class Address {
+  public:
+    typedef enum { RegBase, FrameIndexBase } BaseKind;
+
+  private:
+    BaseKind Kind;
+    union {
+      unsigned Reg;
+      int FI;
+    } Base;
+    int64_t Offset;
+
+  public:
+    Address() : Kind(RegBase), Offset(0) { Base.Reg = 0; }
+    void setKind(BaseKind K) { Kind = K; }
+    BaseKind getKind() const { return Kind; }
+    bool isRegBase() const { return Kind == RegBase; }
+    bool isFIBase() const { return Kind == FrameIndexBase; }
+    void setReg(unsigned Reg) {
+      assert(isRegBase() && "Invalid base register access!");
+      Base.Reg = Reg;
+    }
+    unsigned getReg() const {
+      assert(isRegBase() && "Invalid base register access!");
+      return Base.Reg;
+    }
+    void setFI(int FI) {
+      assert(isFIBase() && "Invalid base frame index access!");
+      Base.FI = FI;
+    }
+    int getFI() const {
+      assert(isFIBase() && "Invalid base frame index access!");
+      return Base.FI;
+    }
+    void setOffset(int64_t O) { Offset = O; }
+    int64_t getOffset() const { return Offset; }
+  };
+
+  const RISCVSubtarget *Subtarget;
+  const RISCVTargetLowering &RTLI;
+  LLVMContext *Context;
+  bool IsRV64;
+  MVT XLenVT;
+
+public:
+  explicit RISCVFastISel(FunctionLoweringInfo &FuncInfo,
+                         const TargetLibraryInfo *LibInfo)
+      : FastISel(FuncInfo, LibInfo),
+        Subtarget(&FuncInfo.MF->getSubtarget<RISCVSubtarget>()),
+        RTLI(*Subtarget->getTargetLowering()),
+        Context(&FuncInfo.Fn->getContext()) {
+    IsRV64 = Subtarget->isRV64();
+    XLenVT = IsRV64 ? MVT::i64 : MVT::i32;
+  }
+
+  bool fastSelectInstruction(const Instruction *I) override;
+  bool fastLowerArguments() override;
+  bool fastLowerCall(CallLoweringInfo &CLI) override;
+  unsigned fastMaterializeConstant(const Constant *C) override;
+  unsigned fastMaterializeAlloca(const AllocaInst *AI) override;
+  unsigned fastEmit_ri(MVT VT, MVT RetVT, unsigned Opcode, unsigned Op0,
+                       bool Op0IsKill, uint64_t Imm) override;
+
+private:
+  bool isTypeLegal(Type *Ty, MVT &VT);
+  bool isTypeSupported(Type *Ty, MVT &VT);
+  const TargetRegisterClass *getRegClassFor(MVT VT) const {
+    return VT == MVT::i64 ? &RISCV::GPR64RegClass : &RISCV::GPRRegClass;
+  }
+
+  // Address handling.
+  bool computeAddress(const Value *Obj, Address &Addr);
+  bool simplifyAddress(Address &Addr);
+  void addLoadStoreOperands(MachineInstrBuilder &MIB, const Address &Addr,
+                            MachineMemOperand *MMO);
+
+  // Emit helpers.
+  unsigned emitLoad(MVT VT, Address &Addr, MachineMemOperand *MMO);
+  bool emitStore(MVT VT, unsigned SrcReg, Address &Addr,
+                 MachineMemOperand *MMO);
+  unsigned emitIntExt(MVT SrcVT, unsigned SrcReg, MVT DestVT, bool IsZExt);
+  bool getICmpOperands(const CmpInst *CI, unsigned &LHSReg, unsigned &RHSReg,
+                       MVT &VT);
+  unsigned emitICmp(CmpInst::Predicate Pred, unsigned LHSReg, unsigned RHSReg,
+                    MVT VT);
+  unsigned materializeGV(const GlobalValue *GV, MVT VT);
+
+  // Instruction selection.
+  bool selectLoad(const Instruction *I);
+  bool selectStore(const Instruction *I);
+  bool selectBranch(const Instruction *I);
+  bool selectICmp(const Instruction *I);
+  bool selectIntExt(const Instruction *I);
+  bool selectTrunc(const Instruction *I);
+  bool selectRet(const Instruction *I);
+
+#include "RISCVGenFastISel.inc"
+};
+
+} // end anonymous namespace
+
+bool RISCVFastISel::isTypeLegal(Type *Ty, MVT &VT) {
+  EVT Evt = TLI.getValueType(DL, Ty, true);
+  // Only handle simple types.
+  if (Evt == MVT::Other || !Evt.isSimple())
+    return false;
+  VT = Evt.getSimpleVT();
+  return TLI.isTypeLegal(VT);
+}
+
+// Integers narrower than a register are handled by extending them in a GPR.
+// Floating-point and packed-SIMD values are always left to SelectionDAG.
+bool RISCVFastISel::isTypeSupported(Type *Ty, MVT &VT) {
+  if (!Ty->isIntegerTy() && !Ty->isPointerTy())
+    return false;
+  if (isTypeLegal(Ty, VT))
+    return true;
+  return VT == MVT::i1 || VT == MVT::i8 || VT == MVT::i16;
+}
+
+bool RISCVFastISel::computeAddress(const Value *Obj, Address &Addr) {
+  const User *U = nullptr;
+  unsigned Opcode = Instruction::UserOp1;
+  if (const Instruction *I = dyn_cast<Instruction>(Obj)) {
+    // Don't walk into other basic blocks unless the object is an alloca from
+    // another block, otherwise it may not have a virtual register assigned.
+    if (FuncInfo.StaticAllocaMap.count(static_cast<const AllocaInst *>(Obj)) ||
+        FuncInfo.MBBMap[I->getParent()] == FuncInfo.MBB) {
+      Opcode = I->getOpcode();
+      U = I;
+    }
+  } else if (const ConstantExpr *C = dyn_cast<ConstantExpr>(Obj)) {
+    Opcode = C->getOpcode();
+    U = C;
+  }
+
+  switch (Opcode) {
+  default:
+    break;
+  case Instruction::BitCast:
+    // Look through bitcasts.
+    return computeAddress(U->getOperand(0), Addr);
+  case Instruction::IntToPtr:
+    // Look past no-op inttoptrs.
+    if (TLI.getValueType(DL, U->getOperand(0)->getType()) ==
+        TLI.getPointerTy(DL))
+      return computeAddress(U->getOperand(0), Addr);
+    break;
+  case Instruction::PtrToInt:
+    // Look past no-op ptrtoints.
+    if (TLI.getValueType(DL, U->getType()) == TLI.getPointerTy(DL))
+      return computeAddress(U->getOperand(0), Addr);
+    break;
+  case Instruction::GetElementPtr: {
+    Address SavedAddr = Addr;
+    int64_t TmpOffset = Addr.getOffset();
+    // Fold a GEP with only constant indices into the offset.
+    gep_type_iterator GTI = gep_type_begin(U);
+    for (User::const_op_iterator i = U->op_begin() + 1, e = U->op_end();
+         i != e; ++i, ++GTI) {
+      const Value *Op = *i;
+      if (StructType *STy = GTI.getStructTypeOrNull()) {
+        const StructLayout *SL = DL.getStructLayout(STy);
+        unsigned Idx = cast<ConstantInt>(Op)->getZExtValue();
+        TmpOffset += SL->getElementOffset(Idx);
+        continue;
+      }
+      const ConstantInt *CI = dyn_cast<ConstantInt>(Op);
+      if (!CI)
+        // A variable index is computed by the generic GEP selection.
+        return false;
+      uint64_t S = DL.getTypeAllocSize(GTI.getIndexedType());
+      TmpOffset += CI->getSExtValue() * S;
+    }
+    Addr.setOffset(TmpOffset);
+    if (computeAddress(U->getOperand(0), Addr))
+      return true;
+    // We failed, restore everything and try the other options.
+    Addr = SavedAddr;
+    break;
+  }
+  case Instruction::Alloca: {
+    const AllocaInst *AI = cast<AllocaInst>(Obj);
+    DenseMap<const AllocaInst *, int>::iterator SI =
+        FuncInfo.StaticAllocaMap.find(AI);
+    if (SI != FuncInfo.StaticAllocaMap.end()) {
+      Addr.setKind(Address::FrameIndexBase);
+      Addr.setFI(SI->second);
+      return true;
+    }
+    break;
+  }
+  }
+
+  Addr.setReg(getRegForValue(Obj));
+  return Addr.getReg() != 0;
+}
+
+// Make the offset fit into the 12-bit immediate of a load or store by adding
+// it to the base register first.
+bool RISCVFastISel::simplifyAddress(Address &Addr) {
+  if (isInt<12>(Addr.getOffset()))
+    return true;
+
+  if (Addr.isFIBase()) {
+    unsigned ResultReg = createResultReg(getRegClassFor(XLenVT));
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+            TII.get(IsRV64 ? RISCV::ADDI64 : RISCV::ADDI), ResultReg)
+        .addFrameIndex(Addr.getFI())
+        .addImm(0);
+    Addr.setKind(Address::RegBase);
+    Addr.setReg(ResultReg);
+  }
+
+  unsigned ResultReg = fastEmit_ri_(XLenVT, ISD::ADD, Addr.getReg(),
+                                    /*IsKill=*/false, Addr.getOffset(),
+                                    XLenVT);
+  if (!ResultReg)
+    return false;
+  Addr.setReg(ResultReg);
+  Addr.setOffset(0);
+  return true;
+}
+
+void RISCVFastISel::addLoadStoreOperands(MachineInstrBuilder &MIB,
+                                         const Address &Addr,
+                                         MachineMemOperand *MMO) {
+  if (Addr.isFIBase())
+    MIB.addFrameIndex(Addr.getFI());
+  else
+    MIB.addReg(Addr.getReg());
+  MIB.addImm(Addr.getOffset());
+  if (MMO)
+    MIB.addMemOperand(MMO);
+}
+
+unsigned RISCVFastISel::emitLoad(MVT VT, Address &Addr,
+                                 MachineMemOperand *MMO) {
+  // Sub-word values are zero-extended; any later extension is explicit.
+  unsigned Opc;
+  switch (VT.SimpleTy) {
+  default:
+    return 0;
+  case MVT::i1:
+  case MVT::i8:
+    Opc = RISCV::LBU;
+    break;
+  case MVT::i16:
+    Opc = RISCV::LHU;
+    break;
+  case MVT::i32:
+    Opc = RISCV::LW;
+    break;
+  case MVT::i64:
+    Opc = RISCV::LD;
+    break;
+  }
+
+  if (!simplifyAddress(Addr))
+    return 0;
+
+  unsigned ResultReg = createResultReg(getRegClassFor(VT));
+  const MCInstrDesc &II = TII.get(Opc);
+  if (Addr.isRegBase())
+    Addr.setReg(constrainOperandRegClass(II, Addr.getReg(), 1));
+  MachineInstrBuilder MIB =
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, II, ResultReg);
+  addLoadStoreOperands(MIB, Addr, MMO);
+  return ResultReg;
+}
+
+bool RISCVFastISel::emitStore(MVT VT, unsigned SrcReg, Address &Addr,
+                              MachineMemOperand *MMO) {
+  unsigned Opc;
+  switch (VT.SimpleTy) {
+  default:
+    return false;
+  case MVT::i1:
+  case MVT::i8:
+    Opc = RISCV::SB;
+    break;
+  case MVT::i16:
+    Opc = RISCV::SH;
+    break;
+  case MVT::i32:
+    Opc = RISCV::SW;
+    break;
+  case MVT::i64:
+    Opc = RISCV::SD;
+    break;
+  }
+
+  if (!simplifyAddress(Addr))
+    return false;
+
+  const MCInstrDesc &II = TII.get(Opc);
+  SrcReg = constrainOperandRegClass(II, SrcReg, 0);
+  if (Addr.isRegBase())
+    Addr.setReg(constrainOperandRegClass(II, Addr.getReg(), 1));
+  MachineInstrBuilder MIB =
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, II).addReg(SrcReg);
+  addLoadStoreOperands(MIB, Addr, MMO);
+  return true;
+}
+
+// Extend SrcReg from SrcVT to DestVT. Values narrower than 32 bits are
+// extended within a GPR first. On RV64 an i32 is always held sign-extended,
+// so sign-extending it to i64 only changes the register class.
+unsigned RISCVFastISel::emitIntExt(MVT SrcVT, unsigned SrcReg, MVT DestVT,
+                                   bool IsZExt) {
+  if (SrcVT == DestVT || SrcVT == MVT::i64)
+    return SrcReg;
+
+  MVT OrigVT = SrcVT;
+  if (SrcVT != MVT::i32) {
+    if (IsZExt && SrcVT != MVT::i16) {
+      SrcReg = fastEmitInst_ri(RISCV::ANDI, &RISCV::GPRRegClass, SrcReg,
+                               /*IsKill=*/false, SrcVT == MVT::i1 ? 1 : 255);
+    } else {
+      unsigned Shift = 32 - SrcVT.getSizeInBits();
+      unsigned ShlOpc = IsRV64 ? RISCV::SLLIW : RISCV::SLLI;
+      unsigned ShrOpc;
+      if (IsZExt)
+        ShrOpc = IsRV64 ? RISCV::SRLIW : RISCV::SRLI;
+      else
+        ShrOpc = IsRV64 ? RISCV::SRAIW : RISCV::SRAI;
+      unsigned TmpReg = fastEmitInst_ri(ShlOpc, &RISCV::GPRRegClass, SrcReg,
+                                        /*IsKill=*/false, Shift);
+      SrcReg = fastEmitInst_ri(ShrOpc, &RISCV::GPRRegClass, TmpReg,
+                               /*IsKill=*/true, Shift);
+    }
+    if (!SrcReg)
+      return 0;
+  }
+
+  if (DestVT != MVT::i64)
+    return SrcReg;
+
+  unsigned Reg64 = createResultReg(&RISCV::GPR64RegClass);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+          TII.get(TargetOpcode::SUBREG_TO_REG), Reg64)
+      .addImm(0)
+      .addReg(SrcReg)
+      .addImm(RISCV::sub_32);
+  // A value extended within the GPR already has its upper bits right.
+  if (!IsZExt || OrigVT != MVT::i32)
+    return Reg64;
+
+  unsigned TmpReg = fastEmitInst_ri(RISCV::SLLI64, &RISCV::GPR64RegClass,
+                                    Reg64, /*IsKill=*/true, 32);
+  return fastEmitInst_ri(RISCV::SRLI64, &RISCV::GPR64RegClass, TmpReg,
+                         /*IsKill=*/true, 32);
+}
+
+unsigned RISCVFastISel::materializeGV(const GlobalValue *GV, MVT VT) {
+  // Thread-local addresses need the TLS sequences built by SelectionDAG.
+  if (GV->isThreadLocal())
+    return 0;
+
+  const TargetRegisterClass *RC = getRegClassFor(VT);
+  unsigned ResultReg = createResultReg(RC);
+
+  // Small data is addressed relative to gp, like lowerGlobalAddress does.
+  const auto &TLOF = static_cast<const RISCVELFTargetObjectFile &>(
+      *TM.getObjFileLowering());
+  const GlobalObject *GO = dyn_cast<GlobalObject>(GV);
+  if (GO && TLOF.isGlobalInSmallSection(GO, TM)) {
+    if (Subtarget->hasXV5())
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+              TII.get(IsRV64 ? RISCV::ADDIGP64 : RISCV::ADDIGP), ResultReg)
+          .addGlobalAddress(GV, 0, RISCVII::MO_GPREL);
+    else
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+              TII.get(IsRV64 ? RISCV::ADDI64 : RISCV::ADDI), ResultReg)
+          .addReg(IsRV64 ? RISCV::X3_64 : RISCV::X3_32)
+          .addGlobalAddress(GV, 0, RISCVII::MO_GPREL);
+    return ResultReg;
+  }
+
+  if (TLI.isPositionIndependent() || TM.getCodeModel() == CodeModel::Medium) {
+    unsigned Opc;
+    if (TM.shouldAssumeDSOLocal(*GV->getParent(), GV))
+      Opc = IsRV64 ? RISCV::PseudoLLA64 : RISCV::PseudoLLA;
+    else
+      Opc = IsRV64 ? RISCV::PseudoLA64 : RISCV::PseudoLA;
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(Opc), ResultReg)
+        .addGlobalAddress(GV);
+    return ResultReg;
+  }
+
+  unsigned HiReg = createResultReg(RC);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+          TII.get(IsRV64 ? RISCV::LUI64 : RISCV::LUI), HiReg)
+      .addGlobalAddress(GV, 0, RISCVII::MO_HI);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+          TII.get(IsRV64 ? RISCV::ADDI64 : RISCV::ADDI), ResultReg)
+      .addReg(HiReg, RegState::Kill)
+      .addGlobalAddress(GV, 0, RISCVII::MO_LO);
+  return ResultReg;
+}
+
+unsigned RISCVFastISel::fastMaterializeConstant(const Constant *C) {
+  EVT CEVT = TLI.getValueType(DL, C->getType(), true);
+  if (!CEVT.isSimple())
+    return 0;
+  MVT VT = CEVT.getSimpleVT();
+
+  // Integer constants are handled by the generated MOVi32imm/MOVi64imm
+  // selection.
+  if (const GlobalValue *GV = dyn_cast<GlobalValue>(C))
+    return materializeGV(GV, VT);
+  return 0;
+}
+
+unsigned RISCVFastISel::fastMaterializeAlloca(const AllocaInst *AI) {
+  assert(TLI.getValueType(DL, AI->getType(), true) == XLenVT &&
+         "Alloca should always return a pointer.");
+
+  DenseMap<const AllocaInst *, int>::iterator SI =
+      FuncInfo.StaticAllocaMap.find(AI);
+  if (SI == FuncInfo.StaticAllocaMap.end())
+    return 0;
+
+  unsigned ResultReg = createResultReg(getRegClassFor(XLenVT));
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+          TII.get(IsRV64 ? RISCV::ADDI64 : RISCV::ADDI), ResultReg)
+      .addFrameIndex(SI->second)
+      .addImm(0);
+  return ResultReg;
+}
+
+bool RISCVFastISel::selectLoad(const Instruction *I) {
+  // Atomic loads need fences.
+  if (cast<LoadInst>(I)->isAtomic())
+    return false;
+
+  MVT VT;
+  if (!isTypeSupported(I->getType(), VT))
+    return false;
+
+  Address Addr;
+  if (!computeAddress(I->getOperand(0), Addr))
+    return false;
+
+  unsigned ResultReg = emitLoad(VT, Addr, createMachineMemOperandFor(I));
+  if (!ResultReg)
+    return false;
+  updateValueMap(I, ResultReg);
+  return true;
+}
+
+bool RISCVFastISel::selectStore(const Instruction *I) {
+  const Value *Op0 = I->getOperand(0);
+
+  // Atomic stores need fences.
+  if (cast<StoreInst>(I)->isAtomic())
+    return false;
+
+  MVT VT;
+  if (!isTypeSupported(Op0->getType(), VT))
+    return false;
+
+  // Storing zero or a null pointer uses x0 directly.
+  unsigned SrcReg;
+  const Constant *C = dyn_cast<Constant>(Op0);
+  if (C && C->isNullValue()) {
+    SrcReg = VT == MVT::i64 ? RISCV::X0_64 : RISCV::X0_32;
+  } else {
+    SrcReg = getRegForValue(Op0);
+    if (!SrcReg)
+      return false;
+    // Only bit 0 of an i1 is defined.
+    if (VT == MVT::i1)
+      SrcReg = emitIntExt(MVT::i1, SrcReg, MVT::i8, /*IsZExt=*/true);
+  }
+
+  Address Addr;
+  if (!computeAddress(I->getOperand(1), Addr))
+    return false;
+
+  return emitStore(VT, SrcReg, Addr, createMachineMemOperandFor(I));
+}
+
+// Get both operands of an integer compare in registers of the same class,
+// extending anything narrower than 32 bits according to the predicate.
+bool RISCVFastISel::getICmpOperands(const CmpInst *CI, unsigned &LHSReg,
+                                    unsigned &RHSReg, MVT &VT) {
+  if (!isTypeSupported(CI->getOperand(0)->getType(), VT))
+    return false;
+
+  LHSReg = getRegForValue(CI->getOperand(0));
+  RHSReg = getRegForValue(CI->getOperand(1));
+  if (!LHSReg || !RHSReg)
+    return false;
+
+  if (VT == MVT::i1 || VT == MVT::i8 || VT == MVT::i16) {
+    bool IsZExt = !CI->isSigned();
+    LHSReg = emitIntExt(VT, LHSReg, MVT::i32, IsZExt);
+    RHSReg = emitIntExt(VT, RHSReg, MVT::i32, IsZExt);
+    if (!LHSReg || !RHSReg)
+      return false;
+    VT = MVT::i32;
+  }
+  return true;
+}
+
+// Materialise an integer compare as 0 or 1 in a GPR. The sequences are the
+// ones used by the setcc patterns.
+unsigned RISCVFastISel::emitICmp(CmpInst::Predicate Pred, unsigned LHSReg,
+                                 unsigned RHSReg, MVT VT) {
+  bool Is64 = VT == MVT::i64;
+  const TargetRegisterClass *RC = &RISCV::GPRRegClass;
+  unsigned SLTOpc = Is64 ? RISCV::SLT32 : RISCV::SLT;
+  unsigned SLTUOpc = Is64 ? RISCV::SLTU32 : RISCV::SLTU;
+  bool Invert = false;
+  unsigned ResultReg;
+
+  switch (Pred) {
+  default:
+    return 0;
+  case CmpInst::ICMP_EQ:
+  case CmpInst::ICMP_NE: {
+    unsigned XorReg =
+        fastEmitInst_rr(Is64 ? RISCV::XOR64 : RISCV::XOR, getRegClassFor(VT),
+                        LHSReg, /*IsKill=*/false, RHSReg, /*IsKill=*/false);
+    if (Pred == CmpInst::ICMP_EQ)
+      return fastEmitInst_ri(Is64 ? RISCV::SLTIU32 : RISCV::SLTIU, RC, XorReg,
+                             /*IsKill=*/true, 1);
+    return fastEmitInst_rr(SLTUOpc, RC, Is64 ? RISCV::X0_64 : RISCV::X0_32,
+                           /*IsKill=*/false, XorReg, /*IsKill=*/true);
+  }
+  case CmpInst::ICMP_SGT:
+  case CmpInst::ICMP_SLE:
+    Invert = Pred == CmpInst::ICMP_SLE;
+    ResultReg = fastEmitInst_rr(SLTOpc, RC, RHSReg, false, LHSReg, false);
+    break;
+  case CmpInst::ICMP_SLT:
+  case CmpInst::ICMP_SGE:
+    Invert = Pred == CmpInst::ICMP_SGE;
+    ResultReg = fastEmitInst_rr(SLTOpc, RC, LHSReg, false, RHSReg, false);
+    break;
+  case CmpInst::ICMP_UGT:
+  case CmpInst::ICMP_ULE:
+    Invert = Pred == CmpInst::ICMP_ULE;
+    ResultReg = fastEmitInst_rr(SLTUOpc, RC, RHSReg, false, LHSReg, false);
+    break;
+  case CmpInst::ICMP_ULT:
+  case CmpInst::ICMP_UGE:
+    Invert = Pred == CmpInst::ICMP_UGE;
+    ResultReg = fastEmitInst_rr(SLTUOpc, RC, LHSReg, false, RHSReg, false);
+    break;
+  }
+
+  if (Invert)
+    ResultReg =
+        fastEmitInst_ri(RISCV::XORI, RC, ResultReg, /*IsKill=*/true, 1);
+  return ResultReg;
+}
+
+bool RISCVFastISel::selectICmp(const Instruction *I) {
+  const ICmpInst *CI = cast<ICmpInst>(I);
+  unsigned LHSReg, RHSReg;
+  MVT VT;
+  if (!getICmpOperands(CI, LHSReg, RHSReg, VT))
+    return false;
+
+  unsigned ResultReg = emitICmp(CI->getPredicate(), LHSReg, RHSReg, VT);
+  if (!ResultReg)
+    return false;
+  updateValueMap(I, ResultReg);
+  return true;
+}
+
+bool RISCVFastISel::selectBranch(const Instruction *I) {
+  const BranchInst *BI = cast<BranchInst>(I);
+  MachineBasicBlock *BrBB = FuncInfo.MBB;
+  MachineBasicBlock *TBB = FuncInfo.MBBMap[BI->getSuccessor(0)];
+  MachineBasicBlock *FBB = FuncInfo.MBBMap[BI->getSuccessor(1)];
+
+  // Fold a compare that is only used by this branch into the branch itself.
+  const ICmpInst *CI = dyn_cast<ICmpInst>(BI->getCondition());
+  if (CI && CI->hasOneUse() && CI->getParent() == I->getParent()) {
+    unsigned LHSReg, RHSReg;
+    MVT VT;
+    if (!getICmpOperands(CI, LHSReg, RHSReg, VT))
+      return false;
+
+    bool Is64 = VT == MVT::i64;
+    bool Swap = false;
+    unsigned Opc;
+    switch (CI->getPredicate()) {
+    default:
+      return false;
+    case CmpInst::ICMP_EQ:  Opc = Is64 ? RISCV::BEQ64 : RISCV::BEQ; break;
+    case CmpInst::ICMP_NE:  Opc = Is64 ? RISCV::BNE64 : RISCV::BNE; break;
+    case CmpInst::ICMP_SLT: Opc = Is64 ? RISCV::BLT64 : RISCV::BLT; break;
+    case CmpInst::ICMP_SGE: Opc = Is64 ? RISCV::BGE64 : RISCV::BGE; break;
+    case CmpInst::ICMP_ULT: Opc = Is64 ? RISCV::BLTU64 : RISCV::BLTU; break;
+    case CmpInst::ICMP_UGE: Opc = Is64 ? RISCV::BGEU64 : RISCV::BGEU; break;
+    case CmpInst::ICMP_SGT:
+      Opc = Is64 ? RISCV::BLT64 : RISCV::BLT;
+      Swap = true;
+      break;
+    case CmpInst::ICMP_SLE:
+      Opc = Is64 ? RISCV::BGE64 : RISCV::BGE;
+      Swap = true;
+      break;
+    case CmpInst::ICMP_UGT:
+      Opc = Is64 ? RISCV::BLTU64 : RISCV::BLTU;
+      Swap = true;
+      break;
+    case CmpInst::ICMP_ULE:
+      Opc = Is64 ? RISCV::BGEU64 : RISCV::BGEU;
+      Swap = true;
+      break;
+    }
+    if (Swap)
+      std::swap(LHSReg, RHSReg);
+
+    const MCInstrDesc &II = TII.get(Opc);
+    LHSReg = constrainOperandRegClass(II, LHSReg, 0);
+    RHSReg = constrainOperandRegClass(II, RHSReg, 1);
+    BuildMI(*BrBB, FuncInfo.InsertPt, DbgLoc, II)
+        .addReg(LHSReg)
+        .addReg(RHSReg)
+        .addMBB(TBB);
+    finishCondBranch(BI->getParent(), TBB, FBB);
+    return true;
+  }
+
+  unsigned CondReg = getRegForValue(BI->getCondition());
+  if (!CondReg)
+    return false;
+  // Only bit 0 of an i1 is defined.
+  CondReg = emitIntExt(MVT::i1, CondReg, MVT::i32, /*IsZExt=*/true);
+  if (!CondReg)
+    return false;
+  BuildMI(*BrBB, FuncInfo.InsertPt, DbgLoc, TII.get(RISCV::BNE))
+      .addReg(CondReg, RegState::Kill)
+      .addReg(RISCV::X0_32)
+      .addMBB(TBB);
+  finishCondBranch(BI->getParent(), TBB, FBB);
+  return true;
+}
+
+bool RISCVFastISel::selectIntExt(const Instruction *I) {
+  MVT SrcVT, DestVT;
+  if (!isTypeSupported(I->getOperand(0)->getType(), SrcVT) ||
+      !isTypeSupported(I->getType(), DestVT))
+    return false;
+
+  unsigned SrcReg = getRegForValue(I->getOperand(0));
+  if (!SrcReg)
+    return false;
+
+  // Narrow results are produced in a full GPR.
+  if (DestVT != MVT::i64)
+    DestVT = MVT::i32;
+  unsigned ResultReg = emitIntExt(SrcVT, SrcReg, DestVT, isa<ZExtInst>(I));
+  if (!ResultReg)
+    return false;
+  updateValueMap(I, ResultReg);
+  return true;
+}
+
+bool RISCVFastISel::selectTrunc(const Instruction *I) {
+  MVT SrcVT, DestVT;
+  if (!isTypeSupported(I->getOperand(0)->getType(), SrcVT) ||
+      !isTypeSupported(I->getType(), DestVT))
+    return false;
+
+  unsigned SrcReg = getRegForValue(I->getOperand(0));
+  if (!SrcReg)
+    return false;
+
+  // Truncating within a GPR keeps the register as it is; the unused upper
+  // bits are extended explicitly wherever they matter.
+  if (SrcVT != MVT::i64) {
+    updateValueMap(I, SrcReg);
+    return true;
+  }
+
+  // Keep the i32 sign-extended in the 64-bit register.
+  unsigned SubReg = fastEmitInst_extractsubreg(MVT::i32, SrcReg,
+                                               /*IsKill=*/false, RISCV::sub_32);
+  unsigned ResultReg = fastEmitInst_ri(RISCV::ADDIW, &RISCV::GPRRegClass,
+                                       SubReg, /*IsKill=*/true, 0);
+  if (!ResultReg)
+    return false;
+  updateValueMap(I, ResultReg);
+  return true;
+}
+
+bool RISCVFastISel::fastLowerArguments() {
+  const Function *F = FuncInfo.Fn;
+  if (F->isVarArg() || F->getCallingConv() != CallingConv::C ||
+      F->hasFnAttribute("interrupt"))
+    return false;
+
+  // Only handle integers and pointers that each arrive in one of a0-a7.
+  ArrayRef<MCPhysReg> ArgRegs = getArgRegs(Subtarget);
+  if (F->arg_size() > ArgRegs.size())
+    return false;
+  for (const Argument &Arg : F->args()) {
+    if (Arg.hasByValAttr() || Arg.hasAttribute(Attribute::InReg) ||
+        Arg.hasStructRetAttr() || Arg.hasNestAttr() ||
+        Arg.hasSwiftSelfAttr() || Arg.hasSwiftErrorAttr())
+      return false;
+    MVT VT;
+    if (!isTypeSupported(Arg.getType(), VT))
+      return false;
+  }
+
+  const TargetRegisterClass *RC = getRegClassFor(XLenVT);
+  unsigned Idx = 0;
+  for (const Argument &Arg : F->args()) {
+    unsigned DstReg = FuncInfo.MF->addLiveIn(ArgRegs[Idx++], RC);
+    // Copy out of the live-in so the argument can be spilled like any other
+    // virtual register.
+    unsigned ResultReg = createResultReg(RC);
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+            TII.get(TargetOpcode::COPY), ResultReg)
+        .addReg(DstReg, getKillRegState(true));
+
+    // On RV64 narrower values live in the 32-bit subregister. An i32 is
+    // re-extended unless the caller promised to do it, as
+    // LowerFormalArguments does.
+    MVT VT = TLI.getValueType(DL, Arg.getType()).getSimpleVT();
+    if (IsRV64 && VT != MVT::i64) {
+      ResultReg = fastEmitInst_extractsubreg(MVT::i32, ResultReg,
+                                             /*IsKill=*/true, RISCV::sub_32);
+      if (VT == MVT::i32 && !Arg.hasAttribute(Attribute::SExt))
+        ResultReg = fastEmitInst_ri(RISCV::ADDIW, &RISCV::GPRRegClass,
+                                    ResultReg, /*IsKill=*/true, 0);
+    }
+    updateValueMap(&Arg, ResultReg);
+  }
+  // Every argument arrived in a register.
+  FuncInfo.MF->getInfo<RISCVMachineFunctionInfo>()->setFormalArgInfo(0, false);
+  return true;
+}
+
+bool RISCVFastISel::fastLowerCall(CallLoweringInfo &CLI) {
+  CallingConv::ID CC = CLI.CallConv;
+  const Value *Callee = CLI.Callee;
+
+  // Varargs, tail calls and non-standard conventions are left to
+  // SelectionDAG, as are calls to bare symbols.
+  if (CC != CallingConv::C || CLI.IsVarArg || CLI.IsTailCall ||
+      CLI.Symbol) {
+    ++NumFastISelCallFallbacks;
+    return false;
+  }
+
+  MVT RetVT;
+  if (CLI.RetTy->isVoidTy())
+    RetVT = MVT::isVoid;
+  else if (!isTypeSupported(CLI.RetTy, RetVT)) {
+    ++NumFastISelCallFallbacks;
+    return false;
+  }
+
+  for (auto Flag : CLI.OutFlags)
+    if (Flag.isInReg() || Flag.isSRet() || Flag.isNest() || Flag.isByVal() ||
+        Flag.isSwiftSelf() || Flag.isSwiftError()) {
+      ++NumFastISelCallFallbacks;
+      return false;
+    }
+
+  SmallVector<MVT, 8> OutVTs;
+  for (const Value *Val : CLI.OutVals) {
+    MVT VT;
+    if (!isTypeSupported(Val->getType(), VT)) {
+      ++NumFastISelCallFallbacks;
+      return false;
+    }
+    OutVTs.push_back(VT);
+  }
+
+  // Every argument has to be passed in a register, so no outgoing argument
+  // area is needed.
+  SmallVector<CCValAssign, 8> ArgLocs;
+  CCState CCInfo(CC, CLI.IsVarArg, *FuncInfo.MF, ArgLocs, *Context);
+  CCInfo.AnalyzeCallOperands(OutVTs, CLI.OutFlags,
+                             RTLI.CCAssignFnForCall(CLI.IsVarArg));
+  for (CCValAssign &VA : ArgLocs)
+    if (!VA.isRegLoc() ||
+        (VA.getLocInfo() != CCValAssign::Full &&
+         VA.getLocInfo() != CCValAssign::SExt &&
+         VA.getLocInfo() != CCValAssign::ZExt &&
+         VA.getLocInfo() != CCValAssign::AExt)) {
+      ++NumFastISelCallFallbacks;
+      return false;
+    }
+
+  // The callee address, if it isn't a direct call.
+  const GlobalValue *GV = dyn_cast<GlobalValue>(Callee);
+  unsigned CalleeReg = 0;
+  if (!GV) {
+    CalleeReg = getRegForValue(Callee);
+    if (!CalleeReg)
+      return false;
+  }
+
+  // Put the arguments in place.
+  SmallVector<unsigned, 8> ArgRegs;
+  for (CCValAssign &VA : ArgLocs) {
+    unsigned ArgReg = getRegForValue(CLI.OutVals[VA.getValNo()]);
+    if (!ArgReg)
+      return false;
+    if (VA.getLocInfo() != CCValAssign::Full) {
+      ArgReg = emitIntExt(OutVTs[VA.getValNo()], ArgReg, VA.getLocVT(),
+                          VA.getLocInfo() == CCValAssign::ZExt);
+      if (!ArgReg)
+        return false;
+    }
+    ArgRegs.push_back(ArgReg);
+  }
+
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+          TII.get(TII.getCallFrameSetupOpcode()))
+      .addImm(0)
+      .addImm(0);
+  for (unsigned i = 0, e = ArgLocs.size(); i != e; ++i) {
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+            TII.get(TargetOpcode::COPY), ArgLocs[i].getLocReg())
+        .addReg(ArgRegs[i]);
+    CLI.OutRegs.push_back(ArgLocs[i].getLocReg());
+  }
+
+  // Issue the call.
+  MachineInstrBuilder MIB;
+  if (GV) {
+    unsigned char OpFlags = RISCVII::MO_CALL;
+    if (!TM.shouldAssumeDSOLocal(*GV->getParent(), GV))
+      OpFlags = RISCVII::MO_PLT;
+    MIB = BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+                  TII.get(IsRV64 ? RISCV::PseudoCALL64 : RISCV::PseudoCALL))
+              .addGlobalAddress(GV, 0, OpFlags);
+  } else {
+    const MCInstrDesc &II =
+        TII.get(IsRV64 ? RISCV::PseudoCALLIndirect64
+                       : RISCV::PseudoCALLIndirect);
+    CalleeReg = constrainOperandRegClass(II, CalleeReg, 0);
+    MIB = BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, II)
+              .addReg(CalleeReg);
+  }
+  for (unsigned Reg : CLI.OutRegs)
+    MIB.addReg(Reg, RegState::Implicit);
+  MIB.addRegMask(TRI.getCallPreservedMask(*FuncInfo.MF, CC));
+  CLI.Call = MIB;
+
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+          TII.get(TII.getCallFrameDestroyOpcode()))
+      .addImm(0)
+      .addImm(0);
+
+  // Copy the result out of its physical register.
+  if (RetVT != MVT::isVoid) {
+    SmallVector<CCValAssign, 2> RVLocs;
+    CCState CCRetInfo(CC, false, *FuncInfo.MF, RVLocs, *Context);
+    CCRetInfo.AnalyzeCallResult(RetVT, RTLI.CCAssignFnForReturn());
+    if (RVLocs.size() != 1 || !RVLocs[0].isRegLoc())
+      return false;
+    MVT CopyVT = RVLocs[0].getLocVT();
+    unsigned ResultReg = createResultReg(getRegClassFor(CopyVT));
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+            TII.get(TargetOpcode::COPY), ResultReg)
+        .addReg(RVLocs[0].getLocReg());
+    CLI.InRegs.push_back(RVLocs[0].getLocReg());
+    CLI.ResultReg = ResultReg;
+    CLI.NumResultRegs = 1;
+  }
+  return true;
+}
+
+bool RISCVFastISel::selectRet(const Instruction *I) {
+  const Function &F = *I->getParent()->getParent();
+  const ReturnInst *Ret = cast<ReturnInst>(I);
+
+  // Interrupt handlers return with a trap-return instruction.
+  if (!FuncInfo.CanLowerReturn || F.isVarArg() ||
+      F.getCallingConv() != CallingConv::C || F.hasFnAttribute("interrupt")) {
+    ++NumFastISelRetFallbacks;
+    return false;
+  }
+
+  SmallVector<unsigned, 1> RetRegs;
+  if (Ret->getNumOperands() > 0) {
+    // Only a single value returned in a GPR is handled.
+    SmallVector<ISD::OutputArg, 4> Outs;
+    GetReturnInfo(F.getReturnType(), F.getAttributes(), Outs, TLI, DL);
+    SmallVector<CCValAssign, 16> ValLocs;
+    CCState CCInfo(F.getCallingConv(), F.isVarArg(), *FuncInfo.MF, ValLocs,
+                   I->getContext());
+    CCInfo.AnalyzeReturn(Outs, RTLI.CCAssignFnForReturn());
+
+    const Value *RV = Ret->getOperand(0);
+    MVT RVVT;
+    if (ValLocs.size() != 1 || !ValLocs[0].isRegLoc() ||
+        ValLocs[0].getLocInfo() != CCValAssign::Full ||
+        !isTypeSupported(RV->getType(), RVVT)) {
+      ++NumFastISelRetFallbacks;
+      return false;
+    }
+    CCValAssign &VA = ValLocs[0];
+
+    unsigned Reg = getRegForValue(RV);
+    if (!Reg)
+      return false;
+
+    // Narrow values are extended as the attributes ask for.
+    MVT DestVT = VA.getValVT();
+    if (RVVT != DestVT && (Outs[0].Flags.isZExt() || Outs[0].Flags.isSExt())) {
+      Reg = emitIntExt(RVVT, Reg, DestVT, Outs[0].Flags.isZExt());
+      if (!Reg)
+        return false;
+    }
+
+    unsigned DestReg = VA.getLocReg();
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+            TII.get(TargetOpcode::COPY), DestReg)
+        .addReg(Reg);
+    RetRegs.push_back(DestReg);
+  }
+
+  MachineInstrBuilder MIB =
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+              TII.get(IsRV64 ? RISCV::PseudoRET64 : RISCV::PseudoRET));
+  for (unsigned Reg : RetRegs)
+    MIB.addReg(Reg, RegState::Implicit);
+  return true;
+}
+
+unsigned RISCVFastISel::fastEmit_ri(MVT VT, MVT RetVT, unsigned Opcode,
+                                    unsigned Op0, bool Op0IsKill,
+                                    uint64_t Imm) {
+  // All of the immediate patterns carry an operand predicate, so TableGen
+  // only generates the per-predicate emitters; try each range that fits.
+  unsigned ResultReg = 0;
+  if (Predicate_simm12(Imm))
+    ResultReg = fastEmit_ri_Predicate_simm12(VT, RetVT, Opcode, Op0, Op0IsKill,
+                                             Imm);
+  if (!ResultReg && Predicate_uimm5(Imm))
+    ResultReg = fastEmit_ri_Predicate_uimm5(VT, RetVT, Opcode, Op0, Op0IsKill,
+                                            Imm);
+  if (!ResultReg && Predicate_uimm6(Imm))
+    ResultReg = fastEmit_ri_Predicate_uimm6(VT, RetVT, Opcode, Op0, Op0IsKill,
+                                            Imm);
+  return ResultReg;
+}
+
+bool RISCVFastISel::fastSelectInstruction(const Instruction *I) {
+  switch (I->getOpcode()) {
+  default:
+    break;
+  case Instruction::Load:
+    if (selectLoad(I))
+      return true;
+    ++NumFastISelMemFallbacks;
+    return false;
+  case Instruction::Store:
+    if (selectStore(I))
+      return true;
+    ++NumFastISelMemFallbacks;
+    return false;
+  case Instruction::Br:
+    return selectBranch(I);
+  case Instruction::ICmp:
+    return selectICmp(I);
+  case Instruction::ZExt:
+  case Instruction::SExt:
+    return selectIntExt(I);
+  case Instruction::Trunc:
+    return selectTrunc(I);
+  case Instruction::Ret:
+    return selectRet(I);
+  }
+  return false;
+}
+
+namespace llvm {
+FastISel *RISCV::createFastISel(FunctionLoweringInfo &FuncInfo,
+                                const TargetLibraryInfo *LibInfo) {
+  return new RISCVFastISel(FuncInfo, LibInfo);
+}
+}
@@ -15,6 +15,7 @@
 #include "RISCVSubtarget.h"
 #include "RISCVCallingConv.h"
 #include "RISCVMachineFunctionInfo.h"
+#include "MCTargetDesc/RISCVBaseInfo.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
@@ -24,6 +25,46 @@
 
 using namespace llvm;
 
+// The __riscv_save_N routines store ra and s0 to s(N-1) at fixed offsets below
+// the incoming stack pointer, ra first. __riscv_restore_N reloads them, frees
+// that part of the frame and returns. Both ship with libgcc.
+static const char *const SpillLibCalls[] = {
+  "__riscv_save_0",  "__riscv_save_1",  "__riscv_save_2",  "__riscv_save_3",
+  "__riscv_save_4",  "__riscv_save_5",  "__riscv_save_6",  "__riscv_save_7",
+  "__riscv_save_8",  "__riscv_save_9",  "__riscv_save_10", "__riscv_save_11",
+  "__riscv_save_12"
+};
+
+static const char *const RestoreLibCalls[] = {
+  "__riscv_restore_0",  "__riscv_restore_1",  "__riscv_restore_2",
+  "__riscv_restore_3",  "__riscv_restore_4",  "__riscv_restore_5",
+  "__riscv_restore_6",  "__riscv_restore_7",  "__riscv_restore_8",
+  "__riscv_restore_9",  "__riscv_restore_10", "__riscv_restore_11",
+  "__riscv_restore_12"
+};
+
+/// Return the position of Reg in the save area of the __riscv_save_N
+/// routines (ra is 0, s0 is 1, ...), or -1 if they do not save it.
+static int getLibCallSlot(unsigned Reg) {
+  switch (Reg) {
+  default:
+    return -1;
+  case RISCV::X1_32:  case RISCV::X1_64:  return 0;
+  case RISCV::X8_32:  case RISCV::X8_64:  return 1;
+  case RISCV::X9_32:  case RISCV::X9_64:  return 2;
+  case RISCV::X18_32: case RISCV::X18_64: return 3;
+  case RISCV::X19_32: case RISCV::X19_64: return 4;
+  case RISCV::X20_32: case RISCV::X20_64: return 5;
+  case RISCV::X21_32: case RISCV::X21_64: return 6;
+  case RISCV::X22_32: case RISCV::X22_64: return 7;
+  case RISCV::X23_32: case RISCV::X23_64: return 8;
+  case RISCV::X24_32: case RISCV::X24_64: return 9;
+  case RISCV::X25_32: case RISCV::X25_64: return 10;
+  case RISCV::X26_32: case RISCV::X26_64: return 11;
+  case RISCV::X27_32: case RISCV::X27_64: return 12;
+  }
+}
+
 RISCVFrameLowering::RISCVFrameLowering(const RISCVSubtarget &sti)
       : TargetFrameLowering(StackGrowsDown,
                             /*StackAlignment=*/sti.hasE() ? 4: 16,
@@ -32,19 +73,44 @@ RISCVFrameLowering::RISCVFrameLowering(const RISCVSubtarget &sti)
 
 bool RISCVFrameLowering::hasFP(const MachineFunction &MF) const {
   const MachineFrameInfo &MFI = MF.getFrameInfo();
-  const TargetRegisterInfo *TRI = STI.getRegisterInfo();
 
   return (MF.getTarget().Options.DisableFramePointerElim(MF) ||
           MF.getFrameInfo().hasVarSizedObjects() ||
           MFI.isFrameAddressTaken() ||
-          TRI->needsStackRealignment(MF));
+          needsStackRealignment(MF));
 }
 
 bool RISCVFrameLowering::hasBP(const MachineFunction &MF) const {
   const MachineFrameInfo &MFI = MF.getFrameInfo();
+
+  return MFI.hasVarSizedObjects() && needsStackRealignment(MF);
+}
+
+// A trap can be taken while the stack pointer is only aligned to the register
+// size, e.g. in the middle of hand-written assembly, so an interrupt handler
+// that calls other functions first gives them the alignment the ABI promises.
+static bool isInterruptWithCalls(const MachineFunction &MF) {
+  return MF.getFunction()->hasFnAttribute("interrupt") &&
+         MF.getFrameInfo().hasCalls();
+}
+
+bool RISCVFrameLowering::needsStackRealignment(
+    const MachineFunction &MF) const {
   const TargetRegisterInfo *TRI = STI.getRegisterInfo();
+  if (TRI->needsStackRealignment(MF))
+    return true;
 
-  return MFI.hasVarSizedObjects() && TRI->needsStackRealignment(MF);
+  unsigned SlotSize = STI.isRV64() ? 8 : 4;
+  return isInterruptWithCalls(MF) && getStackAlignment() > SlotSize &&
+         TRI->canRealignStack(MF);
+}
+
+unsigned
+RISCVFrameLowering::getStackRealignment(const MachineFunction &MF) const {
+  unsigned MaxAlign = MF.getFrameInfo().getMaxAlignment();
+  if (isInterruptWithCalls(MF))
+    MaxAlign = std::max(MaxAlign, getStackAlignment());
+  return MaxAlign;
 }
 
 void RISCVFrameLowering::emitPrologue(MachineFunction &MF,
@@ -55,13 +121,13 @@ void RISCVFrameLowering::emitPrologue(MachineFunction &MF,
   unsigned ADDI = STI.isRV64() ? RISCV::ADDI64 :RISCV::ADDI;
   unsigned AND = STI.isRV64() ? RISCV::AND64 :RISCV::AND;
 
-  assert(&MF.front() == &MBB && "Shrink-wrapping not yet supported");
+  // With shrink-wrapping MBB is the save block chosen by the ShrinkWrap pass,
+  // which need not be the entry block. The callee-saved spills have already
+  // been inserted at its start.
   MachineFrameInfo &MFI = MF.getFrameInfo();
 
   const RISCVInstrInfo &TII =
       *static_cast<const RISCVInstrInfo *>(STI.getInstrInfo());
-  const RISCVRegisterInfo &TRI =
-      *static_cast<const RISCVRegisterInfo *>(STI.getRegisterInfo());
   const TargetRegisterClass *RC = STI.isRV64() ?
     &RISCV::GPR64RegClass : &RISCV::GPRRegClass;
 
@@ -82,22 +148,37 @@ void RISCVFrameLowering::emitPrologue(MachineFunction &MF,
   MachineModuleInfo &MMI = MF.getMMI();
   const MCRegisterInfo *MRI = MMI.getContext().getRegisterInfo();
 
-  // Adjust stack.
-  TII.adjustStackPtr(SP, -StackSize, MBB, MBBI);
+  const std::vector<CalleeSavedInfo> &CSI = MFI.getCalleeSavedInfo();
+  uint64_t LibCallStackSize = getLibCallStackSize(MF, CSI);
+
+  // The call to __riscv_save_N comes first. It has already allocated the top
+  // LibCallStackSize bytes of the frame.
+  if (LibCallStackSize) {
+    ++MBBI;
+    unsigned CFIIndex = MF.addFrameInst(
+        MCCFIInstruction::createDefCfaOffset(nullptr, -LibCallStackSize));
+    BuildMI(MBB, MBBI, DL, TII.get(TargetOpcode::CFI_INSTRUCTION))
+        .addCFIIndex(CFIIndex);
+  }
 
-  // emit ".cfi_def_cfa_offset StackSize"
-  unsigned CFIIndex = MF.addFrameInst(
-      MCCFIInstruction::createDefCfaOffset(nullptr, -StackSize));
-  BuildMI(MBB, MBBI, DL, TII.get(TargetOpcode::CFI_INSTRUCTION))
-      .addCFIIndex(CFIIndex);
+  if (StackSize > LibCallStackSize) {
+    // Adjust stack.
+    TII.adjustStackPtr(SP, -(StackSize - LibCallStackSize), MBB, MBBI);
 
-  const std::vector<CalleeSavedInfo> &CSI = MFI.getCalleeSavedInfo();
+    // emit ".cfi_def_cfa_offset StackSize"
+    unsigned CFIIndex = MF.addFrameInst(
+        MCCFIInstruction::createDefCfaOffset(nullptr, -StackSize));
+    BuildMI(MBB, MBBI, DL, TII.get(TargetOpcode::CFI_INSTRUCTION))
+        .addCFIIndex(CFIIndex);
+  }
 
   if (CSI.size()) {
     // Find the instruction past the last instruction that saves a callee-saved
-    // register to the stack.
+    // register to the stack. Registers saved by __riscv_save_N have no store
+    // of their own.
     for (unsigned i = 0; i < CSI.size(); ++i)
-      ++MBBI;
+      if (!LibCallStackSize || getLibCallSlot(CSI[i].getReg()) < 0)
+        ++MBBI;
 
     // Iterate over list of callee-saved registers and emit .cfi_offset
     // directives.
@@ -133,13 +214,13 @@ void RISCVFrameLowering::emitPrologue(MachineFunction &MF,
     // E.g. pass structure by stack and the structure need 16 byte alignment.
     // See the test case c-c++-common/torture/vector-shift2.c
     // myfunc2 function will return structure by stack.
-    if (TRI.needsStackRealignment(MF)) {
+    if (needsStackRealignment(MF)) {
       // ADDI $Reg, $zero, -MaxAlignment
       // AND  $sp, $sp, $Reg
       unsigned VR = MF.getRegInfo().createVirtualRegister(RC);
-      assert(isInt<16>(MFI.getMaxAlignment()) &&
+      assert(isInt<16>(getStackRealignment(MF)) &&
              "Function's alignment size requirement is not supported.");
-      int MaxAlign = -(int)MFI.getMaxAlignment();
+      int MaxAlign = -(int)getStackRealignment(MF);
 
       BuildMI(MBB, MBBI, DL, TII.get(ADDI), VR).addReg(ZERO) .addImm(MaxAlign);
       BuildMI(MBB, MBBI, DL, TII.get(AND), SP).addReg(SP).addReg(VR);
@@ -173,20 +254,29 @@ void RISCVFrameLowering::emitEpilogue(MachineFunction &MF,
   const RISCVInstrInfo &TII =
       *static_cast<const RISCVInstrInfo *>(STI.getInstrInfo());
 
-  MachineBasicBlock::iterator MBBI = MBB.getLastNonDebugInstr();
-  DebugLoc DL = MBBI->getDebugLoc();
+  // The restore block is not necessarily a return block when shrink-wrapping,
+  // so insert in front of its terminators rather than its last instruction.
+  MachineBasicBlock::iterator MBBI = MBB.getFirstTerminator();
+  DebugLoc DL;
+  if (MBBI != MBB.end())
+    DL = MBBI->getDebugLoc();
 
   // Get the number of bytes from FrameInfo
   uint64_t StackSize = MFI.getStackSize();
 
+  // The tail call to __riscv_restore_N frees the top of the frame.
+  const std::vector<CalleeSavedInfo> &CSI = MFI.getCalleeSavedInfo();
+  uint64_t LibCallStackSize = getLibCallStackSize(MF, CSI);
+
   // Restore the stack pointer if framepointer enabled
   // and the stack have been realign or have variable length object
   if (hasFP(MF)) {
     // Find the first instruction that restores a callee-saved register.
     MachineBasicBlock::iterator I = MBBI;
 
-    for (unsigned i = 0; i < MFI.getCalleeSavedInfo().size(); ++i)
-      --I;
+    for (unsigned i = 0; i < CSI.size(); ++i)
+      if (!LibCallStackSize || getLibCallSlot(CSI[i].getReg()) < 0)
+        --I;
 
     // Insert instruction "addi $sp, $fp, 0" at this location.
     if (isInt<12>(-StackSize)) {
@@ -197,11 +287,11 @@ void RISCVFrameLowering::emitEpilogue(MachineFunction &MF,
     }
   }
 
-  if (!StackSize)
+  if (StackSize == LibCallStackSize)
     return;
   else
     // Adjust stack.
-    TII.adjustStackPtr(SP, StackSize, MBB, MBBI);
+    TII.adjustStackPtr(SP, StackSize - LibCallStackSize, MBB, MBBI);
 }
 
 bool RISCVFrameLowering::
@@ -213,9 +303,22 @@ spillCalleeSavedRegisters(MachineBasicBlock &MBB,
     return false;
 
   MachineFunction &MF = *MBB.getParent();
-  MachineBasicBlock *EntryBlock = &(&MF)->front();
   const TargetInstrInfo &TII = *STI.getInstrInfo();
 
+  DebugLoc DL;
+  if (MI != MBB.end()) DL = MI->getDebugLoc();
+
+  // Call __riscv_save_N through t0, which is free at the save point (see
+  // useSaveRestoreLibCalls and canUseAsPrologue).
+  int LibCallID = getLibCallID(MF, CSI);
+  if (LibCallID >= 0) {
+    unsigned T0 = STI.isRV64() ? RISCV::X5_64 : RISCV::X5_32;
+    unsigned Opc = STI.isRV64() ? RISCV::PseudoCALLReg64 : RISCV::PseudoCALLReg;
+    BuildMI(MBB, MI, DL, TII.get(Opc), T0)
+        .addExternalSymbol(SpillLibCalls[LibCallID], RISCVII::MO_CALL)
+        .setMIFlag(MachineInstr::FrameSetup);
+  }
+
   for (unsigned i = 0, e = CSI.size(); i != e; ++i) {
     // Add the callee-saved register as live-in. Do not add if the register is
     // RA and return address is taken, because it has already been added in
@@ -228,10 +331,13 @@ spillCalleeSavedRegisters(MachineBasicBlock &MBB,
     if (!IsRAAndRetAddrIsTaken)
       MBB.addLiveIn(Reg);
 
+    if (LibCallID >= 0 && getLibCallSlot(Reg) >= 0)
+      continue;
+
     // Insert the spill to the stack frame.
     bool IsKill = !IsRAAndRetAddrIsTaken;
     const TargetRegisterClass *RC = TRI->getMinimalPhysRegClass(Reg);
-    TII.storeRegToStackSlot(*EntryBlock, MI, Reg, IsKill,
+    TII.storeRegToStackSlot(MBB, MI, Reg, IsKill,
                             CSI[i].getFrameIdx(), RC, TRI);
   }
 
@@ -249,14 +355,129 @@ restoreCalleeSavedRegisters(MachineBasicBlock &MBB,
   DebugLoc DL;
   if (MI != MBB.end()) DL = MI->getDebugLoc();
 
+  MachineFunction &MF = *MBB.getParent();
   const TargetInstrInfo &TII = *STI.getInstrInfo();
+  int LibCallID = getLibCallID(MF, CSI);
 
   for (unsigned i = 0, e = CSI.size(); i != e; ++i) {
     unsigned Reg = CSI[i].getReg();
+    if (LibCallID >= 0 && getLibCallSlot(Reg) >= 0)
+      continue;
     const TargetRegisterClass *RC = TRI->getMinimalPhysRegClass(Reg);
     TII.loadRegFromStackSlot(MBB, MI, Reg, CSI[i].getFrameIdx(), RC, TRI);
   }
 
+  // __riscv_restore_N returns to our caller, so it replaces the return.
+  if (LibCallID >= 0) {
+    assert(MI != MBB.end() && MI->isReturn() && !MI->isCall() &&
+           "Restore routine must replace a return");
+    unsigned Opc = STI.isRV64() ? RISCV::PseudoTAIL64 : RISCV::PseudoTAIL;
+    MachineInstr *NewMI =
+        BuildMI(MBB, MI, DL, TII.get(Opc))
+            .addExternalSymbol(RestoreLibCalls[LibCallID], RISCVII::MO_CALL)
+            .setMIFlag(MachineInstr::FrameDestroy);
+    NewMI->copyImplicitOps(MF, *MI);
+    MI->eraseFromParent();
+  }
+
+  return true;
+}
+
+bool RISCVFrameLowering::useSaveRestoreLibCalls(
+    const MachineFunction &MF) const {
+  const Function *F = MF.getFunction();
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+
+  if (!STI.enableSaveRestore() && !F->optForSize())
+    return false;
+
+  // Interrupt handlers return with a trap return, which __riscv_restore_N
+  // cannot do.
+  if (F->hasFnAttribute("interrupt"))
+    return false;
+
+  // The save area overlaps the varargs save area and the return address slot,
+  // both of which are also at fixed offsets below the incoming stack pointer.
+  // A function that ends in a tail call has no return for __riscv_restore_N
+  // to replace. RV32E has neither s2-s11 nor the 16-byte stack alignment the
+  // routines assume.
+  if (STI.hasE() || F->isVarArg() || MFI.hasTailCall() ||
+      MFI.isReturnAddressTaken())
+    return false;
+
+  // __riscv_save_N is called through t0 and uses t1 as scratch, so neither
+  // may bring an argument into the function, as fastcc can.
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  for (auto I = MRI.livein_begin(), E = MRI.livein_end(); I != E; ++I)
+    if (clobberedBySaveLibCall(I->first))
+      return false;
+  return true;
+}
+
+bool RISCVFrameLowering::clobberedBySaveLibCall(unsigned Reg) const {
+  const TargetRegisterInfo *TRI = STI.getRegisterInfo();
+  return TRI->regsOverlap(Reg, STI.isRV64() ? RISCV::X5_64 : RISCV::X5_32) ||
+         TRI->regsOverlap(Reg, STI.isRV64() ? RISCV::X6_64 : RISCV::X6_32);
+}
+
+int RISCVFrameLowering::getLibCallID(
+    const MachineFunction &MF, const std::vector<CalleeSavedInfo> &CSI) const {
+  if (CSI.empty() || !useSaveRestoreLibCalls(MF))
+    return -1;
+
+  // The routines always save ra and a prefix of s0-s11, so pick the one that
+  // covers the highest-numbered register we need.
+  int MaxSlot = -1;
+  for (auto &CS : CSI)
+    MaxSlot = std::max(MaxSlot, getLibCallSlot(CS.getReg()));
+  return MaxSlot;
+}
+
+uint64_t RISCVFrameLowering::getLibCallStackSize(
+    const MachineFunction &MF, const std::vector<CalleeSavedInfo> &CSI) const {
+  int LibCallID = getLibCallID(MF, CSI);
+  if (LibCallID < 0)
+    return 0;
+  unsigned SlotSize = STI.isRV64() ? 8 : 4;
+  return alignTo((LibCallID + 1) * SlotSize, 16);
+}
+
+bool RISCVFrameLowering::assignCalleeSavedSpillSlots(
+    MachineFunction &MF, const TargetRegisterInfo *TRI,
+    std::vector<CalleeSavedInfo> &CSI) const {
+  int LibCallID = getLibCallID(MF, CSI);
+  if (LibCallID < 0)
+    return false;
+
+  // Registers handled by the library routines live where the routines put
+  // them; everything else gets an ordinary spill slot.
+  MachineFrameInfo &MFI = MF.getFrameInfo();
+  unsigned SlotSize = STI.isRV64() ? 8 : 4;
+  for (auto &CS : CSI) {
+    unsigned Reg = CS.getReg();
+    int Slot = getLibCallSlot(Reg);
+    int FrameIdx;
+    if (Slot >= 0) {
+      FrameIdx = MFI.CreateFixedSpillStackObject(
+          SlotSize, -(int64_t)(Slot + 1) * SlotSize);
+    } else {
+      const TargetRegisterClass *RC = TRI->getMinimalPhysRegClass(Reg);
+      unsigned Align =
+          std::min(TRI->getSpillAlignment(*RC), getStackAlignment());
+      FrameIdx = MFI.CreateStackObject(TRI->getSpillSize(*RC), Align, true);
+    }
+    CS.setFrameIdx(FrameIdx);
+  }
+
+  // The routines save registers in groups that fill the whole 16-byte
+  // aligned area, so __riscv_save_4 also stores s4-s6 and __riscv_restore_4
+  // reloads them. Reserve the rest of the area so that no local is placed
+  // there.
+  uint64_t LibCallStackSize = getLibCallStackSize(MF, CSI);
+  uint64_t UsedSize = (LibCallID + 1) * SlotSize;
+  if (LibCallStackSize > UsedSize)
+    MFI.CreateFixedSpillStackObject(LibCallStackSize - UsedSize,
+                                    -(int64_t)LibCallStackSize);
   return true;
 }
 
@@ -355,6 +576,29 @@ bool RISCVFrameLowering::hasReservedCallFrame(const MachineFunction &MF) const {
   return !MF.getFrameInfo().hasVarSizedObjects();
 }
 
+bool RISCVFrameLowering::enableShrinkWrapping(const MachineFunction &MF) const {
+  // Keep the conventional code flow when not optimizing.
+  return !MF.getFunction()->hasFnAttribute(Attribute::OptimizeNone);
+}
+
+bool RISCVFrameLowering::canUseAsPrologue(const MachineBasicBlock &MBB) const {
+  if (!useSaveRestoreLibCalls(*MBB.getParent()))
+    return true;
+
+  // The call to __riscv_save_N clobbers t0 and t1.
+  for (const auto &LI : MBB.liveins())
+    if (clobberedBySaveLibCall(LI.PhysReg))
+      return false;
+  return true;
+}
+
+bool RISCVFrameLowering::canUseAsEpilogue(const MachineBasicBlock &MBB) const {
+  // __riscv_restore_N returns to the caller, so nothing may follow it.
+  if (!useSaveRestoreLibCalls(*MBB.getParent()))
+    return true;
+  return MBB.isReturnBlock();
+}
+
 // Eliminate ADJCALLSTACKDOWN, ADJCALLSTACKUP pseudo instructions
 MachineBasicBlock::iterator RISCVFrameLowering::
 eliminateCallFramePseudoInstr(MachineFunction &MF, MachineBasicBlock &MBB,
@@ -30,10 +30,21 @@ public:
 
   bool hasBP(const MachineFunction &MF) const;
 
+  /// Return true if the prologue realigns the stack pointer, either for
+  /// over-aligned stack objects or because MF is an interrupt handler that
+  /// calls other functions.
+  bool needsStackRealignment(const MachineFunction &MF) const;
+
+  /// Return the alignment the prologue realigns the stack pointer to.
+  unsigned getStackRealignment(const MachineFunction &MF) const;
+
   MachineBasicBlock::iterator
   eliminateCallFramePseudoInstr(MachineFunction &MF, MachineBasicBlock &MBB,
                                 MachineBasicBlock::iterator MI) const override;
 
+  bool assignCalleeSavedSpillSlots(
+      MachineFunction &MF, const TargetRegisterInfo *TRI,
+      std::vector<CalleeSavedInfo> &CSI) const override;
   bool spillCalleeSavedRegisters(MachineBasicBlock &MBB,
                                  MachineBasicBlock::iterator MI,
                                  const std::vector<CalleeSavedInfo> &CSI,
@@ -51,10 +62,32 @@ public:
 
   bool hasReservedCallFrame(const MachineFunction &MF) const override;
 
+  bool enableShrinkWrapping(const MachineFunction &MF) const override;
+
+  bool canUseAsPrologue(const MachineBasicBlock &MBB) const override;
+  bool canUseAsEpilogue(const MachineBasicBlock &MBB) const override;
+
 protected:
   const RISCVSubtarget &STI;
 
   uint64_t estimateStackSize(const MachineFunction &MF) const;
+
+  /// Return true if the callee-saved registers of MF may be saved and
+  /// restored by the __riscv_save_N and __riscv_restore_N library routines.
+  bool useSaveRestoreLibCalls(const MachineFunction &MF) const;
+
+  /// Return true if Reg overlaps t0 or t1, which calling __riscv_save_N
+  /// clobbers.
+  bool clobberedBySaveLibCall(unsigned Reg) const;
+
+  /// Return N for the __riscv_save_N routine that saves CSI, or -1 if the
+  /// registers are saved inline.
+  int getLibCallID(const MachineFunction &MF,
+                   const std::vector<CalleeSavedInfo> &CSI) const;
+
+  /// Return the number of bytes of the frame allocated by the save routine.
+  uint64_t getLibCallStackSize(const MachineFunction &MF,
+                               const std::vector<CalleeSavedInfo> &CSI) const;
 };
 }
 #endif
@@ -28,14 +28,14 @@ using namespace llvm;
 // SelectionDAG operations.
 namespace {
 class RISCVDAGToDAGISel final : public SelectionDAGISel {
-  const RISCVSubtarget &Subtarget;
+  const RISCVSubtarget *Subtarget;
   unsigned LUI, ADDI;
 public:
   explicit RISCVDAGToDAGISel(RISCVTargetMachine &TargetMachine)
       : SelectionDAGISel(TargetMachine),
-        Subtarget(*TargetMachine.getSubtargetImpl()) {
-    LUI = Subtarget.isRV64() ? RISCV::LUI64 : RISCV::LUI;
-    ADDI = Subtarget.isRV64() ? RISCV::ADDI64 : RISCV::ADDI;
+        Subtarget(TargetMachine.getSubtargetImpl()) {
+    LUI = Subtarget->isRV64() ? RISCV::LUI64 : RISCV::LUI;
+    ADDI = Subtarget->isRV64() ? RISCV::ADDI64 : RISCV::ADDI;
   }
 
   StringRef getPassName() const override {
@@ -44,6 +44,8 @@ public:
 
   void Select(SDNode *Node) override;
 
+  void PostprocessISelDAG() override;
+
   bool SelectInlineAsmMemoryOperand(const SDValue &Op, unsigned ConstraintID,
                                     std::vector<SDValue> &OutOps) override;
 
@@ -57,16 +59,11 @@ public:
   bool selectAddrFrameIndexOffset(SDValue Addr, SDValue &Base,
                                   SDValue &Offset, unsigned OffsetBits) const;
   bool SelectAddrRegImm12s(SDValue Addr, SDValue &Base, SDValue &Offset) const;
+  bool SelectAddrGP(SDNode *Root, SDValue Addr, SDValue &Offset) const;
 
-  bool SelectAddr16BitInstOffset(SDValue Addr, SDValue &Base,
-                                 SDValue &Offset, unsigned OffsetBits,
-                                 unsigned ShiftBits) const;
-
-  bool SelectAddrRegImm5uWord(SDValue Addr, SDValue &Base,
-                              SDValue &Offset) const;
-
-  bool SelectAddrRegImm5uDouble(SDValue Addr, SDValue &Base,
-                                SDValue &Offset) const;
+private:
+  void doPeepholeLoadStoreADDI();
+  bool selectBitfieldExtract(SDNode *Node);
 
 // Include the pieces autogenerated from the target description.
 #include "RISCVGenDAGISel.inc"
@@ -124,7 +121,7 @@ bool RISCVDAGToDAGISel::SelectAddrRegImm12s(SDValue Addr, SDValue &Base,
     return true;
 
   if (Addr.isMachineOpcode()
-      && Addr.getMachineOpcode() == RISCV::ADDI
+      && Addr.getMachineOpcode() == ADDI
       && Addr.getOperand(0).isMachineOpcode ()
       && Addr.getOperand(0).getMachineOpcode() == RISCVDAGToDAGISel::LUI) {
     // Use the hi-part register content, if possible.
@@ -144,73 +141,170 @@ bool RISCVDAGToDAGISel::SelectAddrRegImm12s(SDValue Addr, SDValue &Base,
       }
   }
 
+  if (Addr.isMachineOpcode() && Addr.getMachineOpcode() == ADDI) {
+    // Small data is reached from gp directly.
+    // Example:
+    // addi reg, gp, %gp_rel(sym)
+    // lw rt, 0(reg)
+    // To:
+    // lw rt, %gp_rel(sym)(gp)
+    RegisterSDNode *BaseReg = dyn_cast<RegisterSDNode>(Addr.getOperand(0));
+    GlobalAddressSDNode *GA = dyn_cast<GlobalAddressSDNode>(Addr.getOperand(1));
+    if (BaseReg && GA && GA->getTargetFlags() == RISCVII::MO_GPREL) {
+      Base = Addr.getOperand(0);
+      Offset = Addr.getOperand(1);
+      return true;
+    }
+  }
+
+  if (auto *C = dyn_cast<ConstantSDNode>(Addr)) {
+    // A constant address keeps its low 12 bits in the offset.
+    // Example:
+    // lui reg, %hi(C)
+    // addi reg, reg, %lo(C)
+    // lw rt, 0(reg)
+    // To:
+    // lui reg, %hi(C)
+    // lw rt, %lo(C)(reg)
+    int64_t CVal = C->getSExtValue();
+    int64_t Lo12 = SignExtend64<12>(CVal);
+    int64_t Hi = CVal - Lo12;
+    if (isInt<32>(Hi)) {
+      SDLoc DL(Addr);
+      EVT VT = Addr.getValueType();
+      if (Hi == 0)
+        Base = CurDAG->getRegister(
+            Subtarget->isRV64() ? RISCV::X0_64 : RISCV::X0_32, VT);
+      else
+        Base = SDValue(
+            CurDAG->getMachineNode(
+                LUI, DL, VT,
+                CurDAG->getTargetConstant((Hi >> 12) & 0xfffff, DL, VT)),
+            0);
+      Offset = CurDAG->getTargetConstant(Lo12, DL, VT);
+      return true;
+    }
+  }
+
   if (selectAddrFrameIndex(Addr, Base, Offset))
     return true;
 
   return false;
 }
 
-// Select 16 bit Load/Store instructions
-bool RISCVDAGToDAGISel::SelectAddr16BitInstOffset(SDValue Addr,
-                                                  SDValue &Base,
-                                                  SDValue &Offset,
-                                                  unsigned OffsetBits,
-                                                  unsigned ShiftBits) const {
-  if ((Addr.getOpcode() == ISD::ADD) &&
-      CurDAG->isBaseWithConstantOffset(Addr)) {
-    ConstantSDNode *CN = dyn_cast<ConstantSDNode>(Addr.getOperand(1));
+/// Match the %gp_rel(sym) of an addigp, for the AndeStar V5 gp-implied loads
+/// and stores. Their offset is scaled by the access size, so the symbol and
+/// the offset folded into it must both be aligned to it.
+bool RISCVDAGToDAGISel::SelectAddrGP(SDNode *Root, SDValue Addr,
+                                     SDValue &Offset) const {
+  // An offset inside the object is folded into the relocation.
+  int64_t AddrOffset = 0;
+  if (CurDAG->isBaseWithConstantOffset(Addr)) {
+    AddrOffset = cast<ConstantSDNode>(Addr.getOperand(1))->getSExtValue();
+    Addr = Addr.getOperand(0);
+  }
 
-    if (isUIntN(OffsetBits + ShiftBits, CN->getSExtValue())) {
-      EVT ValTy = Addr.getValueType();
+  if (!Addr.isMachineOpcode() ||
+      (Addr.getMachineOpcode() != RISCV::ADDIGP &&
+       Addr.getMachineOpcode() != RISCV::ADDIGP64))
+    return false;
 
-      // Return false if the offset not align on (1 << ShiftBits)
-      if (ShiftBits)
-        if (CN->getSExtValue() % (1 << ShiftBits) != 0)
-          return false;
+  auto *GA = dyn_cast<GlobalAddressSDNode>(Addr.getOperand(0));
+  auto *Mem = dyn_cast<MemSDNode>(Root);
+  if (!GA || !Mem || GA->getTargetFlags() != RISCVII::MO_GPREL)
+    return false;
 
-      // 16 bit 33 form load/store instruction not allow base as SP or FP.
-      if (dyn_cast<FrameIndexSDNode>(Addr.getOperand(0)))
-        return false;
-      else
-        Base = Addr.getOperand(0);
+  const DataLayout &DL = CurDAG->getDataLayout();
+  const GlobalValue *GV = GA->getGlobal();
+  unsigned Size = Mem->getMemoryVT().getStoreSize();
+  unsigned Align = GV->getPointerAlignment(DL);
+  int64_t NewOffset = GA->getOffset() + AddrOffset;
+  if (Align < Size || NewOffset % Size != 0)
+    return false;
 
-      Offset = CurDAG->getTargetConstant(CN->getZExtValue(), SDLoc(Addr),
-                                         ValTy);
-      return true;
-    }
+  if (AddrOffset == 0) {
+    Offset = Addr.getOperand(0);
+    return true;
   }
-
-  return false;
+  if (GA->getOffset() != 0 || NewOffset < 0 ||
+      (uint64_t)NewOffset >= DL.getTypeAllocSize(GV->getValueType()))
+    return false;
+  Offset = CurDAG->getTargetGlobalAddress(GV, SDLoc(Addr),
+                                          Addr.getValueType(), NewOffset,
+                                          GA->getTargetFlags());
+  return true;
 }
 
-bool RISCVDAGToDAGISel::SelectAddrRegImm5uWord(SDValue Addr, SDValue &Base,
-                                               SDValue &Offset) const {
-  if (SelectAddr16BitInstOffset(Addr, Base, Offset, 5, 2))
-    return true;
-
-  if (!CurDAG->isBaseWithConstantOffset(Addr) &&
-      !dyn_cast<FrameIndexSDNode>(Addr)) {
-    EVT ValTy = Addr.getValueType();
-    Base = Addr;
-    Offset  = CurDAG->getTargetConstant(0, SDLoc(Addr), ValTy);
-    return true;
+// Select an AndeStar V5 bfoz or bfos for a field extraction that would
+// otherwise need two shifts, or a shift and an and:
+//   (and (srl x, lsb), 2^n - 1)          -> bfoz x, lsb + n - 1, lsb
+//   (and x, 2^n - 1), too wide for andi   -> bfoz x, n - 1, 0
+//   (sra (shl x, c1), c2), c2 >= c1       -> bfos x, xlen - 1 - c1, c2 - c1
+bool RISCVDAGToDAGISel::selectBitfieldExtract(SDNode *Node) {
+  SDLoc DL(Node);
+  MVT VT = Node->getSimpleValueType(0);
+  if (VT != MVT::i32 && VT != MVT::i64)
+    return false;
+  unsigned BitWidth = VT.getSizeInBits();
+  // i32 values on RV64 are kept sign-extended, which a zero-extended field
+  // reaching bit 31 would break.
+  unsigned MaxZExtMSB =
+      VT == MVT::i32 && Subtarget->isRV64() ? BitWidth - 2 : BitWidth - 1;
+
+  SDValue Src;
+  unsigned MSB, LSB;
+  bool IsSigned = false;
+  switch (Node->getOpcode()) {
+  default:
+    return false;
+  case ISD::AND: {
+    auto *Mask = dyn_cast<ConstantSDNode>(Node->getOperand(1));
+    if (!Mask || !isMask_64(Mask->getZExtValue()))
+      return false;
+    unsigned Width = countTrailingOnes(Mask->getZExtValue());
+    SDValue Op0 = Node->getOperand(0);
+    auto *Shamt = dyn_cast<ConstantSDNode>(
+        Op0.getOpcode() == ISD::SRL ? Op0.getOperand(1) : SDValue());
+    if (Shamt && Op0.hasOneUse()) {
+      Src = Op0.getOperand(0);
+      LSB = Shamt->getZExtValue();
+    } else if (!isUInt<11>(Mask->getZExtValue())) {
+      Src = Op0;
+      LSB = 0;
+    } else {
+      return false;
+    }
+    MSB = LSB + Width - 1;
+    break;
+  }
+  case ISD::SRA: {
+    SDValue Op0 = Node->getOperand(0);
+    if (Op0.getOpcode() != ISD::SHL || !Op0.hasOneUse())
+      return false;
+    auto *C1 = dyn_cast<ConstantSDNode>(Op0.getOperand(1));
+    auto *C2 = dyn_cast<ConstantSDNode>(Node->getOperand(1));
+    if (!C1 || !C2 || C2->getZExtValue() < C1->getZExtValue())
+      return false;
+    Src = Op0.getOperand(0);
+    MSB = BitWidth - 1 - C1->getZExtValue();
+    LSB = C2->getZExtValue() - C1->getZExtValue();
+    IsSigned = true;
+    break;
+  }
   }
-  return false;
-}
 
-bool RISCVDAGToDAGISel::SelectAddrRegImm5uDouble(SDValue Addr, SDValue &Base,
-                                                 SDValue &Offset) const {
-  if (SelectAddr16BitInstOffset(Addr, Base, Offset, 5, 3))
-    return true;
+  if (MSB >= BitWidth || (!IsSigned && MSB > MaxZExtMSB))
+    return false;
 
-  if (!CurDAG->isBaseWithConstantOffset(Addr) &&
-      !dyn_cast<FrameIndexSDNode>(Addr)) {
-    EVT ValTy = Addr.getValueType();
-    Base = Addr;
-    Offset  = CurDAG->getTargetConstant(0, SDLoc(Addr), ValTy);
-    return true;
-  }
-  return false;
+  unsigned Opc;
+  if (VT == MVT::i64)
+    Opc = IsSigned ? RISCV::BFOS64 : RISCV::BFOZ64;
+  else
+    Opc = IsSigned ? RISCV::BFOS : RISCV::BFOZ;
+  SDValue Ops[] = {Src, CurDAG->getTargetConstant(MSB, DL, VT),
+                   CurDAG->getTargetConstant(LSB, DL, VT)};
+  ReplaceNode(Node, CurDAG->getMachineNode(Opc, DL, VT, Ops));
+  return true;
 }
 
 void RISCVDAGToDAGISel::Select(SDNode *Node) {
@@ -229,7 +323,7 @@ void RISCVDAGToDAGISel::Select(SDNode *Node) {
   switch (Node->getOpcode()) {
   default: break;
   case ISD::FrameIndex: {
-    MVT PtrVT = Subtarget.isRV64() ? MVT::i64 : MVT::i32;
+    MVT PtrVT = Subtarget->isRV64() ? MVT::i64 : MVT::i32;
     int FI = cast<FrameIndexSDNode>(Node)->getIndex();
     SDValue TFI = CurDAG->getTargetFrameIndex(FI, PtrVT);
     if (Node->hasOneUse()) {
@@ -241,6 +335,11 @@ void RISCVDAGToDAGISel::Select(SDNode *Node) {
                           CurDAG->getTargetConstant(0, DL, PtrVT)));
     return;
   }
+  case ISD::AND:
+  case ISD::SRA:
+    if (Subtarget->hasXV5() && selectBitfieldExtract(Node))
+      return;
+    break;
   }
 
   // Select the default instruction.
@@ -265,6 +364,175 @@ SelectInlineAsmMemoryOperand(const SDValue &Op, unsigned ConstraintID,
   return true;
 }
 
+void RISCVDAGToDAGISel::PostprocessISelDAG() {
+  doPeepholeLoadStoreADDI();
+}
+
+// Return the operand indices of the base register and the 12-bit offset of a
+// machine node that adds an immediate to a register: a load, a store or an
+// addi itself.
+static bool getBaseAndOffsetIdx(unsigned Opc, unsigned &BaseOpIdx,
+                                unsigned &OffsetOpIdx) {
+  switch (Opc) {
+  default:
+    return false;
+  case RISCV::LB:
+  case RISCV::LH:
+  case RISCV::LW:
+  case RISCV::LBU:
+  case RISCV::LHU:
+  case RISCV::LB64:
+  case RISCV::LH64:
+  case RISCV::LW64:
+  case RISCV::LBU64:
+  case RISCV::LHU64:
+  case RISCV::LWU:
+  case RISCV::LD:
+  case RISCV::FLW:
+  case RISCV::FLD:
+  case RISCV::ADDI:
+  case RISCV::ADDI64:
+    BaseOpIdx = 0;
+    OffsetOpIdx = 1;
+    return true;
+  case RISCV::SB:
+  case RISCV::SH:
+  case RISCV::SW:
+  case RISCV::SB64:
+  case RISCV::SH64:
+  case RISCV::SW64:
+  case RISCV::SD:
+  case RISCV::FSW:
+  case RISCV::FSD:
+    BaseOpIdx = 1;
+    OffsetOpIdx = 2;
+    return true;
+  }
+}
+
+// Merge an addi into the 12-bit offset of the loads, stores and addis that
+// use it. Global addresses are lowered without their offset so that accesses
+// to the same object share the lui, which leaves sequences like
+//   lui a0, %hi(sym)
+//   addi a0, a0, %lo(sym)
+//   lw a1, 8(a0)
+// that become
+//   lui a0, %hi(sym)
+//   lw a1, %lo(sym+8)(a0)
+void RISCVDAGToDAGISel::doPeepholeLoadStoreADDI() {
+  SelectionDAG::allnodes_iterator Position(CurDAG->getRoot().getNode());
+  ++Position;
+
+  while (Position != CurDAG->allnodes_begin()) {
+    SDNode *N = &*--Position;
+    // Skip dead nodes and any non-machine opcodes.
+    if (N->use_empty() || !N->isMachineOpcode())
+      continue;
+
+    unsigned BaseOpIdx, OffsetOpIdx;
+    if (!getBaseAndOffsetIdx(N->getMachineOpcode(), BaseOpIdx, OffsetOpIdx))
+      continue;
+
+    auto *Offset2Node = dyn_cast<ConstantSDNode>(N->getOperand(OffsetOpIdx));
+    if (!Offset2Node)
+      continue;
+    int64_t Offset2 = Offset2Node->getSExtValue();
+
+    SDValue Base = N->getOperand(BaseOpIdx);
+    if (!Base.isMachineOpcode())
+      continue;
+
+    // The pc-relative address of a local symbol takes the whole offset in
+    // its relocation:
+    //   lla a0, sym
+    //   addi a0, a0, 8
+    // becomes
+    //   lla a0, sym+8
+    if (N->getMachineOpcode() == ADDI &&
+        (Base.getMachineOpcode() == RISCV::PseudoLLA ||
+         Base.getMachineOpcode() == RISCV::PseudoLLA64)) {
+      auto *GA = dyn_cast<GlobalAddressSDNode>(Base.getOperand(0));
+      if (!GA || GA->getOffset() != 0)
+        continue;
+      SDLoc DL(N);
+      EVT VT = N->getValueType(0);
+      SDValue NewGA = CurDAG->getTargetGlobalAddress(
+          GA->getGlobal(), DL, VT, Offset2, GA->getTargetFlags());
+      SDNode *LLA =
+          CurDAG->getMachineNode(Base.getMachineOpcode(), DL, VT, NewGA);
+      ReplaceUses(SDValue(N, 0), SDValue(LLA, 0));
+      if (Base.getNode()->use_empty())
+        CurDAG->RemoveDeadNode(Base.getNode());
+      continue;
+    }
+
+    if (Base.getMachineOpcode() != ADDI)
+      continue;
+
+    SDValue ImmOperand = Base.getOperand(1);
+    EVT Ty = ImmOperand.getValueType();
+    SDLoc DL(ImmOperand);
+
+    if (auto *Const = dyn_cast<ConstantSDNode>(ImmOperand)) {
+      // Frame indices are resolved, and their offsets checked, later.
+      if (isa<FrameIndexSDNode>(Base.getOperand(0)))
+        continue;
+      int64_t CombinedOffset = Const->getSExtValue() + Offset2;
+      if (!isInt<12>(CombinedOffset))
+        continue;
+      ImmOperand = CurDAG->getTargetConstant(CombinedOffset, DL, Ty);
+    } else if (auto *GA = dyn_cast<GlobalAddressSDNode>(ImmOperand)) {
+      if (GA->getOffset() != 0)
+        continue;
+      const DataLayout &Layout = CurDAG->getDataLayout();
+      const GlobalValue *GV = GA->getGlobal();
+      if (GA->getTargetFlags() == RISCVII::MO_LO) {
+        // The lui holds %hi(sym), which only equals %hi(sym+off) if adding
+        // off to the low part doesn't carry into bit 11. The alignment of
+        // the object guarantees that for offsets smaller than it.
+        unsigned Align = GV->getPointerAlignment(Layout);
+        if (Offset2 != 0 && (Offset2 < 0 || (uint64_t)Offset2 >= Align))
+          continue;
+      } else if (GA->getTargetFlags() == RISCVII::MO_GPREL) {
+        // Small data is in range of gp as a whole, so any offset inside the
+        // object can be folded.
+        if (Offset2 < 0 ||
+            (uint64_t)Offset2 >= Layout.getTypeAllocSize(GV->getValueType()))
+          continue;
+      } else {
+        continue;
+      }
+      ImmOperand = CurDAG->getTargetGlobalAddress(
+          GA->getGlobal(), DL, Ty, Offset2, GA->getTargetFlags());
+    } else if (auto *CP = dyn_cast<ConstantPoolSDNode>(ImmOperand)) {
+      if (CP->getTargetFlags() != RISCVII::MO_LO || CP->getOffset() != 0 ||
+          CP->isMachineConstantPoolEntry())
+        continue;
+      if (Offset2 != 0 &&
+          (Offset2 < 0 || (uint64_t)Offset2 >= CP->getAlignment()))
+        continue;
+      ImmOperand = CurDAG->getTargetConstantPool(
+          CP->getConstVal(), Ty, CP->getAlignment(), Offset2,
+          CP->getTargetFlags());
+    } else {
+      continue;
+    }
+
+    DEBUG(dbgs() << "Folding add-immediate into mem-op:\nBase:    ";
+          Base->dump(CurDAG); dbgs() << "\nN: "; N->dump(CurDAG);
+          dbgs() << "\n");
+
+    SmallVector<SDValue, 4> Ops(N->op_begin(), N->op_end());
+    Ops[BaseOpIdx] = Base.getOperand(0);
+    Ops[OffsetOpIdx] = ImmOperand;
+    CurDAG->UpdateNodeOperands(N, Ops);
+
+    // The add-immediate may now be dead, in which case remove it.
+    if (Base.getNode()->use_empty())
+      CurDAG->RemoveDeadNode(Base.getNode());
+  }
+}
+
 // This pass converts a legalized DAG into a RISCV-specific DAG, ready
 // for instruction scheduling.
 FunctionPass *llvm::createRISCVISelDag(RISCVTargetMachine &TM) {
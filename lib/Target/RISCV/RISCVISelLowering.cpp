@@ -19,11 +19,13 @@
 #include "RISCVRegisterInfo.h"
 #include "RISCVSubtarget.h"
 #include "RISCVTargetMachine.h"
+#include "RISCVTargetObjectFile.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/CallingConvLower.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/SelectionDAGISel.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
@@ -38,6 +40,42 @@ using namespace llvm;
 
 #define DEBUG_TYPE "riscv-lower"
 
+STATISTIC(NumTailCalls, "Number of tail calls");
+
+static cl::opt<bool>
+EnableRISCVTailCalls("enable-riscv-tail-calls", cl::Hidden,
+                     cl::desc("RISCV: Enable tail calls."), cl::init(true));
+
+static cl::opt<unsigned> BranchlessSelectMaxInsts(
+    "riscv-branchless-select-max-insts", cl::Hidden, cl::init(4),
+    cl::desc("RISCV: Maximum number of instructions an integer select may "
+             "expand to without a branch"));
+
+static cl::opt<bool> EnableCompactJumpTables(
+    "riscv-compact-jump-tables", cl::Hidden, cl::init(true),
+    cl::desc("RISCV: Emit jump tables with 8- or 16-bit PC-relative entries "
+             "when linker relaxation is disabled"));
+
+static cl::opt<unsigned> MulByConstMaxInsts(
+    "riscv-mul-const-max-insts", cl::Hidden, cl::init(12),
+    cl::desc("RISCV: Maximum number of shifts and adds a multiplication by a "
+             "constant may expand to when the M extension is unavailable"));
+
+static cl::opt<unsigned> DivByConstMaxInsts(
+    "riscv-div-const-max-insts", cl::Hidden, cl::init(36),
+    cl::desc("RISCV: Maximum number of instructions a division by a constant "
+             "may expand to when the M extension is unavailable"));
+
+/// Return true if the calling convention is one that we can guarantee TCO for.
+static bool canGuaranteeTCO(CallingConv::ID CC) {
+  return CC == CallingConv::Fast;
+}
+
+/// Return true if we might ever do TCO for calls with this calling convention.
+static bool shouldGuaranteeTCO(CallingConv::ID CC, bool GuaranteedTailCallOpt) {
+  return GuaranteedTailCallOpt && canGuaranteeTCO(CC);
+}
+
 RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &TM,
                                          const RISCVSubtarget &STI)
     : TargetLowering(TM), Subtarget(&STI) {
@@ -48,6 +86,21 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &TM,
   if(Subtarget->isRV64())
     addRegisterClass(MVT::i64,  &RISCV::GPR64RegClass);
 
+  if (Subtarget->useHardFloat())
+    addRegisterClass(MVT::f32, &RISCV::FPR32RegClass);
+  if (Subtarget->useHardDouble())
+    addRegisterClass(MVT::f64, &RISCV::FPR64RegClass);
+
+  if (Subtarget->hasP()) {
+    if (Subtarget->isRV64()) {
+      addRegisterClass(MVT::v8i8, &RISCV::GPR64PRegClass);
+      addRegisterClass(MVT::v4i16, &RISCV::GPR64PRegClass);
+    } else {
+      addRegisterClass(MVT::v4i8, &RISCV::GPRPRegClass);
+      addRegisterClass(MVT::v2i16, &RISCV::GPRPRegClass);
+    }
+  }
+
   LUI = Subtarget->isRV64() ? RISCV::LUI64 : RISCV::LUI;
   ADDI = Subtarget->isRV64() ? RISCV::ADDI64 : RISCV::ADDI;
 
@@ -118,11 +171,6 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &TM,
       setOperationAction(ISD::SMUL_LOHI, VT, Expand);
       setOperationAction(ISD::UMUL_LOHI, VT, Expand);
 
-      // Expand ATOMIC_LOAD and ATOMIC_STORE using ATOMIC_CMP_SWAP.
-      // FIXME: probably much too conservative.
-      setOperationAction(ISD::ATOMIC_LOAD,  VT, Expand);
-      setOperationAction(ISD::ATOMIC_STORE, VT, Expand);
-
       // No special instructions for these.
       setOperationAction(ISD::CTPOP,           VT, Expand);
       setOperationAction(ISD::CTTZ,            VT, Expand);
@@ -133,97 +181,35 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &TM,
     }
   }
 
-  //Some Atmoic ops are legal
-  if(Subtarget->hasA()) {
-    if(Subtarget->isRV64()) {
-      //push 32 bits up to 64
-      setOperationAction(ISD::ATOMIC_SWAP,      MVT::i32, Promote);
-      setOperationAction(ISD::ATOMIC_LOAD_ADD,  MVT::i32, Promote);
-      setOperationAction(ISD::ATOMIC_LOAD_AND,  MVT::i32, Promote);
-      setOperationAction(ISD::ATOMIC_LOAD_OR,   MVT::i32, Promote);
-      setOperationAction(ISD::ATOMIC_LOAD_XOR,  MVT::i32, Promote);
-      setOperationAction(ISD::ATOMIC_LOAD_MIN,  MVT::i32, Promote);
-      setOperationAction(ISD::ATOMIC_LOAD_MAX,  MVT::i32, Promote);
-      setOperationAction(ISD::ATOMIC_LOAD_UMIN, MVT::i32, Promote);
-      setOperationAction(ISD::ATOMIC_LOAD_UMAX, MVT::i32, Promote);
-      //Legal in RV64A
-      setOperationAction(ISD::ATOMIC_SWAP,      MVT::i64, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_ADD,  MVT::i64, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_AND,  MVT::i64, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_OR,   MVT::i64, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_XOR,  MVT::i64, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_MIN,  MVT::i64, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_MAX,  MVT::i64, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_UMIN, MVT::i64, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_UMAX, MVT::i64, Legal);
-      //These are not native instructions
-      setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i32, Expand);
-      setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i32, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i32, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i64, Expand);
-    } else {
-      //Legal in RV32A
-      setOperationAction(ISD::ATOMIC_SWAP,      MVT::i32, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_ADD,  MVT::i32, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_AND,  MVT::i32, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_OR,   MVT::i32, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_XOR,  MVT::i32, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_MIN,  MVT::i32, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_MAX,  MVT::i32, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_UMIN, MVT::i32, Legal);
-      setOperationAction(ISD::ATOMIC_LOAD_UMAX, MVT::i32, Legal);
-      //Expand 64 bit into 32?
-      setOperationAction(ISD::ATOMIC_SWAP,      MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_ADD,  MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_AND,  MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_OR,   MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_XOR,  MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_MIN,  MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_MAX,  MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_UMIN, MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_UMAX, MVT::i64, Expand);
-      //These are not native instructions
-      setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i32, Expand);
-      setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i32, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i32, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i64, Expand);
+  // Without A every atomic operation becomes a __atomic_* libcall. With A,
+  // i8 and i16 operations are done on the containing word (see
+  // lowerPartwordAtomic), and AtomicExpand rewrites a word nand as a
+  // compare-and-swap loop.
+  if (Subtarget->hasA()) {
+    setMaxAtomicSizeInBitsSupported(Subtarget->isRV64() ? 64 : 32);
+    for (MVT VT : {MVT::i8, MVT::i16}) {
+      setOperationAction(ISD::ATOMIC_SWAP, VT, Custom);
+      setOperationAction(ISD::ATOMIC_LOAD_ADD, VT, Custom);
+      setOperationAction(ISD::ATOMIC_LOAD_SUB, VT, Custom);
+      setOperationAction(ISD::ATOMIC_LOAD_AND, VT, Custom);
+      setOperationAction(ISD::ATOMIC_LOAD_OR, VT, Custom);
+      setOperationAction(ISD::ATOMIC_LOAD_XOR, VT, Custom);
+      setOperationAction(ISD::ATOMIC_LOAD_NAND, VT, Custom);
+      setOperationAction(ISD::ATOMIC_LOAD_MIN, VT, Custom);
+      setOperationAction(ISD::ATOMIC_LOAD_MAX, VT, Custom);
+      setOperationAction(ISD::ATOMIC_LOAD_UMIN, VT, Custom);
+      setOperationAction(ISD::ATOMIC_LOAD_UMAX, VT, Custom);
+      setOperationAction(ISD::ATOMIC_CMP_SWAP_WITH_SUCCESS, VT, Custom);
     }
   } else {
-    //No atomic ops so expand all
-    setOperationAction(ISD::ATOMIC_SWAP,      MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_ADD,  MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_AND,  MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_OR,   MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_XOR,  MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_MIN,  MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_MAX,  MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_UMIN, MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_UMAX, MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_SWAP,      MVT::i64, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_ADD,  MVT::i64, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_AND,  MVT::i64, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_OR,   MVT::i64, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_XOR,  MVT::i64, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_MIN,  MVT::i64, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_MAX,  MVT::i64, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_UMIN, MVT::i64, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_UMAX, MVT::i64, Expand);
-    setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i64, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i32, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i64, Expand);
-    setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i64, Expand);
+    setMaxAtomicSizeInBitsSupported(0);
   }
 
   // TODO: add all necessary setOperationAction calls
 
   setOperationAction(ISD::JumpTable, PtrVT, Custom);
-  setOperationAction(ISD::BR_JT, MVT::Other, Expand);
+  setOperationAction(ISD::BR_JT, MVT::Other,
+                     useCompactJumpTables() ? Custom : Expand);
 
   setOperationAction(ISD::ROTR, MVT::i32, Expand);
   setOperationAction(ISD::ROTL, MVT::i32, Expand);
@@ -257,20 +243,132 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &TM,
   setOperationAction(ISD::BSWAP,            MVT::i32,   Expand);
   setOperationAction(ISD::BSWAP,            MVT::i64,   Expand);
 
+  // B has single instructions for the bit counts, rotates, byte swap,
+  // min/max and the byte and halfword sign extensions. Without it, swap
+  // bytes with fewer masks than the generic expansion and, without M,
+  // finish the population count with shifts instead of a multiply libcall.
+  for (MVT VT : {MVT::i32, MVT::i64}) {
+    if (!isTypeLegal(VT))
+      continue;
+
+    if (Subtarget->hasB()) {
+      for (unsigned Opc : {ISD::CTPOP, ISD::CTLZ, ISD::CTTZ, ISD::ROTL,
+                           ISD::ROTR, ISD::BSWAP, ISD::SMIN, ISD::SMAX,
+                           ISD::UMIN, ISD::UMAX})
+        setOperationAction(Opc, VT, Legal);
+    } else {
+      setOperationAction(ISD::BSWAP, VT, Custom);
+      if (!Subtarget->hasM())
+        setOperationAction(ISD::CTPOP, VT, Custom);
+    }
+  }
+  if (Subtarget->hasB()) {
+    setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i8, Legal);
+    setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i16, Legal);
+  }
+
   setOperationAction(ISD::GlobalAddress, PtrVT, Custom);
   setOperationAction(ISD::BlockAddress,  PtrVT, Custom);
+  setOperationAction(ISD::GlobalTLSAddress, PtrVT, Custom);
   setOperationAction(ISD::ConstantPool,  PtrVT, Custom);
 
+  // Handle floating-point types held in FPRs.
+  for (MVT VT : {MVT::f32, MVT::f64}) {
+    if (!isTypeLegal(VT))
+      continue;
+
+    // Only ordered/unordered eq, lt and le have instructions; the rest are
+    // expanded in terms of those by swapping operands or inverting.
+    for (ISD::CondCode CC : {ISD::SETGT, ISD::SETGE, ISD::SETOGT, ISD::SETOGE,
+                             ISD::SETONE, ISD::SETUEQ, ISD::SETUGT,
+                             ISD::SETUGE, ISD::SETULT, ISD::SETULE})
+      setCondCodeAction(CC, VT, Expand);
+
+    setOperationAction(ISD::BR_CC,     VT, Expand);
+    setOperationAction(ISD::SELECT,    VT, Expand);
+    setOperationAction(ISD::SELECT_CC, VT, Custom);
+
+    // fmin and fmax return the other operand when one is a NaN.
+    setOperationAction(ISD::FMINNUM, VT, Legal);
+    setOperationAction(ISD::FMAXNUM, VT, Legal);
+
+    // No special instructions for these.
+    setOperationAction(ISD::FREM,       VT, Expand);
+    setOperationAction(ISD::FSIN,       VT, Expand);
+    setOperationAction(ISD::FCOS,       VT, Expand);
+    setOperationAction(ISD::FSINCOS,    VT, Expand);
+    setOperationAction(ISD::FPOW,       VT, Expand);
+    setOperationAction(ISD::FP16_TO_FP, VT, Expand);
+    setOperationAction(ISD::FP_TO_FP16, VT, Expand);
+
+    setLoadExtAction(ISD::EXTLOAD, VT, MVT::f16, Expand);
+    setTruncStoreAction(VT, MVT::f16, Expand);
+  }
+  if (isTypeLegal(MVT::f64)) {
+    setLoadExtAction(ISD::EXTLOAD, MVT::f64, MVT::f32, Expand);
+    setTruncStoreAction(MVT::f64, MVT::f32, Expand);
+  }
+
+  // Handle packed-SIMD types held in GPRs. Only the lane-wise arithmetic,
+  // compares and shifts have instructions; bitwise operations, loads, stores
+  // and selects work on the whole register, and the rest is done lane by lane.
+  for (MVT VT : {MVT::v4i8, MVT::v2i16, MVT::v8i8, MVT::v4i16}) {
+    if (!isTypeLegal(VT))
+      continue;
+
+    for (unsigned Opc = 0; Opc < ISD::BUILTIN_OP_END; ++Opc)
+      setOperationAction(Opc, VT, Expand);
+
+    for (unsigned Opc : {ISD::UNDEF, ISD::BITCAST, ISD::ADD, ISD::SUB,
+                         ISD::SMIN, ISD::SMAX, ISD::UMIN, ISD::UMAX,
+                         ISD::SETCC})
+      setOperationAction(Opc, VT, Legal);
+
+    for (unsigned Opc : {ISD::AND, ISD::OR, ISD::XOR, ISD::LOAD, ISD::STORE,
+                         ISD::SELECT}) {
+      setOperationAction(Opc, VT, Promote);
+      AddPromotedToType(Opc, VT, PtrVT);
+    }
+
+    for (unsigned Opc : {ISD::BUILD_VECTOR, ISD::EXTRACT_VECTOR_ELT,
+                         ISD::VECTOR_SHUFFLE, ISD::SHL, ISD::SRL, ISD::SRA})
+      setOperationAction(Opc, VT, Custom);
+
+    for (ISD::CondCode CC : {ISD::SETNE, ISD::SETGT, ISD::SETGE, ISD::SETUGT,
+                             ISD::SETUGE})
+      setCondCodeAction(CC, VT, Expand);
+
+    for (MVT InnerVT : MVT::integer_vector_valuetypes()) {
+      setTruncStoreAction(VT, InnerVT, Expand);
+      setLoadExtAction(ISD::SEXTLOAD, VT, InnerVT, Expand);
+      setLoadExtAction(ISD::ZEXTLOAD, VT, InnerVT, Expand);
+      setLoadExtAction(ISD::EXTLOAD, VT, InnerVT, Expand);
+    }
+  }
+
+  // Without M, multiplications and divisions by constants are rewritten into
+  // shifts and adds before they can be expanded into libcalls.
+  if (!Subtarget->hasM()) {
+    setTargetDAGCombine(ISD::MUL);
+    setTargetDAGCombine(ISD::SDIV);
+    setTargetDAGCombine(ISD::UDIV);
+  }
+
   setBooleanContents(ZeroOrOneBooleanContent);
+  setBooleanVectorContents(ZeroOrNegativeOneBooleanContent);
 
   // Function alignments (log2)
   setMinFunctionAlignment(Subtarget->hasC() ? 1 : 2);
   setPrefFunctionAlignment(2);
 
-  // inline memcpy() for kernel to see explicit copy
-  MaxStoresPerMemset = MaxStoresPerMemsetOptSize = 128;
-  MaxStoresPerMemcpy = MaxStoresPerMemcpyOptSize = 128;
-  MaxStoresPerMemmove = MaxStoresPerMemmoveOptSize = 128;
+  // Unroll short memory operations into loads and stores. Longer ones are
+  // left to RISCVSelectionDAGInfo, which emits a word loop or a libcall.
+  MaxStoresPerMemset = 16;
+  MaxStoresPerMemsetOptSize = 8;
+  MaxStoresPerMemcpy = 8;
+  MaxStoresPerMemcpyOptSize = 4;
+  MaxStoresPerMemmove = 8;
+  MaxStoresPerMemmoveOptSize = 4;
 }
 
 void
@@ -278,6 +376,8 @@ RISCVTargetLowering::LowerOperationWrapper(SDNode *N,
                                            SmallVectorImpl<SDValue> &Results,
                                            SelectionDAG &DAG) const {
   SDValue Res = LowerOperation(SDValue(N, 0), DAG);
+  if (!Res.getNode())
+    return;
 
   for (unsigned I = 0, E = Res->getNumValues(); I != E; ++I)
     Results.push_back(Res.getValue(I));
@@ -294,10 +394,14 @@ SDValue RISCVTargetLowering::LowerOperation(SDValue Op, SelectionDAG &DAG) const
   switch (Op.getOpcode()) {
   case ISD::GlobalAddress:
     return lowerGlobalAddress(Op, DAG);
+  case ISD::GlobalTLSAddress:
+    return lowerGlobalTLSAddress(Op, DAG);
   case ISD::BlockAddress:
     return lowerBlockAddress(Op, DAG);
   case ISD::JumpTable:
     return lowerJumpTable(Op, DAG);
+  case ISD::BR_JT:
+    return lowerBR_JT(Op, DAG);
   case ISD::SELECT_CC:
     return lowerSELECT_CC(Op, DAG);
   case ISD::VASTART:
@@ -311,11 +415,78 @@ SDValue RISCVTargetLowering::LowerOperation(SDValue Op, SelectionDAG &DAG) const
   case ISD::UMULO:
   case ISD::SMULO:
     return lowerUMULO_SMULO(Op, DAG);
+  case ISD::BUILD_VECTOR:
+    return lowerBUILD_VECTOR(Op, DAG);
+  case ISD::EXTRACT_VECTOR_ELT:
+    return lowerEXTRACT_VECTOR_ELT(Op, DAG);
+  case ISD::SHL:
+  case ISD::SRL:
+  case ISD::SRA:
+    return lowerVectorShift(Op, DAG);
+  case ISD::VECTOR_SHUFFLE:
+    return lowerVECTOR_SHUFFLE(Op, DAG);
+  case ISD::BSWAP:
+    return lowerBSWAP(Op, DAG);
+  case ISD::CTPOP:
+    return lowerCTPOP(Op, DAG);
+  case ISD::ATOMIC_SWAP:
+  case ISD::ATOMIC_LOAD_ADD:
+  case ISD::ATOMIC_LOAD_SUB:
+  case ISD::ATOMIC_LOAD_AND:
+  case ISD::ATOMIC_LOAD_OR:
+  case ISD::ATOMIC_LOAD_XOR:
+  case ISD::ATOMIC_LOAD_NAND:
+  case ISD::ATOMIC_LOAD_MIN:
+  case ISD::ATOMIC_LOAD_MAX:
+  case ISD::ATOMIC_LOAD_UMIN:
+  case ISD::ATOMIC_LOAD_UMAX:
+  case ISD::ATOMIC_CMP_SWAP_WITH_SUCCESS:
+    return lowerPartwordAtomic(Op, DAG);
   default:
     report_fatal_error("unimplemented operand");
   }
 }
 
+// Addresses are PC-relative when generating position-independent code or
+// when the code model (medany) allows the program to be linked anywhere in
+// the address space.
+bool RISCVTargetLowering::usePCRelAddressing() const {
+  return isPositionIndependent() ||
+         getTargetMachine().getCodeModel() == CodeModel::Medium;
+}
+
+// Describe the load done by a GOT-loading pseudo. GOT entries don't change
+// once the program is loaded.
+static void addGOTMemOperand(MachineSDNode *Load, EVT Ty, SelectionDAG &DAG) {
+  MachineFunction &MF = DAG.getMachineFunction();
+  MachineMemOperand *MemOp = MF.getMachineMemOperand(
+      MachinePointerInfo::getGOT(MF),
+      MachineMemOperand::MOLoad | MachineMemOperand::MODereferenceable |
+          MachineMemOperand::MOInvariant,
+      Ty.getStoreSize(), Ty.getStoreSize());
+  MachineSDNode::mmo_iterator MemRefs = MF.allocateMemRefsArray(1);
+  MemRefs[0] = MemOp;
+  Load->setMemRefs(MemRefs, MemRefs + 1);
+}
+
+// Materialise the address of Addr relative to the PC. A symbol that may be
+// preempted is loaded from the GOT instead.
+SDValue RISCVTargetLowering::getPCRelAddr(SDValue Addr, const SDLoc &DL,
+                                          EVT Ty, SelectionDAG &DAG,
+                                          bool IsLocal) const {
+  bool IsRV64 = Subtarget->isRV64();
+  if (IsLocal)
+    return SDValue(DAG.getMachineNode(IsRV64 ? RISCV::PseudoLLA64
+                                             : RISCV::PseudoLLA,
+                                      DL, Ty, Addr),
+                   0);
+
+  MachineSDNode *Load = DAG.getMachineNode(
+      IsRV64 ? RISCV::PseudoLA64 : RISCV::PseudoLA, DL, Ty, Addr);
+  addGOTMemOperand(Load, Ty, DAG);
+  return SDValue(Load, 0);
+}
+
 SDValue RISCVTargetLowering::lowerGlobalAddress(SDValue Op,
                                                 SelectionDAG &DAG) const {
   SDLoc DL(Op);
@@ -324,18 +495,163 @@ SDValue RISCVTargetLowering::lowerGlobalAddress(SDValue Op,
   const GlobalValue *GV = N->getGlobal();
   int64_t Offset = N->getOffset();
 
-//  if (!isPositionIndependent()) {
-    SDValue GAHi =
-        DAG.getTargetGlobalAddress(GV, DL, Ty, Offset, RISCVII::MO_HI);
-    SDValue GALo =
-        DAG.getTargetGlobalAddress(GV, DL, Ty, Offset, RISCVII::MO_LO);
-    SDValue MNHi = SDValue(DAG.getMachineNode(LUI, DL, Ty, GAHi), 0);
-    SDValue MNLo =
-        SDValue(DAG.getMachineNode(ADDI, DL, Ty, MNHi, GALo), 0);
-    return MNLo;
-//  } else {
-//    llvm_unreachable("Unable to lowerGlobalAddress");
-//  }
+  // Small data is addressed with a single instruction relative to gp. The
+  // offset is folded into the relocation only while it stays inside the
+  // object, so that the linker is still able to reach it from gp.
+  const auto &TLOF = static_cast<const RISCVELFTargetObjectFile &>(
+      *getTargetMachine().getObjFileLowering());
+  const GlobalObject *GO = dyn_cast<GlobalObject>(GV);
+  if (GO && TLOF.isGlobalInSmallSection(GO, getTargetMachine())) {
+    uint64_t Size = DAG.getDataLayout().getTypeAllocSize(GO->getValueType());
+    bool FoldOffset = Offset >= 0 && (uint64_t)Offset < Size;
+    SDValue GPReg =
+        DAG.getRegister(Subtarget->isRV64() ? RISCV::X3_64 : RISCV::X3_32, Ty);
+    SDValue GARel = DAG.getTargetGlobalAddress(GV, DL, Ty,
+                                               FoldOffset ? Offset : 0,
+                                               RISCVII::MO_GPREL);
+    // AndeStar V5 has an addigp that reaches further and implies gp.
+    SDValue Addr;
+    if (Subtarget->hasXV5())
+      Addr = SDValue(DAG.getMachineNode(Subtarget->isRV64() ? RISCV::ADDIGP64
+                                                            : RISCV::ADDIGP,
+                                        DL, Ty, GARel),
+                     0);
+    else
+      Addr = SDValue(DAG.getMachineNode(ADDI, DL, Ty, GPReg, GARel), 0);
+    if (!FoldOffset && Offset != 0)
+      Addr = DAG.getNode(ISD::ADD, DL, Ty, Addr,
+                         DAG.getConstant(Offset, DL, Ty));
+    return Addr;
+  }
+
+  if (usePCRelAddressing()) {
+    if (getTargetMachine().shouldAssumeDSOLocal(*GV->getParent(), GV))
+      return getPCRelAddr(DAG.getTargetGlobalAddress(GV, DL, Ty, Offset), DL,
+                          Ty, DAG, /*IsLocal=*/true);
+
+    // The GOT entry holds the address of the symbol itself, so the offset is
+    // added afterwards.
+    SDValue Addr = getPCRelAddr(DAG.getTargetGlobalAddress(GV, DL, Ty, 0), DL,
+                                Ty, DAG, /*IsLocal=*/false);
+    if (Offset != 0)
+      Addr = DAG.getNode(ISD::ADD, DL, Ty, Addr,
+                         DAG.getConstant(Offset, DL, Ty));
+    return Addr;
+  }
+
+  // Emit the offset as a separate add so that every access to the object
+  // shares one lui. The selector folds it back into the %lo part where that
+  // is safe.
+  SDValue GAHi = DAG.getTargetGlobalAddress(GV, DL, Ty, 0, RISCVII::MO_HI);
+  SDValue GALo = DAG.getTargetGlobalAddress(GV, DL, Ty, 0, RISCVII::MO_LO);
+  SDValue MNHi = SDValue(DAG.getMachineNode(LUI, DL, Ty, GAHi), 0);
+  SDValue MNLo =
+      SDValue(DAG.getMachineNode(ADDI, DL, Ty, MNHi, GALo), 0);
+  if (Offset != 0)
+    return DAG.getNode(ISD::ADD, DL, Ty, MNLo,
+                       DAG.getConstant(Offset, DL, Ty));
+  return MNLo;
+}
+
+// Local-exec and initial-exec TLS: the variable is at a fixed offset from the
+// thread pointer, either known at link time or loaded from the GOT.
+SDValue RISCVTargetLowering::getStaticTLSAddr(GlobalAddressSDNode *N,
+                                              SelectionDAG &DAG,
+                                              bool UseGOT) const {
+  SDLoc DL(N);
+  EVT Ty = getPointerTy(DAG.getDataLayout());
+  const GlobalValue *GV = N->getGlobal();
+  bool IsRV64 = Subtarget->isRV64();
+  SDValue TPReg = DAG.getRegister(IsRV64 ? RISCV::X4_64 : RISCV::X4_32, Ty);
+
+  if (UseGOT) {
+    // la.tls.ie followed by an add of tp.
+    SDValue Addr = DAG.getTargetGlobalAddress(GV, DL, Ty, 0, 0);
+    MachineSDNode *Load = DAG.getMachineNode(
+        IsRV64 ? RISCV::PseudoLA_TLS_IE64 : RISCV::PseudoLA_TLS_IE, DL, Ty,
+        Addr);
+    addGOTMemOperand(Load, Ty, DAG);
+    return DAG.getNode(ISD::ADD, DL, Ty, SDValue(Load, 0), TPReg);
+  }
+
+  // lui %tprel_hi, add tp with %tprel_add, then addi %tprel_lo.
+  SDValue AddrHi =
+      DAG.getTargetGlobalAddress(GV, DL, Ty, 0, RISCVII::MO_TPREL_HI);
+  SDValue AddrAdd =
+      DAG.getTargetGlobalAddress(GV, DL, Ty, 0, RISCVII::MO_TPREL_ADD);
+  SDValue AddrLo =
+      DAG.getTargetGlobalAddress(GV, DL, Ty, 0, RISCVII::MO_TPREL_LO);
+
+  SDValue MNHi = SDValue(DAG.getMachineNode(LUI, DL, Ty, AddrHi), 0);
+  SDValue MNAdd = SDValue(
+      DAG.getMachineNode(IsRV64 ? RISCV::PseudoAddTPRel64
+                                : RISCV::PseudoAddTPRel,
+                         DL, Ty, MNHi, TPReg, AddrAdd),
+      0);
+  return SDValue(DAG.getMachineNode(ADDI, DL, Ty, MNAdd, AddrLo), 0);
+}
+
+// General-dynamic and local-dynamic TLS: ask __tls_get_addr for the address
+// of the variable in the calling thread.
+SDValue RISCVTargetLowering::getDynamicTLSAddr(GlobalAddressSDNode *N,
+                                               SelectionDAG &DAG) const {
+  SDLoc DL(N);
+  EVT Ty = getPointerTy(DAG.getDataLayout());
+  IntegerType *CallTy = Type::getIntNTy(*DAG.getContext(), Ty.getSizeInBits());
+  const GlobalValue *GV = N->getGlobal();
+
+  // la.tls.gd computes the address of the GOT entry pair for the variable.
+  SDValue Addr = DAG.getTargetGlobalAddress(GV, DL, Ty, 0, 0);
+  SDValue Load = SDValue(
+      DAG.getMachineNode(Subtarget->isRV64() ? RISCV::PseudoLA_TLS_GD64
+                                             : RISCV::PseudoLA_TLS_GD,
+                         DL, Ty, Addr),
+      0);
+
+  ArgListTy Args;
+  ArgListEntry Entry;
+  Entry.Node = Load;
+  Entry.Ty = CallTy;
+  Args.push_back(Entry);
+
+  TargetLowering::CallLoweringInfo CLI(DAG);
+  CLI.setDebugLoc(DL)
+      .setChain(DAG.getEntryNode())
+      .setCallee(CallingConv::C, CallTy,
+                 DAG.getExternalSymbol("__tls_get_addr", Ty),
+                 std::move(Args));
+
+  return LowerCallTo(CLI).first;
+}
+
+SDValue RISCVTargetLowering::lowerGlobalTLSAddress(SDValue Op,
+                                                   SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT Ty = Op.getValueType();
+  GlobalAddressSDNode *N = cast<GlobalAddressSDNode>(Op);
+  int64_t Offset = N->getOffset();
+
+  SDValue Addr;
+  switch (getTargetMachine().getTLSModel(N->getGlobal())) {
+  case TLSModel::LocalExec:
+    Addr = getStaticTLSAddr(N, DAG, /*UseGOT=*/false);
+    break;
+  case TLSModel::InitialExec:
+    Addr = getStaticTLSAddr(N, DAG, /*UseGOT=*/true);
+    break;
+  case TLSModel::LocalDynamic:
+  case TLSModel::GeneralDynamic:
+    Addr = getDynamicTLSAddr(N, DAG);
+    break;
+  }
+
+  // The relocations describe the variable itself, so the offset is added
+  // afterwards.
+  if (Offset != 0)
+    return DAG.getNode(ISD::ADD, DL, Ty, Addr,
+                       DAG.getConstant(Offset, DL, Ty));
+
+  return Addr;
 }
 
 SDValue RISCVTargetLowering::lowerBlockAddress(SDValue Op,
@@ -345,18 +661,18 @@ SDValue RISCVTargetLowering::lowerBlockAddress(SDValue Op,
   BlockAddressSDNode *BASDN = cast<BlockAddressSDNode>(Op);
   const BlockAddress *BA = BASDN->getBlockAddress();
 
-//  if (!isPositionIndependent()) {
-    SDValue BAHi =
-        DAG.getTargetBlockAddress(BA, Ty, 0, RISCVII::MO_HI);
-    SDValue BALo =
-        DAG.getTargetBlockAddress(BA, Ty, 0, RISCVII::MO_LO);
-    SDValue MNHi = SDValue(DAG.getMachineNode(LUI, DL, Ty, BAHi), 0);
-    SDValue MNLo =
-        SDValue(DAG.getMachineNode(ADDI, DL, Ty, MNHi, BALo), 0);
-    return MNLo;
-//  } else {
-//    llvm_unreachable("Unable to lowerBlockAddress");
-//  }
+  if (usePCRelAddressing())
+    return getPCRelAddr(DAG.getTargetBlockAddress(BA, Ty), DL, Ty, DAG,
+                        /*IsLocal=*/true);
+
+  SDValue BAHi =
+      DAG.getTargetBlockAddress(BA, Ty, 0, RISCVII::MO_HI);
+  SDValue BALo =
+      DAG.getTargetBlockAddress(BA, Ty, 0, RISCVII::MO_LO);
+  SDValue MNHi = SDValue(DAG.getMachineNode(LUI, DL, Ty, BAHi), 0);
+  SDValue MNLo =
+      SDValue(DAG.getMachineNode(ADDI, DL, Ty, MNHi, BALo), 0);
+  return MNLo;
 }
 
 SDValue RISCVTargetLowering::lowerExternalSymbol(SDValue Op,
@@ -368,16 +684,49 @@ SDValue RISCVTargetLowering::lowerExternalSymbol(SDValue Op,
 
   // TODO: should also handle gp-relative loads
 
-//  if (!isPositionIndependent()) {
-    SDValue GAHi = DAG.getTargetExternalSymbol(Sym, Ty, RISCVII::MO_HI);
-    SDValue GALo = DAG.getTargetExternalSymbol(Sym, Ty, RISCVII::MO_LO);
-    SDValue MNHi = SDValue(DAG.getMachineNode(LUI, DL, Ty, GAHi), 0);
-    SDValue MNLo =
-        SDValue(DAG.getMachineNode(ADDI, DL, Ty, MNHi, GALo), 0);
-    return MNLo;
-//  } else {
-//    llvm_unreachable("Unable to lowerExternalSymbol");
-//  }
+  if (usePCRelAddressing()) {
+    const Module *M = DAG.getMachineFunction().getFunction()->getParent();
+    return getPCRelAddr(DAG.getTargetExternalSymbol(Sym, Ty), DL, Ty, DAG,
+                        getTargetMachine().shouldAssumeDSOLocal(*M, nullptr));
+  }
+
+  SDValue GAHi = DAG.getTargetExternalSymbol(Sym, Ty, RISCVII::MO_HI);
+  SDValue GALo = DAG.getTargetExternalSymbol(Sym, Ty, RISCVII::MO_LO);
+  SDValue MNHi = SDValue(DAG.getMachineNode(LUI, DL, Ty, GAHi), 0);
+  SDValue MNLo =
+      SDValue(DAG.getMachineNode(ADDI, DL, Ty, MNHi, GALo), 0);
+  return MNLo;
+}
+
+// Compact jump table entries are differences between code labels, which the
+// assembler can only fold while linker relaxation cannot move the labels.
+bool RISCVTargetLowering::useCompactJumpTables() const {
+  return EnableCompactJumpTables && !Subtarget->enableLinkerRelax();
+}
+
+unsigned RISCVTargetLowering::getJumpTableEncoding() const {
+  if (useCompactJumpTables())
+    return MachineJumpTableInfo::EK_Custom32;
+  return TargetLowering::getJumpTableEncoding();
+}
+
+// Dispatch through a compact jump table. The entry is read and added to the
+// table's base block by PseudoJumpTableDest, whose entry size is only known
+// once the function has been laid out.
+SDValue RISCVTargetLowering::lowerBR_JT(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue Chain = Op.getOperand(0);
+  SDValue JT = Op.getOperand(1);
+  SDValue Entry = Op.getOperand(2);
+  EVT Ty = JT.getValueType();
+  int JTI = cast<JumpTableSDNode>(JT)->getIndex();
+
+  SDNode *Dest = DAG.getMachineNode(
+      Subtarget->isRV64() ? RISCV::PseudoJumpTableDest64
+                          : RISCV::PseudoJumpTableDest,
+      DL, Ty, Ty, lowerJumpTable(JT, DAG), Entry,
+      DAG.getTargetJumpTable(JTI, MVT::i32));
+  return DAG.getNode(ISD::BRIND, DL, MVT::Other, Chain, SDValue(Dest, 0));
 }
 
 SDValue RISCVTargetLowering::lowerJumpTable(SDValue Op,
@@ -386,18 +735,18 @@ SDValue RISCVTargetLowering::lowerJumpTable(SDValue Op,
   EVT Ty = Op.getValueType();
   JumpTableSDNode *N = cast<JumpTableSDNode>(Op);
 
-//  if (!isPositionIndependent()) {
-    SDValue GAHi =
-        DAG.getTargetJumpTable(N->getIndex(), Ty, RISCVII::MO_HI);
-    SDValue GALo =
-        DAG.getTargetJumpTable(N->getIndex(), Ty, RISCVII::MO_LO);
-    SDValue MNHi = SDValue(DAG.getMachineNode(LUI, DL, Ty, GAHi), 0);
-    SDValue MNLo =
-        SDValue(DAG.getMachineNode(ADDI, DL, Ty, MNHi, GALo), 0);
-    return MNLo;
-//  } else {
-//    llvm_unreachable("Unable to lowerGlobalAddress");
-//  }
+  if (usePCRelAddressing())
+    return getPCRelAddr(DAG.getTargetJumpTable(N->getIndex(), Ty), DL, Ty,
+                        DAG, /*IsLocal=*/true);
+
+  SDValue GAHi =
+      DAG.getTargetJumpTable(N->getIndex(), Ty, RISCVII::MO_HI);
+  SDValue GALo =
+      DAG.getTargetJumpTable(N->getIndex(), Ty, RISCVII::MO_LO);
+  SDValue MNHi = SDValue(DAG.getMachineNode(LUI, DL, Ty, GAHi), 0);
+  SDValue MNLo =
+      SDValue(DAG.getMachineNode(ADDI, DL, Ty, MNHi, GALo), 0);
+  return MNLo;
 }
 
 SDValue RISCVTargetLowering::lowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const {
@@ -408,6 +757,15 @@ SDValue RISCVTargetLowering::lowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const
   ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(4))->get();
   SDLoc DL(Op);
 
+  // The Select_FPR pseudos branch on a GPR comparison. Materialize a
+  // floating-point comparison with setcc and branch on its result.
+  if (LHS.getValueType().isFloatingPoint() ||
+      (Op.getValueType().isFloatingPoint() && LHS.getValueType() != MVT::i32)) {
+    LHS = DAG.getSetCC(DL, MVT::i32, LHS, RHS, CC);
+    RHS = DAG.getConstant(0, DL, MVT::i32);
+    CC = ISD::SETNE;
+  }
+
   switch (CC) {
   default:
     break;
@@ -420,6 +778,12 @@ SDValue RISCVTargetLowering::lowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const
     break;
   }
 
+  // Compare against x0 rather than a register set to zero.
+  if (isNullConstant(RHS))
+    RHS = DAG.getRegister(RHS.getValueType() == MVT::i64 ? RISCV::X0_64
+                                                         : RISCV::X0_32,
+                          RHS.getValueType());
+
   SDValue TargetCC = DAG.getConstant(CC, DL, MVT::i32);
 
   SDVTList VTs = DAG.getVTList(Op.getValueType(), MVT::Glue);
@@ -509,22 +873,23 @@ SDValue RISCVTargetLowering::LowerConstantPool(SDValue Op,
   ConstantPoolSDNode *N = cast<ConstantPoolSDNode>(Op);
   const Constant *C = N->getConstVal();
 
-//  if (!isPositionIndependent()) {
-    uint8_t OpFlagHi = RISCVII::MO_HI;
-    uint8_t OpFlagLo = RISCVII::MO_LO;
+  if (usePCRelAddressing())
+    return getPCRelAddr(DAG.getTargetConstantPool(C, Ty, N->getAlignment(),
+                                                  N->getOffset()),
+                        DL, Ty, DAG, /*IsLocal=*/true);
 
-    SDValue Hi = DAG.getTargetConstantPool(C, MVT::i32, N->getAlignment(),
-                                           N->getOffset(), OpFlagHi);
-    SDValue Lo = DAG.getTargetConstantPool(C, MVT::i32, N->getAlignment(),
-                                           N->getOffset(), OpFlagLo);
+  uint8_t OpFlagHi = RISCVII::MO_HI;
+  uint8_t OpFlagLo = RISCVII::MO_LO;
 
-    SDValue MNHi = SDValue(DAG.getMachineNode(LUI, DL, Ty, Hi), 0);
-    SDValue MNLo =
-        SDValue(DAG.getMachineNode(ADDI, DL, Ty, MNHi, Lo), 0);
-    return MNLo;
-//  } else {
-//    llvm_unreachable("Unable to LowerConstantPool");
-//  }
+  SDValue Hi = DAG.getTargetConstantPool(C, MVT::i32, N->getAlignment(),
+                                         N->getOffset(), OpFlagHi);
+  SDValue Lo = DAG.getTargetConstantPool(C, MVT::i32, N->getAlignment(),
+                                         N->getOffset(), OpFlagLo);
+
+  SDValue MNHi = SDValue(DAG.getMachineNode(LUI, DL, Ty, Hi), 0);
+  SDValue MNLo =
+      SDValue(DAG.getMachineNode(ADDI, DL, Ty, MNHi, Lo), 0);
+  return MNLo;
 }
 
 // Custom lower UMULO/SMULO to pass the test case 
@@ -588,42 +953,700 @@ SDValue RISCVTargetLowering::lowerUMULO_SMULO(SDValue Op,
   return DAG.getMergeValues(Ops, dl);
 }
 
+// Constant packed-SIMD vectors are materialised as an integer, and a v2i16
+// built from two halfwords is a single pkbb16. Anything else goes through
+// the stack.
+SDValue RISCVTargetLowering::lowerBUILD_VECTOR(SDValue Op,
+                                               SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  MVT XLenVT = Subtarget->isRV64() ? MVT::i64 : MVT::i32;
+  unsigned EltBits = VT.getScalarSizeInBits();
+
+  if (ISD::isBuildVectorOfConstantSDNodes(Op.getNode())) {
+    APInt Packed(VT.getSizeInBits(), 0);
+    for (unsigned I = 0, E = Op.getNumOperands(); I != E; ++I) {
+      SDValue Elt = Op.getOperand(I);
+      if (Elt.isUndef())
+        continue;
+      APInt Val = cast<ConstantSDNode>(Elt)->getAPIntValue().trunc(EltBits);
+      Packed |= Val.zext(VT.getSizeInBits()).shl(I * EltBits);
+    }
+    return DAG.getBitcast(VT, DAG.getConstant(Packed, DL, XLenVT));
+  }
+
+  if (VT == MVT::v2i16) {
+    SDValue Lo = DAG.getBitcast(VT, Op.getOperand(0));
+    SDValue Hi = DAG.getBitcast(VT, Op.getOperand(1));
+    return SDValue(DAG.getMachineNode(RISCV::PKBB16, DL, VT, Hi, Lo), 0);
+  }
+
+  return SDValue();
+}
+
+// Extract a lane by shifting it down to the bottom of the register.
+SDValue RISCVTargetLowering::lowerEXTRACT_VECTOR_ELT(SDValue Op,
+                                                     SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue Vec = Op.getOperand(0);
+  SDValue Idx = Op.getOperand(1);
+  EVT VT = Vec.getValueType();
+  MVT XLenVT = Subtarget->isRV64() ? MVT::i64 : MVT::i32;
+  EVT ShiftTy = getShiftAmountTy(XLenVT, DAG.getDataLayout());
+  unsigned EltBits = VT.getScalarSizeInBits();
+
+  SDValue Amt = DAG.getNode(ISD::SHL, DL, XLenVT,
+                            DAG.getZExtOrTrunc(Idx, DL, XLenVT),
+                            DAG.getConstant(Log2_32(EltBits), DL, ShiftTy));
+  SDValue Res = DAG.getNode(ISD::SRL, DL, XLenVT, DAG.getBitcast(XLenVT, Vec),
+                            DAG.getZExtOrTrunc(Amt, DL, ShiftTy));
+  return DAG.getAnyExtOrTrunc(Res, DL, Op.getValueType());
+}
+
+// The packed shifts take a single amount for every lane; shifts by anything
+// but a splat are done lane by lane.
+SDValue RISCVTargetLowering::lowerVectorShift(SDValue Op,
+                                              SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  MVT XLenVT = Subtarget->isRV64() ? MVT::i64 : MVT::i32;
+
+  auto *BV = dyn_cast<BuildVectorSDNode>(Op.getOperand(1));
+  if (!BV)
+    return SDValue();
+  SDValue Amt = BV->getSplatValue();
+  if (!Amt.getNode())
+    return SDValue();
+
+  unsigned Opc;
+  switch (Op.getOpcode()) {
+  default:
+    llvm_unreachable("Unexpected shift opcode");
+  case ISD::SHL:
+    Opc = RISCVISD::VSHL;
+    break;
+  case ISD::SRL:
+    Opc = RISCVISD::VSRL;
+    break;
+  case ISD::SRA:
+    Opc = RISCVISD::VSRA;
+    break;
+  }
+
+  if (auto *C = dyn_cast<ConstantSDNode>(Amt))
+    Amt = DAG.getConstant(C->getZExtValue(), DL, XLenVT);
+  else
+    Amt = DAG.getZExtOrTrunc(Amt, DL, XLenVT);
+  return DAG.getNode(Opc, DL, VT, Op.getOperand(0), Amt);
+}
+
+bool RISCVTargetLowering::isShuffleMaskLegal(const SmallVectorImpl<int> &Mask,
+                                             EVT VT) const {
+  return VT == MVT::v2i16 && isTypeLegal(VT);
+}
+
+// pk<x><y>16 puts halfword x of rs1 in the top lane and halfword y of rs2 in
+// the bottom lane, which covers every two-lane shuffle.
+SDValue RISCVTargetLowering::lowerVECTOR_SHUFFLE(SDValue Op,
+                                                 SelectionDAG &DAG) const {
+  EVT VT = Op.getValueType();
+  if (VT != MVT::v2i16)
+    return SDValue();
+
+  auto *SVN = cast<ShuffleVectorSDNode>(Op);
+  int Lo = std::max(SVN->getMaskElt(0), 0);
+  int Hi = std::max(SVN->getMaskElt(1), 0);
+  SDValue Top = Op.getOperand(Hi / 2);
+  SDValue Bottom = Op.getOperand(Lo / 2);
+
+  static const unsigned PackOpcodes[2][2] = {
+      {RISCV::PKBB16, RISCV::PKBT16}, {RISCV::PKTB16, RISCV::PKTT16}};
+  unsigned Opc = PackOpcodes[Hi % 2][Lo % 2];
+  return SDValue(DAG.getMachineNode(Opc, SDLoc(Op), VT, Top, Bottom), 0);
+}
+
+// With B the zero check in front of a count is more expensive than the count.
+bool RISCVTargetLowering::isCheapToSpeculateCttz() const {
+  return Subtarget->hasB();
+}
+
+bool RISCVTargetLowering::isCheapToSpeculateCtlz() const {
+  return Subtarget->hasB();
+}
+
+// Swap adjacent bytes, then adjacent halfwords and so on, with a single mask
+// per step. The generic expansion needs a mask for every byte, which on RV64
+// means materializing six 64-bit constants.
+SDValue RISCVTargetLowering::lowerBSWAP(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  EVT ShVT = getShiftAmountTy(VT, DAG.getDataLayout());
+  unsigned Len = VT.getSizeInBits();
+  SDValue V = Op.getOperand(0);
+
+  for (unsigned Shift = 8; Shift < Len; Shift *= 2) {
+    SDValue Amt = DAG.getConstant(Shift, DL, ShVT);
+    SDValue Hi = DAG.getNode(ISD::SRL, DL, VT, V, Amt);
+    SDValue Lo = DAG.getNode(ISD::SHL, DL, VT, V, Amt);
+    // The last step swaps the two halves and needs no mask.
+    if (Shift * 2 < Len) {
+      SDValue Mask = DAG.getConstant(
+          APInt::getSplat(Len, APInt::getLowBitsSet(2 * Shift, Shift)), DL,
+          VT);
+      Hi = DAG.getNode(ISD::AND, DL, VT, Hi, Mask);
+      Lo = DAG.getNode(ISD::SHL, DL, VT,
+                       DAG.getNode(ISD::AND, DL, VT, V, Mask), Amt);
+    }
+    V = DAG.getNode(ISD::OR, DL, VT, Hi, Lo);
+  }
+  return V;
+}
+
+// The generic population count sums the per-byte counts with a multiply,
+// which is a libcall without M. Add the bytes up with shifts instead.
+SDValue RISCVTargetLowering::lowerCTPOP(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  EVT ShVT = getShiftAmountTy(VT, DAG.getDataLayout());
+  unsigned Len = VT.getSizeInBits();
+  SDValue V = Op.getOperand(0);
+
+  auto Srl = [&](SDValue X, unsigned Amt) {
+    return DAG.getNode(ISD::SRL, DL, VT, X, DAG.getConstant(Amt, DL, ShVT));
+  };
+  auto Splat = [&](uint8_t Byte) {
+    return DAG.getConstant(APInt::getSplat(Len, APInt(8, Byte)), DL, VT);
+  };
+
+  // v = v - ((v >> 1) & 0x55...)
+  V = DAG.getNode(ISD::SUB, DL, VT, V,
+                  DAG.getNode(ISD::AND, DL, VT, Srl(V, 1), Splat(0x55)));
+  // v = (v & 0x33...) + ((v >> 2) & 0x33...)
+  V = DAG.getNode(ISD::ADD, DL, VT,
+                  DAG.getNode(ISD::AND, DL, VT, V, Splat(0x33)),
+                  DAG.getNode(ISD::AND, DL, VT, Srl(V, 2), Splat(0x33)));
+  // v = (v + (v >> 4)) & 0x0F...
+  V = DAG.getNode(ISD::AND, DL, VT,
+                  DAG.getNode(ISD::ADD, DL, VT, V, Srl(V, 4)), Splat(0x0F));
+  // Fold the byte counts into the low byte; none of the sums can carry out
+  // of it.
+  for (unsigned Shift = 8; Shift < Len; Shift *= 2)
+    V = DAG.getNode(ISD::ADD, DL, VT, V, Srl(V, Shift));
+  return DAG.getNode(ISD::AND, DL, VT, V, DAG.getConstant(2 * Len - 1, DL, VT));
+}
+
+// There are no i8 or i16 AMOs, LRs or SCs, so these atomics work on the
+// aligned word that contains them. And, or and xor are a single word AMO
+// whose operand leaves the other bytes alone; everything else is an LR/SC
+// loop that only changes the bits under a mask.
+SDValue RISCVTargetLowering::lowerPartwordAtomic(SDValue Op,
+                                                 SelectionDAG &DAG) const {
+  auto *AN = cast<AtomicSDNode>(Op);
+  SDLoc DL(Op);
+  EVT PtrVT = getPointerTy(DAG.getDataLayout());
+  unsigned Opcode = Op.getOpcode();
+  unsigned ValWidth = AN->getMemoryVT().getSizeInBits();
+  SDValue Chain = AN->getChain();
+  SDValue Ptr = AN->getBasePtr();
+
+  auto Shl = [&](SDValue X, SDValue Amt) {
+    return DAG.getNode(ISD::SHL, DL, MVT::i32, X, Amt);
+  };
+
+  SDValue AlignedAddr = DAG.getNode(ISD::AND, DL, PtrVT, Ptr,
+                                    DAG.getConstant(-4, DL, PtrVT));
+  SDValue ShiftAmt = Shl(DAG.getNode(ISD::AND, DL, MVT::i32,
+                                     DAG.getZExtOrTrunc(Ptr, DL, MVT::i32),
+                                     DAG.getConstant(3, DL, MVT::i32)),
+                         DAG.getConstant(3, DL, MVT::i32));
+  SDValue Mask = Shl(DAG.getConstant(maskTrailingOnes<uint32_t>(ValWidth), DL,
+                                     MVT::i32),
+                     ShiftAmt);
+
+  // The word is accessed as a whole, with the ordering of the original
+  // operation.
+  MachineFunction &MF = DAG.getMachineFunction();
+  const MachineMemOperand *OldMMO = AN->getMemOperand();
+  MachineMemOperand *MMO = MF.getMachineMemOperand(
+      MachinePointerInfo(), OldMMO->getFlags(), 4, 4, AAMDNodes(), nullptr,
+      OldMMO->getSyncScopeID(), OldMMO->getOrdering(),
+      OldMMO->getFailureOrdering());
+  SDValue Ordering = DAG.getTargetConstant(
+      static_cast<unsigned>(AN->getOrdering()), DL, MVT::i32);
+  SDVTList VTs = DAG.getVTList(MVT::i32, MVT::Other);
+
+  if (Opcode == ISD::ATOMIC_CMP_SWAP_WITH_SUCCESS) {
+    SDValue CmpVal =
+        Shl(DAG.getNode(ISD::ZERO_EXTEND, DL, MVT::i32, Op.getOperand(2)),
+            ShiftAmt);
+    SDValue NewVal =
+        Shl(DAG.getNode(ISD::ZERO_EXTEND, DL, MVT::i32, Op.getOperand(3)),
+            ShiftAmt);
+    SDValue Ops[] = {Chain, AlignedAddr, CmpVal, NewVal, Mask, Ordering};
+    SDValue Word = DAG.getMemIntrinsicNode(RISCVISD::MASKED_CMP_SWAP, DL, VTs,
+                                           Ops, MVT::i32, MMO);
+    SDValue Field = DAG.getNode(ISD::AND, DL, MVT::i32, Word, Mask);
+    SDValue Res = DAG.getNode(ISD::TRUNCATE, DL, Op.getValueType(),
+                              DAG.getNode(ISD::SRL, DL, MVT::i32, Field,
+                                          ShiftAmt));
+    SDValue Success =
+        DAG.getSetCC(DL, Op->getValueType(1), Field, CmpVal, ISD::SETEQ);
+    return DAG.getMergeValues({Res, Success, Word.getValue(1)}, DL);
+  }
+
+  // Signed min and max compare the sign-extended value with the field
+  // sign-extended in place, so the bits above the value must be copies of its
+  // sign.
+  bool IsSigned =
+      Opcode == ISD::ATOMIC_LOAD_MAX || Opcode == ISD::ATOMIC_LOAD_MIN;
+  SDValue Val = Shl(DAG.getNode(IsSigned ? ISD::SIGN_EXTEND : ISD::ZERO_EXTEND,
+                                DL, MVT::i32, Op.getOperand(2)),
+                    ShiftAmt);
+
+  SDValue Word;
+  switch (Opcode) {
+  default:
+    llvm_unreachable("Unexpected sub-word atomic");
+  case ISD::ATOMIC_LOAD_AND:
+    Val = DAG.getNode(ISD::OR, DL, MVT::i32, Val,
+                      DAG.getNOT(DL, Mask, MVT::i32));
+    LLVM_FALLTHROUGH;
+  case ISD::ATOMIC_LOAD_OR:
+  case ISD::ATOMIC_LOAD_XOR:
+    Word = DAG.getAtomic(Opcode, DL, MVT::i32, Chain, AlignedAddr, Val, MMO);
+    break;
+  case ISD::ATOMIC_LOAD_MAX:
+  case ISD::ATOMIC_LOAD_MIN: {
+    // Shifting the field to the top of the word and back sign-extends it.
+    SDValue SextShamt = DAG.getNode(ISD::SUB, DL, MVT::i32,
+                                    DAG.getConstant(32 - ValWidth, DL,
+                                                    MVT::i32),
+                                    ShiftAmt);
+    SDValue Ops[] = {Chain, AlignedAddr, Val, Mask, SextShamt, Ordering};
+    Word = DAG.getMemIntrinsicNode(Opcode == ISD::ATOMIC_LOAD_MAX
+                                       ? RISCVISD::MASKED_ATOMIC_LOAD_MAX
+                                       : RISCVISD::MASKED_ATOMIC_LOAD_MIN,
+                                   DL, VTs, Ops, MVT::i32, MMO);
+    break;
+  }
+  case ISD::ATOMIC_SWAP:
+  case ISD::ATOMIC_LOAD_ADD:
+  case ISD::ATOMIC_LOAD_SUB:
+  case ISD::ATOMIC_LOAD_NAND:
+  case ISD::ATOMIC_LOAD_UMAX:
+  case ISD::ATOMIC_LOAD_UMIN: {
+    unsigned MaskedOpc;
+    switch (Opcode) {
+    default:
+      llvm_unreachable("Unexpected sub-word atomic");
+    case ISD::ATOMIC_SWAP:
+      MaskedOpc = RISCVISD::MASKED_ATOMIC_SWAP;
+      break;
+    case ISD::ATOMIC_LOAD_ADD:
+      MaskedOpc = RISCVISD::MASKED_ATOMIC_LOAD_ADD;
+      break;
+    case ISD::ATOMIC_LOAD_SUB:
+      MaskedOpc = RISCVISD::MASKED_ATOMIC_LOAD_SUB;
+      break;
+    case ISD::ATOMIC_LOAD_NAND:
+      MaskedOpc = RISCVISD::MASKED_ATOMIC_LOAD_NAND;
+      break;
+    case ISD::ATOMIC_LOAD_UMAX:
+      MaskedOpc = RISCVISD::MASKED_ATOMIC_LOAD_UMAX;
+      break;
+    case ISD::ATOMIC_LOAD_UMIN:
+      MaskedOpc = RISCVISD::MASKED_ATOMIC_LOAD_UMIN;
+      break;
+    }
+    SDValue Ops[] = {Chain, AlignedAddr, Val, Mask, Ordering};
+    Word = DAG.getMemIntrinsicNode(MaskedOpc, DL, VTs, Ops, MVT::i32, MMO);
+    break;
+  }
+  }
+
+  SDValue Res = DAG.getNode(ISD::TRUNCATE, DL, Op.getValueType(),
+                            DAG.getNode(ISD::SRL, DL, MVT::i32, Word,
+                                        ShiftAmt));
+  return DAG.getMergeValues({Res, Word.getValue(1)}, DL);
+}
+
+// A multiplier as a sum of shifted copies of the multiplicand: (shift amount,
+// subtract) pairs.
+typedef SmallVector<std::pair<unsigned, bool>, 8> MulTermVector;
+
+// Split the Len-bit multiplier C into its non-adjacent form, the signed-digit
+// representation with the fewest nonzero digits. Digits at or above Len wrap
+// away, so negative multipliers need no special casing.
+static void getMulTerms(uint64_t C, unsigned Len, MulTermVector &Terms) {
+  if (Len < 64)
+    C &= (UINT64_C(1) << Len) - 1;
+  for (unsigned Bit = 0; C && Bit < Len; ++Bit, C >>= 1) {
+    if (!(C & 1))
+      continue;
+    bool Sub = (C & 3) == 3;
+    Terms.push_back(std::make_pair(Bit, Sub));
+    C = Sub ? C + 1 : C - 1;
+  }
+}
+
+// Number of instructions buildMulTerms emits for Terms.
+static unsigned getMulTermsCost(const MulTermVector &Terms) {
+  if (Terms.empty())
+    return 0;
+  unsigned Cost = Terms.size() - 1;
+  bool HasAdd = false;
+  for (const auto &T : Terms) {
+    if (T.first)
+      ++Cost;
+    HasAdd |= !T.second;
+  }
+  // An all-negative multiplier starts from a negation.
+  return HasAdd ? Cost : Cost + 1;
+}
+
+static SDValue buildMulTerms(SDValue X, const MulTermVector &Terms,
+                             const SDLoc &DL, SelectionDAG &DAG) {
+  EVT VT = X.getValueType();
+  EVT ShVT = DAG.getTargetLoweringInfo().getShiftAmountTy(
+      VT, DAG.getDataLayout());
+  auto Term = [&](unsigned Shift) {
+    if (!Shift)
+      return X;
+    return DAG.getNode(ISD::SHL, DL, VT, X, DAG.getConstant(Shift, DL, ShVT));
+  };
+
+  auto First = std::find_if(
+      Terms.begin(), Terms.end(),
+      [](const std::pair<unsigned, bool> &T) { return !T.second; });
+  SDValue Acc =
+      First != Terms.end() ? Term(First->first) : DAG.getConstant(0, DL, VT);
+  for (auto I = Terms.begin(), E = Terms.end(); I != E; ++I)
+    if (I != First)
+      Acc = DAG.getNode(I->second ? ISD::SUB : ISD::ADD, DL, VT, Acc,
+                        Term(I->first));
+  return Acc;
+}
+
+namespace {
+// How to divide by a constant with shifts and adds, see performDIVCombine.
+struct DivByConstPlan {
+  unsigned PreShift;   // Trailing zeros of the divisor.
+  uint64_t Divisor;    // The odd part of the divisor.
+  unsigned Period;     // Smallest E with 2^E == 1 (mod Divisor).
+  uint64_t Reciprocal; // (2^E - 1) / Divisor.
+  MulTermVector DivisorTerms;
+  MulTermVector FixTerms;
+  unsigned FixShift;
+  unsigned Cost;
+};
+} // end anonymous namespace
+
+static bool getDivByConstPlan(uint64_t Divisor, unsigned Len,
+                              DivByConstPlan &P) {
+  if (!Divisor || Divisor > UINT32_MAX)
+    return false;
+  P.PreShift = countTrailingZeros(Divisor);
+  P.Divisor = Divisor >> P.PreShift;
+  // Powers of two are left to the generic combines.
+  if (P.Divisor == 1)
+    return false;
+
+  P.Period = 1;
+  for (uint64_t R = 2 % P.Divisor; R != 1; R = R * 2 % P.Divisor)
+    if (++P.Period > Len)
+      return false;
+  uint64_t Mersenne =
+      P.Period == 64 ? UINT64_MAX : (UINT64_C(1) << P.Period) - 1;
+  P.Reciprocal = Mersenne / P.Divisor;
+
+  unsigned NumTerms = countPopulation(P.Reciprocal);
+  unsigned NumSteps = 0;
+  for (unsigned Shift = P.Period; Shift < Len; Shift *= 2)
+    ++NumSteps;
+
+  // Each truncating shift loses less than one, and the later steps scale what
+  // was lost by at most 2^E / (2^E - 1); truncating the series loses less
+  // than one more. So the estimate is short by at most MaxError and the
+  // remainder is below (MaxError + 1) * Divisor.
+  uint64_t MaxError =
+      NumTerms + NumSteps + (NumTerms + NumSteps) / Mersenne + 2;
+  uint64_t MaxRem = (MaxError + 1) * P.Divisor - 1;
+
+  // Find the shortest FixMul / 2^FixShift that divides every possible
+  // remainder exactly without overflowing. With FixMul = ceil(2^S / D) and
+  // Eps = FixMul * D - 2^S that holds when MaxRem * Eps < 2^S.
+  uint64_t MaxVal = Len == 64 ? UINT64_MAX : (UINT64_C(1) << Len) - 1;
+  uint64_t FixMul = 0;
+  for (P.FixShift = 1; P.FixShift < std::min(Len, 63U); ++P.FixShift) {
+    uint64_t Pow = UINT64_C(1) << P.FixShift;
+    FixMul = (Pow + P.Divisor - 1) / P.Divisor;
+    if (MaxRem > MaxVal / FixMul)
+      return false;
+    uint64_t Eps = FixMul * P.Divisor - Pow;
+    if (!Eps || MaxRem < (Pow + Eps - 1) / Eps)
+      break;
+  }
+  if (P.FixShift == std::min(Len, 63U))
+    return false;
+
+  getMulTerms(P.Divisor, Len, P.DivisorTerms);
+  getMulTerms(FixMul, Len, P.FixTerms);
+  P.Cost = (P.PreShift ? 1 : 0) + 2 * NumTerms - 1 + 2 * NumSteps +
+           getMulTermsCost(P.DivisorTerms) + 1 +
+           getMulTermsCost(P.FixTerms) + 2;
+  return true;
+}
+
+SDValue RISCVTargetLowering::PerformDAGCombine(SDNode *N,
+                                               DAGCombinerInfo &DCI) const {
+  switch (N->getOpcode()) {
+  case ISD::MUL:
+    return performMULCombine(N, DCI.DAG);
+  case ISD::SDIV:
+  case ISD::UDIV:
+    return performDIVCombine(N, DCI.DAG);
+  }
+  return SDValue();
+}
+
+// Without M a multiplication is a call to __mulsi3 or __muldi3, which loop
+// over the bits of an operand. A multiplication by a constant is cheaper as
+// a short chain of shifts and adds.
+SDValue RISCVTargetLowering::performMULCombine(SDNode *N,
+                                               SelectionDAG &DAG) const {
+  EVT VT = N->getValueType(0);
+  auto *C = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  if (!C || !VT.isScalarInteger() || VT.getSizeInBits() > 64)
+    return SDValue();
+
+  unsigned Len = VT.getSizeInBits();
+  MulTermVector Terms;
+  getMulTerms(C->getZExtValue(), Len, Terms);
+  if (Terms.empty())
+    return SDValue();
+
+  unsigned Cost = getMulTermsCost(Terms);
+  // Shifts and adds wider than a register are split and need a carry.
+  if (Len > (Subtarget->isRV64() ? 64U : 32U))
+    Cost *= 3;
+  unsigned MaxCost = MulByConstMaxInsts;
+  if (DAG.getMachineFunction().getFunction()->optForSize())
+    MaxCost = std::min(MaxCost, 3U);
+  if (Cost > MaxCost)
+    return SDValue();
+
+  return buildMulTerms(N->getOperand(0), Terms, SDLoc(N), DAG);
+}
+
+// Without M a division is a call to a shift-and-subtract loop. For a
+// constant divisor, strip its power-of-two factor with a shift. The odd part
+// D has a period E with 2^E == 1 (mod D), so 1/D = C / (2^E - 1) with
+// C = (2^E - 1) / D, and
+//
+//   X / D = X * C * (2^-E + 2^-2E + 2^-3E + ...)
+//
+// X * C * 2^-E is a sum of right shifts of X, and the series is summed by
+// doubling: Q += Q >> E, Q += Q >> 2E, ... Every shift truncates, so Q never
+// exceeds the quotient and falls short by a few units at most. The remainder
+// X - Q * D is then small enough to be divided exactly by a multiplication by
+// a short constant and a shift. Signed divisions divide the magnitudes.
+SDValue RISCVTargetLowering::performDIVCombine(SDNode *N,
+                                               SelectionDAG &DAG) const {
+  EVT VT = N->getValueType(0);
+  auto *C = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  if (!C || !VT.isScalarInteger() || !isTypeLegal(VT) ||
+      DAG.getMachineFunction().getFunction()->optForSize())
+    return SDValue();
+
+  unsigned Len = VT.getSizeInBits();
+  bool IsSigned = N->getOpcode() == ISD::SDIV;
+  bool NegDivisor = IsSigned && C->getSExtValue() < 0;
+  uint64_t Divisor = NegDivisor ? 0 - uint64_t(C->getSExtValue())
+                                : C->getZExtValue();
+  DivByConstPlan P;
+  if (!getDivByConstPlan(Divisor, Len, P))
+    return SDValue();
+  unsigned Cost = P.Cost;
+  if (IsSigned)
+    Cost += NegDivisor ? 6 : 5;
+  if (Cost > DivByConstMaxInsts)
+    return SDValue();
+
+  SDLoc DL(N);
+  EVT ShVT = getShiftAmountTy(VT, DAG.getDataLayout());
+  auto Srl = [&](SDValue V, unsigned Amt) {
+    return DAG.getNode(ISD::SRL, DL, VT, V, DAG.getConstant(Amt, DL, ShVT));
+  };
+  auto Add = [&](SDValue A, SDValue B) {
+    return DAG.getNode(ISD::ADD, DL, VT, A, B);
+  };
+
+  SDValue X = N->getOperand(0);
+  SDValue Sign;
+  if (IsSigned) {
+    Sign = DAG.getNode(ISD::SRA, DL, VT, X, DAG.getConstant(Len - 1, DL, ShVT));
+    X = DAG.getNode(ISD::SUB, DL, VT, DAG.getNode(ISD::XOR, DL, VT, X, Sign),
+                    Sign);
+  }
+  if (P.PreShift)
+    X = Srl(X, P.PreShift);
+
+  SDValue Q;
+  for (unsigned Bit = 0; Bit < P.Period; ++Bit) {
+    if (!(P.Reciprocal >> Bit & 1))
+      continue;
+    SDValue T = Srl(X, P.Period - Bit);
+    Q = Q ? Add(Q, T) : T;
+  }
+  for (unsigned Shift = P.Period; Shift < Len; Shift *= 2)
+    Q = Add(Q, Srl(Q, Shift));
+
+  SDValue Rem = DAG.getNode(ISD::SUB, DL, VT, X,
+                            buildMulTerms(Q, P.DivisorTerms, DL, DAG));
+  Q = Add(Q, Srl(buildMulTerms(Rem, P.FixTerms, DL, DAG), P.FixShift));
+
+  if (IsSigned) {
+    if (NegDivisor)
+      Sign = DAG.getNOT(DL, Sign, VT);
+    Q = DAG.getNode(ISD::SUB, DL, VT, DAG.getNode(ISD::XOR, DL, VT, Q, Sign),
+                    Sign);
+  }
+  return Q;
+}
+
+// Expand a MEMCPY_LOOP or MEMSET_LOOP pseudo into a loop that walks the
+// destination up to its end, one or two words per iteration:
+//
+// BB:
+//   End = Dst + Size
+// LoopMBB:
+//   D = phi [Dst, BB], [DNext, LoopMBB]
+//   S = phi [Src, BB], [SNext, LoopMBB]     (memcpy)
+//   V = load 0(S)                           (memcpy)
+//   store V, 0(D)
+//   ...
+//   SNext = S + Step                        (memcpy)
+//   DNext = D + Step
+//   bne DNext, End, LoopMBB
 MachineBasicBlock *
-RISCVTargetLowering::EmitInstrWithCustomInserter(MachineInstr &MI,
-                                                 MachineBasicBlock *BB) const {
-  const TargetInstrInfo &TII = *BB->getParent()->getSubtarget().getInstrInfo();
+RISCVTargetLowering::emitMemLoop(MachineInstr &MI,
+                                 MachineBasicBlock *BB) const {
+  const TargetInstrInfo &TII = *Subtarget->getInstrInfo();
+  MachineFunction *F = BB->getParent();
+  MachineRegisterInfo &MRI = F->getRegInfo();
   DebugLoc DL = MI.getDebugLoc();
-  bool Is64RV = Subtarget->isRV64();
+  bool IsMemcpy = MI.getOpcode() == RISCV::MEMCPY_LOOP ||
+                  MI.getOpcode() == RISCV::MEMCPY_LOOP64;
+  bool Is64 = MI.getOpcode() == RISCV::MEMCPY_LOOP64 ||
+              MI.getOpcode() == RISCV::MEMSET_LOOP64;
+  unsigned Dst = MI.getOperand(0).getReg();
+  unsigned Src = MI.getOperand(1).getReg();
+  uint64_t Size = MI.getOperand(2).getImm();
+  unsigned Width = MI.getOperand(3).getImm();
+
+  const TargetRegisterClass *RC =
+      Is64 ? &RISCV::GPR64RegClass : &RISCV::GPRRegClass;
+  unsigned AddiOpc = Is64 ? RISCV::ADDI64 : RISCV::ADDI;
+  unsigned LoadOpc = !Is64 ? RISCV::LW : Width == 8 ? RISCV::LD : RISCV::LW64;
+  unsigned StoreOpc = !Is64 ? RISCV::SW : Width == 8 ? RISCV::SD : RISCV::SW64;
+  // Two words per iteration when that divides the size, to halve the loop
+  // overhead and separate each load from its store.
+  unsigned Unroll = (Size / Width) % 2 ? 1 : 2;
+  unsigned Step = Width * Unroll;
 
-  // To "insert" a SELECT instruction, we actually have to insert the diamond
-  // control-flow pattern.  The incoming instruction knows the destination vreg
-  // to set, the condition code register to branch on, the true/false values to
-  // select between, and a branch opcode to use.
   const BasicBlock *LLVM_BB = BB->getBasicBlock();
   MachineFunction::iterator I = ++BB->getIterator();
+  MachineBasicBlock *LoopMBB = F->CreateMachineBasicBlock(LLVM_BB);
+  MachineBasicBlock *DoneMBB = F->CreateMachineBasicBlock(LLVM_BB);
+  F->insert(I, LoopMBB);
+  F->insert(I, DoneMBB);
+  DoneMBB->splice(DoneMBB->begin(), BB,
+                  std::next(MachineBasicBlock::iterator(MI)), BB->end());
+  DoneMBB->transferSuccessorsAndUpdatePHIs(BB);
+  BB->addSuccessor(LoopMBB);
+  LoopMBB->addSuccessor(LoopMBB);
+  LoopMBB->addSuccessor(DoneMBB);
+
+  unsigned End = MRI.createVirtualRegister(RC);
+  if (isInt<12>(Size)) {
+    BuildMI(*BB, MI, DL, TII.get(AddiOpc), End).addReg(Dst).addImm(Size);
+  } else {
+    unsigned SizeReg = MRI.createVirtualRegister(RC);
+    BuildMI(*BB, MI, DL,
+            TII.get(Is64 ? RISCV::MOVi64imm : RISCV::MOVi32imm), SizeReg)
+        .addImm(Size);
+    BuildMI(*BB, MI, DL, TII.get(Is64 ? RISCV::ADD64 : RISCV::ADD), End)
+        .addReg(Dst)
+        .addReg(SizeReg);
+  }
 
-  // ThisMBB:
-  // ...
-  //  TrueVal = ...
-  //  jmp_XX r1, r2 goto Copy1MBB
-  //  fallthrough --> Copy0MBB
-  MachineBasicBlock *ThisMBB = BB;
-  MachineFunction *F = BB->getParent();
-  MachineBasicBlock *Copy0MBB = F->CreateMachineBasicBlock(LLVM_BB);
-  MachineBasicBlock *Copy1MBB = F->CreateMachineBasicBlock(LLVM_BB);
+  unsigned D = MRI.createVirtualRegister(RC);
+  unsigned DNext = MRI.createVirtualRegister(RC);
+  BuildMI(LoopMBB, DL, TII.get(RISCV::PHI), D)
+      .addReg(Dst)
+      .addMBB(BB)
+      .addReg(DNext)
+      .addMBB(LoopMBB);
+  unsigned S = 0, SNext = 0;
+  if (IsMemcpy) {
+    S = MRI.createVirtualRegister(RC);
+    SNext = MRI.createVirtualRegister(RC);
+    BuildMI(LoopMBB, DL, TII.get(RISCV::PHI), S)
+        .addReg(Src)
+        .addMBB(BB)
+        .addReg(SNext)
+        .addMBB(LoopMBB);
+  }
 
-  F->insert(I, Copy0MBB);
-  F->insert(I, Copy1MBB);
-  // Update machine-CFG edges by transferring all successors of the current
-  // block to the new block which will contain the Phi node for the select.
-  Copy1MBB->splice(Copy1MBB->begin(), BB,
-                   std::next(MachineBasicBlock::iterator(MI)), BB->end());
-  Copy1MBB->transferSuccessorsAndUpdatePHIs(BB);
-  // Next, add the true and fallthrough blocks as its successors.
-  BB->addSuccessor(Copy0MBB);
-  BB->addSuccessor(Copy1MBB);
+  SmallVector<unsigned, 2> Vals;
+  for (unsigned J = 0; J != Unroll; ++J) {
+    if (!IsMemcpy) {
+      Vals.push_back(Src);
+      continue;
+    }
+    unsigned V = MRI.createVirtualRegister(RC);
+    BuildMI(LoopMBB, DL, TII.get(LoadOpc), V).addReg(S).addImm(J * Width);
+    Vals.push_back(V);
+  }
+  for (unsigned J = 0; J != Unroll; ++J)
+    BuildMI(LoopMBB, DL, TII.get(StoreOpc))
+        .addReg(Vals[J])
+        .addReg(D)
+        .addImm(J * Width);
+  if (IsMemcpy)
+    BuildMI(LoopMBB, DL, TII.get(AddiOpc), SNext).addReg(S).addImm(Step);
+  BuildMI(LoopMBB, DL, TII.get(AddiOpc), DNext).addReg(D).addImm(Step);
+  BuildMI(LoopMBB, DL, TII.get(Is64 ? RISCV::BNE64 : RISCV::BNE))
+      .addReg(DNext)
+      .addReg(End)
+      .addMBB(LoopMBB);
+
+  MI.eraseFromParent();
+  return DoneMBB;
+}
+
+MachineBasicBlock *
+RISCVTargetLowering::EmitInstrWithCustomInserter(MachineInstr &MI,
+                                                 MachineBasicBlock *BB) const {
+  switch (MI.getOpcode()) {
+  case RISCV::MEMCPY_LOOP:
+  case RISCV::MEMCPY_LOOP64:
+  case RISCV::MEMSET_LOOP:
+  case RISCV::MEMSET_LOOP64:
+    return emitMemLoop(MI, BB);
+  default:
+    break;
+  }
+
+  const TargetInstrInfo &TII = *BB->getParent()->getSubtarget().getInstrInfo();
+  DebugLoc DL = MI.getDebugLoc();
+  const MachineRegisterInfo &MRI = BB->getParent()->getRegInfo();
+  // Pick the branch width from the compared registers; the Select_FPR
+  // pseudos always compare 32-bit GPRs.
+  bool Is64RV = Subtarget->isRV64() &&
+                RISCV::GPR64RegClass.hasSubClassEq(
+                    MRI.getRegClass(MI.getOperand(1).getReg()));
 
-  // Insert Branch if Flag
   unsigned LHS = MI.getOperand(1).getReg();
   unsigned RHS = MI.getOperand(2).getReg();
   int CC = MI.getOperand(3).getImm();
@@ -651,6 +1674,58 @@ RISCVTargetLowering::EmitInstrWithCustomInserter(MachineInstr &MI,
     report_fatal_error("unimplemented select CondCode " + Twine(CC));
   }
 
+  // Integer selects whose branch-free form is short are not worth a branch
+  // that may mispredict. Longer ones are left to early if-conversion, which
+  // weighs them against the critical path of the surrounding code.
+  MachineFunction *F = BB->getParent();
+  if (MI.getOpcode() != RISCV::Select_FPR32 &&
+      MI.getOpcode() != RISCV::Select_FPR64 &&
+      getTargetMachine().getOptLevel() != CodeGenOpt::None) {
+    const RISCVInstrInfo &RII = *Subtarget->getInstrInfo();
+    unsigned TrueReg = MI.getOperand(4).getReg();
+    unsigned FalseReg = MI.getOperand(5).getReg();
+    unsigned MaxCost = BranchlessSelectMaxInsts;
+    if (F->getFunction()->optForSize())
+      MaxCost = std::min(MaxCost, 3U);
+    unsigned CondCost;
+    unsigned Cost = RII.getBranchlessSelectCost(Opcode, LHS, RHS, TrueReg,
+                                                FalseReg, MRI, CondCost);
+    if (Cost && Cost <= MaxCost) {
+      RII.buildBranchlessSelect(*BB, MI, DL, MI.getOperand(0).getReg(),
+                                Opcode, LHS, RHS, TrueReg, FalseReg);
+      MI.eraseFromParent();
+      return BB;
+    }
+  }
+
+  // To "insert" a SELECT instruction, we actually have to insert the diamond
+  // control-flow pattern.  The incoming instruction knows the destination vreg
+  // to set, the condition code register to branch on, the true/false values to
+  // select between, and a branch opcode to use.
+  const BasicBlock *LLVM_BB = BB->getBasicBlock();
+  MachineFunction::iterator I = ++BB->getIterator();
+
+  // ThisMBB:
+  // ...
+  //  TrueVal = ...
+  //  jmp_XX r1, r2 goto Copy1MBB
+  //  fallthrough --> Copy0MBB
+  MachineBasicBlock *ThisMBB = BB;
+  MachineBasicBlock *Copy0MBB = F->CreateMachineBasicBlock(LLVM_BB);
+  MachineBasicBlock *Copy1MBB = F->CreateMachineBasicBlock(LLVM_BB);
+
+  F->insert(I, Copy0MBB);
+  F->insert(I, Copy1MBB);
+  // Update machine-CFG edges by transferring all successors of the current
+  // block to the new block which will contain the Phi node for the select.
+  Copy1MBB->splice(Copy1MBB->begin(), BB,
+                   std::next(MachineBasicBlock::iterator(MI)), BB->end());
+  Copy1MBB->transferSuccessorsAndUpdatePHIs(BB);
+  // Next, add the true and fallthrough blocks as its successors.
+  BB->addSuccessor(Copy0MBB);
+  BB->addSuccessor(Copy1MBB);
+
+  // Insert Branch if Flag
   BuildMI(BB, DL, TII.get(Opcode))
     .addReg(LHS)
     .addReg(RHS)
@@ -689,6 +1764,7 @@ RISCVTargetLowering::getConstraintType(StringRef Constraint) const {
   if (Constraint.size() == 1) {
     switch (Constraint[0]) {
     case 'r':
+    case 'f':
       return C_RegisterClass;
     default:
       break;
@@ -709,6 +1785,12 @@ RISCVTargetLowering::getRegForInlineAsmConstraint(
         return std::make_pair(0U, &RISCV::GPR64RegClass);
       else
         return std::make_pair(0U, &RISCV::GPRRegClass);
+    case 'f':   // FP_REGS
+      if (VT == MVT::f32 && Subtarget->hasF())
+        return std::make_pair(0U, &RISCV::FPR32RegClass);
+      if (VT == MVT::f64 && Subtarget->hasD())
+        return std::make_pair(0U, &RISCV::FPR64RegClass);
+      break;
     }
   }
 
@@ -742,6 +1824,78 @@ static CCAssignFn *getCCAssignFn(const RISCVSubtarget *STI, bool IsVarArg) {
   return (IsVarArg ? CC_RISCV32_VAR : CC_RISCV32);
 }
 
+// Only the arguments passed through "..." use the variadic convention. The
+// named ones are passed as in any other call, so a hard-float ABI still puts
+// named floating-point arguments in FPRs.
+static void analyzeCallOperands(CCState &CCInfo, const RISCVSubtarget *STI,
+                                const SmallVectorImpl<ISD::OutputArg> &Outs,
+                                bool IsVarArg) {
+  for (unsigned I = 0, E = Outs.size(); I != E; ++I) {
+    MVT ArgVT = Outs[I].VT;
+    CCAssignFn *CC = getCCAssignFn(STI, IsVarArg && !Outs[I].IsFixed);
+    if (CC(I, ArgVT, ArgVT, CCValAssign::Full, Outs[I].Flags, CCInfo))
+      llvm_unreachable("Call operand has unhandled type");
+  }
+}
+
+// Vectors of 8- and 16-bit lanes are passed like integers of the same size
+// whether or not the P extension makes them legal, so objects built with and
+// without it can call each other.
+static bool isPackedABIType(EVT VT) {
+  if (!VT.isVector() || !VT.isSimple())
+    return false;
+  EVT EltVT = VT.getVectorElementType();
+  unsigned Size = VT.getSizeInBits();
+  return (EltVT == MVT::i8 || EltVT == MVT::i16) && (Size == 32 || Size == 64);
+}
+
+MVT RISCVTargetLowering::getRegisterTypeForCallingConv(MVT VT) const {
+  if (isPackedABIType(VT))
+    return Subtarget->isRV64() ? MVT::i64 : MVT::i32;
+  return TargetLowering::getRegisterTypeForCallingConv(VT);
+}
+
+MVT RISCVTargetLowering::getRegisterTypeForCallingConv(LLVMContext &Context,
+                                                       EVT VT) const {
+  if (isPackedABIType(VT))
+    return Subtarget->isRV64() ? MVT::i64 : MVT::i32;
+  return TargetLowering::getRegisterTypeForCallingConv(Context, VT);
+}
+
+unsigned
+RISCVTargetLowering::getNumRegistersForCallingConv(LLVMContext &Context,
+                                                   EVT VT) const {
+  if (isPackedABIType(VT))
+    return VT.getSizeInBits() > (Subtarget->isRV64() ? 64u : 32u) ? 2 : 1;
+  return TargetLowering::getNumRegistersForCallingConv(Context, VT);
+}
+
+unsigned RISCVTargetLowering::getVectorTypeBreakdownForCallingConv(
+    LLVMContext &Context, EVT VT, EVT &IntermediateVT,
+    unsigned &NumIntermediates, MVT &RegisterVT) const {
+  if (!isPackedABIType(VT))
+    return TargetLowering::getVectorTypeBreakdownForCallingConv(
+        Context, VT, IntermediateVT, NumIntermediates, RegisterVT);
+  RegisterVT = getRegisterTypeForCallingConv(Context, VT);
+  IntermediateVT = RegisterVT;
+  NumIntermediates = getNumRegistersForCallingConv(Context, VT);
+  return NumIntermediates;
+}
+
+CCAssignFn *RISCVTargetLowering::CCAssignFnForCall(bool IsVarArg) const {
+  return getCCAssignFn(Subtarget, IsVarArg);
+}
+
+CCAssignFn *RISCVTargetLowering::CCAssignFnForReturn() const {
+  return Subtarget->isRV64() ? RetCC_RISCV64 : RetCC_RISCV32;
+}
+
+FastISel *
+RISCVTargetLowering::createFastISel(FunctionLoweringInfo &FuncInfo,
+                                    const TargetLibraryInfo *LibInfo) const {
+  return RISCV::createFastISel(FuncInfo, LibInfo);
+}
+
 // RestoreVarArgRegs - Store VarArg register to the stack
 void RISCVTargetLowering::RestoreVarArgRegs(std::vector<SDValue> &OutChains,
                                             SDValue Chain, const SDLoc &DL,
@@ -901,6 +2055,12 @@ static SDValue UnpackFromArgumentSlot(SDValue Val, const CCValAssign &VA,
     break;
   case CCValAssign::AExtUpper:
   case CCValAssign::AExt:
+    // f32 is bit-converted to i32 and then any-extended on RV64.
+    if (ValVT.isFloatingPoint()) {
+      Val = DAG.getNode(ISD::TRUNCATE, DL, ValVT.changeTypeToInteger(), Val);
+      Val = DAG.getNode(ISD::BITCAST, DL, ValVT, Val);
+      break;
+    }
     Val = DAG.getNode(ISD::TRUNCATE, DL, ValVT, Val);
     break;
   case CCValAssign::SExtUpper:
@@ -945,7 +2105,19 @@ SDValue RISCVTargetLowering::LowerFormalArguments(
   const Function *Func = DAG.getMachineFunction().getFunction();
   Function::const_arg_iterator FuncArg = Func->arg_begin();
 
-  CCAssignFn *CC = getCCAssignFn (Subtarget, IsVarArg);
+  if (Func->hasFnAttribute("interrupt")) {
+    if (!Func->arg_empty())
+      report_fatal_error(
+          "Functions with the interrupt attribute cannot have arguments!");
+
+    StringRef Kind = Func->getFnAttribute("interrupt").getValueAsString();
+    if (Kind != "user" && Kind != "supervisor" && Kind != "machine")
+      report_fatal_error(
+          "Function interrupt attribute argument not supported!");
+  }
+
+  // Every incoming argument is a named one.
+  CCAssignFn *CC = getCCAssignFn(Subtarget, /*IsVarArg=*/false);
 
   CCInfo.AnalyzeFormalArguments(Ins, CC);
   FI->setFormalArgInfo(CCInfo.getNextStackOffset(),
@@ -978,7 +2150,17 @@ SDValue RISCVTargetLowering::LowerFormalArguments(
     bool IsRegLoc = VA.isRegLoc();
     SDValue ArgValue;
     // Arguments stored on registers
-    if (IsRegLoc) {
+    if (IsRegLoc && VA.needsCustom()) {
+      // An f64 passed in a pair of GPRs on RV32.
+      assert(VA.getValVT() == MVT::f64 && "Unexpected custom argument");
+      unsigned LoReg = addLiveIn(MF, VA.getLocReg(), &RISCV::GPRRegClass);
+      unsigned HiReg = addLiveIn(MF, getNextArgGPR(Subtarget, VA.getLocReg()),
+                                 &RISCV::GPRRegClass);
+      SDValue Lo = DAG.getCopyFromReg(Chain, DL, LoReg, MVT::i32);
+      SDValue Hi = DAG.getCopyFromReg(Chain, DL, HiReg, MVT::i32);
+      ArgValue = DAG.getNode(ISD::BITCAST, DL, MVT::f64,
+                             DAG.getNode(ISD::BUILD_PAIR, DL, MVT::i64, Lo, Hi));
+    } else if (IsRegLoc) {
       MVT RegVT = VA.getLocVT();
       unsigned ArgReg = VA.getLocReg();
       const TargetRegisterClass *RC = getRegClassFor(RegVT);
@@ -999,9 +2181,13 @@ SDValue RISCVTargetLowering::LowerFormalArguments(
       // sanity check
       assert(VA.isMemLoc());
 
-      // The stack pointer offset is relative to the caller stack frame.
+      // The stack pointer offset is relative to the caller stack frame. With
+      // guaranteed tail calls the slot may be overwritten by the outgoing
+      // arguments of a tail call, so it isn't immutable.
+      bool IsImmutable = !shouldGuaranteeTCO(
+          CallConv, getTargetMachine().Options.GuaranteedTailCallOpt);
       int FrameIdx = MFI.CreateFixedObject(LocVT.getSizeInBits() / 8,
-                                      VA.getLocMemOffset(), true);
+                                           VA.getLocMemOffset(), IsImmutable);
       // Create load nodes to retrieve arguments from the stack
       SDValue FIN = DAG.getFrameIndex(FrameIdx,
                                       getPointerTy(DAG.getDataLayout()));
@@ -1161,6 +2347,120 @@ void RISCVTargetLowering::passByValArg(
   MemOpChains.push_back(Chain);
 }
 
+/// Return true if Arg is a load of the caller's own incoming stack argument
+/// at Offset, so a sibling call can leave it where it is.
+static bool matchingStackOffset(SDValue Arg, unsigned Offset,
+                                MachineFrameInfo &MFI) {
+  LoadSDNode *Ld = dyn_cast<LoadSDNode>(Arg);
+  if (!Ld)
+    return false;
+  FrameIndexSDNode *FINode = dyn_cast<FrameIndexSDNode>(Ld->getBasePtr());
+  if (!FINode)
+    return false;
+  int FI = FINode->getIndex();
+  if (!MFI.isFixedObjectIndex(FI) || !MFI.isImmutableObjectIndex(FI))
+    return false;
+  return Offset == MFI.getObjectOffset(FI) &&
+         Arg.getValueSizeInBits() / 8 == MFI.getObjectSize(FI);
+}
+
+bool RISCVTargetLowering::isEligibleForTailCallOptimization(
+    CCState &CCInfo, CallLoweringInfo &CLI, MachineFunction &MF,
+    const SmallVectorImpl<CCValAssign> &ArgLocs) const {
+  CallingConv::ID CalleeCC = CLI.CallConv;
+  const Function &Caller = *MF.getFunction();
+  CallingConv::ID CallerCC = Caller.getCallingConv();
+  const RISCVMachineFunctionInfo *FI = MF.getInfo<RISCVMachineFunctionInfo>();
+
+  if (!EnableRISCVTailCalls)
+    return false;
+
+  // An interrupt handler has to restore every register it clobbered and
+  // return with a trap return, so it cannot hand its frame to the callee.
+  if (Caller.hasFnAttribute("interrupt"))
+    return false;
+
+  // The register save area of a variadic caller goes away with its frame, and
+  // a va_list pointing into it may be among the arguments.
+  if (Caller.isVarArg())
+    return false;
+
+  // Byval and indirectly passed arguments live in the caller's frame.
+  if (FI->hasByvalArg())
+    return false;
+  for (const ISD::OutputArg &Out : CLI.Outs)
+    if (Out.Flags.isByVal())
+      return false;
+  for (const CCValAssign &VA : ArgLocs)
+    if (VA.getLocInfo() == CCValAssign::Indirect)
+      return false;
+
+  // The callee's stack arguments have to fit in the caller's incoming
+  // argument area, which is the only stack the two share.
+  if (CCInfo.getNextStackOffset() > FI->getIncomingArgSize())
+    return false;
+
+  // With -tailcallopt, fastcc functions always tail call each other; their
+  // stack arguments are stored over the caller's own.
+  if (shouldGuaranteeTCO(CalleeCC, MF.getTarget().Options.GuaranteedTailCallOpt))
+    return CalleeCC == CallerCC;
+
+  // A sibling call must preserve the same registers and return its value in
+  // the same place as the caller.
+  if (CalleeCC != CallerCC)
+    return false;
+
+  // A sibling call doesn't store anything to the stack, so every stack
+  // argument must already be in place.
+  if (CCInfo.getNextStackOffset() != 0) {
+    MachineFrameInfo &MFI = MF.getFrameInfo();
+    for (unsigned I = 0, E = ArgLocs.size(); I != E; ++I) {
+      const CCValAssign &VA = ArgLocs[I];
+      if (!VA.isMemLoc())
+        continue;
+      if (VA.getLocInfo() != CCValAssign::Full ||
+          !matchingStackOffset(CLI.OutVals[I], VA.getLocMemOffset(), MFI))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+SDValue RISCVTargetLowering::addTokenForArgument(SDValue Chain,
+                                                 SelectionDAG &DAG,
+                                                 MachineFrameInfo &MFI,
+                                                 int ClobberedFI) const {
+  SmallVector<SDValue, 8> ArgChains;
+  int64_t FirstByte = MFI.getObjectOffset(ClobberedFI);
+  int64_t LastByte = FirstByte + MFI.getObjectSize(ClobberedFI) - 1;
+
+  // Include the original chain at the beginning of the list.
+  ArgChains.push_back(Chain);
+
+  // Incoming stack arguments are loaded straight off the entry node; add the
+  // chain of every such load that overlaps the clobbered object.
+  for (SDNode *U : DAG.getEntryNode().getNode()->uses())
+    if (LoadSDNode *L = dyn_cast<LoadSDNode>(U))
+      if (FrameIndexSDNode *FINode =
+              dyn_cast<FrameIndexSDNode>(L->getBasePtr()))
+        if (FINode->getIndex() < 0) {
+          int64_t InFirstByte = MFI.getObjectOffset(FINode->getIndex());
+          int64_t InLastByte =
+              InFirstByte + MFI.getObjectSize(FINode->getIndex()) - 1;
+
+          if ((InFirstByte <= FirstByte && FirstByte <= InLastByte) ||
+              (FirstByte <= InFirstByte && InFirstByte <= LastByte))
+            ArgChains.push_back(SDValue(L, 1));
+        }
+
+  return DAG.getNode(ISD::TokenFactor, SDLoc(Chain), MVT::Other, ArgChains);
+}
+
+bool RISCVTargetLowering::mayBeEmittedAsTailCall(const CallInst *CI) const {
+  return EnableRISCVTailCalls && CI->isTailCall();
+}
+
 // Lower a call to a callseq_start + CALL + callseq_end chain, and add input 
 // and output parameter nodes.
 SDValue
@@ -1173,7 +2473,7 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
   SmallVectorImpl<ISD::InputArg> &Ins = CLI.Ins;
   SDValue Chain = CLI.Chain;
   SDValue Callee = CLI.Callee;
-  CLI.IsTailCall = false;
+  bool &IsTailCall = CLI.IsTailCall;
   CallingConv::ID CallConv = CLI.CallConv;
   bool IsVarArg = CLI.IsVarArg;
 
@@ -1185,9 +2485,17 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
   // Analyze the operands of the call, assigning locations to each operand.
   SmallVector<CCValAssign, 16> ArgLocs;
   CCState ArgCCInfo(CallConv, IsVarArg, MF, ArgLocs, *DAG.getContext());
-  CCAssignFn *CC = getCCAssignFn (Subtarget, IsVarArg);
-  ArgCCInfo.AnalyzeCallOperands(Outs, CC);
+  analyzeCallOperands(ArgCCInfo, Subtarget, Outs, IsVarArg);
+
+  // Check if it's really possible to do a tail call.
+  if (IsTailCall)
+    IsTailCall = isEligibleForTailCallOptimization(ArgCCInfo, CLI, MF, ArgLocs);
 
+  if (IsTailCall)
+    ++NumTailCalls;
+  else if (CLI.CS && CLI.CS->isMustTailCall())
+    report_fatal_error("failed to perform tail call elimination on a call "
+                       "site marked musttail");
 
   // Get a count of how many bytes are to be pushed on the stack.
   unsigned NextStackOffset = ArgCCInfo.getNextStackOffset();
@@ -1199,7 +2507,7 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
   NextStackOffset = alignTo(NextStackOffset, StackAlignment);
   SDValue NextStackOffsetVal = DAG.getIntPtrConstant(NextStackOffset, DL, true);
 
-  if (!CLI.IsTailCall)
+  if (!IsTailCall)
     Chain = DAG.getCALLSEQ_START(Chain, NextStackOffset, 0, DL);
 
   // Copy argument values to their designated locations.
@@ -1249,7 +2557,7 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
         assert(Flags.getByValSize() &&
                "ByVal args of size 0 should have been ignored by front-end.");
         assert(ByValIdx < ArgCCInfo.getInRegsParamsCount());
-        assert(!CLI.IsTailCall &&
+        assert(!IsTailCall &&
                "Do not tail-call optimize if there is a byval argument.");
         passByValArg(Chain, DL, RegsToPass, MemOpChains, StackPtr, MFI, DAG, Arg,
                      FirstByValReg, LastByValReg, Flags, true, VA);
@@ -1278,6 +2586,21 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
       continue;
     }
 
+    if (VA.needsCustom()) {
+      // An f64 passed in a pair of GPRs on RV32.
+      assert(VA.isRegLoc() && VA.getValVT() == MVT::f64 &&
+             "Unexpected custom argument");
+      SDValue AsI64 = DAG.getNode(ISD::BITCAST, DL, MVT::i64, Arg);
+      SDValue Lo = DAG.getNode(ISD::EXTRACT_ELEMENT, DL, MVT::i32, AsI64,
+                               DAG.getIntPtrConstant(0, DL));
+      SDValue Hi = DAG.getNode(ISD::EXTRACT_ELEMENT, DL, MVT::i32, AsI64,
+                               DAG.getIntPtrConstant(1, DL));
+      RegsToPass.push_back(std::make_pair(VA.getLocReg(), Lo));
+      RegsToPass.push_back(
+          std::make_pair(getNextArgGPR(Subtarget, VA.getLocReg()), Hi));
+      continue;
+    }
+
     // Promote the value if needed.
     switch (VA.getLocInfo()) {
     default: llvm_unreachable("Unknown loc info!");
@@ -1291,6 +2614,10 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
       Arg = DAG.getNode(ISD::ZERO_EXTEND, DL, VA.getLocVT(), Arg);
       break;
     case CCValAssign::AExt:
+      // f32 is bit-converted to i32 and then any-extended on RV64.
+      if (Arg.getValueType().isFloatingPoint())
+        Arg = DAG.getNode(ISD::BITCAST, DL,
+                          Arg.getValueType().changeTypeToInteger(), Arg);
       Arg = DAG.getNode(ISD::ANY_EXTEND, DL, VA.getLocVT(), Arg);
       break;
     case CCValAssign::BCvt:
@@ -1300,11 +2627,23 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
 
     if (VA.isRegLoc()) {
       RegsToPass.push_back(std::make_pair(VA.getLocReg(), Arg));
-    } else {
+    } else if (!IsTailCall) {
       assert(VA.isMemLoc());
       MemOpChains.push_back(LowerMemOpCallTo(Chain, StackPtr, Arg,
                                              DL, DAG, VA, Flags));
+    } else if (shouldGuaranteeTCO(CallConv,
+                                  MF.getTarget().Options.GuaranteedTailCallOpt)) {
+      // Overwrite the caller's incoming argument area, after any incoming
+      // argument stored there has been read.
+      int FI = MFI.CreateFixedObject(VA.getLocVT().getSizeInBits() / 8,
+                                     VA.getLocMemOffset(), true);
+      SDValue FIN = DAG.getFrameIndex(FI, PtrVT);
+      SDValue ArgChain = addTokenForArgument(Chain, DAG, MFI, FI);
+      MemOpChains.push_back(
+          DAG.getStore(ArgChain, DL, Arg, FIN,
+                       MachinePointerInfo::getFixedStack(MF, FI)));
     }
+    // Otherwise this is a sibling call and the argument is already in place.
   }
 
   if (!MemOpChains.empty())
@@ -1320,10 +2659,21 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
     InFlag = Chain.getValue(1);
   }
 
-  if (isa<GlobalAddressSDNode>(Callee)) {
-    Callee = lowerGlobalAddress(Callee, DAG);
-  } else if (isa<ExternalSymbolSDNode>(Callee)) {
-    Callee = lowerExternalSymbol(Callee, DAG);
+  // Direct calls are emitted as "call sym", which the assembler expands to a
+  // relaxable AUIPC+JALR pair. Calls to symbols that may be preempted go
+  // through the PLT.
+  if (GlobalAddressSDNode *S = dyn_cast<GlobalAddressSDNode>(Callee)) {
+    const GlobalValue *GV = S->getGlobal();
+    unsigned OpFlags = RISCVII::MO_CALL;
+    if (!getTargetMachine().shouldAssumeDSOLocal(*GV->getParent(), GV))
+      OpFlags = RISCVII::MO_PLT;
+    Callee = DAG.getTargetGlobalAddress(GV, DL, PtrVT, S->getOffset(), OpFlags);
+  } else if (ExternalSymbolSDNode *S = dyn_cast<ExternalSymbolSDNode>(Callee)) {
+    unsigned OpFlags = RISCVII::MO_CALL;
+    if (!getTargetMachine().shouldAssumeDSOLocal(*MF.getFunction()->getParent(),
+                                                 nullptr))
+      OpFlags = RISCVII::MO_PLT;
+    Callee = DAG.getTargetExternalSymbol(S->getSymbol(), PtrVT, OpFlags);
   }
 
   // The first call operand is the chain and the second is the target address.
@@ -1349,6 +2699,11 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
   if (InFlag.getNode())
     Ops.push_back(InFlag);
 
+  if (IsTailCall) {
+    MF.getFrameInfo().setHasTailCall();
+    return DAG.getNode(RISCVISD::TAIL, DL, MVT::Other, Ops);
+  }
+
   SDVTList NodeTys = DAG.getVTList(MVT::Other, MVT::Glue);
   Chain = DAG.getNode(RISCVISD::CALL, DL, NodeTys, Ops);
   InFlag = Chain.getValue(1);
@@ -1488,6 +2843,25 @@ RISCVTargetLowering::LowerReturn(SDValue Chain, CallingConv::ID CallConv,
     RetOps.push_back(Flag);
   }
 
+  // Interrupt handlers return with the trap-return instruction of the
+  // privilege level they run at.
+  const Function *Func = DAG.getMachineFunction().getFunction();
+  if (Func->hasFnAttribute("interrupt")) {
+    if (!Func->getReturnType()->isVoidTy())
+      report_fatal_error(
+          "Functions with the interrupt attribute must have void return type!");
+
+    StringRef Kind = Func->getFnAttribute("interrupt").getValueAsString();
+    unsigned RetOpc;
+    if (Kind == "user")
+      RetOpc = RISCVISD::URET_FLAG;
+    else if (Kind == "supervisor")
+      RetOpc = RISCVISD::SRET_FLAG;
+    else
+      RetOpc = RISCVISD::MRET_FLAG;
+    return DAG.getNode(RetOpc, DL, MVT::Other, RetOps);
+  }
+
   return DAG.getNode(RISCVISD::RET_FLAG, DL, MVT::Other, RetOps);
 }
 
@@ -1497,10 +2871,46 @@ const char *RISCVTargetLowering::getTargetNodeName(unsigned Opcode) const {
     break;
   case RISCVISD::RET_FLAG:
     return "RISCVISD::RET_FLAG";
+  case RISCVISD::URET_FLAG:
+    return "RISCVISD::URET_FLAG";
+  case RISCVISD::SRET_FLAG:
+    return "RISCVISD::SRET_FLAG";
+  case RISCVISD::MRET_FLAG:
+    return "RISCVISD::MRET_FLAG";
   case RISCVISD::CALL:
     return "RISCVISD::CALL";
+  case RISCVISD::TAIL:
+    return "RISCVISD::TAIL";
   case RISCVISD::SELECT_CC:
     return "RISCVISD::SELECT_CC";
+  case RISCVISD::VSHL:
+    return "RISCVISD::VSHL";
+  case RISCVISD::VSRL:
+    return "RISCVISD::VSRL";
+  case RISCVISD::VSRA:
+    return "RISCVISD::VSRA";
+  case RISCVISD::MEMCPY_LOOP:
+    return "RISCVISD::MEMCPY_LOOP";
+  case RISCVISD::MEMSET_LOOP:
+    return "RISCVISD::MEMSET_LOOP";
+  case RISCVISD::MASKED_ATOMIC_SWAP:
+    return "RISCVISD::MASKED_ATOMIC_SWAP";
+  case RISCVISD::MASKED_ATOMIC_LOAD_ADD:
+    return "RISCVISD::MASKED_ATOMIC_LOAD_ADD";
+  case RISCVISD::MASKED_ATOMIC_LOAD_SUB:
+    return "RISCVISD::MASKED_ATOMIC_LOAD_SUB";
+  case RISCVISD::MASKED_ATOMIC_LOAD_NAND:
+    return "RISCVISD::MASKED_ATOMIC_LOAD_NAND";
+  case RISCVISD::MASKED_ATOMIC_LOAD_MAX:
+    return "RISCVISD::MASKED_ATOMIC_LOAD_MAX";
+  case RISCVISD::MASKED_ATOMIC_LOAD_MIN:
+    return "RISCVISD::MASKED_ATOMIC_LOAD_MIN";
+  case RISCVISD::MASKED_ATOMIC_LOAD_UMAX:
+    return "RISCVISD::MASKED_ATOMIC_LOAD_UMAX";
+  case RISCVISD::MASKED_ATOMIC_LOAD_UMIN:
+    return "RISCVISD::MASKED_ATOMIC_LOAD_UMIN";
+  case RISCVISD::MASKED_CMP_SWAP:
+    return "RISCVISD::MASKED_CMP_SWAP";
   }
   return nullptr;
 }
@@ -1512,6 +2922,45 @@ EVT RISCVTargetLowering::getSetCCResultType(const DataLayout &, LLVMContext &,
   return VT.changeVectorElementTypeToInteger();
 }
 
+Instruction *RISCVTargetLowering::emitLeadingFence(IRBuilder<> &Builder,
+                                                   Instruction *Inst,
+                                                   AtomicOrdering Ord) const {
+  if (isa<LoadInst>(Inst) && Ord == AtomicOrdering::SequentiallyConsistent)
+    return Builder.CreateFence(Ord);
+  if (isa<StoreInst>(Inst) && isReleaseOrStronger(Ord))
+    return Builder.CreateFence(AtomicOrdering::Release);
+  return nullptr;
+}
+
+Instruction *RISCVTargetLowering::emitTrailingFence(IRBuilder<> &Builder,
+                                                    Instruction *Inst,
+                                                    AtomicOrdering Ord) const {
+  if (isa<LoadInst>(Inst) && isAcquireOrStronger(Ord))
+    return Builder.CreateFence(AtomicOrdering::Acquire);
+  return nullptr;
+}
+
+TargetLowering::AtomicExpansionKind
+RISCVTargetLowering::shouldExpandAtomicRMWInIR(AtomicRMWInst *AI) const {
+  // There is no amonand. Sub-word operations, nand included, are lowered on
+  // the containing word instead.
+  unsigned Size = AI->getType()->getPrimitiveSizeInBits();
+  if (Size >= 32 && AI->getOperation() == AtomicRMWInst::Nand)
+    return AtomicExpansionKind::CmpXChg;
+  return AtomicExpansionKind::None;
+}
+
+bool RISCVTargetLowering::isFPImmLegal(const APFloat &Imm, EVT VT) const {
+  // +0.0 is materialized with a move from x0.
+  return isTypeLegal(VT) && Imm.isPosZero();
+}
+
+bool RISCVTargetLowering::isFMAFasterThanFMulAndFAdd(EVT VT) const {
+  VT = VT.getScalarType();
+  return VT.isSimple() && isTypeLegal(VT) &&
+         (VT == MVT::f32 || VT == MVT::f64);
+}
+
 bool
 RISCVTargetLowering::isOffsetFoldingLegal(const GlobalAddressSDNode *GA) const {
   // The RISCV target isn't yet aware of offsets.
@@ -16,17 +16,51 @@
 #define LLVM_LIB_TARGET_RISCV_RISCVISELLOWERING_H
 
 #include "RISCV.h"
+#include "llvm/CodeGen/CallingConvLower.h"
 #include "llvm/CodeGen/SelectionDAG.h"
 #include "llvm/Target/TargetLowering.h"
 
 namespace llvm {
 class RISCVSubtarget;
+
+namespace RISCV {
+FastISel *createFastISel(FunctionLoweringInfo &FuncInfo,
+                         const TargetLibraryInfo *LibInfo);
+}
+
 namespace RISCVISD {
 enum NodeType : unsigned {
   FIRST_NUMBER = ISD::BUILTIN_OP_END,
   RET_FLAG,
+  // Returns from an interrupt handler.
+  URET_FLAG,
+  SRET_FLAG,
+  MRET_FLAG,
   CALL,
-  SELECT_CC
+  TAIL,
+  SELECT_CC,
+  // Packed-SIMD shifts of every lane by the same scalar amount.
+  VSHL,
+  VSRL,
+  VSRA,
+  // Word-by-word copy and fill loops for memcpy and memset. Operands are the
+  // destination, the source address or splatted fill value, the number of
+  // bytes and the word size.
+  MEMCPY_LOOP,
+  MEMSET_LOOP,
+  // i8 and i16 atomics on the aligned word that contains them. Operands are
+  // the word address, the value shifted into place (the compare and new
+  // values for MASKED_CMP_SWAP), the mask of the bits that may change, the
+  // sign-extension shift for signed min and max, and the ordering.
+  MASKED_ATOMIC_SWAP = ISD::FIRST_TARGET_MEMORY_OPCODE,
+  MASKED_ATOMIC_LOAD_ADD,
+  MASKED_ATOMIC_LOAD_SUB,
+  MASKED_ATOMIC_LOAD_NAND,
+  MASKED_ATOMIC_LOAD_MAX,
+  MASKED_ATOMIC_LOAD_MIN,
+  MASKED_ATOMIC_LOAD_UMAX,
+  MASKED_ATOMIC_LOAD_UMIN,
+  MASKED_CMP_SWAP
 };
 }
 
@@ -40,6 +74,8 @@ public:
   // Provide custom lowering hooks for some operations.
   SDValue LowerOperation(SDValue Op, SelectionDAG &DAG) const override;
 
+  SDValue PerformDAGCombine(SDNode *N, DAGCombinerInfo &DCI) const override;
+
   /// ReplaceNodeResults - Replace the results of node with an illegal result
   /// type with new values built out of custom code.
   ///
@@ -56,6 +92,12 @@ public:
     return MVT::i32;
   }
 
+  bool useCompactJumpTables() const;
+  unsigned getJumpTableEncoding() const override;
+
+  bool isCheapToSpeculateCttz() const override;
+  bool isCheapToSpeculateCtlz() const override;
+
   // This method returns the name of a target specific DAG node.
   const char *getTargetNodeName(unsigned Opcode) const override;
 
@@ -67,6 +109,42 @@ public:
   EVT getSetCCResultType(const DataLayout &DL, LLVMContext &Context,
                          EVT VT) const override;
 
+  // Atomic loads and stores are plain loads and stores bracketed by fences;
+  // read-modify-write operations carry their ordering in the aq/rl bits.
+  bool shouldInsertFencesForAtomic(const Instruction *I) const override {
+    return isa<LoadInst>(I) || isa<StoreInst>(I);
+  }
+  Instruction *emitLeadingFence(IRBuilder<> &Builder, Instruction *Inst,
+                                AtomicOrdering Ord) const override;
+  Instruction *emitTrailingFence(IRBuilder<> &Builder, Instruction *Inst,
+                                 AtomicOrdering Ord) const override;
+
+  TargetLowering::AtomicExpansionKind
+  shouldExpandAtomicRMWInIR(AtomicRMWInst *AI) const override;
+
+  // Only the halfword shuffles of v2i16 map onto the pack instructions.
+  bool isShuffleMaskLegal(const SmallVectorImpl<int> &Mask,
+                          EVT VT) const override;
+
+  FastISel *createFastISel(FunctionLoweringInfo &FuncInfo,
+                           const TargetLibraryInfo *LibInfo) const override;
+
+  // Packed-SIMD types are passed in GPRs like integers of the same size,
+  // whether or not the P extension makes them legal.
+  MVT getRegisterTypeForCallingConv(MVT VT) const override;
+  MVT getRegisterTypeForCallingConv(LLVMContext &Context,
+                                    EVT VT) const override;
+  unsigned getNumRegistersForCallingConv(LLVMContext &Context,
+                                         EVT VT) const override;
+  unsigned getVectorTypeBreakdownForCallingConv(
+      LLVMContext &Context, EVT VT, EVT &IntermediateVT,
+      unsigned &NumIntermediates, MVT &RegisterVT) const override;
+
+  // The calling convention functions used for calls and returns, shared with
+  // FastISel.
+  CCAssignFn *CCAssignFnForCall(bool IsVarArg) const;
+  CCAssignFn *CCAssignFnForReturn() const;
+
 private:
   // Lower incoming arguments, copy physregs into vregs
   SDValue LowerFormalArguments(SDValue Chain, CallingConv::ID CallConv,
@@ -90,10 +168,18 @@ private:
                                          Type *Ty) const override {
     return true;
   }
+  bool usePCRelAddressing() const;
+  SDValue getPCRelAddr(SDValue Addr, const SDLoc &DL, EVT Ty,
+                       SelectionDAG &DAG, bool IsLocal) const;
   SDValue lowerGlobalAddress(SDValue Op, SelectionDAG &DAG) const;
+  SDValue getStaticTLSAddr(GlobalAddressSDNode *N, SelectionDAG &DAG,
+                           bool UseGOT) const;
+  SDValue getDynamicTLSAddr(GlobalAddressSDNode *N, SelectionDAG &DAG) const;
+  SDValue lowerGlobalTLSAddress(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerBlockAddress(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerExternalSymbol(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerJumpTable(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerBR_JT(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerVASTART(SDValue Op, SelectionDAG &DAG) const;
 
@@ -104,6 +190,21 @@ private:
 
   SDValue lowerUMULO_SMULO(SDValue Op, SelectionDAG &DAG) const;
 
+  SDValue lowerBUILD_VECTOR(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerEXTRACT_VECTOR_ELT(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerVectorShift(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerVECTOR_SHUFFLE(SDValue Op, SelectionDAG &DAG) const;
+
+  SDValue lowerBSWAP(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerCTPOP(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerPartwordAtomic(SDValue Op, SelectionDAG &DAG) const;
+
+  SDValue performMULCombine(SDNode *N, SelectionDAG &DAG) const;
+  SDValue performDIVCombine(SDNode *N, SelectionDAG &DAG) const;
+
+  MachineBasicBlock *emitMemLoop(MachineInstr &MI,
+                                 MachineBasicBlock *BB) const;
+
 
   typedef SmallVector<std::pair<unsigned, SDValue>, 8> RegsToPassVector;
 
@@ -147,6 +248,23 @@ private:
                                StringRef Constraint, MVT VT) const override;
 
   bool isOffsetFoldingLegal(const GlobalAddressSDNode *GA) const override;
+
+  bool isFPImmLegal(const APFloat &Imm, EVT VT) const override;
+
+  bool isFMAFasterThanFMulAndFAdd(EVT VT) const override;
+
+  bool mayBeEmittedAsTailCall(const CallInst *CI) const override;
+
+  /// isEligibleForTailCallOptimization - Check whether the call is eligible
+  /// for tail call optimization.
+  bool isEligibleForTailCallOptimization(
+      CCState &CCInfo, CallLoweringInfo &CLI, MachineFunction &MF,
+      const SmallVectorImpl<CCValAssign> &ArgLocs) const;
+
+  /// addTokenForArgument - Chain the incoming argument loads that overlap the
+  /// fixed stack object ClobberedFI in front of a store to it.
+  SDValue addTokenForArgument(SDValue Chain, SelectionDAG &DAG,
+                              MachineFrameInfo &MFI, int ClobberedFI) const;
 };
 }
 
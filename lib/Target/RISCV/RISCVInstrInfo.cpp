@@ -33,28 +33,15 @@ RISCVInstrInfo::RISCVInstrInfo(RISCVSubtarget &sti)
     RI(sti), STI(sti) {
   if (sti.isRV32()) {
     UncondBranch = RISCV::PseudoBR;
-    CADDI16SP = RISCV::CADDI16SP;
-    CADDI = RISCV::CADDI;
-    CLUI = RISCV::CLUI;
     ADDI = RISCV::ADDI;
     ADD = RISCV::ADD;
     LUI = RISCV::LUI;
-    CMV = RISCV::CMV;
-    CLI = RISCV::CLI;
   } else {
     UncondBranch = RISCV::PseudoBR64;
-    CADDI16SP = RISCV::CADDI16SP64;
-    CADDI = RISCV::CADDI64;
-    CLUI = RISCV::CLUI64;
     ADDI = RISCV::ADDI64;
     ADD = RISCV::ADD64;
     LUI = RISCV::LUI64;
-    CMV = RISCV::CMV64;
-    CLI = RISCV::CLI64;
   }
-
-  if (sti.hasC())
-    UncondBranch = RISCV::CJ;
 }
 
 void RISCVInstrInfo::copyPhysReg(MachineBasicBlock &MBB,
@@ -63,33 +50,48 @@ void RISCVInstrInfo::copyPhysReg(MachineBasicBlock &MBB,
                                  unsigned DestinationRegister,
                                  unsigned SourceRegister,
                                  bool KillSource) const {
-  if (STI.isRV64() && RISCV::GPRRegClass.contains(DestinationRegister)) {
-    BuildMI(MBB, Position, DL, get(RISCV::ADDIW), DestinationRegister)
+  if (RISCV::FPR32RegClass.contains(DestinationRegister, SourceRegister) ||
+      RISCV::FPR64RegClass.contains(DestinationRegister, SourceRegister)) {
+    unsigned Opc = RISCV::FPR32RegClass.contains(DestinationRegister)
+                       ? RISCV::FSGNJ_S
+                       : RISCV::FSGNJ_D;
+    BuildMI(MBB, Position, DL, get(Opc), DestinationRegister)
       .addReg(SourceRegister, getKillRegState(KillSource))
-      .addImm(0);
+      .addReg(SourceRegister, getKillRegState(KillSource));
     return;
   }
 
-  if (STI.hasC()) {
-    BuildMI(MBB, Position, DL, get(CMV), DestinationRegister)
-      .addReg(SourceRegister, getKillRegState(KillSource));
-  } else {
-    BuildMI(MBB, Position, DL, get(ADDI), DestinationRegister)
+  if (STI.isRV64() && RISCV::GPRRegClass.contains(DestinationRegister)) {
+    BuildMI(MBB, Position, DL, get(RISCV::ADDIW), DestinationRegister)
       .addReg(SourceRegister, getKillRegState(KillSource))
       .addImm(0);
+    return;
   }
+
+  BuildMI(MBB, Position, DL, get(ADDI), DestinationRegister)
+    .addReg(SourceRegister, getKillRegState(KillSource))
+    .addImm(0);
 }
 
 void RISCVInstrInfo::getLoadStoreOpcodes(const TargetRegisterClass *RC,
                                          unsigned &LoadOpcode,
                                          unsigned &StoreOpcode) const {
-  if (RC == &RISCV::GPRRegClass || RC == &RISCV::GPRCRegClass) {
+  // Callee-saved spills pass the minimal class of the register, which may be
+  // one of the restricted subclasses (GPRC, GPRTC, GPRNoX0, ...).
+  if (RISCV::GPRRegClass.hasSubClassEq(RC) ||
+      RISCV::GPRPRegClass.hasSubClassEq(RC)) {
     LoadOpcode = RISCV::LW;
     StoreOpcode = RISCV::SW;
-  } else if (RC == &RISCV::GPR64RegClass ||
-             RC == &RISCV::GPR64CRegClass) {
+  } else if (RISCV::GPR64RegClass.hasSubClassEq(RC) ||
+             RISCV::GPR64PRegClass.hasSubClassEq(RC)) {
     LoadOpcode = RISCV::LD;
     StoreOpcode = RISCV::SD;
+  } else if (RISCV::FPR32RegClass.hasSubClassEq(RC)) {
+    LoadOpcode = RISCV::FLW;
+    StoreOpcode = RISCV::FSW;
+  } else if (RISCV::FPR64RegClass.hasSubClassEq(RC)) {
+    LoadOpcode = RISCV::FLD;
+    StoreOpcode = RISCV::FSD;
   } else
     llvm_unreachable("Unsupported regclass to load or store");
 }
@@ -137,19 +139,9 @@ void RISCVInstrInfo::adjustStackPtr(unsigned SP, int64_t Amount,
     return;
 
   if (isInt<12>(Amount)) {
-    if (isInt<10>(Amount) && ((Amount % 16) == 0) && STI.hasC()) {
-      // c.addi16sp amount
-      BuildMI(MBB, I, DL, get(CADDI16SP), SP).
-        addReg(SP).addImm(Amount);
-    } else if (isInt<6>(Amount) && STI.hasC()) {
-      // c.addi sp amount
-      BuildMI(MBB, I, DL, get(CADDI), SP).
-        addReg(SP).addImm(Amount);
-    } else {
-      // addi sp, sp, amount
-      BuildMI(MBB, I, DL, get(ADDI), SP).
-        addReg(SP).addImm(Amount);
-    }
+    // addi sp, sp, amount
+    BuildMI(MBB, I, DL, get(ADDI), SP).
+      addReg(SP).addImm(Amount);
   } else {
     basePlusImmediate (SP, SP, Amount, MBB, I, DL);
   }
@@ -169,30 +161,20 @@ void RISCVInstrInfo::loadImmediate(unsigned ScratchReg,
 
   int64_t LuiImm = ((Imm + 0x800) >> 12) & 0xfffff;
   int64_t LowImm = SignExtend64<12>(Imm);
-  unsigned LuiOpcode = LUI;
-
-  if (isUInt<5>(LuiImm) && STI.hasC())
-    LuiOpcode = CLUI;
 
   if ((LuiImm != 0) && (LowImm == 0)) {
-    BuildMI(MBB, II, DL, get(LuiOpcode), ScratchReg)
+    BuildMI(MBB, II, DL, get(LUI), ScratchReg)
       .addImm(LuiImm);
   } else if ((LuiImm == 0) && (LowImm != 0)) {
-    if (isInt<6>(LowImm) && STI.hasC()) {
-      // c.li
-      BuildMI(MBB, II, DL, get(CLI), ScratchReg)
-        .addImm(LowImm);
-    } else {
-      BuildMI(MBB, II, DL, get(ADDI), ScratchReg)
-        .addReg(ZeroReg)
-        .addImm(LowImm);
-    }
+    BuildMI(MBB, II, DL, get(ADDI), ScratchReg)
+      .addReg(ZeroReg)
+      .addImm(LowImm);
   } else {
     // Create TempReg here because Virtual register expect as SSA form.
     // So ADDI ScratchReg, ScratchReg, Imm is not allow.
     unsigned TempReg = RegInfo.createVirtualRegister(RC);
 
-    BuildMI(MBB, II, DL, get(LuiOpcode), TempReg)
+    BuildMI(MBB, II, DL, get(LUI), TempReg)
       .addImm(LuiImm);
 
     BuildMI(MBB, II, DL, get(ADDI), ScratchReg)
@@ -234,12 +216,8 @@ RISCVInstrInfo::basePlusImmediateStripOffset(unsigned BaseReg, int64_t &Imm,
   unsigned ScratchReg2 = RegInfo.createVirtualRegister(RC);
 
   int64_t LuiImm = ((Imm + 0x800) >> 12) & 0xfffff;
-  unsigned LuiOpcode = LUI;
-
-  if (isUInt<5>(LuiImm) && STI.hasC())
-    LuiOpcode = CLUI;
 
-  BuildMI(MBB, II, DL, get(LuiOpcode), ScratchReg1)
+  BuildMI(MBB, II, DL, get(LUI), ScratchReg1)
     .addImm(LuiImm);
 
   BuildMI(MBB, II, DL, get(ADD), ScratchReg2)
@@ -290,7 +268,15 @@ static bool isCondBranch(unsigned Opcode) {
       Opcode == RISCV::CBEQZ ||
       Opcode == RISCV::CBNEZ ||
       Opcode == RISCV::CBEQZ64 ||
-      Opcode == RISCV::CBNEZ64)
+      Opcode == RISCV::CBNEZ64 ||
+      Opcode == RISCV::BEQC ||
+      Opcode == RISCV::BNEC ||
+      Opcode == RISCV::BBC ||
+      Opcode == RISCV::BBS ||
+      Opcode == RISCV::BEQC64 ||
+      Opcode == RISCV::BNEC64 ||
+      Opcode == RISCV::BBC64 ||
+      Opcode == RISCV::BBS64)
     return true;
   return false;
 }
@@ -494,6 +480,14 @@ unsigned RISCVInstrInfo::getOppositeBranchOpc(unsigned Opc) const {
   case RISCV::CBNEZ:   return RISCV::CBEQZ;
   case RISCV::CBEQZ64: return RISCV::CBNEZ64;
   case RISCV::CBNEZ64: return RISCV::CBEQZ64;
+  case RISCV::BEQC:    return RISCV::BNEC;
+  case RISCV::BNEC:    return RISCV::BEQC;
+  case RISCV::BBC:     return RISCV::BBS;
+  case RISCV::BBS:     return RISCV::BBC;
+  case RISCV::BEQC64:  return RISCV::BNEC64;
+  case RISCV::BNEC64:  return RISCV::BEQC64;
+  case RISCV::BBC64:   return RISCV::BBS64;
+  case RISCV::BBS64:   return RISCV::BBC64;
   }
 }
 
@@ -514,6 +508,15 @@ static unsigned getBranchDisplacementBits(unsigned Opc) {
   case RISCV::CBEQZ64:
   case RISCV::CBNEZ64:
     return 9;
+  case RISCV::BEQC:
+  case RISCV::BNEC:
+  case RISCV::BBC:
+  case RISCV::BBS:
+  case RISCV::BEQC64:
+  case RISCV::BNEC64:
+  case RISCV::BBC64:
+  case RISCV::BBS64:
+    return 11;
   case RISCV::CJ:
   case RISCV::CJ64:
     return 12;
@@ -573,6 +576,14 @@ MachineBasicBlock *RISCVInstrInfo::getBranchDestBlock(
   case RISCV::BGE64:
   case RISCV::BLTU64:
   case RISCV::BGEU64:
+  case RISCV::BEQC:
+  case RISCV::BNEC:
+  case RISCV::BBC:
+  case RISCV::BBS:
+  case RISCV::BEQC64:
+  case RISCV::BNEC64:
+  case RISCV::BBC64:
+  case RISCV::BBS64:
     return MI.getOperand(2).getMBB();
   }
 }
@@ -587,14 +598,32 @@ unsigned RISCVInstrInfo::getInstSizeInBytes(const MachineInstr &MI) const {
     break;
   case RISCV::PseudoRET:
   case RISCV::PseudoRET64:
-  case RISCV::PseudoCALL:
-  case RISCV::PseudoCALL64:
+  case RISCV::PseudoCALLIndirect:
+  case RISCV::PseudoCALLIndirect64:
+  case RISCV::PseudoTAILIndirect:
+  case RISCV::PseudoTAILIndirect64:
   case RISCV::PseudoBR:
   case RISCV::PseudoBR64:
   case RISCV::PseudoBRIND:
   case RISCV::PseudoBRIND64:
     NumBytes = 4;
     break;
+  case RISCV::PseudoCALL:
+  case RISCV::PseudoCALL64:
+  case RISCV::PseudoCALLReg:
+  case RISCV::PseudoCALLReg64:
+  case RISCV::PseudoTAIL:
+  case RISCV::PseudoTAIL64:
+  case RISCV::PseudoLLA:
+  case RISCV::PseudoLLA64:
+  case RISCV::PseudoLA:
+  case RISCV::PseudoLA64:
+  case RISCV::PseudoLA_TLS_IE:
+  case RISCV::PseudoLA_TLS_IE64:
+  case RISCV::PseudoLA_TLS_GD:
+  case RISCV::PseudoLA_TLS_GD64:
+    NumBytes = 8;
+    break;
   }
 
   return NumBytes;
@@ -613,3 +642,222 @@ unsigned RISCVInstrInfo::insertIndirectBranch(MachineBasicBlock &MBB,
   }
   llvm_unreachable("Not support relax to indirect branch yet");
 }
+
+// Return true if Reg is known to hold zero.
+static bool isZeroReg(unsigned Reg, const MachineRegisterInfo &MRI) {
+  if (Reg == RISCV::X0_32 || Reg == RISCV::X0_64)
+    return true;
+  if (!TargetRegisterInfo::isVirtualRegister(Reg))
+    return false;
+
+  const MachineInstr *MI = MRI.getVRegDef(Reg);
+  if (!MI)
+    return false;
+
+  switch (MI->getOpcode()) {
+  default:
+    return false;
+  case RISCV::COPY:
+    return MI->getOperand(1).getReg() == RISCV::X0_32 ||
+           MI->getOperand(1).getReg() == RISCV::X0_64;
+  case RISCV::ADDI:
+  case RISCV::ADDIW:
+  case RISCV::ADDI64:
+    return MI->getOperand(1).isReg() && MI->getOperand(2).isImm() &&
+           MI->getOperand(2).getImm() == 0 &&
+           isZeroReg(MI->getOperand(1).getReg(), MRI);
+  case RISCV::MOVi64imm:
+    return MI->getOperand(1).isImm() && MI->getOperand(1).getImm() == 0;
+  }
+}
+
+// The conditions of the register-register branches are materialized with a
+// single slt/sltu, or with xor plus sltu for the equality tests. Inverted is
+// set when the branch is taken on a 0 result.
+namespace {
+struct SelectCond {
+  bool Is64;
+  bool IsEquality;
+  bool IsUnsigned;
+  bool Inverted;
+};
+} // end anonymous namespace
+
+static bool analyzeSelectBranch(unsigned BrOpc, SelectCond &SC) {
+  SC = SelectCond{false, false, false, false};
+  switch (BrOpc) {
+  default:
+    return false;
+  case RISCV::BEQ64:  SC.Is64 = true; LLVM_FALLTHROUGH;
+  case RISCV::BEQ:    SC.IsEquality = true; SC.Inverted = true; break;
+  case RISCV::BNE64:  SC.Is64 = true; LLVM_FALLTHROUGH;
+  case RISCV::BNE:    SC.IsEquality = true; break;
+  case RISCV::BLT64:  SC.Is64 = true; LLVM_FALLTHROUGH;
+  case RISCV::BLT:    break;
+  case RISCV::BGE64:  SC.Is64 = true; LLVM_FALLTHROUGH;
+  case RISCV::BGE:    SC.Inverted = true; break;
+  case RISCV::BLTU64: SC.Is64 = true; LLVM_FALLTHROUGH;
+  case RISCV::BLTU:   SC.IsUnsigned = true; break;
+  case RISCV::BGEU64: SC.Is64 = true; LLVM_FALLTHROUGH;
+  case RISCV::BGEU:   SC.IsUnsigned = true; SC.Inverted = true; break;
+  }
+  return true;
+}
+
+unsigned RISCVInstrInfo::getBranchlessSelectCost(
+    unsigned BrOpc, unsigned LHS, unsigned RHS, unsigned TrueReg,
+    unsigned FalseReg, const MachineRegisterInfo &MRI,
+    unsigned &CondCost) const {
+  SelectCond SC;
+  if (!analyzeSelectBranch(BrOpc, SC))
+    return 0;
+
+  // Comparing against zero needs no xor.
+  CondCost = 1;
+  if (SC.IsEquality && !isZeroReg(LHS, MRI) && !isZeroReg(RHS, MRI))
+    ++CondCost;
+
+  // x & -c or x & (c - 1) when one side is zero, otherwise
+  // F ^ ((T ^ F) & -c).
+  if (isZeroReg(TrueReg, MRI) || isZeroReg(FalseReg, MRI))
+    return CondCost + 2;
+  return CondCost + 4;
+}
+
+void RISCVInstrInfo::buildBranchlessSelect(
+    MachineBasicBlock &MBB, MachineBasicBlock::iterator I, const DebugLoc &DL,
+    unsigned DstReg, unsigned BrOpc, unsigned LHS, unsigned RHS,
+    unsigned TrueReg, unsigned FalseReg) const {
+  MachineRegisterInfo &MRI = MBB.getParent()->getRegInfo();
+  SelectCond SC;
+  bool Valid = analyzeSelectBranch(BrOpc, SC);
+  assert(Valid && "Unexpected select condition");
+  (void)Valid;
+
+  bool Is64Val = STI.isRV64() &&
+                 RISCV::GPR64RegClass.hasSubClassEq(MRI.getRegClass(DstReg));
+  const TargetRegisterClass *CmpRC =
+      SC.Is64 ? &RISCV::GPR64RegClass : &RISCV::GPRRegClass;
+  const TargetRegisterClass *ValRC =
+      Is64Val ? &RISCV::GPR64RegClass : &RISCV::GPRRegClass;
+  unsigned CmpZero = SC.Is64 ? RISCV::X0_64 : RISCV::X0_32;
+
+  // Materialize the condition as 0/1 directly in the width of the values
+  // where the compare allows it.
+  unsigned SetOpc;
+  if (SC.Is64 && Is64Val)
+    SetOpc = SC.IsUnsigned || SC.IsEquality ? RISCV::SLTU64 : RISCV::SLT64;
+  else if (SC.Is64)
+    SetOpc = SC.IsUnsigned || SC.IsEquality ? RISCV::SLTU32 : RISCV::SLT32;
+  else
+    SetOpc = SC.IsUnsigned || SC.IsEquality ? RISCV::SLTU : RISCV::SLT;
+  const TargetRegisterClass *SetRC = SC.Is64 ? ValRC : &RISCV::GPRRegClass;
+
+  unsigned Cond = MRI.createVirtualRegister(SetRC);
+  if (SC.IsEquality) {
+    // x != y is 0 <u (x ^ y).
+    unsigned Diff;
+    if (isZeroReg(RHS, MRI))
+      Diff = LHS;
+    else if (isZeroReg(LHS, MRI))
+      Diff = RHS;
+    else {
+      Diff = MRI.createVirtualRegister(CmpRC);
+      BuildMI(MBB, I, DL, get(SC.Is64 ? RISCV::XOR64 : RISCV::XOR), Diff)
+          .addReg(LHS)
+          .addReg(RHS);
+    }
+    BuildMI(MBB, I, DL, get(SetOpc), Cond).addReg(CmpZero).addReg(Diff);
+  } else
+    BuildMI(MBB, I, DL, get(SetOpc), Cond).addReg(LHS).addReg(RHS);
+
+  // A 32-bit compare feeding 64-bit values; the 0/1 result has its upper
+  // bits clear already.
+  if (Is64Val && !SC.Is64) {
+    unsigned Cond64 = MRI.createVirtualRegister(&RISCV::GPR64RegClass);
+    BuildMI(MBB, I, DL, get(RISCV::SUBREG_TO_REG), Cond64)
+        .addImm(0)
+        .addReg(Cond)
+        .addImm(RISCV::sub_32);
+    Cond = Cond64;
+  }
+
+  if (SC.Inverted)
+    std::swap(TrueReg, FalseReg);
+
+  unsigned Zero = Is64Val ? RISCV::X0_64 : RISCV::X0_32;
+  unsigned SubOpc, AddiOpc, AndOpc, XorOpc;
+  if (Is64Val) {
+    SubOpc = RISCV::SUB64;
+    AddiOpc = RISCV::ADDI64;
+    AndOpc = RISCV::AND64;
+    XorOpc = RISCV::XOR64;
+  } else {
+    SubOpc = STI.isRV64() ? RISCV::SUBW : RISCV::SUB;
+    AddiOpc = STI.isRV64() ? RISCV::ADDIW : RISCV::ADDI;
+    AndOpc = RISCV::AND;
+    XorOpc = RISCV::XOR;
+  }
+
+  unsigned Mask = MRI.createVirtualRegister(ValRC);
+  if (isZeroReg(TrueReg, MRI)) {
+    // c ? 0 : F  -->  F & (c - 1)
+    BuildMI(MBB, I, DL, get(AddiOpc), Mask).addReg(Cond).addImm(-1);
+    BuildMI(MBB, I, DL, get(AndOpc), DstReg).addReg(FalseReg).addReg(Mask);
+    return;
+  }
+
+  // c ? T : 0  -->  T & -c
+  BuildMI(MBB, I, DL, get(SubOpc), Mask).addReg(Zero).addReg(Cond);
+  if (isZeroReg(FalseReg, MRI)) {
+    BuildMI(MBB, I, DL, get(AndOpc), DstReg).addReg(TrueReg).addReg(Mask);
+    return;
+  }
+
+  // c ? T : F  -->  F ^ ((T ^ F) & -c)
+  unsigned Diff = MRI.createVirtualRegister(ValRC);
+  unsigned Masked = MRI.createVirtualRegister(ValRC);
+  BuildMI(MBB, I, DL, get(XorOpc), Diff).addReg(TrueReg).addReg(FalseReg);
+  BuildMI(MBB, I, DL, get(AndOpc), Masked).addReg(Diff).addReg(Mask);
+  BuildMI(MBB, I, DL, get(XorOpc), DstReg).addReg(FalseReg).addReg(Masked);
+}
+
+bool RISCVInstrInfo::canInsertSelect(const MachineBasicBlock &MBB,
+                                     ArrayRef<MachineOperand> Cond,
+                                     unsigned TrueReg, unsigned FalseReg,
+                                     int &CondCycles, int &TrueCycles,
+                                     int &FalseCycles) const {
+  // Only the register-register branches; the compressed and Andes branches
+  // are formed after register allocation anyway.
+  if (Cond.size() != 3 || !Cond[1].isReg() || !Cond[2].isReg())
+    return false;
+
+  const MachineRegisterInfo &MRI = MBB.getParent()->getRegInfo();
+  const TargetRegisterClass *RC =
+      RI.getCommonSubClass(MRI.getRegClass(TrueReg), MRI.getRegClass(FalseReg));
+  if (!RC || !(RISCV::GPRRegClass.hasSubClassEq(RC) ||
+               (STI.isRV64() && RISCV::GPR64RegClass.hasSubClassEq(RC))))
+    return false;
+
+  unsigned CondCost;
+  unsigned Cost =
+      getBranchlessSelectCost(Cond[0].getImm(), Cond[1].getReg(),
+                              Cond[2].getReg(), TrueReg, FalseReg, MRI,
+                              CondCost);
+  if (!Cost)
+    return false;
+
+  CondCycles = CondCost;
+  TrueCycles = FalseCycles = Cost - CondCost;
+  return true;
+}
+
+void RISCVInstrInfo::insertSelect(MachineBasicBlock &MBB,
+                                  MachineBasicBlock::iterator I,
+                                  const DebugLoc &DL, unsigned DstReg,
+                                  ArrayRef<MachineOperand> Cond,
+                                  unsigned TrueReg, unsigned FalseReg) const {
+  buildBranchlessSelect(MBB, I, DL, DstReg, Cond[0].getImm(),
+                        Cond[1].getReg(), Cond[2].getReg(), TrueReg,
+                        FalseReg);
+}
@@ -26,8 +26,7 @@ class RISCVSubtarget;
 class RISCVInstrInfo : public RISCVGenInstrInfo {
   const RISCVRegisterInfo RI;
   RISCVSubtarget &STI;
-  unsigned UncondBranch, LUI, CLUI, ADDI, CMV;
-  unsigned CADDI16SP, CADDI, ADD, CLI;
+  unsigned UncondBranch, LUI, ADDI, ADD;
 
 public:
   explicit RISCVInstrInfo(RISCVSubtarget &STI);
@@ -103,6 +102,34 @@ public:
                                 int64_t BrOffset,
                                 RegScavenger *RS = nullptr) const override;
 
+  bool canInsertSelect(const MachineBasicBlock &MBB,
+                       ArrayRef<MachineOperand> Cond, unsigned TrueReg,
+                       unsigned FalseReg, int &CondCycles, int &TrueCycles,
+                       int &FalseCycles) const override;
+
+  void insertSelect(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                    const DebugLoc &DL, unsigned DstReg,
+                    ArrayRef<MachineOperand> Cond, unsigned TrueReg,
+                    unsigned FalseReg) const override;
+
+  /// Return the number of instructions buildBranchlessSelect needs to select
+  /// between \p TrueReg and \p FalseReg on the condition of the conditional
+  /// branch \p BrOpc, or 0 if the branch can't be turned into a select.
+  /// \p CondCost is set to the part spent materializing the condition.
+  unsigned getBranchlessSelectCost(unsigned BrOpc, unsigned LHS, unsigned RHS,
+                                   unsigned TrueReg, unsigned FalseReg,
+                                   const MachineRegisterInfo &MRI,
+                                   unsigned &CondCost) const;
+
+  /// Materialize the condition of the conditional branch \p BrOpc on
+  /// \p LHS and \p RHS as 0/1 and use it to mask \p TrueReg or \p FalseReg
+  /// into \p DstReg without a branch.
+  void buildBranchlessSelect(MachineBasicBlock &MBB,
+                             MachineBasicBlock::iterator I, const DebugLoc &DL,
+                             unsigned DstReg, unsigned BrOpc, unsigned LHS,
+                             unsigned RHS, unsigned TrueReg,
+                             unsigned FalseReg) const;
+
 private:
   void BuildCondBr(MachineBasicBlock &MBB, MachineBasicBlock *TBB,
                    const DebugLoc &DL, ArrayRef<MachineOperand> Cond) const;
@@ -0,0 +1,628 @@
+//===- RISCVInstructionSelector.cpp -------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the InstructionSelector class for
+/// RISCV. Register-register arithmetic is selected by the patterns imported
+/// from RISCVInstrInfo*.td; the rest is selected by hand with the same
+/// sequences FastISel uses.
+//===----------------------------------------------------------------------===//
+
+#include "RISCV.h"
+#include "RISCVInstrInfo.h"
+#include "RISCVRegisterBankInfo.h"
+#include "RISCVSubtarget.h"
+#include "RISCVTargetMachine.h"
+#include "RISCVTargetObjectFile.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/CodeGen/GlobalISel/Utils.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "riscv-isel"
+
+#include "llvm/CodeGen/GlobalISel/InstructionSelectorImpl.h"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+namespace {
+
+#define GET_GLOBALISEL_PREDICATE_BITSET
+#include "RISCVGenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATE_BITSET
+
+class RISCVInstructionSelector : public InstructionSelector {
+public:
+  RISCVInstructionSelector(const RISCVTargetMachine &TM,
+                           const RISCVSubtarget &STI,
+                           const RISCVRegisterBankInfo &RBI);
+
+  bool select(MachineInstr &I) const override;
+
+private:
+  bool selectImpl(MachineInstr &I) const;
+
+  // Every value lives in the GPR bank; the size picks the 32-bit or the
+  // 64-bit view of the registers.
+  const TargetRegisterClass *getRegClassFor(unsigned Size) const {
+    return Size > 32 ? &RISCV::GPR64RegClass : &RISCV::GPRRegClass;
+  }
+  const TargetRegisterClass *getRegClassFor(unsigned Reg,
+                                            MachineRegisterInfo &MRI) const {
+    return getRegClassFor(MRI.getType(Reg).getSizeInBits());
+  }
+
+  bool selectCopy(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectPHI(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectConstant(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectGlobalValue(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectLoadStore(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectExt(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectTrunc(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectICmp(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectBrCond(MachineInstr &I, MachineRegisterInfo &MRI) const;
+
+  // Extend the \p SrcSize-bit value in \p SrcReg to \p DstSize bits, the same
+  // way FastISel does.
+  unsigned emitIntExt(MachineInstr &I, MachineRegisterInfo &MRI,
+                      unsigned SrcReg, unsigned SrcSize, unsigned DstSize,
+                      bool IsZExt) const;
+  // Emit \p Opc with a register and an immediate operand into a new virtual
+  // register of class \p RC.
+  unsigned emitRI(MachineInstr &I, MachineRegisterInfo &MRI, unsigned Opc,
+                  const TargetRegisterClass *RC, unsigned SrcReg,
+                  int64_t Imm) const;
+  unsigned emitRR(MachineInstr &I, MachineRegisterInfo &MRI, unsigned Opc,
+                  const TargetRegisterClass *RC, unsigned LHSReg,
+                  unsigned RHSReg) const;
+
+  const RISCVInstrInfo &TII;
+  const RISCVRegisterInfo &TRI;
+  const RISCVTargetMachine &TM;
+  const RISCVRegisterBankInfo &RBI;
+  const RISCVSubtarget &STI;
+  bool IsRV64;
+
+#define GET_GLOBALISEL_PREDICATES_DECL
+#include "RISCVGenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATES_DECL
+
+// We declare the temporaries used by selectImpl() in the class to minimize the
+// cost of constructing placeholder values.
+#define GET_GLOBALISEL_TEMPORARIES_DECL
+#include "RISCVGenGlobalISel.inc"
+#undef GET_GLOBALISEL_TEMPORARIES_DECL
+};
+} // end anonymous namespace
+
+namespace llvm {
+InstructionSelector *
+createRISCVInstructionSelector(const RISCVTargetMachine &TM,
+                               const RISCVSubtarget &STI,
+                               const RISCVRegisterBankInfo &RBI) {
+  return new RISCVInstructionSelector(TM, STI, RBI);
+}
+}
+
+#define GET_GLOBALISEL_IMPL
+#include "RISCVGenGlobalISel.inc"
+#undef GET_GLOBALISEL_IMPL
+
+RISCVInstructionSelector::RISCVInstructionSelector(
+    const RISCVTargetMachine &TM, const RISCVSubtarget &STI,
+    const RISCVRegisterBankInfo &RBI)
+    : InstructionSelector(), TII(*STI.getInstrInfo()),
+      TRI(TII.getRegisterInfo()), TM(TM), RBI(RBI), STI(STI),
+      IsRV64(STI.isRV64()),
+#define GET_GLOBALISEL_PREDICATES_INIT
+#include "RISCVGenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATES_INIT
+#define GET_GLOBALISEL_TEMPORARIES_INIT
+#include "RISCVGenGlobalISel.inc"
+#undef GET_GLOBALISEL_TEMPORARIES_INIT
+{
+}
+
+unsigned RISCVInstructionSelector::emitRI(MachineInstr &I,
+                                          MachineRegisterInfo &MRI,
+                                          unsigned Opc,
+                                          const TargetRegisterClass *RC,
+                                          unsigned SrcReg, int64_t Imm) const {
+  unsigned DstReg = MRI.createVirtualRegister(RC);
+  auto MIB = BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(Opc), DstReg)
+                 .addReg(SrcReg)
+                 .addImm(Imm);
+  if (!constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI))
+    return 0;
+  return DstReg;
+}
+
+unsigned RISCVInstructionSelector::emitRR(MachineInstr &I,
+                                          MachineRegisterInfo &MRI,
+                                          unsigned Opc,
+                                          const TargetRegisterClass *RC,
+                                          unsigned LHSReg,
+                                          unsigned RHSReg) const {
+  unsigned DstReg = MRI.createVirtualRegister(RC);
+  auto MIB = BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(Opc), DstReg)
+                 .addReg(LHSReg)
+                 .addReg(RHSReg);
+  if (!constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI))
+    return 0;
+  return DstReg;
+}
+
+bool RISCVInstructionSelector::selectCopy(MachineInstr &I,
+                                          MachineRegisterInfo &MRI) const {
+  unsigned DstReg = I.getOperand(0).getReg();
+  if (TargetRegisterInfo::isPhysicalRegister(DstReg))
+    return true;
+
+  const RegisterBank *RegBank = RBI.getRegBank(DstReg, MRI, TRI);
+  (void)RegBank;
+  assert(RegBank && RegBank->getID() == RISCV::GPRRegBankID &&
+         "Unsupported reg bank");
+
+  // No need to constrain SrcReg. It will get constrained when
+  // we hit another of its uses or its defs.
+  // Copies do not have constraints.
+  if (!RBI.constrainGenericRegister(DstReg, *getRegClassFor(DstReg, MRI),
+                                    MRI)) {
+    DEBUG(dbgs() << "Failed to constrain " << TII.getName(I.getOpcode())
+                 << " operand\n");
+    return false;
+  }
+  return true;
+}
+
+bool RISCVInstructionSelector::selectPHI(MachineInstr &I,
+                                         MachineRegisterInfo &MRI) const {
+  unsigned DstReg = I.getOperand(0).getReg();
+  if (TargetRegisterInfo::isPhysicalRegister(DstReg) ||
+      MRI.getRegClassOrNull(DstReg))
+    return true;
+  return RBI.constrainGenericRegister(DstReg, *getRegClassFor(DstReg, MRI),
+                                      MRI);
+}
+
+bool RISCVInstructionSelector::selectConstant(MachineInstr &I,
+                                              MachineRegisterInfo &MRI) const {
+  unsigned DstReg = I.getOperand(0).getReg();
+  bool Is64 = MRI.getType(DstReg).getSizeInBits() == 64;
+  const MachineOperand &Val = I.getOperand(1);
+  if (!Val.isCImm())
+    return false;
+  int64_t Imm = Val.getCImm()->getSExtValue();
+
+  // Small constants are a single addi from x0, like the simm12 patterns.
+  if (isInt<12>(Imm)) {
+    auto MIB = BuildMI(*I.getParent(), I, I.getDebugLoc(),
+                       TII.get(Is64 ? RISCV::ADDI64 : RISCV::ADDI), DstReg)
+                   .addReg(Is64 ? RISCV::X0_64 : RISCV::X0_32)
+                   .addImm(Imm);
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+
+  I.setDesc(TII.get(Is64 ? RISCV::MOVi64imm : RISCV::MOVi32imm));
+  I.getOperand(1).ChangeToImmediate(Imm);
+  return constrainSelectedInstRegOperands(I, TII, TRI, RBI);
+}
+
+// Materialise a global address as lowerGlobalAddress does: gp-relative for
+// small data, lla/la for PIC and the medium code model, and lui+addi
+// otherwise.
+bool RISCVInstructionSelector::selectGlobalValue(
+    MachineInstr &I, MachineRegisterInfo &MRI) const {
+  const GlobalValue *GV = I.getOperand(1).getGlobal();
+  // Thread-local addresses need the TLS sequences built by SelectionDAG.
+  if (GV->isThreadLocal())
+    return false;
+
+  MachineBasicBlock &MBB = *I.getParent();
+  const DebugLoc &DL = I.getDebugLoc();
+  unsigned DstReg = I.getOperand(0).getReg();
+  MachineInstr *MI;
+
+  const auto &TLOF = static_cast<const RISCVELFTargetObjectFile &>(
+      *TM.getObjFileLowering());
+  const GlobalObject *GO = dyn_cast<GlobalObject>(GV);
+  if (GO && TLOF.isGlobalInSmallSection(GO, TM)) {
+    if (STI.hasXV5())
+      MI = BuildMI(MBB, I, DL,
+                   TII.get(IsRV64 ? RISCV::ADDIGP64 : RISCV::ADDIGP), DstReg)
+               .addGlobalAddress(GV, 0, RISCVII::MO_GPREL);
+    else
+      MI = BuildMI(MBB, I, DL, TII.get(IsRV64 ? RISCV::ADDI64 : RISCV::ADDI),
+                   DstReg)
+               .addReg(IsRV64 ? RISCV::X3_64 : RISCV::X3_32)
+               .addGlobalAddress(GV, 0, RISCVII::MO_GPREL);
+  } else if (TM.isPositionIndependent() ||
+             TM.getCodeModel() == CodeModel::Medium) {
+    unsigned Opc;
+    if (TM.shouldAssumeDSOLocal(*GV->getParent(), GV))
+      Opc = IsRV64 ? RISCV::PseudoLLA64 : RISCV::PseudoLLA;
+    else
+      Opc = IsRV64 ? RISCV::PseudoLA64 : RISCV::PseudoLA;
+    MI = BuildMI(MBB, I, DL, TII.get(Opc), DstReg).addGlobalAddress(GV);
+  } else {
+    unsigned HiReg = MRI.createVirtualRegister(getRegClassFor(DstReg, MRI));
+    BuildMI(MBB, I, DL, TII.get(IsRV64 ? RISCV::LUI64 : RISCV::LUI), HiReg)
+        .addGlobalAddress(GV, 0, RISCVII::MO_HI);
+    MI = BuildMI(MBB, I, DL, TII.get(IsRV64 ? RISCV::ADDI64 : RISCV::ADDI),
+                 DstReg)
+             .addReg(HiReg, RegState::Kill)
+             .addGlobalAddress(GV, 0, RISCVII::MO_LO);
+  }
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MI, TII, TRI, RBI);
+}
+
+bool RISCVInstructionSelector::selectLoadStore(MachineInstr &I,
+                                               MachineRegisterInfo &MRI) const {
+  bool IsLoad = I.getOpcode() == TargetOpcode::G_LOAD;
+  unsigned ValReg = I.getOperand(0).getReg();
+
+  // Sub-word values are zero-extended; any later extension is explicit.
+  unsigned Opc;
+  switch (MRI.getType(ValReg).getSizeInBits()) {
+  default:
+    return false;
+  case 8:
+    Opc = IsLoad ? RISCV::LBU : RISCV::SB;
+    break;
+  case 16:
+    Opc = IsLoad ? RISCV::LHU : RISCV::SH;
+    break;
+  case 32:
+    Opc = IsLoad ? RISCV::LW : RISCV::SW;
+    break;
+  case 64:
+    if (!IsRV64)
+      return false;
+    Opc = IsLoad ? RISCV::LD : RISCV::SD;
+    break;
+  }
+
+  // Fold a frame index or a small constant offset into the address; the
+  // instructions computing it are removed if nothing else uses them.
+  MachineOperand Base = I.getOperand(1);
+  int64_t Offset = 0;
+  MachineInstr *BaseMI = MRI.getVRegDef(Base.getReg());
+  if (BaseMI && BaseMI->getOpcode() == TargetOpcode::G_GEP) {
+    Optional<int64_t> Imm =
+        getConstantVRegVal(BaseMI->getOperand(2).getReg(), MRI);
+    if (Imm && isInt<12>(*Imm)) {
+      Offset = *Imm;
+      Base = BaseMI->getOperand(1);
+      BaseMI = MRI.getVRegDef(Base.getReg());
+    }
+  }
+  if (BaseMI && BaseMI->getOpcode() == TargetOpcode::G_FRAME_INDEX)
+    Base = BaseMI->getOperand(1);
+
+  MachineInstrBuilder MIB =
+      BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(Opc));
+  if (IsLoad)
+    MIB.addDef(ValReg);
+  else
+    MIB.addUse(ValReg);
+  if (Base.isFI())
+    MIB.addFrameIndex(Base.getIndex());
+  else
+    MIB.addUse(Base.getReg());
+  MIB.addImm(Offset);
+  MIB.setMemRefs(I.memoperands_begin(), I.memoperands_end());
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+unsigned RISCVInstructionSelector::emitIntExt(MachineInstr &I,
+                                              MachineRegisterInfo &MRI,
+                                              unsigned SrcReg, unsigned SrcSize,
+                                              unsigned DstSize,
+                                              bool IsZExt) const {
+  const TargetRegisterClass *RC = &RISCV::GPRRegClass;
+  unsigned OrigSize = SrcSize;
+  if (SrcSize < 32) {
+    if (IsZExt && SrcSize != 16) {
+      SrcReg = emitRI(I, MRI, RISCV::ANDI, RC, SrcReg, SrcSize == 1 ? 1 : 255);
+    } else {
+      unsigned Shift = 32 - SrcSize;
+      unsigned ShlOpc = IsRV64 ? RISCV::SLLIW : RISCV::SLLI;
+      unsigned ShrOpc;
+      if (IsZExt)
+        ShrOpc = IsRV64 ? RISCV::SRLIW : RISCV::SRLI;
+      else
+        ShrOpc = IsRV64 ? RISCV::SRAIW : RISCV::SRAI;
+      unsigned TmpReg = emitRI(I, MRI, ShlOpc, RC, SrcReg, Shift);
+      SrcReg = TmpReg ? emitRI(I, MRI, ShrOpc, RC, TmpReg, Shift) : 0;
+    }
+    if (!SrcReg)
+      return 0;
+  }
+
+  if (DstSize != 64)
+    return SrcReg;
+
+  // On RV64 a 32-bit value is always held sign-extended, so sign-extending
+  // it only changes the register class.
+  unsigned Reg64 = MRI.createVirtualRegister(&RISCV::GPR64RegClass);
+  BuildMI(*I.getParent(), I, I.getDebugLoc(),
+          TII.get(TargetOpcode::SUBREG_TO_REG), Reg64)
+      .addImm(0)
+      .addReg(SrcReg)
+      .addImm(RISCV::sub_32);
+  if (!IsZExt || OrigSize != 32)
+    return Reg64;
+
+  unsigned TmpReg =
+      emitRI(I, MRI, RISCV::SLLI64, &RISCV::GPR64RegClass, Reg64, 32);
+  return TmpReg ? emitRI(I, MRI, RISCV::SRLI64, &RISCV::GPR64RegClass, TmpReg,
+                         32)
+                : 0;
+}
+
+bool RISCVInstructionSelector::selectExt(MachineInstr &I,
+                                         MachineRegisterInfo &MRI) const {
+  unsigned DstReg = I.getOperand(0).getReg();
+  unsigned SrcReg = I.getOperand(1).getReg();
+  unsigned DstSize = MRI.getType(DstReg).getSizeInBits();
+  unsigned SrcSize = MRI.getType(SrcReg).getSizeInBits();
+  if (SrcSize > 32 || DstSize > 64 || (DstSize == 64 && !IsRV64))
+    return false;
+
+  unsigned ResultReg;
+  if (I.getOpcode() == TargetOpcode::G_ANYEXT) {
+    // The upper bits are undefined, so only the register class may change.
+    if (DstSize <= 32) {
+      I.setDesc(TII.get(TargetOpcode::COPY));
+      return selectCopy(I, MRI);
+    }
+    ResultReg = emitIntExt(I, MRI, SrcReg, 32, DstSize, /*IsZExt=*/false);
+  } else {
+    ResultReg = emitIntExt(I, MRI, SrcReg, SrcSize, DstSize,
+                           I.getOpcode() == TargetOpcode::G_ZEXT);
+  }
+  if (!ResultReg)
+    return false;
+
+  BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(TargetOpcode::COPY),
+          DstReg)
+      .addReg(ResultReg);
+  I.eraseFromParent();
+  return RBI.constrainGenericRegister(DstReg, *getRegClassFor(DstSize), MRI);
+}
+
+bool RISCVInstructionSelector::selectTrunc(MachineInstr &I,
+                                           MachineRegisterInfo &MRI) const {
+  unsigned DstReg = I.getOperand(0).getReg();
+  unsigned SrcReg = I.getOperand(1).getReg();
+
+  // Truncating within a GPR keeps the register as it is; the unused upper
+  // bits are extended explicitly wherever they matter.
+  if (MRI.getType(SrcReg).getSizeInBits() <= 32) {
+    I.setDesc(TII.get(TargetOpcode::COPY));
+    return selectCopy(I, MRI);
+  }
+
+  // Keep the 32-bit value sign-extended in the 64-bit register.
+  if (!RBI.constrainGenericRegister(SrcReg, RISCV::GPR64RegClass, MRI))
+    return false;
+  unsigned SubReg = MRI.createVirtualRegister(&RISCV::GPRRegClass);
+  BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(TargetOpcode::COPY),
+          SubReg)
+      .addReg(SrcReg, 0, RISCV::sub_32);
+  auto MIB = BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(RISCV::ADDIW),
+                     DstReg)
+                 .addReg(SubReg)
+                 .addImm(0);
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+// Materialise an integer compare as 0 or 1 in a GPR. The sequences are the
+// ones used by the setcc patterns.
+bool RISCVInstructionSelector::selectICmp(MachineInstr &I,
+                                          MachineRegisterInfo &MRI) const {
+  unsigned DstReg = I.getOperand(0).getReg();
+  auto Pred = static_cast<CmpInst::Predicate>(I.getOperand(1).getPredicate());
+  unsigned LHSReg = I.getOperand(2).getReg();
+  unsigned RHSReg = I.getOperand(3).getReg();
+  bool Is64 = MRI.getType(LHSReg).getSizeInBits() == 64;
+  const TargetRegisterClass *RC = &RISCV::GPRRegClass;
+  unsigned SLTOpc = Is64 ? RISCV::SLT32 : RISCV::SLT;
+  unsigned SLTUOpc = Is64 ? RISCV::SLTU32 : RISCV::SLTU;
+  bool Invert = false;
+  unsigned ResultReg;
+
+  switch (Pred) {
+  default:
+    return false;
+  case CmpInst::ICMP_EQ:
+  case CmpInst::ICMP_NE: {
+    unsigned XorReg = emitRR(I, MRI, Is64 ? RISCV::XOR64 : RISCV::XOR,
+                             getRegClassFor(LHSReg, MRI), LHSReg, RHSReg);
+    if (!XorReg)
+      return false;
+    if (Pred == CmpInst::ICMP_EQ)
+      ResultReg = emitRI(I, MRI, Is64 ? RISCV::SLTIU32 : RISCV::SLTIU, RC,
+                         XorReg, 1);
+    else
+      ResultReg = emitRR(I, MRI, SLTUOpc, RC,
+                         Is64 ? RISCV::X0_64 : RISCV::X0_32, XorReg);
+    break;
+  }
+  case CmpInst::ICMP_SGT:
+  case CmpInst::ICMP_SLE:
+    Invert = Pred == CmpInst::ICMP_SLE;
+    ResultReg = emitRR(I, MRI, SLTOpc, RC, RHSReg, LHSReg);
+    break;
+  case CmpInst::ICMP_SLT:
+  case CmpInst::ICMP_SGE:
+    Invert = Pred == CmpInst::ICMP_SGE;
+    ResultReg = emitRR(I, MRI, SLTOpc, RC, LHSReg, RHSReg);
+    break;
+  case CmpInst::ICMP_UGT:
+  case CmpInst::ICMP_ULE:
+    Invert = Pred == CmpInst::ICMP_ULE;
+    ResultReg = emitRR(I, MRI, SLTUOpc, RC, RHSReg, LHSReg);
+    break;
+  case CmpInst::ICMP_ULT:
+  case CmpInst::ICMP_UGE:
+    Invert = Pred == CmpInst::ICMP_UGE;
+    ResultReg = emitRR(I, MRI, SLTUOpc, RC, LHSReg, RHSReg);
+    break;
+  }
+
+  if (ResultReg && Invert)
+    ResultReg = emitRI(I, MRI, RISCV::XORI, RC, ResultReg, 1);
+  if (!ResultReg)
+    return false;
+
+  BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(TargetOpcode::COPY),
+          DstReg)
+      .addReg(ResultReg);
+  I.eraseFromParent();
+  return RBI.constrainGenericRegister(DstReg, *RC, MRI);
+}
+
+bool RISCVInstructionSelector::selectBrCond(MachineInstr &I,
+                                            MachineRegisterInfo &MRI) const {
+  unsigned CondReg = I.getOperand(0).getReg();
+  MachineBasicBlock *TBB = I.getOperand(1).getMBB();
+  MachineInstr *CmpMI = MRI.getVRegDef(CondReg);
+
+  // Fold a compare that is only used by this branch into the branch itself.
+  // Instructions are selected bottom-up, so the compare is still generic and
+  // is deleted as dead once the branch no longer uses it.
+  if (CmpMI && CmpMI->getOpcode() == TargetOpcode::G_ICMP &&
+      CmpMI->getParent() == I.getParent() && MRI.hasOneUse(CondReg)) {
+    unsigned LHSReg = CmpMI->getOperand(2).getReg();
+    unsigned RHSReg = CmpMI->getOperand(3).getReg();
+    bool Is64 = MRI.getType(LHSReg).getSizeInBits() == 64;
+    bool Swap = false;
+    unsigned Opc;
+    switch (CmpMI->getOperand(1).getPredicate()) {
+    default:
+      return false;
+    case CmpInst::ICMP_EQ:  Opc = Is64 ? RISCV::BEQ64 : RISCV::BEQ; break;
+    case CmpInst::ICMP_NE:  Opc = Is64 ? RISCV::BNE64 : RISCV::BNE; break;
+    case CmpInst::ICMP_SLT: Opc = Is64 ? RISCV::BLT64 : RISCV::BLT; break;
+    case CmpInst::ICMP_SGE: Opc = Is64 ? RISCV::BGE64 : RISCV::BGE; break;
+    case CmpInst::ICMP_ULT: Opc = Is64 ? RISCV::BLTU64 : RISCV::BLTU; break;
+    case CmpInst::ICMP_UGE: Opc = Is64 ? RISCV::BGEU64 : RISCV::BGEU; break;
+    case CmpInst::ICMP_SGT:
+      Opc = Is64 ? RISCV::BLT64 : RISCV::BLT;
+      Swap = true;
+      break;
+    case CmpInst::ICMP_SLE:
+      Opc = Is64 ? RISCV::BGE64 : RISCV::BGE;
+      Swap = true;
+      break;
+    case CmpInst::ICMP_UGT:
+      Opc = Is64 ? RISCV::BLTU64 : RISCV::BLTU;
+      Swap = true;
+      break;
+    case CmpInst::ICMP_ULE:
+      Opc = Is64 ? RISCV::BGEU64 : RISCV::BGEU;
+      Swap = true;
+      break;
+    }
+    if (Swap)
+      std::swap(LHSReg, RHSReg);
+
+    auto MIB = BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(Opc))
+                   .addReg(LHSReg)
+                   .addReg(RHSReg)
+                   .addMBB(TBB);
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+
+  // Only bit 0 of an s1 is defined.
+  unsigned AndReg =
+      emitRI(I, MRI, RISCV::ANDI, &RISCV::GPRRegClass, CondReg, 1);
+  if (!AndReg)
+    return false;
+  BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(RISCV::BNE))
+      .addReg(AndReg, RegState::Kill)
+      .addReg(RISCV::X0_32)
+      .addMBB(TBB);
+  I.eraseFromParent();
+  return true;
+}
+
+bool RISCVInstructionSelector::select(MachineInstr &I) const {
+  assert(I.getParent() && "Instruction should be in a basic block!");
+  assert(I.getParent()->getParent() && "Instruction should be in a function!");
+
+  auto &MBB = *I.getParent();
+  auto &MF = *MBB.getParent();
+  auto &MRI = MF.getRegInfo();
+
+  if (!isPreISelGenericOpcode(I.getOpcode())) {
+    if (I.getOpcode() == TargetOpcode::PHI)
+      return selectPHI(I, MRI);
+
+    if (I.isCopy())
+      return selectCopy(I, MRI);
+
+    return true;
+  }
+
+  if (selectImpl(I))
+    return true;
+
+  using namespace TargetOpcode;
+  switch (I.getOpcode()) {
+  case G_CONSTANT:
+    return selectConstant(I, MRI);
+  case G_GLOBAL_VALUE:
+    return selectGlobalValue(I, MRI);
+  case G_FRAME_INDEX:
+    // Add 0 to the frame index; eliminateFrameIndex folds in the offset.
+    I.setDesc(TII.get(IsRV64 ? RISCV::ADDI64 : RISCV::ADDI));
+    MachineInstrBuilder(MF, I).addImm(0);
+    break;
+  case G_GEP:
+    I.setDesc(TII.get(IsRV64 ? RISCV::ADD64 : RISCV::ADD));
+    break;
+  case G_IMPLICIT_DEF:
+    I.setDesc(TII.get(TargetOpcode::IMPLICIT_DEF));
+    return selectCopy(I, MRI);
+  case G_PTRTOINT:
+  case G_INTTOPTR:
+    I.setDesc(TII.get(TargetOpcode::COPY));
+    return selectCopy(I, MRI);
+  case G_LOAD:
+  case G_STORE:
+    return selectLoadStore(I, MRI);
+  case G_SEXT:
+  case G_ZEXT:
+  case G_ANYEXT:
+    return selectExt(I, MRI);
+  case G_TRUNC:
+    return selectTrunc(I, MRI);
+  case G_ICMP:
+    return selectICmp(I, MRI);
+  case G_BRCOND:
+    return selectBrCond(I, MRI);
+  default:
+    return false;
+  }
+
+  return constrainSelectedInstRegOperands(I, TII, TRI, RBI);
+}
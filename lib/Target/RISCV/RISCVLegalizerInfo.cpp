@@ -0,0 +1,114 @@
+//===- RISCVLegalizerInfo.cpp ------------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the Machinelegalizer class for RISCV.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#include "RISCVLegalizerInfo.h"
+#include "RISCVSubtarget.h"
+#include "llvm/CodeGen/LowLevelType.h"
+#include "llvm/CodeGen/ValueTypes.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Type.h"
+#include "llvm/Target/TargetOpcodes.h"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+RISCVLegalizerInfo::RISCVLegalizerInfo(const RISCVSubtarget &ST) {
+  using namespace TargetOpcode;
+
+  bool IsRV64 = ST.isRV64();
+  const LLT p0 = LLT::pointer(0, IsRV64 ? 64 : 32);
+
+  const LLT s1 = LLT::scalar(1);
+  const LLT s8 = LLT::scalar(8);
+  const LLT s16 = LLT::scalar(16);
+  const LLT s32 = LLT::scalar(32);
+  const LLT s64 = LLT::scalar(64);
+  const LLT XLenTy = IsRV64 ? s64 : s32;
+
+  // Integer operations are done on s32 and, on RV64, on s64 as well; the
+  // 32-bit forms select to the W instructions there. Anything narrower is
+  // widened. Anything wider is left to SelectionDAG.
+  SmallVector<LLT, 2> IntTys = {s32};
+  if (IsRV64)
+    IntTys.push_back(s64);
+
+  setAction({G_FRAME_INDEX, p0}, Legal);
+  setAction({G_GLOBAL_VALUE, p0}, Legal);
+
+  for (unsigned Op : {G_LOAD, G_STORE}) {
+    for (auto Ty : {s8, s16, s32, p0})
+      setAction({Op, Ty}, Legal);
+    if (IsRV64)
+      setAction({Op, s64}, Legal);
+    setAction({Op, s1}, WidenScalar);
+    setAction({Op, 1, p0}, Legal);
+  }
+
+  for (unsigned Op : {G_ADD, G_SUB, G_AND, G_OR, G_XOR, G_SHL, G_LSHR,
+                      G_ASHR}) {
+    for (auto Ty : {s1, s8, s16})
+      setAction({Op, Ty}, WidenScalar);
+    for (auto Ty : IntTys)
+      setAction({Op, Ty}, Legal);
+  }
+
+  for (unsigned Op : {G_MUL, G_SDIV, G_UDIV, G_SREM, G_UREM}) {
+    for (auto Ty : {s1, s8, s16})
+      setAction({Op, Ty}, WidenScalar);
+    if (ST.hasM())
+      for (auto Ty : IntTys)
+        setAction({Op, Ty}, Legal);
+    else if (!IsRV64 && Op != G_MUL)
+      setAction({Op, s32}, Libcall);
+  }
+
+  for (unsigned Op : {G_SEXT, G_ZEXT, G_ANYEXT}) {
+    for (auto Ty : IntTys)
+      setAction({Op, Ty}, Legal);
+    for (auto Ty : {s1, s8, s16, s32})
+      setAction({Op, 1, Ty}, Legal);
+  }
+
+  setAction({G_GEP, p0}, Legal);
+  setAction({G_GEP, 1, XLenTy}, Legal);
+
+  setAction({G_PTRTOINT, XLenTy}, Legal);
+  setAction({G_PTRTOINT, 1, p0}, Legal);
+  setAction({G_INTTOPTR, p0}, Legal);
+  setAction({G_INTTOPTR, 1, XLenTy}, Legal);
+
+  setAction({G_BRCOND, s1}, Legal);
+
+  for (auto Ty : IntTys)
+    setAction({G_CONSTANT, Ty}, Legal);
+  setAction({G_CONSTANT, p0}, Legal);
+  for (auto Ty : {s1, s8, s16})
+    setAction({G_CONSTANT, Ty}, WidenScalar);
+
+  for (auto Ty : {s1, s8, s16, s32, p0})
+    setAction({G_IMPLICIT_DEF, Ty}, Legal);
+  if (IsRV64)
+    setAction({G_IMPLICIT_DEF, s64}, Legal);
+
+  setAction({G_ICMP, s1}, Legal);
+  for (auto Ty : {s1, s8, s16})
+    setAction({G_ICMP, 1, Ty}, WidenScalar);
+  for (auto Ty : IntTys)
+    setAction({G_ICMP, 1, Ty}, Legal);
+  setAction({G_ICMP, 1, p0}, Legal);
+
+  computeTables();
+}
@@ -14,6 +14,7 @@
 #ifndef LLVM_LIB_TARGET_RISCV_RISCVMACHINEFUNCTIONINFO_H
 #define LLVM_LIB_TARGET_RISCV_RISCVMACHINEFUNCTIONINFO_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/CodeGen/MachineFunction.h"
 
 namespace llvm {
@@ -39,11 +40,20 @@ class RISCVMachineFunctionInfo : public MachineFunctionInfo {
   /// Size of incoming argument area.
   unsigned IncomingArgSize;
 
+  /// Entry size and base block of each compact jump table, keyed by jump
+  /// table index. Entries hold the distance of their destination from the
+  /// base block, scaled down by the instruction alignment.
+  DenseMap<unsigned, std::pair<unsigned, const MachineBasicBlock *>>
+      JumpTableEntryInfo;
+
 public:
-  RISCVMachineFunctionInfo() : CalleeSavedFrameSize(0) {}
+  RISCVMachineFunctionInfo()
+    : CalleeSavedFrameSize(0), ReturnAddrIndex(0), VarArgsFrameIndex(0),
+      HasByvalArg(false), IncomingArgSize(0) {}
 
   explicit RISCVMachineFunctionInfo(MachineFunction &MF)
-    : CalleeSavedFrameSize(0), ReturnAddrIndex(0) {}
+    : CalleeSavedFrameSize(0), ReturnAddrIndex(0), VarArgsFrameIndex(0),
+      HasByvalArg(false), IncomingArgSize(0) {}
 
   unsigned getCalleeSavedFrameSize() const { return CalleeSavedFrameSize; }
   void setCalleeSavedFrameSize(unsigned bytes) { CalleeSavedFrameSize = bytes; }
@@ -60,6 +70,21 @@ public:
   }
 
   unsigned getIncomingArgSize() const { return IncomingArgSize; }
+  bool hasByvalArg() const { return HasByvalArg; }
+
+  void setJumpTableEntryInfo(unsigned Idx, unsigned Size,
+                             const MachineBasicBlock *Base) {
+    JumpTableEntryInfo[Idx] = std::make_pair(Size, Base);
+  }
+  // Tables that RISCVCompressJumpTables has not seen use word entries.
+  unsigned getJumpTableEntrySize(unsigned Idx) const {
+    auto I = JumpTableEntryInfo.find(Idx);
+    return I == JumpTableEntryInfo.end() ? 4 : I->second.first;
+  }
+  const MachineBasicBlock *getJumpTableBase(unsigned Idx) const {
+    auto I = JumpTableEntryInfo.find(Idx);
+    return I == JumpTableEntryInfo.end() ? nullptr : I->second.second;
+  }
 };
 
 } // End llvm namespace
@@ -0,0 +1,357 @@
+//===-- RISCVOptimizeSExt.cpp - Remove redundant sign extensions ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// On RV64, i32 values live in the 32-bit view of the GPRs and are kept
+// sign-extended to 64 bits. Instruction selection re-establishes that
+// invariant whenever a 64-bit value is narrowed ("addiw rd, rs, 0") or
+// sign-extended in register ("slli rd, rs, 32; srai rd, rd, 32"), without
+// knowing whether the source was already sign-extended, e.g. because it was
+// produced by a W instruction or a sign-extending load in another block.
+//
+// This pass tracks which virtual registers are known to be sign-extended from
+// bit 31 and deletes the redundant extensions. When the source of an
+// extension is a single-use 64-bit add, sub, mul or left shift, the operation
+// is rewritten into its W form, which performs the extension for free.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCV.h"
+#include "RISCVInstrInfo.h"
+#include "RISCVSubtarget.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "riscv-optimize-sext"
+
+STATISTIC(NumSExtRemoved, "Number of redundant sign extensions removed");
+STATISTIC(NumWRewritten, "Number of instructions rewritten into W form");
+
+// How far the use-def chains are followed when proving that a register is
+// sign-extended.
+static const unsigned MaxSExtDepth = 8;
+
+namespace {
+  class RISCVOptimizeSExt : public MachineFunctionPass {
+  public:
+    static char ID;
+    RISCVOptimizeSExt() : MachineFunctionPass(ID) {}
+
+    const RISCVInstrInfo *TII;
+    MachineRegisterInfo *MRI;
+
+    bool runOnMachineFunction(MachineFunction &Fn) override;
+
+    StringRef getPassName() const override {
+      return "RISCV sign-extension elimination pass";
+    }
+
+  private:
+    bool isSignExtended(unsigned Reg, SmallPtrSetImpl<MachineInstr *> &Visited,
+                        unsigned Depth) const;
+    bool isSignExtended(unsigned Reg) const;
+    unsigned rewriteToW(unsigned Reg, MachineInstr *&CopyMI);
+    bool replaceExtension(MachineInstr &MI, unsigned DstReg, unsigned SrcReg);
+    bool optimizeADDIW(MachineInstr &MI);
+    bool optimizeShiftPair(MachineInstr &MI);
+  };
+  char RISCVOptimizeSExt::ID = 0;
+}
+
+bool RISCVOptimizeSExt::isSignExtended(unsigned Reg) const {
+  SmallPtrSet<MachineInstr *, 8> Visited;
+  return isSignExtended(Reg, Visited, 0);
+}
+
+// Return true if the 64-bit value held in Reg is known to be sign-extended
+// from bit 31. Cycles through PHIs are assumed to preserve the property; the
+// answer is then decided by the values entering the cycle.
+bool RISCVOptimizeSExt::isSignExtended(unsigned Reg,
+                                       SmallPtrSetImpl<MachineInstr *> &Visited,
+                                       unsigned Depth) const {
+  if (!TargetRegisterInfo::isVirtualRegister(Reg))
+    return Reg == RISCV::X0_32 || Reg == RISCV::X0_64;
+
+  MachineInstr *MI = MRI->getVRegDef(Reg);
+  if (!MI)
+    return false;
+  if (!Visited.insert(MI).second)
+    return true;
+  if (Depth++ == MaxSExtDepth)
+    return false;
+
+  switch (MI->getOpcode()) {
+  default:
+    return false;
+
+  // The W instructions, narrow loads and comparisons.
+  case RISCV::ADDW:
+  case RISCV::SUBW:
+  case RISCV::SLLW:
+  case RISCV::SRLW:
+  case RISCV::SRAW:
+  case RISCV::ADDIW:
+  case RISCV::SLLIW:
+  case RISCV::SRLIW:
+  case RISCV::SRAIW:
+  case RISCV::MULW:
+  case RISCV::DIVW:
+  case RISCV::DIVUW:
+  case RISCV::REMW:
+  case RISCV::REMUW:
+  case RISCV::LB:
+  case RISCV::LH:
+  case RISCV::LW:
+  case RISCV::LBU:
+  case RISCV::LHU:
+  case RISCV::LB64:
+  case RISCV::LH64:
+  case RISCV::LW64:
+  case RISCV::LBU64:
+  case RISCV::LHU64:
+  case RISCV::SLT:
+  case RISCV::SLTU:
+  case RISCV::SLTI:
+  case RISCV::SLTIU:
+  case RISCV::SLT32:
+  case RISCV::SLTU32:
+  case RISCV::SLTI32:
+  case RISCV::SLTIU32:
+  case RISCV::SLT64:
+  case RISCV::SLTU64:
+  case RISCV::SLTI64:
+  case RISCV::SLTIU64:
+  case RISCV::LUI:
+  case RISCV::LUI64:
+  case RISCV::MOVi32imm:
+    return true;
+
+  case RISCV::MOVi64imm:
+    return MI->getOperand(1).isImm() && isInt<32>(MI->getOperand(1).getImm());
+
+  case RISCV::ADDI64:
+    return MI->getOperand(1).isReg() &&
+           MI->getOperand(1).getReg() == RISCV::X0_64;
+
+  case RISCV::SRAI64:
+    return MI->getOperand(2).getImm() >= 32;
+  case RISCV::SRLI64:
+    return MI->getOperand(2).getImm() > 32;
+
+  case RISCV::ANDI:
+  case RISCV::ANDI64:
+    if (MI->getOperand(2).isImm() && MI->getOperand(2).getImm() >= 0)
+      return true;
+    LLVM_FALLTHROUGH;
+  case RISCV::ORI:
+  case RISCV::ORI64:
+  case RISCV::XORI:
+  case RISCV::XORI64:
+  case RISCV::COPY:
+    return MI->getOperand(1).isReg() &&
+           isSignExtended(MI->getOperand(1).getReg(), Visited, Depth);
+
+  case RISCV::SUBREG_TO_REG:
+    return isSignExtended(MI->getOperand(2).getReg(), Visited, Depth);
+
+  case RISCV::AND:
+  case RISCV::OR:
+  case RISCV::XOR:
+  case RISCV::AND64:
+  case RISCV::OR64:
+  case RISCV::XOR64:
+    return isSignExtended(MI->getOperand(1).getReg(), Visited, Depth) &&
+           isSignExtended(MI->getOperand(2).getReg(), Visited, Depth);
+
+  case RISCV::PHI:
+    for (unsigned I = 1, E = MI->getNumOperands(); I != E; I += 2)
+      if (!isSignExtended(MI->getOperand(I).getReg(), Visited, Depth))
+        return false;
+    return true;
+  }
+}
+
+static unsigned getWOpcode(const MachineInstr &MI) {
+  switch (MI.getOpcode()) {
+  default:
+    return 0;
+  case RISCV::ADD64:
+    return RISCV::ADDW;
+  case RISCV::SUB64:
+    return RISCV::SUBW;
+  case RISCV::MUL64:
+    return RISCV::MULW;
+  case RISCV::ADDI64:
+    // Leave frame index bases to frame lowering.
+    return MI.getOperand(1).isReg() && MI.getOperand(2).isImm() ? RISCV::ADDIW
+                                                                 : 0;
+  case RISCV::SLLI64:
+    // The low 32 bits of a 64-bit left shift only match SLLIW for shift
+    // amounts that fit in 5 bits.
+    return MI.getOperand(2).getImm() < 32 ? RISCV::SLLIW : 0;
+  }
+}
+
+// If Reg, or the 64-bit register whose low half Reg copies, is defined by a
+// single-use operation that has a W form, replace that operation with the W
+// form and return the new 32-bit register. CopyMI is set to the intervening
+// copy, which the caller deletes once the extension is gone.
+unsigned RISCVOptimizeSExt::rewriteToW(unsigned Reg, MachineInstr *&CopyMI) {
+  CopyMI = nullptr;
+  MachineInstr *DefMI = MRI->getVRegDef(Reg);
+  if (DefMI && DefMI->isCopy() && DefMI->getOperand(1).getSubReg() ==
+                                      RISCV::sub_32) {
+    unsigned SrcReg = DefMI->getOperand(1).getReg();
+    if (!TargetRegisterInfo::isVirtualRegister(SrcReg) ||
+        !MRI->hasOneNonDBGUse(Reg))
+      return 0;
+    CopyMI = DefMI;
+    Reg = SrcReg;
+    DefMI = MRI->getVRegDef(Reg);
+  }
+  if (!DefMI || !MRI->hasOneNonDBGUse(Reg))
+    return 0;
+
+  unsigned WOpc = getWOpcode(*DefMI);
+  if (!WOpc)
+    return 0;
+
+  unsigned NewReg = MRI->createVirtualRegister(&RISCV::GPRRegClass);
+  MachineInstrBuilder MIB = BuildMI(*DefMI->getParent(), DefMI,
+                                    DefMI->getDebugLoc(), TII->get(WOpc),
+                                    NewReg);
+  for (unsigned I = 1, E = DefMI->getNumOperands(); I != E; ++I) {
+    const MachineOperand &MO = DefMI->getOperand(I);
+    if (!MO.isReg())
+      MIB.add(MO);
+    else if (MO.getReg() == RISCV::X0_64)
+      MIB.addReg(RISCV::X0_32);
+    else
+      MIB.addReg(MO.getReg(), 0, RISCV::sub_32);
+  }
+
+  DEBUG(dbgs() << "Rewriting: " << *DefMI << "     into: " << *MIB);
+  DefMI->eraseFromParent();
+  ++NumWRewritten;
+  return NewReg;
+}
+
+// Make the uses of the extension in MI read SrcReg instead.
+bool RISCVOptimizeSExt::replaceExtension(MachineInstr &MI, unsigned DstReg,
+                                         unsigned SrcReg) {
+  if (!MRI->constrainRegClass(SrcReg, MRI->getRegClass(DstReg)))
+    return false;
+
+  DEBUG(dbgs() << "Removing redundant sign extension: " << MI);
+  MRI->replaceRegWith(DstReg, SrcReg);
+  MRI->clearKillFlags(SrcReg);
+  MI.eraseFromParent();
+  ++NumSExtRemoved;
+  return true;
+}
+
+// addiw rd, rs, 0
+bool RISCVOptimizeSExt::optimizeADDIW(MachineInstr &MI) {
+  const MachineOperand &Imm = MI.getOperand(2);
+  unsigned DstReg = MI.getOperand(0).getReg();
+  unsigned SrcReg = MI.getOperand(1).getReg();
+  if (!Imm.isImm() || Imm.getImm() != 0 ||
+      !TargetRegisterInfo::isVirtualRegister(SrcReg))
+    return false;
+
+  if (isSignExtended(SrcReg))
+    return replaceExtension(MI, DstReg, SrcReg);
+
+  MachineInstr *CopyMI;
+  unsigned NewReg = rewriteToW(SrcReg, CopyMI);
+  if (!NewReg)
+    return false;
+  if (CopyMI)
+    CopyMI->eraseFromParent();
+  return replaceExtension(MI, DstReg, NewReg);
+}
+
+// slli rt, rs, 32; srai rd, rt, 32
+bool RISCVOptimizeSExt::optimizeShiftPair(MachineInstr &MI) {
+  unsigned DstReg = MI.getOperand(0).getReg();
+  unsigned ShlReg = MI.getOperand(1).getReg();
+  if (MI.getOperand(2).getImm() != 32 ||
+      !TargetRegisterInfo::isVirtualRegister(ShlReg))
+    return false;
+
+  MachineInstr *ShlMI = MRI->getVRegDef(ShlReg);
+  if (!ShlMI || ShlMI->getOpcode() != RISCV::SLLI64 ||
+      ShlMI->getOperand(2).getImm() != 32)
+    return false;
+  unsigned SrcReg = ShlMI->getOperand(1).getReg();
+  if (!TargetRegisterInfo::isVirtualRegister(SrcReg))
+    return false;
+
+  if (isSignExtended(SrcReg)) {
+    if (!replaceExtension(MI, DstReg, SrcReg))
+      return false;
+    if (MRI->use_nodbg_empty(ShlReg))
+      ShlMI->eraseFromParent();
+    return true;
+  }
+
+  if (!MRI->hasOneNonDBGUse(ShlReg))
+    return false;
+  MachineInstr *CopyMI;
+  unsigned NewReg = rewriteToW(SrcReg, CopyMI);
+  if (!NewReg)
+    return false;
+  assert(!CopyMI && "Shift pair source is a 64-bit register");
+
+  unsigned ExtReg = MRI->createVirtualRegister(&RISCV::GPR64RegClass);
+  BuildMI(*MI.getParent(), MI, MI.getDebugLoc(),
+          TII->get(RISCV::SUBREG_TO_REG), ExtReg)
+      .addImm(0)
+      .addReg(NewReg)
+      .addImm(RISCV::sub_32);
+  ShlMI->eraseFromParent();
+  return replaceExtension(MI, DstReg, ExtReg);
+}
+
+bool RISCVOptimizeSExt::runOnMachineFunction(MachineFunction &Fn) {
+  if (skipFunction(*Fn.getFunction()))
+    return false;
+
+  const RISCVSubtarget &STI = Fn.getSubtarget<RISCVSubtarget>();
+  if (!STI.isRV64())
+    return false;
+
+  TII = STI.getInstrInfo();
+  MRI = &Fn.getRegInfo();
+  assert(MRI->isSSA() && "Expected to run on SSA form");
+
+  bool Modified = false;
+  for (MachineBasicBlock &MBB : Fn)
+    for (auto I = MBB.begin(), E = MBB.end(); I != E;) {
+      MachineInstr &MI = *I++;
+      if (MI.getOpcode() == RISCV::ADDIW)
+        Modified |= optimizeADDIW(MI);
+      else if (MI.getOpcode() == RISCV::SRAI64)
+        Modified |= optimizeShiftPair(MI);
+    }
+
+  return Modified;
+}
+
+/// createRISCVOptimizeSExtPass - returns an instance of the sign-extension
+/// elimination pass.
+FunctionPass *llvm::createRISCVOptimizeSExtPass() {
+  return new RISCVOptimizeSExt();
+}
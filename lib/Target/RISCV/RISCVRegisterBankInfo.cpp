@@ -0,0 +1,132 @@
+//===-- RISCVRegisterBankInfo.cpp -------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the RegisterBankInfo class for RISCV.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#include "RISCVRegisterBankInfo.h"
+#include "RISCVInstrInfo.h" // For the register classes
+#include "RISCVSubtarget.h"
+#include "llvm/CodeGen/GlobalISel/RegisterBank.h"
+#include "llvm/CodeGen/GlobalISel/RegisterBankInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+
+#define GET_TARGET_REGBANK_IMPL
+#include "RISCVGenRegisterBank.inc"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+namespace llvm {
+namespace RISCV {
+enum PartialMappingIdx {
+  PMI_GPR32,
+  PMI_GPR64,
+  PMI_Min = PMI_GPR32,
+};
+
+// Everything lives in the GPR bank. Values of up to 32 bits use the 32-bit
+// view of the registers, 64-bit values (RV64 only) the whole register.
+RegisterBankInfo::PartialMapping PartMappings[]{
+    // 32-bit GPR Partial Mapping
+    {0, 32, GPRRegBank},
+    // 64-bit GPR Partial Mapping
+    {0, 64, GPRRegBank},
+};
+
+enum ValueMappingIdx {
+  InvalidIdx = 0,
+  GPR32Idx = 1,
+  GPR64Idx = 2,
+};
+
+RegisterBankInfo::ValueMapping ValueMappings[] = {
+    // invalid
+    {nullptr, 0},
+    // 32-bit GPR
+    {&PartMappings[PMI_GPR32 - PMI_Min], 1},
+    // 64-bit GPR
+    {&PartMappings[PMI_GPR64 - PMI_Min], 1}};
+} // end namespace RISCV
+} // end namespace llvm
+
+RISCVRegisterBankInfo::RISCVRegisterBankInfo(const TargetRegisterInfo &TRI)
+    : RISCVGenRegisterBankInfo() {
+  static bool AlreadyInit = false;
+  // We have only one set of register banks, whatever the subtarget is, so the
+  // checks only need to be done once.
+  if (AlreadyInit)
+    return;
+  AlreadyInit = true;
+
+  const RegisterBank &RBGPR = getRegBank(RISCV::GPRRegBankID);
+  (void)RBGPR;
+  assert(&RISCV::GPRRegBank == &RBGPR && "The order in RegBanks is messed up");
+
+  assert(RBGPR.covers(*TRI.getRegClass(RISCV::GPRRegClassID)) &&
+         "Subclass not added?");
+  assert(RBGPR.covers(*TRI.getRegClass(RISCV::GPR64RegClassID)) &&
+         "Subclass not added?");
+  assert(RBGPR.covers(*TRI.getRegClass(RISCV::GPRCRegClassID)) &&
+         "Subclass not added?");
+  assert(RBGPR.covers(*TRI.getRegClass(RISCV::GPR64CRegClassID)) &&
+         "Subclass not added?");
+  assert(RBGPR.getSize() == 64 && "GPRs should hold up to 64-bit");
+}
+
+const RegisterBank &RISCVRegisterBankInfo::getRegBankFromRegClass(
+    const TargetRegisterClass &RC) const {
+  const RegisterBank &RBGPR = getRegBank(RISCV::GPRRegBankID);
+  if (RBGPR.covers(RC))
+    return RBGPR;
+  llvm_unreachable("Unsupported register kind");
+}
+
+const RegisterBankInfo::InstructionMapping &
+RISCVRegisterBankInfo::getInstrMapping(const MachineInstr &MI) const {
+  auto Opc = MI.getOpcode();
+
+  // Try the default logic for non-generic instructions that are either copies
+  // or already have some operands assigned to banks.
+  if (!isPreISelGenericOpcode(Opc)) {
+    const InstructionMapping &Mapping = getInstrMappingImpl(MI);
+    if (Mapping.isValid())
+      return Mapping;
+  }
+
+  const MachineFunction &MF = *MI.getParent()->getParent();
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  unsigned NumOperands = MI.getNumOperands();
+
+  // With a single bank the only thing to decide is the size of each value.
+  // Operands that aren't virtual registers (immediates, predicates, blocks)
+  // have no mapping.
+  SmallVector<const ValueMapping *, 4> OpdsMapping(NumOperands);
+  for (unsigned Idx = 0; Idx < NumOperands; ++Idx) {
+    const MachineOperand &MO = MI.getOperand(Idx);
+    if (!MO.isReg() || !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+      continue;
+    LLT Ty = MRI.getType(MO.getReg());
+    if (!Ty.isValid())
+      continue;
+    if (Ty.isVector() || Ty.getSizeInBits() > 64)
+      return getInvalidInstructionMapping();
+    OpdsMapping[Idx] = &RISCV::ValueMappings[Ty.getSizeInBits() <= 32
+                                                 ? RISCV::GPR32Idx
+                                                 : RISCV::GPR64Idx];
+  }
+
+  return getInstructionMapping(DefaultMappingID, /*Cost=*/1,
+                               getOperandsMapping(OpdsMapping), NumOperands);
+}
@@ -18,6 +18,7 @@
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/RegisterScavenging.h"
+#include "llvm/CodeGen/VirtRegMap.h"
 #include "llvm/IR/DebugInfo.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -36,10 +37,35 @@ RISCVRegisterInfo::RISCVRegisterInfo(const RISCVSubtarget &STI)
 
 const MCPhysReg *
 RISCVRegisterInfo::getCalleeSavedRegs(const MachineFunction *MF) const {
-  if(Subtarget.isRV64())
+  if (MF->getFunction()->hasFnAttribute("interrupt")) {
+    if (Subtarget.isRV64()) {
+      if (Subtarget.useHardDouble())
+        return CSR_Interrupt_RV64_D_SaveList;
+      if (Subtarget.useHardFloat())
+        return CSR_Interrupt_RV64_F_SaveList;
+      return CSR_Interrupt_RV64_SaveList;
+    } else if (Subtarget.hasE())
+      return CSR_Interrupt_RV32E_SaveList;
+    else if (Subtarget.useHardDouble())
+      return CSR_Interrupt_RV32_D_SaveList;
+    else if (Subtarget.useHardFloat())
+      return CSR_Interrupt_RV32_F_SaveList;
+    else
+      return CSR_Interrupt_RV32_SaveList;
+  }
+
+  if(Subtarget.isRV64()) {
+    if (Subtarget.useHardDouble())
+      return CSR_RV64_D_SaveList;
+    if (Subtarget.useHardFloat())
+      return CSR_RV64_F_SaveList;
     return CSR_RV64_SaveList;
-  else if(Subtarget.hasE())
+  } else if(Subtarget.hasE())
     return CSR_RV32E_SaveList;
+  else if (Subtarget.useHardDouble())
+    return CSR_RV32_D_SaveList;
+  else if (Subtarget.useHardFloat())
+    return CSR_RV32_F_SaveList;
   else
     return CSR_RV32_SaveList;
 }
@@ -77,8 +103,7 @@ BitVector RISCVRegisterInfo::getReservedRegs(const MachineFunction &MF) const {
   }
   // Reserve the base register if we need to both realign the stack and
   // allocate variable-sized objects at runtime. This should test the
-  if (needsStackRealignment(MF) &&
-      MF.getFrameInfo().hasVarSizedObjects()) {
+  if (getFrameLowering(MF)->hasBP(MF)) {
     Reserved.set(RISCV::X9_64);
     Reserved.set(RISCV::X9_32);
   }
@@ -90,6 +115,164 @@ const uint32_t *RISCVRegisterInfo::getNoPreservedMask() const {
   return CSR_NoRegs_RegMask;
 }
 
+namespace {
+// What an instruction needs from its register operands to have a compressed
+// form.
+enum CompressConstraint {
+  CC_None,
+  // rd and rs1 in GPRC, e.g. c.lw/c.sw/c.beqz.
+  CC_GPRC,
+  // rd == rs1, e.g. c.add/c.addi/c.slli.
+  CC_Tied,
+  // rd == rs1 and both in GPRC, e.g. c.and/c.sub/c.srli.
+  CC_TiedGPRC
+};
+}
+
+static CompressConstraint getCompressConstraint(const MachineInstr &MI) {
+  switch (MI.getOpcode()) {
+  default:
+    return CC_None;
+  case RISCV::ADD:
+  case RISCV::ADD64:
+  case RISCV::ADDI:
+  case RISCV::ADDI64:
+  case RISCV::ADDIW:
+  case RISCV::SLLI:
+  case RISCV::SLLI64:
+    return CC_Tied;
+  case RISCV::AND:
+  case RISCV::AND64:
+  case RISCV::OR:
+  case RISCV::OR64:
+  case RISCV::XOR:
+  case RISCV::XOR64:
+  case RISCV::SUB:
+  case RISCV::SUB64:
+  case RISCV::ADDW:
+  case RISCV::SUBW:
+  case RISCV::ANDI:
+  case RISCV::ANDI64:
+  case RISCV::SRLI:
+  case RISCV::SRLI64:
+  case RISCV::SRAI:
+  case RISCV::SRAI64:
+    return CC_TiedGPRC;
+  case RISCV::LW:
+  case RISCV::LW64:
+  case RISCV::SW:
+  case RISCV::SW64:
+    return MI.getOperand(2).isImm() && isShiftedUInt<5, 2>(
+               MI.getOperand(2).getImm()) ? CC_GPRC : CC_None;
+  case RISCV::LD:
+  case RISCV::SD:
+    return MI.getOperand(2).isImm() && isShiftedUInt<5, 3>(
+               MI.getOperand(2).getImm()) ? CC_GPRC : CC_None;
+  case RISCV::BEQ:
+  case RISCV::BNE:
+  case RISCV::BEQ64:
+  case RISCV::BNE64:
+    return MI.getOperand(1).getReg() == RISCV::X0_32 ||
+           MI.getOperand(1).getReg() == RISCV::X0_64 ? CC_GPRC : CC_None;
+  }
+}
+
+static bool isCommutableCompress(unsigned Opcode) {
+  switch (Opcode) {
+  default:
+    return false;
+  case RISCV::ADD:
+  case RISCV::ADD64:
+  case RISCV::ADDW:
+  case RISCV::AND:
+  case RISCV::AND64:
+  case RISCV::OR:
+  case RISCV::OR64:
+  case RISCV::XOR:
+  case RISCV::XOR64:
+    return true;
+  }
+}
+
+// When optimizing for size, prefer the registers that let the instructions
+// using VirtReg be compressed: the register already assigned to the operand
+// the compressed form ties it to, then the registers in GPRC.
+void RISCVRegisterInfo::getRegAllocationHints(
+    unsigned VirtReg, ArrayRef<MCPhysReg> Order,
+    SmallVectorImpl<MCPhysReg> &Hints, const MachineFunction &MF,
+    const VirtRegMap *VRM, const LiveRegMatrix *Matrix) const {
+  TargetRegisterInfo::getRegAllocationHints(VirtReg, Order, Hints, MF, VRM,
+                                            Matrix);
+
+  if (!VRM || !Subtarget.hasC() || !MF.getFunction()->optForSize())
+    return;
+
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  const TargetRegisterClass *RC = MRI.getRegClass(VirtReg);
+  const TargetRegisterClass *CRC =
+      Subtarget.isRV64() && RC->hasSuperClassEq(&RISCV::GPR64RegClass)
+          ? &RISCV::GPR64CRegClass
+          : &RISCV::GPRCRegClass;
+  // Candidates for a tied compressible form, paired with the number of
+  // instructions each one would make compressible.
+  SmallVector<std::pair<MCPhysReg, unsigned>, 4> TiedHints;
+  bool WantGPRC = false;
+
+  auto addTiedHint = [&](const MachineOperand &MO, bool NeedGPRC) {
+    if (!MO.isReg() || MO.getReg() == VirtReg)
+      return;
+    unsigned PhysReg = MO.getReg();
+    if (TargetRegisterInfo::isVirtualRegister(PhysReg))
+      PhysReg = VRM->getPhys(PhysReg);
+    if (PhysReg == VirtRegMap::NO_PHYS_REG || MRI.isReserved(PhysReg) ||
+        (NeedGPRC && !CRC->contains(PhysReg)) ||
+        !is_contained(Order, PhysReg) || is_contained(Hints, PhysReg))
+      return;
+    for (auto &Hint : TiedHints)
+      if (Hint.first == PhysReg) {
+        ++Hint.second;
+        return;
+      }
+    TiedHints.push_back({PhysReg, 1});
+  };
+
+  for (const MachineOperand &MO : MRI.reg_nodbg_operands(VirtReg)) {
+    const MachineInstr &MI = *MO.getParent();
+    CompressConstraint C = getCompressConstraint(MI);
+    if (C == CC_None)
+      continue;
+    unsigned OpIdx = MI.getOperandNo(&MO);
+    if (C == CC_GPRC) {
+      WantGPRC |= OpIdx < 2;
+      continue;
+    }
+    bool NeedGPRC = C == CC_TiedGPRC;
+    WantGPRC |= NeedGPRC;
+    if (OpIdx == 0) {
+      addTiedHint(MI.getOperand(1), NeedGPRC);
+      if (isCommutableCompress(MI.getOpcode()))
+        addTiedHint(MI.getOperand(2), NeedGPRC);
+    } else if (OpIdx == 1 ||
+               (OpIdx == 2 && isCommutableCompress(MI.getOpcode()))) {
+      addTiedHint(MI.getOperand(0), NeedGPRC);
+    }
+  }
+
+  std::stable_sort(TiedHints.begin(), TiedHints.end(),
+                   [](const std::pair<MCPhysReg, unsigned> &A,
+                      const std::pair<MCPhysReg, unsigned> &B) {
+                     return A.second > B.second;
+                   });
+  for (const auto &Hint : TiedHints)
+    Hints.push_back(Hint.first);
+  if (!WantGPRC)
+    return;
+  for (MCPhysReg Reg : Order)
+    if (CRC->contains(Reg) && !MRI.isReserved(Reg) &&
+        !is_contained(Hints, Reg))
+      Hints.push_back(Reg);
+}
+
 bool RISCVRegisterInfo::
 requiresRegisterScavenging(const MachineFunction &MF) const {
   return true;
@@ -110,72 +293,6 @@ requiresVirtualBaseRegisters(const MachineFunction &MF) const {
   return true;
 }
 
-// Return true if the instruction fit
-// 16 bit load/store format.
-static bool FitFrameBase16BitLoadStore(MachineInstr &MI, unsigned BaseReg,
-                                       int64_t Offset) {
-  unsigned Opc = MI.getOpcode();
-  int64_t Shift = 0;
-
-  // BaseReg must be SP
-  if (BaseReg != RISCV::X2_32 && BaseReg != RISCV::X2_64)
-    return false;
-
-  switch (Opc) {
-  case RISCV::LW:
-  case RISCV::SW:
-    Shift = 2;
-    break;
-  case RISCV::LD:
-  case RISCV::SD:
-    Shift = 3;
-    break;
-  default:
-    return false;
-  }
-
-  // Offset limitation is (imm6u << Shift)
-  if (!isUIntN(6 + Shift, Offset))
-    return false;
-
-  if (Offset % (1 << Shift) != 0)
-    return false;
-
-  return true;
-}
-
-static bool FitCADDI4SPN(MachineInstr &MI, unsigned BaseReg,
-                         int64_t Offset) {
-  unsigned Opc = MI.getOpcode();
-  unsigned RegNum = 0;
-
-  // BaseReg must be SP
-  if (BaseReg != RISCV::X2_32 && BaseReg != RISCV::X2_64)
-    return false;
-
-  // Offset limitation is (imm8u << 2)
-  if (!isUInt<10>(Offset))
-    return false;
-  if ((Offset % 4) != 0)
-    return false;
-
-  if ((MI.getOpcode() != RISCV::ADDI) &&
-      (MI.getOpcode() != RISCV::ADDI64))
-    return false;
-
-  if (!MI.getOperand(0).isReg())
-    return false;
-
-  RegNum = MI.getOperand(0).getReg();
-
-  if ((RegNum >= RISCV::X8_32) && (RegNum <= RISCV::X15_32))
-    return true;
-  if ((RegNum >= RISCV::X8_64) && (RegNum <= RISCV::X15_64))
-    return true;
-
-  return false;
-}
-
 void RISCVRegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
                                             int SPAdj, unsigned FIOperandNum,
                                             RegScavenger *RS) const {
@@ -202,8 +319,6 @@ void RISCVRegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
   MachineFrameInfo &MFI = MF.getFrameInfo();
   const RISCVInstrInfo &TII =
        *static_cast<const RISCVInstrInfo *>(MF.getSubtarget().getInstrInfo());
-  const RISCVRegisterInfo &RegInfo =
-       *static_cast<const RISCVRegisterInfo *>(MF.getSubtarget().getRegisterInfo());
   const RISCVFrameLowering *TFI = getFrameLowering(MF);
   DebugLoc DL = MI.getDebugLoc();
   unsigned BasePtr = (TFI->hasFP(MF) ? FP : SP);
@@ -227,7 +342,7 @@ void RISCVRegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
   // When dynamically realigning the stack, use the frame pointer for
   // parameters, and the stack/base pointer for locals.
   // see the function foo in the test case gcc.dg/torture/pr70421.c
-  if (RegInfo.needsStackRealignment(MF)) {
+  if (TFI->needsStackRealignment(MF)) {
     assert(TFI->hasFP(MF) && "dynamic stack realignment without a FP!");
     bool isFixed = MFI.isFixedObjectIndex(FrameIndex);
     if (MFI.hasVarSizedObjects() && !MFI.isFixedObjectIndex(FrameIndex)) {
@@ -254,39 +369,8 @@ void RISCVRegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
   // Fold imm into offset
   Offset += MI.getOperand(FIOperandNum + 1).getImm();
 
-  // Transfer to 16 bit format
-  // if the instruction fit 16 bit load/store limitation
-  if (Subtarget.hasC() && FitFrameBase16BitLoadStore(MI, BasePtr, Offset)) {
-    unsigned NewOpc;
-
-    switch (MI.getOpcode()) {
-    case RISCV::LW:
-      NewOpc = RISCV::CLWSP;
-      break;
-    case RISCV::SW:
-      NewOpc = RISCV::CSWSP;
-      break;
-    case RISCV::LD:
-      NewOpc = RISCV::CLDSP;
-      break;
-    case RISCV::SD:
-      NewOpc = RISCV::CSDSP;
-      break;
-    default:
-      llvm_unreachable("Cannot transfer to 16-bit instruction");
-    }
-
-    MI.setDesc(TII.get(NewOpc));
-    MI.getOperand(FIOperandNum).ChangeToRegister(BasePtr, false);
-    MI.getOperand(FIOperandNum + 1).ChangeToImmediate(Offset);
-    return;
-  } else if (Subtarget.hasC() && FitCADDI4SPN(MI, BasePtr, Offset)) {
-    MI.setDesc(TII.get(RISCV::CADDI4SPN));
-    MI.getOperand(FIOperandNum).ChangeToRegister(BasePtr, false);
-    MI.getOperand(FIOperandNum + 1).ChangeToImmediate(Offset);
-    return;
   // If the offset fits in an immediate, then directly encode it
-  } else if (isInt<12>(Offset)) {
+  if (isInt<12>(Offset)) {
     MI.getOperand(FIOperandNum).ChangeToRegister(BasePtr, false);
     MI.getOperand(FIOperandNum + 1).ChangeToImmediate(Offset);
     return;
@@ -313,10 +397,18 @@ unsigned RISCVRegisterInfo::getFrameRegister(const MachineFunction &MF) const {
 const uint32_t *
 RISCVRegisterInfo::getCallPreservedMask(const MachineFunction & /*MF*/,
                                         CallingConv::ID /*CC*/) const {
-  if(Subtarget.isRV64())
+  if(Subtarget.isRV64()) {
+    if (Subtarget.useHardDouble())
+      return CSR_RV64_D_RegMask;
+    if (Subtarget.useHardFloat())
+      return CSR_RV64_F_RegMask;
     return CSR_RV64_RegMask;
-  else if(Subtarget.hasE())
+  } else if(Subtarget.hasE())
     return CSR_RV32E_RegMask;
+  else if (Subtarget.useHardDouble())
+    return CSR_RV32_D_RegMask;
+  else if (Subtarget.useHardFloat())
+    return CSR_RV32_F_RegMask;
   else
     return CSR_RV32_RegMask;
 }
@@ -0,0 +1,125 @@
+//===-- RISCVSelectionDAGInfo.cpp - RISCV SelectionDAG Info ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the RISCVSelectionDAGInfo class.
+//
+// Copies and fills small enough for the MaxStoresPerMem* limits have already
+// been unrolled into loads and stores by the time these hooks run. The rest
+// either become a compact word loop, when the size is a known constant, the
+// buffers are word aligned and the loop would not outgrow a call, or a
+// libcall.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCVSelectionDAGInfo.h"
+#include "RISCVISelLowering.h"
+#include "RISCVSubtarget.h"
+#include "llvm/CodeGen/SelectionDAG.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "riscv-selectiondag-info"
+
+static cl::opt<unsigned> MemLoopMaxBytes(
+    "riscv-mem-loop-max-bytes", cl::Hidden, cl::init(256),
+    cl::desc("RISCV: Largest memcpy or memset done by an inline loop rather "
+             "than a libcall"));
+
+// Return the number of bytes each iteration of the inline loop moves per
+// store, or 0 if Align rules the loop out. Misaligned word accesses trap or
+// are emulated, so those are left to the libcall.
+static unsigned getLoopWidth(SelectionDAG &DAG, uint64_t Size, unsigned Align) {
+  MachineFunction &MF = DAG.getMachineFunction();
+  const RISCVSubtarget &STI = MF.getSubtarget<RISCVSubtarget>();
+  // Calls are shorter than the loop and its setup.
+  if (MF.getFunction()->optForSize() || Size > MemLoopMaxBytes)
+    return 0;
+  unsigned Width = STI.isRV64() && Align >= 8 ? 8 : Align >= 4 ? 4 : 0;
+  return Size >= Width ? Width : 0;
+}
+
+SDValue RISCVSelectionDAGInfo::EmitTargetCodeForMemcpy(
+    SelectionDAG &DAG, const SDLoc &DL, SDValue Chain, SDValue Dst,
+    SDValue Src, SDValue Size, unsigned Align, bool IsVolatile,
+    bool AlwaysInline, MachinePointerInfo DstPtrInfo,
+    MachinePointerInfo SrcPtrInfo) const {
+  auto *ConstSize = dyn_cast<ConstantSDNode>(Size);
+  if (!ConstSize)
+    return SDValue();
+  uint64_t SizeVal = ConstSize->getZExtValue();
+  unsigned Width = getLoopWidth(DAG, SizeVal, Align);
+  if (!Width)
+    return SDValue();
+
+  uint64_t LoopBytes = SizeVal & ~uint64_t(Width - 1);
+  SDValue Loop = DAG.getNode(RISCVISD::MEMCPY_LOOP, DL, MVT::Other, Chain, Dst,
+                             Src, DAG.getTargetConstant(LoopBytes, DL, MVT::i32),
+                             DAG.getTargetConstant(Width, DL, MVT::i32));
+  if (LoopBytes == SizeVal)
+    return Loop;
+
+  // The tail is narrower than a word, so it takes at most one load and store
+  // of each smaller width.
+  EVT PtrVT = Dst.getValueType();
+  SDValue Offset = DAG.getConstant(LoopBytes, DL, PtrVT);
+  return DAG.getMemcpy(
+      Loop, DL, DAG.getNode(ISD::ADD, DL, PtrVT, Dst, Offset),
+      DAG.getNode(ISD::ADD, DL, PtrVT, Src, Offset),
+      DAG.getConstant(SizeVal - LoopBytes, DL, Size.getValueType()),
+      MinAlign(Align, LoopBytes), IsVolatile, /*AlwaysInline=*/true,
+      /*isTailCall=*/false, DstPtrInfo.getWithOffset(LoopBytes),
+      SrcPtrInfo.getWithOffset(LoopBytes));
+}
+
+SDValue RISCVSelectionDAGInfo::EmitTargetCodeForMemset(
+    SelectionDAG &DAG, const SDLoc &DL, SDValue Chain, SDValue Dst,
+    SDValue Byte, SDValue Size, unsigned Align, bool IsVolatile,
+    MachinePointerInfo DstPtrInfo) const {
+  auto *ConstSize = dyn_cast<ConstantSDNode>(Size);
+  if (!ConstSize)
+    return SDValue();
+  uint64_t SizeVal = ConstSize->getZExtValue();
+  unsigned Width = getLoopWidth(DAG, SizeVal, Align);
+  if (!Width)
+    return SDValue();
+
+  // Replicate the byte across a register; the loop stores its low Width
+  // bytes. Zero is stored straight from x0.
+  EVT PtrVT = Dst.getValueType();
+  unsigned Bits = PtrVT.getSizeInBits();
+  SDValue Val;
+  if (isNullConstant(Byte)) {
+    Val = DAG.getRegister(Bits == 64 ? RISCV::X0_64 : RISCV::X0_32, PtrVT);
+  } else if (auto *C = dyn_cast<ConstantSDNode>(Byte)) {
+    Val = DAG.getConstant(
+        APInt::getSplat(Bits, C->getAPIntValue().zextOrTrunc(8)), DL, PtrVT);
+  } else {
+    Val = DAG.getNode(ISD::ZERO_EXTEND, DL, PtrVT, Byte);
+    for (unsigned Shift = 8; Shift < Bits; Shift *= 2)
+      Val = DAG.getNode(ISD::OR, DL, PtrVT, Val,
+                        DAG.getNode(ISD::SHL, DL, PtrVT, Val,
+                                    DAG.getConstant(Shift, DL, MVT::i32)));
+  }
+
+  uint64_t LoopBytes = SizeVal & ~uint64_t(Width - 1);
+  SDValue Loop = DAG.getNode(RISCVISD::MEMSET_LOOP, DL, MVT::Other, Chain, Dst,
+                             Val, DAG.getTargetConstant(LoopBytes, DL, MVT::i32),
+                             DAG.getTargetConstant(Width, DL, MVT::i32));
+  if (LoopBytes == SizeVal)
+    return Loop;
+
+  return DAG.getMemset(
+      Loop, DL,
+      DAG.getNode(ISD::ADD, DL, PtrVT, Dst,
+                  DAG.getConstant(LoopBytes, DL, PtrVT)),
+      Byte, DAG.getConstant(SizeVal - LoopBytes, DL, Size.getValueType()),
+      MinAlign(Align, LoopBytes), IsVolatile, /*isTailCall=*/false,
+      DstPtrInfo.getWithOffset(LoopBytes));
+}
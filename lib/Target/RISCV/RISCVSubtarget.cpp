@@ -12,8 +12,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "RISCV.h"
+#include "RISCVCallLowering.h"
 #include "RISCVFrameLowering.h"
+#include "RISCVLegalizerInfo.h"
+#include "RISCVRegisterBankInfo.h"
 #include "RISCVSubtarget.h"
+#include "RISCVTargetMachine.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/TargetRegistry.h"
 
 using namespace llvm;
@@ -26,12 +33,68 @@ using namespace llvm;
 
 void RISCVSubtarget::anchor() {}
 
+namespace {
+#ifdef LLVM_BUILD_GLOBAL_ISEL
+struct RISCVGISelActualAccessor : public GISelAccessor {
+  std::unique_ptr<CallLowering> CallLoweringInfo;
+  std::unique_ptr<InstructionSelector> InstSelector;
+  std::unique_ptr<LegalizerInfo> Legalizer;
+  std::unique_ptr<RegisterBankInfo> RegBankInfo;
+
+  const CallLowering *getCallLowering() const override {
+    return CallLoweringInfo.get();
+  }
+
+  const InstructionSelector *getInstructionSelector() const override {
+    return InstSelector.get();
+  }
+
+  const LegalizerInfo *getLegalizerInfo() const override {
+    return Legalizer.get();
+  }
+
+  const RegisterBankInfo *getRegBankInfo() const override {
+    return RegBankInfo.get();
+  }
+};
+#endif
+} // end anonymous namespace
+
 RISCVSubtarget &
 RISCVSubtarget::initializeSubtargetDependencies(StringRef CPU, StringRef FS,
                                                 const TargetMachine &TM) {
   std::string CPUName = RISCV_MC::selectRISCVCPU(TM.getTargetTriple(), CPU);
   // Parse features string.
   ParseSubtargetFeatures(CPUName, FS);
+
+  StringRef ABIName = TM.Options.MCOptions.getABIName();
+  if (ABIName.empty())
+    TargetABI = isRV64() ? ABI_LP64 : ABI_ILP32;
+  else {
+    int ABI = StringSwitch<int>(ABIName)
+                  .Case("ilp32", ABI_ILP32)
+                  .Case("ilp32f", ABI_ILP32F)
+                  .Case("ilp32d", ABI_ILP32D)
+                  .Case("lp64", ABI_LP64)
+                  .Case("lp64f", ABI_LP64F)
+                  .Case("lp64d", ABI_LP64D)
+                  .Default(-1);
+    if (ABI < 0)
+      report_fatal_error("unknown target ABI '" + ABIName + "'");
+    TargetABI = static_cast<RISCVABIEnum>(ABI);
+  }
+
+  bool IsRV64ABI = TargetABI == ABI_LP64 || TargetABI == ABI_LP64F ||
+                   TargetABI == ABI_LP64D;
+  if (IsRV64ABI != isRV64())
+    report_fatal_error("target ABI '" + ABIName + "' is not valid for " +
+                       (isRV64() ? "RV64" : "RV32"));
+  if (isSingleFloatABI() && !HasF)
+    report_fatal_error("target ABI '" + ABIName +
+                       "' requires the F extension");
+  if (isDoubleFloatABI() && !HasD)
+    report_fatal_error("target ABI '" + ABIName +
+                       "' requires the D extension");
   return *this;
 }
 
@@ -41,7 +104,47 @@ RISCVSubtarget::RISCVSubtarget(const Triple &TT, const std::string &CPU,
       RISCVArchVersion(RV32),
       HasM(false), HasA(false),
       HasF(false), HasD(false),
-      HasE(false), HasC(false),
+      HasE(false), HasC(false), HasXV5(false), HasP(false), HasB(false),
+      UseSoftFloat(false), EnableLinkerRelax(false), EnableSaveRestore(false),
       InstrInfo(initializeSubtargetDependencies(CPU, FS, TM)),
       FrameLowering(*this),
-      TLInfo(TM, *this){}
+      TLInfo(TM, *this) {
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+  GISelAccessor *GISel = new GISelAccessor();
+#else
+  RISCVGISelActualAccessor *GISel = new RISCVGISelActualAccessor();
+  GISel->CallLoweringInfo.reset(new RISCVCallLowering(*getTargetLowering()));
+  GISel->Legalizer.reset(new RISCVLegalizerInfo(*this));
+
+  auto *RBI = new RISCVRegisterBankInfo(*getRegisterInfo());
+
+  // FIXME: At this point, we can't rely on Subtarget having RBI.
+  // It's awkward to mix passing RBI and the Subtarget; should we pass
+  // TII/TRI as well?
+  GISel->InstSelector.reset(createRISCVInstructionSelector(
+      *static_cast<const RISCVTargetMachine *>(&TM), *this, *RBI));
+
+  GISel->RegBankInfo.reset(RBI);
+#endif
+  setGISelAccessor(*GISel);
+}
+
+const CallLowering *RISCVSubtarget::getCallLowering() const {
+  assert(GISel && "Access to GlobalISel APIs not set");
+  return GISel->getCallLowering();
+}
+
+const InstructionSelector *RISCVSubtarget::getInstructionSelector() const {
+  assert(GISel && "Access to GlobalISel APIs not set");
+  return GISel->getInstructionSelector();
+}
+
+const LegalizerInfo *RISCVSubtarget::getLegalizerInfo() const {
+  assert(GISel && "Access to GlobalISel APIs not set");
+  return GISel->getLegalizerInfo();
+}
+
+const RegisterBankInfo *RISCVSubtarget::getRegBankInfo() const {
+  assert(GISel && "Access to GlobalISel APIs not set");
+  return GISel->getRegBankInfo();
+}
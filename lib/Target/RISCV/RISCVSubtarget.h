@@ -17,7 +17,8 @@
 #include "RISCVFrameLowering.h"
 #include "RISCVISelLowering.h"
 #include "RISCVInstrInfo.h"
-#include "llvm/CodeGen/SelectionDAGTargetInfo.h"
+#include "RISCVSelectionDAGInfo.h"
+#include "llvm/CodeGen/GlobalISel/GISelAccessor.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
@@ -39,20 +40,42 @@ private:
 
   RISCVArchEnum RISCVArchVersion;
 
+  enum RISCVABIEnum {
+    ABI_ILP32,
+    ABI_ILP32F,
+    ABI_ILP32D,
+    ABI_LP64,
+    ABI_LP64F,
+    ABI_LP64D
+  };
+
+  // The ABI selected by -target-abi, defaulting to the soft-float ABI of
+  // the base ISA.
+  RISCVABIEnum TargetABI;
+
   bool HasM;
   bool HasA;
   bool HasF;
   bool HasD;
   bool HasE;
   bool HasC;
+  bool HasXV5;
+  bool HasP;
+  bool HasB;
 
   bool UseSoftFloat;
-
+  bool EnableLinkerRelax;
+  bool EnableSaveRestore;
 
   RISCVInstrInfo InstrInfo;
   RISCVFrameLowering FrameLowering;
   RISCVTargetLowering TLInfo;
-  const SelectionDAGTargetInfo TSInfo;
+  RISCVSelectionDAGInfo TSInfo;
+
+  /// Gather the accessor points to GlobalISel-related APIs.
+  /// This is used to avoid ifndefs spreading around while GISel is
+  /// an optional library.
+  std::unique_ptr<GISelAccessor> GISel;
 
   RISCVSubtarget &initializeSubtargetDependencies(StringRef CPU, StringRef FS,
                                                   const TargetMachine &TM);
@@ -66,6 +89,11 @@ public:
   // definition of this function is auto-generated by tblgen.
   void ParseSubtargetFeatures(StringRef CPU, StringRef FS);
 
+  /// This object will take onwership of \p GISelAccessor.
+  void setGISelAccessor(GISelAccessor &GISel) {
+    this->GISel.reset(&GISel);
+  }
+
   const RISCVFrameLowering *getFrameLowering() const override {
     return &FrameLowering;
   }
@@ -76,9 +104,15 @@ public:
   const RISCVTargetLowering *getTargetLowering() const override {
     return &TLInfo;
   }
-  const SelectionDAGTargetInfo *getSelectionDAGInfo() const override {
+  const RISCVSelectionDAGInfo *getSelectionDAGInfo() const override {
     return &TSInfo;
   }
+
+  const CallLowering *getCallLowering() const override;
+  const InstructionSelector *getInstructionSelector() const override;
+  const LegalizerInfo *getLegalizerInfo() const override;
+  const RegisterBankInfo *getRegBankInfo() const override;
+
   bool isRV32() const { return RISCVArchVersion == RV32; };
   bool isRV64() const { return RISCVArchVersion == RV64; };
 
@@ -88,8 +122,42 @@ public:
   bool hasD() const { return HasD; };
   bool hasE() const { return HasE; };
   bool hasC() const { return HasC; };
+  bool hasXV5() const { return HasXV5; };
+  bool hasP() const { return HasP; };
+  bool hasB() const { return HasB; };
 
   bool useSoftFloat() const { return UseSoftFloat; }
+  bool enableLinkerRelax() const { return EnableLinkerRelax; }
+  bool enableSaveRestore() const { return EnableSaveRestore; }
+
+  // Only run the MachineScheduler for CPUs that have a machine model; the
+  // generic CPUs keep the SelectionDAG's source-order schedule.
+  bool enableMachineScheduler() const override {
+    return getSchedModel().hasInstrSchedModel();
+  }
+
+  // RISCVInstrInfo::insertSelect builds branch-free selects from slt/sltu
+  // and masking, so diamonds can always be flattened when cheap enough.
+  bool enableEarlyIfConversion() const override { return true; }
+
+  // Whether f32 values live in FPRs. Floating-point is only done in hardware
+  // when the ABI passes the corresponding values in FPRs.
+  bool useHardFloat() const {
+    return !UseSoftFloat &&
+           (TargetABI == ABI_ILP32F || TargetABI == ABI_ILP32D ||
+            TargetABI == ABI_LP64F || TargetABI == ABI_LP64D);
+  }
+  // Whether f64 values live in FPRs.
+  bool useHardDouble() const {
+    return !UseSoftFloat && HasD &&
+           (TargetABI == ABI_ILP32D || TargetABI == ABI_LP64D);
+  }
+  bool isSingleFloatABI() const {
+    return TargetABI == ABI_ILP32F || TargetABI == ABI_LP64F;
+  }
+  bool isDoubleFloatABI() const {
+    return TargetABI == ABI_ILP32D || TargetABI == ABI_LP64D;
+  }
 };
 } // End llvm namespace
 
@@ -13,8 +13,13 @@
 
 #include "RISCV.h"
 #include "RISCVTargetMachine.h"
+#include "RISCVTargetObjectFile.h"
+#include "RISCVTargetTransformInfo.h"
 #include "llvm/ADT/STLExtras.h"
-#include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
+#include "llvm/CodeGen/GlobalISel/IRTranslator.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelect.h"
+#include "llvm/CodeGen/GlobalISel/Legalizer.h"
+#include "llvm/CodeGen/GlobalISel/RegBankSelect.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/CodeGen/Passes.h"
@@ -27,9 +32,31 @@ static cl::opt<bool>
     BranchRelaxation("riscv-enable-branch-relax", cl::Hidden, cl::init(true),
                      cl::desc("Relax out of range conditional branches"));
 
+static cl::opt<bool>
+    EnableSExtOpt("riscv-enable-sext-opt", cl::Hidden, cl::init(true),
+                  cl::desc("Remove redundant sign extensions of i32 values "
+                           "on RV64"));
+
+static cl::opt<bool>
+    EnableEarlyIfConversion("riscv-enable-early-ifcvt", cl::Hidden,
+                            cl::init(true),
+                            cl::desc("Flatten small if-then(-else) diamonds "
+                                     "into branch-free selects"));
+
+// GlobalISel only covers part of the IR, so by default a function it cannot
+// handle is handed back to SelectionDAG instead of aborting the compilation.
+static cl::opt<bool>
+    EnableGlobalISelAbort("riscv-global-isel-abort", cl::Hidden,
+                          cl::init(false),
+                          cl::desc("Abort instead of falling back to "
+                                   "SelectionDAG when GlobalISel fails"));
+
 extern "C" void LLVMInitializeRISCVTarget() {
   RegisterTargetMachine<RISCVTargetMachine> X(getTheRISCV32Target());
   RegisterTargetMachine<RISCVTargetMachine> Y(getTheRISCV64Target());
+
+  PassRegistry &Registry = *PassRegistry::getPassRegistry();
+  initializeGlobalISel(Registry);
 }
 
 static std::string computeDataLayout(const Triple &TT) {
@@ -60,11 +87,17 @@ RISCVTargetMachine::RISCVTargetMachine(const Target &T, const Triple &TT,
                                        CodeGenOpt::Level OL)
     : LLVMTargetMachine(T, computeDataLayout(TT), TT, CPU, FS, Options,
                         getEffectiveRelocModel(TT, RM), CM, OL),
-      TLOF(make_unique<TargetLoweringObjectFileELF>()),
+      TLOF(make_unique<RISCVELFTargetObjectFile>()),
       Subtarget(TT, CPU, FS, *this) {
   initAsmInfo();
 }
 
+TargetIRAnalysis RISCVTargetMachine::getTargetIRAnalysis() {
+  return TargetIRAnalysis([this](const Function &F) {
+    return TargetTransformInfo(RISCVTTIImpl(this, F));
+  });
+}
+
 namespace {
 class RISCVPassConfig : public TargetPassConfig {
 public:
@@ -75,7 +108,19 @@ public:
     return getTM<RISCVTargetMachine>();
   }
 
+  void addIRPasses() override;
   bool addInstSelector() override;
+  void addMachineSSAOptimization() override;
+  bool addILPOpts() override;
+#ifdef LLVM_BUILD_GLOBAL_ISEL
+  bool addIRTranslator() override;
+  bool addLegalizeMachineIR() override;
+  bool addRegBankSelect() override;
+  bool addGlobalInstructionSelect() override;
+#endif
+  bool isGlobalISelAbortEnabled() const override {
+    return EnableGlobalISelAbort;
+  }
   void addPreEmitPass() override;
   void addPreSched2() override;
 };
@@ -85,17 +130,65 @@ TargetPassConfig *RISCVTargetMachine::createPassConfig(PassManagerBase &PM) {
   return new RISCVPassConfig(*this, PM);
 }
 
+void RISCVPassConfig::addIRPasses() {
+  // Fence atomic loads and stores, and turn word nand into a
+  // compare-and-swap loop, before they reach the DAG.
+  addPass(createAtomicExpandPass());
+
+  TargetPassConfig::addIRPasses();
+}
+
 bool RISCVPassConfig::addInstSelector() {
   addPass(createRISCVISelDag(getRISCVTargetMachine()));
 
   return false;
 }
 
+void RISCVPassConfig::addMachineSSAOptimization() {
+  // Drop the extensions of i32 values that are already sign-extended before
+  // the generic SSA optimizations clean up the copies this leaves behind.
+  if (EnableSExtOpt)
+    addPass(createRISCVOptimizeSExtPass());
+
+  TargetPassConfig::addMachineSSAOptimization();
+}
+
+bool RISCVPassConfig::addILPOpts() {
+  if (EnableEarlyIfConversion)
+    addPass(&EarlyIfConverterID);
+  return true;
+}
+
+#ifdef LLVM_BUILD_GLOBAL_ISEL
+bool RISCVPassConfig::addIRTranslator() {
+  addPass(new IRTranslator());
+  return false;
+}
+
+bool RISCVPassConfig::addLegalizeMachineIR() {
+  addPass(new Legalizer());
+  return false;
+}
+
+bool RISCVPassConfig::addRegBankSelect() {
+  addPass(new RegBankSelect());
+  return false;
+}
+
+bool RISCVPassConfig::addGlobalInstructionSelect() {
+  addPass(new InstructionSelect());
+  return false;
+}
+#endif
+
 void RISCVPassConfig::addPreEmitPass() {
   // Relax conditional branch instructions if they're otherwise out of
   // range of their destination.
   if (BranchRelaxation)
     addPass(&BranchRelaxationPassID);
+
+  // Size the compact jump tables now that the code has settled.
+  addPass(createRISCVCompressJumpTablesPass());
 }
 
 void RISCVPassConfig::addPreSched2() {
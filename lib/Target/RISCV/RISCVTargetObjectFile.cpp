@@ -0,0 +1,89 @@
+//===-- RISCVTargetObjectFile.cpp - RISCV Object Info ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCVTargetObjectFile.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCSectionELF.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Target/TargetMachine.h"
+using namespace llvm;
+
+// Equivalent of GCC's -msmall-data-limit. A limit of 0 disables small data.
+static cl::opt<unsigned>
+SSThreshold("riscv-ssection-threshold", cl::Hidden,
+            cl::desc("Small data and bss section threshold size (default=8)"),
+            cl::init(8));
+
+void RISCVELFTargetObjectFile::Initialize(MCContext &Ctx,
+                                          const TargetMachine &TM) {
+  TargetLoweringObjectFileELF::Initialize(Ctx, TM);
+  InitializeELF(TM.Options.UseInitArray);
+
+  SmallDataSection = getContext().getELFSection(
+      ".sdata", ELF::SHT_PROGBITS, ELF::SHF_WRITE | ELF::SHF_ALLOC);
+  SmallBSSSection = getContext().getELFSection(".sbss", ELF::SHT_NOBITS,
+                                               ELF::SHF_WRITE | ELF::SHF_ALLOC);
+}
+
+bool RISCVELFTargetObjectFile::isGlobalInSmallSection(
+    const GlobalObject *GO, const TargetMachine &TM) const {
+  if (!isGlobalInSmallSectionImpl(GO, TM))
+    return false;
+
+  SectionKind Kind = getKindForGlobal(GO, TM);
+  return Kind.isData() || Kind.isBSS();
+}
+
+// A global goes into .sdata/.sbss, and so may be addressed with a single
+// gp-relative instruction, when the linker is guaranteed to place it within
+// reach of gp: it must be defined in this module and be no larger than the
+// threshold.
+bool RISCVELFTargetObjectFile::isGlobalInSmallSectionImpl(
+    const GlobalObject *GO, const TargetMachine &TM) const {
+  // gp is only valid for the executable, so position-independent code can't
+  // use it.
+  if (SSThreshold == 0 || TM.isPositionIndependent())
+    return false;
+
+  // Only global variables, not functions.
+  const GlobalVariable *GVA = dyn_cast<GlobalVariable>(GO);
+  if (!GVA)
+    return false;
+
+  // A declaration may be defined anywhere, and a definition that can be
+  // replaced at link time may be replaced by one that isn't small data.
+  if (GVA->isDeclaration() || GVA->isInterposable() ||
+      GVA->hasCommonLinkage() || !GVA->hasExactDefinition())
+    return false;
+
+  // Thread-local and explicitly placed data keep their own sections.
+  if (GVA->isThreadLocal() || GVA->hasSection())
+    return false;
+
+  // gcc has traditionally not treated zero-sized objects as small data, so
+  // this is effectively part of the ABI.
+  uint64_t Size =
+      GVA->getParent()->getDataLayout().getTypeAllocSize(GVA->getValueType());
+  return Size > 0 && Size <= SSThreshold;
+}
+
+MCSection *RISCVELFTargetObjectFile::SelectSectionForGlobal(
+    const GlobalObject *GO, SectionKind Kind, const TargetMachine &TM) const {
+  // Handle Small Section classification here.
+  if (Kind.isBSS() && isGlobalInSmallSectionImpl(GO, TM))
+    return SmallBSSSection;
+  if (Kind.isData() && isGlobalInSmallSectionImpl(GO, TM))
+    return SmallDataSection;
+
+  // Otherwise, we work the same as ELF.
+  return TargetLoweringObjectFileELF::SelectSectionForGlobal(GO, Kind, TM);
+}
@@ -21,6 +21,9 @@ namespace llvm {
 class RISCVTargetStreamer : public MCTargetStreamer {
 public:
   RISCVTargetStreamer(MCStreamer &S);
+
+  // Record the ABI selected by -target-abi.
+  virtual void emitTargetABI(StringRef ABIName) {}
 };
 
 // This part is for ELF object output
@@ -30,6 +33,8 @@ class RISCVTargetELFStreamer : public RISCVTargetStreamer {
 public:
   MCELFStreamer &getStreamer();
   RISCVTargetELFStreamer(MCStreamer &S, const MCSubtargetInfo &STI);
+
+  void emitTargetABI(StringRef ABIName) override;
 };
 }
 #endif
@@ -0,0 +1,379 @@
+//===-- RISCVTargetTransformInfo.cpp - RISCV specific TTI -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements a TargetTransformInfo analysis pass specific to the
+/// RISCV target machine. It uses the target's detailed information to provide
+/// more precise answers to certain TTI queries, while letting the target
+/// independent and default TTI implementations handle the rest.
+///
+//===----------------------------------------------------------------------===//
+
+#include "RISCVTargetTransformInfo.h"
+#include "RISCVAnalyzeImmediate.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Target/CostTable.h"
+#include "llvm/Target/TargetLowering.h"
+using namespace llvm;
+
+#define DEBUG_TYPE "riscvtti"
+
+// Cost of an operation that is lowered to a runtime library call: the
+// argument moves, the call itself and the caller-saved registers it clobbers.
+static const unsigned LibcallCost = 10;
+
+bool RISCVTTIImpl::isSoftFloatTy(Type *Ty) const {
+  Ty = Ty->getScalarType();
+  if (Ty->isFloatTy())
+    return !ST->useHardFloat();
+  if (Ty->isDoubleTy())
+    return !ST->useHardDouble();
+  // fp128 and friends are always done in software.
+  return Ty->isFloatingPointTy();
+}
+
+//===----------------------------------------------------------------------===//
+//
+// RISCV cost model.
+//
+//===----------------------------------------------------------------------===//
+
+int RISCVTTIImpl::getIntImmCost(const APInt &Imm, Type *Ty) {
+  assert(Ty->isIntegerTy());
+
+  unsigned BitSize = Ty->getPrimitiveSizeInBits();
+  if (BitSize == 0)
+    return ~0U;
+
+  // Zero is always available in x0.
+  if (Imm == 0)
+    return TTI::TCC_Free;
+
+  // Constants wider than XLEN are materialized one register at a time, each
+  // with the same LUI/ADDI/SLLI sequence that expandMOV64BitImm emits.
+  unsigned XLen = getXLen();
+  APInt ImmVal = Imm.sextOrTrunc(alignTo(BitSize, XLen));
+  int Cost = 0;
+  for (unsigned ShiftVal = 0; ShiftVal < BitSize; ShiftVal += XLen) {
+    int64_t Part = ImmVal.ashr(ShiftVal).sextOrTrunc(XLen).getSExtValue();
+    if (Part == 0)
+      continue;
+    RISCVAnalyzeImmediate AnalyzeImm;
+    Cost += AnalyzeImm.Analyze(Part, XLen, false).size();
+  }
+  return std::max(1, Cost);
+}
+
+int RISCVTTIImpl::getIntImmCost(unsigned Opcode, unsigned Idx,
+                                const APInt &Imm, Type *Ty) {
+  assert(Ty->isIntegerTy());
+
+  unsigned BitSize = Ty->getPrimitiveSizeInBits();
+  if (BitSize == 0)
+    return TTI::TCC_Free;
+
+  // Whether the constant can be folded into the 12-bit signed immediate field
+  // of the instruction that implements Opcode.
+  bool Takes12BitImm = false;
+  switch (Opcode) {
+  default:
+    break;
+  case Instruction::GetElementPtr:
+    // Never hoist GEP indices; CodeGenPrepare splits large offsets into a
+    // base and a load/store offset better than constant hoisting can.
+    return TTI::TCC_Free;
+  case Instruction::Add:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+  case Instruction::ICmp:
+    Takes12BitImm = true;
+    break;
+  case Instruction::Sub:
+    // sub x, C is selected as addi x, -C.
+    if (Idx == 1 && (-Imm).getMinSignedBits() <= 12)
+      return TTI::TCC_Free;
+    break;
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+    // The shift amount is always an immediate.
+    if (Idx == 1)
+      return TTI::TCC_Free;
+    break;
+  case Instruction::Mul:
+    // Multiplication by a power of two is a shift.
+    if (Idx == 1 && Imm.isPowerOf2())
+      return TTI::TCC_Free;
+    break;
+  case Instruction::SDiv:
+  case Instruction::UDiv:
+  case Instruction::SRem:
+  case Instruction::URem:
+    // Division by a constant is turned into a multiply and shifts, but only
+    // if the constant stays visible to instruction selection.
+    if (Idx == 1)
+      return TTI::TCC_Free;
+    break;
+  }
+
+  if (Takes12BitImm && Imm.getMinSignedBits() <= 12)
+    return TTI::TCC_Free;
+
+  return getIntImmCost(Imm, Ty);
+}
+
+unsigned RISCVTTIImpl::getFPOpCost(Type *Ty) {
+  if (isSoftFloatTy(Ty))
+    return TTI::TCC_Expensive;
+  return TTI::TCC_Basic;
+}
+
+unsigned RISCVTTIImpl::getOperationCost(unsigned Opcode, Type *Ty,
+                                        Type *OpTy) {
+  switch (Opcode) {
+  default:
+    break;
+  case Instruction::FAdd:
+  case Instruction::FSub:
+  case Instruction::FMul:
+  case Instruction::FDiv:
+  case Instruction::FRem:
+  case Instruction::SIToFP:
+  case Instruction::UIToFP:
+    if (isSoftFloatTy(Ty))
+      return TTI::TCC_Expensive;
+    break;
+  case Instruction::FCmp:
+  case Instruction::FPToSI:
+  case Instruction::FPToUI:
+    if (OpTy && isSoftFloatTy(OpTy))
+      return TTI::TCC_Expensive;
+    break;
+  case Instruction::FPExt:
+  case Instruction::FPTrunc:
+    if (isSoftFloatTy(Ty) || (OpTy && isSoftFloatTy(OpTy)))
+      return TTI::TCC_Expensive;
+    break;
+  case Instruction::Mul:
+    if (!ST->hasM())
+      return TTI::TCC_Expensive;
+    break;
+  }
+
+  return BaseT::getOperationCost(Opcode, Ty, OpTy);
+}
+
+void RISCVTTIImpl::getUnrollingPreferences(Loop *L, ScalarEvolution &SE,
+                                           TTI::UnrollingPreferences &UP) {
+  // The cores we target are small and in-order with no loop buffer, so the
+  // main win from unrolling is removing the loop overhead of short bodies.
+  // Keep full unrolling modest, never unroll when optimizing for size and
+  // don't generate runtime remainder loops.
+  UP.Threshold = 150;
+  UP.OptSizeThreshold = 0;
+  UP.PartialOptSizeThreshold = 0;
+  UP.Runtime = false;
+
+  // Partially unroll only small loops without calls. Soft-float operations
+  // are calls too, even though they don't look like it in IR.
+  for (BasicBlock *BB : L->blocks()) {
+    for (Instruction &I : *BB) {
+      if (isa<CallInst>(I) || isa<InvokeInst>(I)) {
+        ImmutableCallSite CS(&I);
+        if (const Function *F = CS.getCalledFunction())
+          if (!isLoweredToCall(F))
+            continue;
+        return;
+      }
+      if ((isa<BinaryOperator>(I) || isa<FCmpInst>(I) ||
+           (isa<CastInst>(I) && !isa<BitCastInst>(I))) &&
+          (isSoftFloatTy(I.getType()) ||
+           isSoftFloatTy(I.getOperand(0)->getType())))
+        return;
+    }
+  }
+
+  UP.Partial = true;
+  UP.PartialThreshold = 32;
+}
+
+int RISCVTTIImpl::getArithmeticInstrCost(
+    unsigned Opcode, Type *Ty, TTI::OperandValueKind Opd1Info,
+    TTI::OperandValueKind Opd2Info, TTI::OperandValueProperties Opd1PropInfo,
+    TTI::OperandValueProperties Opd2PropInfo, ArrayRef<const Value *> Args) {
+  if (Ty->isVectorTy())
+    return BaseT::getArithmeticInstrCost(Opcode, Ty, Opd1Info, Opd2Info,
+                                         Opd1PropInfo, Opd2PropInfo, Args);
+
+  std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, Ty);
+  int ISD = TLI->InstructionOpcodeToISD(Opcode);
+  assert(ISD && "Invalid opcode");
+
+  bool ConstOp2 = Opd2Info == TTI::OK_UniformConstantValue;
+  bool Pow2Op2 = ConstOp2 && Opd2PropInfo == TTI::OP_PowerOf2;
+  // The cost model only classifies vector constants, so look at a scalar
+  // operand itself.
+  if (Args.size() == 2)
+    if (const auto *CI = dyn_cast<ConstantInt>(Args[1])) {
+      ConstOp2 = true;
+      Pow2Op2 |= CI->getValue().isPowerOf2();
+    }
+
+  switch (ISD) {
+  default:
+    break;
+  case ISD::FADD:
+  case ISD::FSUB:
+  case ISD::FMUL:
+  case ISD::FDIV:
+  case ISD::FREM:
+    if (isSoftFloatTy(Ty))
+      return LT.first * LibcallCost;
+    break;
+  case ISD::MUL:
+    if (ST->hasM() || Pow2Op2)
+      break;
+    // Without M, multiplying by a constant is done with shifts and adds.
+    if (ConstOp2)
+      return LT.first * 3;
+    return LT.first * LibcallCost;
+  case ISD::SDIV:
+  case ISD::UDIV:
+  case ISD::SREM:
+  case ISD::UREM:
+    if (Pow2Op2)
+      break;
+    // Division by other constants needs MULH, which is also a libcall
+    // without M.
+    if (!ST->hasM())
+      return LT.first * LibcallCost;
+    // The divider is iterative on every core we support.
+    if (!ConstOp2)
+      return LT.first * TTI::TCC_Expensive;
+    break;
+  }
+
+  return BaseT::getArithmeticInstrCost(Opcode, Ty, Opd1Info, Opd2Info,
+                                       Opd1PropInfo, Opd2PropInfo, Args);
+}
+
+int RISCVTTIImpl::getCastInstrCost(unsigned Opcode, Type *Dst, Type *Src,
+                                   const Instruction *I) {
+  switch (Opcode) {
+  default:
+    break;
+  case Instruction::FPToSI:
+  case Instruction::FPToUI:
+  case Instruction::SIToFP:
+  case Instruction::UIToFP:
+  case Instruction::FPExt:
+  case Instruction::FPTrunc:
+    if (!Dst->isVectorTy() && (isSoftFloatTy(Dst) || isSoftFloatTy(Src)))
+      return LibcallCost;
+    break;
+  }
+
+  return BaseT::getCastInstrCost(Opcode, Dst, Src, I);
+}
+
+int RISCVTTIImpl::getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
+                                     Type *CondTy, const Instruction *I) {
+  if (Opcode == Instruction::FCmp && !ValTy->isVectorTy() &&
+      isSoftFloatTy(ValTy))
+    return LibcallCost;
+
+  return BaseT::getCmpSelInstrCost(Opcode, ValTy, CondTy, I);
+}
+
+// Approximate length of the generic expansions of the bit-counting
+// intrinsics, none of which has a native instruction in the base ISA.
+static const CostTblEntry BitManipCostTbl[] = {
+  { ISD::BSWAP,      MVT::i16, 4 },
+  { ISD::BSWAP,      MVT::i32, 10 },
+  { ISD::BSWAP,      MVT::i64, 22 },
+  { ISD::BITREVERSE, MVT::i8,  14 },
+  { ISD::BITREVERSE, MVT::i16, 18 },
+  { ISD::BITREVERSE, MVT::i32, 28 },
+  { ISD::BITREVERSE, MVT::i64, 36 },
+  { ISD::CTPOP,      MVT::i32, 13 },
+  { ISD::CTPOP,      MVT::i64, 18 },
+  { ISD::CTLZ,       MVT::i32, 24 },
+  { ISD::CTLZ,       MVT::i64, 31 },
+  { ISD::CTTZ,       MVT::i32, 17 },
+  { ISD::CTTZ,       MVT::i64, 22 },
+};
+
+int RISCVTTIImpl::getIntrinsicInstrCost(Intrinsic::ID IID, Type *RetTy,
+                                        ArrayRef<Type *> Tys,
+                                        FastMathFlags FMF,
+                                        unsigned ScalarizationCostPassed) {
+  unsigned ISD = ISD::DELETED_NODE;
+  switch (IID) {
+  default:
+    break;
+  case Intrinsic::bswap:
+    ISD = ISD::BSWAP;
+    break;
+  case Intrinsic::bitreverse:
+    ISD = ISD::BITREVERSE;
+    break;
+  case Intrinsic::ctpop:
+    ISD = ISD::CTPOP;
+    break;
+  case Intrinsic::ctlz:
+    ISD = ISD::CTLZ;
+    break;
+  case Intrinsic::cttz:
+    ISD = ISD::CTTZ;
+    break;
+  }
+
+  if (ISD != ISD::DELETED_NODE && RetTy->isIntegerTy()) {
+    std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, RetTy);
+    MVT MTy = LT.second;
+    if (MTy.getSizeInBits() < RetTy->getPrimitiveSizeInBits())
+      MTy = MVT::getIntegerVT(RetTy->getPrimitiveSizeInBits());
+    // B does these in one instruction. Types narrower than i32 also need
+    // the operand extended or the result adjusted.
+    if (ST->hasB() && ISD != ISD::BITREVERSE &&
+        MTy.getSizeInBits() <= getXLen())
+      return LT.first * (MTy.getSizeInBits() < 32 ? 2 : 1);
+    if (const auto *Entry = CostTableLookup(BitManipCostTbl, ISD, MTy)) {
+      int Cost = Entry->Cost;
+      // Without M the population count, and the CTLZ and CTTZ expansions
+      // built on top of it, sum the byte counts with shifts and adds rather
+      // than a multiply.
+      if ((ISD == ISD::CTPOP || ISD == ISD::CTLZ || ISD == ISD::CTTZ) &&
+          !ST->hasM())
+        Cost += 2;
+      return Cost;
+    }
+  }
+
+  return BaseT::getIntrinsicInstrCost(IID, RetTy, Tys, FMF,
+                                      ScalarizationCostPassed);
+}
+
+int RISCVTTIImpl::getIntrinsicInstrCost(Intrinsic::ID IID, Type *RetTy,
+                                        ArrayRef<Value *> Args,
+                                        FastMathFlags FMF, unsigned VF) {
+  // Scalar calls don't need the argument values, so route them through the
+  // type-based query above.
+  if (VF == 1 && !RetTy->isVectorTy()) {
+    SmallVector<Type *, 4> Tys;
+    for (const Value *Arg : Args)
+      Tys.push_back(Arg->getType());
+    return getIntrinsicInstrCost(IID, RetTy, Tys, FMF);
+  }
+
+  return BaseT::getIntrinsicInstrCost(IID, RetTy, Args, FMF, VF);
+}
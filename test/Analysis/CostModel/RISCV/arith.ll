@@ -0,0 +1,70 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=riscv32 \
+; RUN:   | FileCheck -check-prefixes=CHECK,SOFT %s
+; RUN: opt < %s -cost-model -analyze -mtriple=riscv32 -mattr=+m,+f \
+; RUN:   -target-abi ilp32f | FileCheck -check-prefixes=CHECK,HARD %s
+
+; Without M, multiplication and division are libcalls unless the divisor is a
+; power of two or the multiplier a constant.
+
+define i32 @mul(i32 %a, i32 %b) {
+; CHECK-LABEL: 'mul'
+; SOFT: cost of 10 {{.*}} mul i32 %a, %b
+; HARD: cost of 1 {{.*}} mul i32 %a, %b
+; SOFT: cost of 3 {{.*}} mul i32 %a, 5
+; HARD: cost of 1 {{.*}} mul i32 %a, 5
+  %1 = mul i32 %a, %b
+  %2 = mul i32 %a, 5
+  %3 = add i32 %1, %2
+  ret i32 %3
+}
+
+define i32 @sdiv(i32 %a, i32 %b) {
+; CHECK-LABEL: 'sdiv'
+; SOFT: cost of 10 {{.*}} sdiv i32 %a, %b
+; HARD: cost of 4 {{.*}} sdiv i32 %a, %b
+; CHECK: cost of 1 {{.*}} sdiv i32 %a, 8
+  %1 = sdiv i32 %a, %b
+  %2 = sdiv i32 %a, 8
+  %3 = add i32 %1, %2
+  ret i32 %3
+}
+
+define float @fadd(float %a, float %b) {
+; CHECK-LABEL: 'fadd'
+; SOFT: cost of 10 {{.*}} fadd float
+; HARD: cost of 2 {{.*}} fadd float
+  %1 = fadd float %a, %b
+  ret float %1
+}
+
+define i1 @fcmp(float %a, float %b) {
+; CHECK-LABEL: 'fcmp'
+; SOFT: cost of 10 {{.*}} fcmp olt float
+; HARD: cost of 1 {{.*}} fcmp olt float
+  %1 = fcmp olt float %a, %b
+  ret i1 %1
+}
+
+define float @sitofp(i32 %a) {
+; CHECK-LABEL: 'sitofp'
+; SOFT: cost of 10 {{.*}} sitofp i32
+; HARD: cost of 1 {{.*}} sitofp i32
+  %1 = sitofp i32 %a to float
+  ret float %1
+}
+
+declare i32 @llvm.ctpop.i32(i32)
+declare i32 @llvm.bswap.i32(i32)
+
+; There is no native popcount or byte swap. Without M the popcount expansion
+; sums the byte counts with shifts and adds instead of a multiply.
+
+define i32 @bitmanip(i32 %a) {
+; CHECK-LABEL: 'bitmanip'
+; SOFT: cost of 15 {{.*}} @llvm.ctpop.i32
+; HARD: cost of 13 {{.*}} @llvm.ctpop.i32
+; CHECK: cost of 10 {{.*}} @llvm.bswap.i32
+  %1 = call i32 @llvm.ctpop.i32(i32 %a)
+  %2 = call i32 @llvm.bswap.i32(i32 %1)
+  ret i32 %2
+}
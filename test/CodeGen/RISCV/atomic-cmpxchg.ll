@@ -0,0 +1,114 @@
+; RUN: llc -mtriple=riscv32 -mattr=+a -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32A %s
+; RUN: llc -mtriple=riscv64 -mattr=+a -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV64A %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=NOA %s
+
+; Compare-and-swap is an LR/SC loop with the ordering in the aq/rl bits.
+
+define i32 @cmpxchg_monotonic(i32* %p, i32 %cmp, i32 %new) nounwind {
+; CHECK-LABEL: cmpxchg_monotonic:
+; CHECK: [[LOOP:\.[A-Z0-9_]+]]:
+; CHECK-NEXT: lr.w [[R:[a-z0-9]+]], 0(a0)
+; CHECK-NEXT: bne [[R]], {{[a-z0-9]+}}, [[DONE:\.[A-Z0-9_]+]]
+; CHECK: sc.w [[S:[a-z0-9]+]], {{[a-z0-9]+}}, 0(a0)
+; CHECK-NEXT: bne [[S]], zero, [[LOOP]]
+; CHECK: [[DONE]]:
+; NOA-LABEL: cmpxchg_monotonic:
+; NOA: call __atomic_compare_exchange_4
+  %1 = cmpxchg i32* %p, i32 %cmp, i32 %new monotonic monotonic
+  %2 = extractvalue { i32, i1 } %1, 0
+  ret i32 %2
+}
+
+define i32 @cmpxchg_acquire(i32* %p, i32 %cmp, i32 %new) nounwind {
+; CHECK-LABEL: cmpxchg_acquire:
+; CHECK-NOT: fence
+; CHECK: lr.w.aq
+; CHECK: sc.w {{[a-z0-9]+}}
+  %1 = cmpxchg i32* %p, i32 %cmp, i32 %new acquire monotonic
+  %2 = extractvalue { i32, i1 } %1, 0
+  ret i32 %2
+}
+
+define i32 @cmpxchg_release(i32* %p, i32 %cmp, i32 %new) nounwind {
+; CHECK-LABEL: cmpxchg_release:
+; CHECK-NOT: fence
+; CHECK: lr.w {{[a-z0-9]+}}
+; CHECK: sc.w.rl
+  %1 = cmpxchg i32* %p, i32 %cmp, i32 %new release monotonic
+  %2 = extractvalue { i32, i1 } %1, 0
+  ret i32 %2
+}
+
+define i32 @cmpxchg_acq_rel(i32* %p, i32 %cmp, i32 %new) nounwind {
+; CHECK-LABEL: cmpxchg_acq_rel:
+; CHECK: lr.w.aq
+; CHECK: sc.w.rl
+  %1 = cmpxchg i32* %p, i32 %cmp, i32 %new acq_rel monotonic
+  %2 = extractvalue { i32, i1 } %1, 0
+  ret i32 %2
+}
+
+define i1 @cmpxchg_seq_cst(i32* %p, i32 %cmp, i32 %new) nounwind {
+; CHECK-LABEL: cmpxchg_seq_cst:
+; CHECK-NOT: fence
+; CHECK: lr.w.aqrl
+; CHECK: sc.w.rl
+; CHECK-NOT: fence
+; CHECK: jalr zero, ra, 0
+  %1 = cmpxchg i32* %p, i32 %cmp, i32 %new seq_cst seq_cst
+  %2 = extractvalue { i32, i1 } %1, 1
+  ret i1 %2
+}
+
+define i64 @cmpxchg_i64(i64* %p, i64 %cmp, i64 %new) nounwind {
+; RV64A-LABEL: cmpxchg_i64:
+; RV64A: lr.d.aqrl [[R:[a-z0-9]+]], 0(a0)
+; RV64A-NEXT: bne [[R]], a1,
+; RV64A: sc.d.rl [[S:[a-z0-9]+]], a2, 0(a0)
+; RV64A-NEXT: bne [[S]], zero,
+; RV32A-LABEL: cmpxchg_i64:
+; RV32A: call __atomic_compare_exchange_8
+  %1 = cmpxchg i64* %p, i64 %cmp, i64 %new seq_cst seq_cst
+  %2 = extractvalue { i64, i1 } %1, 0
+  ret i64 %2
+}
+
+; Sub-word compare-and-swap works on the containing aligned word, and only
+; compares and replaces the bits of the value.
+define i16 @cmpxchg_i16(i16* %p, i16 %cmp, i16 %new) nounwind {
+; CHECK-LABEL: cmpxchg_i16:
+; CHECK: andi [[A:[a-z0-9]+]], a0, -4
+; CHECK-NEXT: .LBB{{[0-9_]+}}:
+; CHECK-NEXT: lr.w.aq [[W:[a-z0-9]+]], 0([[A]])
+; CHECK-NEXT: and [[S:[a-z0-9]+]], [[W]], [[M:[a-z0-9]+]]
+; CHECK-NEXT: bne [[S]], {{[a-z0-9]+}}, [[DONE:.LBB[0-9_]+]]
+; CHECK-NEXT: # BB#
+; CHECK-NEXT: xor [[S]], [[W]], {{[a-z0-9]+}}
+; CHECK-NEXT: and [[S]], [[S]], [[M]]
+; CHECK-NEXT: xor [[S]], [[W]], [[S]]
+; CHECK-NEXT: sc.w [[S]], [[S]], 0([[A]])
+; CHECK-NEXT: bne [[S]], zero, .LBB
+; CHECK-NEXT: [[DONE]]:
+; CHECK-NOT: lr.w
+; CHECK: jalr zero, ra, 0
+; NOA-LABEL: cmpxchg_i16:
+; NOA: call __atomic_compare_exchange_2
+  %1 = cmpxchg i16* %p, i16 %cmp, i16 %new acquire acquire
+  %2 = extractvalue { i16, i1 } %1, 0
+  ret i16 %2
+}
+
+define i1 @cmpxchg_i8_success(i8* %p, i8 %cmp, i8 %new) nounwind {
+; CHECK-LABEL: cmpxchg_i8_success:
+; CHECK: lr.w.aqrl [[W:[a-z0-9]+]],
+; CHECK: sc.w.rl
+; CHECK: and [[F:[a-z0-9]+]], [[W]], [[M:[a-z0-9]+]]
+; CHECK-NEXT: xor [[F]], [[F]],
+; CHECK-NEXT: sltiu a0, [[F]], 1
+  %1 = cmpxchg i8* %p, i8 %cmp, i8 %new seq_cst seq_cst
+  %2 = extractvalue { i8, i1 } %1, 1
+  ret i1 %2
+}
@@ -0,0 +1,135 @@
+; RUN: llc -mtriple=riscv32 -mattr=+a -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32A %s
+; RUN: llc -mtriple=riscv64 -mattr=+a -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV64A %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=NOA %s
+
+; Atomic loads and stores are ordinary loads and stores with fences around
+; them. The fence operands are the predecessor and successor sets, with
+; i=8, o=4, r=2 and w=1.
+
+define i32 @load_monotonic(i32* %p) nounwind {
+; CHECK-LABEL: load_monotonic:
+; CHECK-NOT: fence
+; CHECK: lw a0, 0(a0)
+; CHECK-NOT: fence
+; CHECK: jalr zero, ra, 0
+; NOA-LABEL: load_monotonic:
+; NOA: call __atomic_load_4
+  %1 = load atomic i32, i32* %p monotonic, align 4
+  ret i32 %1
+}
+
+; fence r, rw
+define i32 @load_acquire(i32* %p) nounwind {
+; CHECK-LABEL: load_acquire:
+; CHECK-NOT: fence
+; CHECK: lw a0, 4(a0)
+; CHECK-NEXT: fence 2, 3
+  %1 = getelementptr i32, i32* %p, i32 1
+  %2 = load atomic i32, i32* %1 acquire, align 4
+  ret i32 %2
+}
+
+define i32 @load_seq_cst(i32* %p) nounwind {
+; CHECK-LABEL: load_seq_cst:
+; CHECK: fence 3, 3
+; CHECK-NEXT: lw a0, 0(a0)
+; CHECK-NEXT: fence 2, 3
+  %1 = load atomic i32, i32* %p seq_cst, align 4
+  ret i32 %1
+}
+
+define i8 @load_i8(i8* %p) nounwind {
+; CHECK-LABEL: load_i8:
+; CHECK: lb a0, 0(a0)
+  %1 = load atomic i8, i8* %p monotonic, align 1
+  ret i8 %1
+}
+
+define i16 @load_i16(i16* %p) nounwind {
+; CHECK-LABEL: load_i16:
+; CHECK: lh a0, 0(a0)
+; CHECK-NEXT: fence 2, 3
+  %1 = load atomic i16, i16* %p acquire, align 2
+  ret i16 %1
+}
+
+define i64 @load_i64(i64* %p) nounwind {
+; RV64A-LABEL: load_i64:
+; RV64A: ld a0, 0(a0)
+; RV64A-NEXT: fence 2, 3
+; RV32A-LABEL: load_i64:
+; RV32A: call __atomic_load_8
+  %1 = load atomic i64, i64* %p acquire, align 8
+  ret i64 %1
+}
+
+define void @store_monotonic(i32* %p, i32 %v) nounwind {
+; CHECK-LABEL: store_monotonic:
+; CHECK-NOT: fence
+; CHECK: sw a1, 0(a0)
+; NOA-LABEL: store_monotonic:
+; NOA: call __atomic_store_4
+  store atomic i32 %v, i32* %p monotonic, align 4
+  ret void
+}
+
+; fence rw, w
+define void @store_release(i32* %p, i32 %v) nounwind {
+; CHECK-LABEL: store_release:
+; CHECK: fence 3, 1
+; CHECK-NEXT: sw a1, 8(a0)
+; CHECK-NOT: fence
+; CHECK: jalr zero, ra, 0
+  %1 = getelementptr i32, i32* %p, i32 2
+  store atomic i32 %v, i32* %1 release, align 4
+  ret void
+}
+
+define void @store_seq_cst(i8* %p, i8 %v) nounwind {
+; CHECK-LABEL: store_seq_cst:
+; CHECK: fence 3, 1
+; CHECK-NEXT: sb a1, 0(a0)
+  store atomic i8 %v, i8* %p seq_cst, align 1
+  ret void
+}
+
+define void @store_i64(i64* %p, i64 %v) nounwind {
+; RV64A-LABEL: store_i64:
+; RV64A: fence 3, 1
+; RV64A-NEXT: sd a1, 0(a0)
+  store atomic i64 %v, i64* %p release, align 8
+  ret void
+}
+
+define void @fence_acquire() nounwind {
+; CHECK-LABEL: fence_acquire:
+; CHECK: fence 2, 3
+  fence acquire
+  ret void
+}
+
+define void @fence_release() nounwind {
+; CHECK-LABEL: fence_release:
+; CHECK: fence 3, 1
+  fence release
+  ret void
+}
+
+define void @fence_acq_rel() nounwind {
+; CHECK-LABEL: fence_acq_rel:
+; CHECK: fence 3, 3
+  fence acq_rel
+  ret void
+}
+
+define void @fence_seq_cst() nounwind {
+; CHECK-LABEL: fence_seq_cst:
+; CHECK: fence 3, 3
+; NOA-LABEL: fence_seq_cst:
+; NOA: fence 3, 3
+  fence seq_cst
+  ret void
+}
@@ -0,0 +1,170 @@
+; RUN: llc -mtriple=riscv32 -mattr=+a -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32A %s
+; RUN: llc -mtriple=riscv64 -mattr=+a -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV64A %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=NOA %s
+
+; The memory ordering of a read-modify-write is carried in its aq/rl bits;
+; no fences are needed.
+
+define i32 @add_monotonic(i32* %p, i32 %v) nounwind {
+; CHECK-LABEL: add_monotonic:
+; CHECK-NOT: fence
+; CHECK: amoadd.w a0, a1, 0(a0)
+; NOA-LABEL: add_monotonic:
+; NOA: call __atomic_fetch_add_4
+  %1 = atomicrmw add i32* %p, i32 %v monotonic
+  ret i32 %1
+}
+
+define i32 @xchg_acquire(i32* %p, i32 %v) nounwind {
+; CHECK-LABEL: xchg_acquire:
+; CHECK-NOT: fence
+; CHECK: amoswap.w.aq a0, a1, 0(a0)
+  %1 = atomicrmw xchg i32* %p, i32 %v acquire
+  ret i32 %1
+}
+
+define i32 @and_release(i32* %p, i32 %v) nounwind {
+; CHECK-LABEL: and_release:
+; CHECK-NOT: fence
+; CHECK: amoand.w.rl a0, a1, 0(a0)
+  %1 = atomicrmw and i32* %p, i32 %v release
+  ret i32 %1
+}
+
+define i32 @or_acq_rel(i32* %p, i32 %v) nounwind {
+; CHECK-LABEL: or_acq_rel:
+; CHECK: amoor.w.aqrl a0, a1, 0(a0)
+  %1 = atomicrmw or i32* %p, i32 %v acq_rel
+  ret i32 %1
+}
+
+define i32 @umax_seq_cst(i32* %p, i32 %v) nounwind {
+; CHECK-LABEL: umax_seq_cst:
+; CHECK-NOT: fence
+; CHECK: amomaxu.w.aqrl a0, a1, 0(a0)
+; CHECK-NOT: fence
+; CHECK: jalr zero, ra, 0
+  %1 = atomicrmw umax i32* %p, i32 %v seq_cst
+  ret i32 %1
+}
+
+; There is no amosub; the value is negated and added.
+define i32 @sub_seq_cst(i32* %p, i32 %v) nounwind {
+; CHECK-LABEL: sub_seq_cst:
+; RV32A: sub [[N:[a-z0-9]+]], zero, a1
+; RV64A: subw [[N:[a-z0-9]+]], zero, a1
+; CHECK: amoadd.w.aqrl a0, [[N]], 0(a0)
+  %1 = atomicrmw sub i32* %p, i32 %v seq_cst
+  ret i32 %1
+}
+
+define i64 @add_i64(i64* %p, i64 %v) nounwind {
+; RV64A-LABEL: add_i64:
+; RV64A: amoadd.d.aqrl a0, a1, 0(a0)
+; RV32A-LABEL: add_i64:
+; RV32A: call __atomic_fetch_add_8
+  %1 = atomicrmw add i64* %p, i64 %v seq_cst
+  ret i64 %1
+}
+
+define i64 @sub_i64(i64* %p, i64 %v) nounwind {
+; RV64A-LABEL: sub_i64:
+; RV64A: sub [[N:[a-z0-9]+]], zero, a1
+; RV64A: amoadd.d a0, [[N]], 0(a0)
+  %1 = atomicrmw sub i64* %p, i64 %v monotonic
+  ret i64 %1
+}
+
+; Sub-word operations work on the containing aligned word, in a single LR/SC
+; loop that only changes the bits of the value.
+define i8 @add_i8(i8* %p, i8 %v) nounwind {
+; CHECK-LABEL: add_i8:
+; CHECK: andi [[A:[a-z0-9]+]], a0, -4
+; CHECK-NEXT: .LBB{{[0-9_]+}}:
+; CHECK-NEXT: lr.w.aqrl [[W:[a-z0-9]+]], 0([[A]])
+; RV32A-NEXT: add [[S:[a-z0-9]+]], [[W]], {{[a-z0-9]+}}
+; RV64A-NEXT: addw [[S:[a-z0-9]+]], [[W]], {{[a-z0-9]+}}
+; CHECK-NEXT: xor [[S]], [[W]], [[S]]
+; CHECK-NEXT: and [[S]], [[S]], {{[a-z0-9]+}}
+; CHECK-NEXT: xor [[S]], [[W]], [[S]]
+; CHECK-NEXT: sc.w.rl [[S]], [[S]], 0([[A]])
+; CHECK-NEXT: bne [[S]], zero, .LBB
+; CHECK-NOT: lr.w
+; CHECK: jalr zero, ra, 0
+; NOA-LABEL: add_i8:
+; NOA: call __atomic_fetch_add_1
+  %1 = atomicrmw add i8* %p, i8 %v seq_cst
+  ret i8 %1
+}
+
+define i8 @nand_i8(i8* %p, i8 %v) nounwind {
+; CHECK-LABEL: nand_i8:
+; CHECK: lr.w [[W:[a-z0-9]+]],
+; CHECK-NEXT: and [[S:[a-z0-9]+]], [[W]], {{[a-z0-9]+}}
+; CHECK-NEXT: xori [[S]], [[S]], -1
+; CHECK: sc.w
+; CHECK-NOT: lr.w
+  %1 = atomicrmw nand i8* %p, i8 %v monotonic
+  ret i8 %1
+}
+
+; Signed min and max sign-extend the field in place before comparing it.
+define i16 @max_i16(i16* %p, i16 %v) nounwind {
+; CHECK-LABEL: max_i16:
+; CHECK: lr.w [[W:[a-z0-9]+]],
+; CHECK-NEXT: and [[F:[a-z0-9]+]], [[W]], {{[a-z0-9]+}}
+; CHECK-NEXT: or {{[a-z0-9]+}}, [[W]], zero
+; RV32A-NEXT: sll [[F]], [[F]], [[SH:[a-z0-9]+]]
+; RV32A-NEXT: sra [[F]], [[F]], [[SH]]
+; RV64A-NEXT: sllw [[F]], [[F]], [[SH:[a-z0-9]+]]
+; RV64A-NEXT: sraw [[F]], [[F]], [[SH]]
+; CHECK-NEXT: blt [[F]],
+; CHECK: sc.w
+  %1 = atomicrmw max i16* %p, i16 %v monotonic
+  ret i16 %1
+}
+
+define i8 @umin_i8(i8* %p, i8 %v) nounwind {
+; CHECK-LABEL: umin_i8:
+; CHECK: lr.w.aq [[W:[a-z0-9]+]],
+; CHECK-NEXT: and [[F:[a-z0-9]+]], [[W]], {{[a-z0-9]+}}
+; CHECK-NEXT: or {{[a-z0-9]+}}, [[W]], zero
+; CHECK-NEXT: bltu {{[a-z0-9]+}}, [[F]],
+; CHECK: sc.w.rl
+  %1 = atomicrmw umin i8* %p, i8 %v acq_rel
+  ret i8 %1
+}
+
+; And, or and xor are a single AMO on the word; the other bytes of the
+; operand leave the rest of the word unchanged.
+define i8 @and_i8(i8* %p, i8 %v) nounwind {
+; CHECK-LABEL: and_i8:
+; CHECK: xori [[M:[a-z0-9]+]], {{[a-z0-9]+}}, -1
+; CHECK-NEXT: or [[V:[a-z0-9]+]], {{[a-z0-9]+}}, [[M]]
+; CHECK-NEXT: andi [[A:[a-z0-9]+]], a0, -4
+; CHECK-NEXT: amoand.w.rl a0, [[V]], 0([[A]])
+; CHECK-NOT: lr.w
+  %1 = atomicrmw and i8* %p, i8 %v release
+  ret i8 %1
+}
+
+define i16 @or_i16(i16* %p, i16 %v) nounwind {
+; CHECK-LABEL: or_i16:
+; CHECK-NOT: lr.w
+; CHECK: amoor.w a0,
+  %1 = atomicrmw or i16* %p, i16 %v monotonic
+  ret i16 %1
+}
+
+define i32 @nand(i32* %p, i32 %v) nounwind {
+; CHECK-LABEL: nand:
+; CHECK: and
+; CHECK: xori [[N:[a-z0-9]+]], {{[a-z0-9]+}}, -1
+; CHECK: lr.w
+; CHECK: sc.w {{[a-z0-9]+}}, [[N]],
+  %1 = atomicrmw nand i32* %p, i32 %v monotonic
+  ret i32 %1
+}
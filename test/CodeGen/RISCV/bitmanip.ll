@@ -0,0 +1,207 @@
+; RUN: llc -mtriple=riscv32 -mattr=+b -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV32B %s
+; RUN: llc -mtriple=riscv64 -mattr=+b -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV64B %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV32I %s
+; RUN: llc -mtriple=riscv32 -mattr=+m -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV32IM %s
+
+declare i32 @llvm.ctlz.i32(i32, i1)
+declare i32 @llvm.cttz.i32(i32, i1)
+declare i32 @llvm.ctpop.i32(i32)
+declare i32 @llvm.bswap.i32(i32)
+declare i64 @llvm.ctlz.i64(i64, i1)
+declare i64 @llvm.ctpop.i64(i64)
+declare i64 @llvm.bswap.i64(i64)
+
+define i32 @ctlz_i32(i32 %a) {
+; RV32B-LABEL: ctlz_i32:
+; RV32B-NOT: call
+; RV32B: clz a0, a0
+; RV64B-LABEL: ctlz_i32:
+; RV64B: clzw a0, a0
+  %1 = call i32 @llvm.ctlz.i32(i32 %a, i1 false)
+  ret i32 %1
+}
+
+define i32 @cttz_i32(i32 %a) {
+; RV32B-LABEL: cttz_i32:
+; RV32B-NOT: call
+; RV32B: ctz a0, a0
+; RV64B-LABEL: cttz_i32:
+; RV64B: ctzw a0, a0
+  %1 = call i32 @llvm.cttz.i32(i32 %a, i1 false)
+  ret i32 %1
+}
+
+define i32 @ctpop_i32(i32 %a) {
+; RV32B-LABEL: ctpop_i32:
+; RV32B: cpop a0, a0
+; RV64B-LABEL: ctpop_i32:
+; RV64B: cpopw a0, a0
+; RV32I-LABEL: ctpop_i32:
+; RV32I-NOT: call
+; RV32I: srli [[A:a[0-9]+]], {{a[0-9]+}}, 8
+; RV32I: srli {{a[0-9]+}}, {{a[0-9]+}}, 16
+; RV32I: andi a0, {{a[0-9]+}}, 63
+; RV32IM-LABEL: ctpop_i32:
+; RV32IM: mul
+; RV32IM: srli a0, {{a[0-9]+}}, 24
+  %1 = call i32 @llvm.ctpop.i32(i32 %a)
+  ret i32 %1
+}
+
+define i64 @ctlz_i64(i64 %a) {
+; RV64B-LABEL: ctlz_i64:
+; RV64B: clz a0, a0
+  %1 = call i64 @llvm.ctlz.i64(i64 %a, i1 false)
+  ret i64 %1
+}
+
+define i64 @ctpop_i64(i64 %a) {
+; RV64B-LABEL: ctpop_i64:
+; RV64B: cpop a0, a0
+  %1 = call i64 @llvm.ctpop.i64(i64 %a)
+  ret i64 %1
+}
+
+define i32 @bswap_i32(i32 %a) {
+; RV32B-LABEL: bswap_i32:
+; RV32B: rev8 a0, a0
+; RV64B-LABEL: bswap_i32:
+; RV64B: rev8 [[R:a[0-9]+]], a0
+; RV64B: srai a0, [[R]], 32
+; RV32I-LABEL: bswap_i32:
+; RV32I-NOT: call
+; RV32I: srli {{a[0-9]+}}, a0, 8
+; RV32I: slli {{a[0-9]+}}, {{a[0-9]+}}, 8
+; RV32I: srli {{a[0-9]+}}, {{a[0-9]+}}, 16
+; RV32I: slli {{a[0-9]+}}, {{a[0-9]+}}, 16
+; RV32I: or a0
+  %1 = call i32 @llvm.bswap.i32(i32 %a)
+  ret i32 %1
+}
+
+define i64 @bswap_i64(i64 %a) {
+; RV64B-LABEL: bswap_i64:
+; RV64B: rev8 a0, a0
+  %1 = call i64 @llvm.bswap.i64(i64 %a)
+  ret i64 %1
+}
+
+define i32 @rotl_i32(i32 %a, i32 %b) {
+; RV32B-LABEL: rotl_i32:
+; RV32B: rol a0, a0, a1
+; RV64B-LABEL: rotl_i32:
+; RV64B: rolw a0, a0, a1
+  %1 = shl i32 %a, %b
+  %2 = sub i32 32, %b
+  %3 = lshr i32 %a, %2
+  %4 = or i32 %1, %3
+  ret i32 %4
+}
+
+define i32 @rotr_i32(i32 %a, i32 %b) {
+; RV32B-LABEL: rotr_i32:
+; RV32B: ror a0, a0, a1
+; RV64B-LABEL: rotr_i32:
+; RV64B: rorw a0, a0, a1
+  %1 = lshr i32 %a, %b
+  %2 = sub i32 32, %b
+  %3 = shl i32 %a, %2
+  %4 = or i32 %1, %3
+  ret i32 %4
+}
+
+define i32 @rotli_i32(i32 %a) {
+; RV32B-LABEL: rotli_i32:
+; RV32B: rori a0, a0, 27
+; RV64B-LABEL: rotli_i32:
+; RV64B: roriw a0, a0, 27
+  %1 = shl i32 %a, 5
+  %2 = lshr i32 %a, 27
+  %3 = or i32 %1, %2
+  ret i32 %3
+}
+
+define i64 @rotri_i64(i64 %a) {
+; RV64B-LABEL: rotri_i64:
+; RV64B: rori a0, a0, 40
+  %1 = lshr i64 %a, 40
+  %2 = shl i64 %a, 24
+  %3 = or i64 %1, %2
+  ret i64 %3
+}
+
+define i32 @andn_i32(i32 %a, i32 %b) {
+; RV32B-LABEL: andn_i32:
+; RV32B: andn a0, a0, a1
+  %neg = xor i32 %b, -1
+  %and = and i32 %neg, %a
+  ret i32 %and
+}
+
+define i32 @orn_i32(i32 %a, i32 %b) {
+; RV32B-LABEL: orn_i32:
+; RV32B: orn a0, a0, a1
+  %neg = xor i32 %b, -1
+  %or = or i32 %neg, %a
+  ret i32 %or
+}
+
+define i64 @andn_i64(i64 %a, i64 %b) {
+; RV64B-LABEL: andn_i64:
+; RV64B: andn a0, a0, a1
+  %neg = xor i64 %b, -1
+  %and = and i64 %neg, %a
+  ret i64 %and
+}
+
+define i32 @smin_i32(i32 %a, i32 %b) {
+; RV32B-LABEL: smin_i32:
+; RV32B: min a0, a0, a1
+  %cmp = icmp slt i32 %a, %b
+  %cond = select i1 %cmp, i32 %a, i32 %b
+  ret i32 %cond
+}
+
+define i32 @umax_i32(i32 %a, i32 %b) {
+; RV32B-LABEL: umax_i32:
+; RV32B: maxu a0, a0, a1
+  %cmp = icmp ugt i32 %a, %b
+  %cond = select i1 %cmp, i32 %a, i32 %b
+  ret i32 %cond
+}
+
+define i32 @sextb_i32(i32 %a) {
+; RV32B-LABEL: sextb_i32:
+; RV32B: sext.b a0, a0
+; RV64B-LABEL: sextb_i32:
+; RV64B: sext.b a0, a0
+  %shl = shl i32 %a, 24
+  %shr = ashr exact i32 %shl, 24
+  ret i32 %shr
+}
+
+define i32 @sexth_i32(i32 %a) {
+; RV32B-LABEL: sexth_i32:
+; RV32B: sext.h a0, a0
+  %shl = shl i32 %a, 16
+  %shr = ashr exact i32 %shl, 16
+  ret i32 %shr
+}
+
+define i32 @zexth_i32(i32 %a) {
+; RV32B-LABEL: zexth_i32:
+; RV32B: zext.h a0, a0
+  %and = and i32 %a, 65535
+  ret i32 %and
+}
+
+define i64 @zexth_i64(i64 %a) {
+; RV64B-LABEL: zexth_i64:
+; RV64B: zext.h a0, a0
+  %and = and i64 %a, 65535
+  ret i64 %and
+}
@@ -4,9 +4,7 @@ declare i32 @external_function(i32) nounwind
 
 define i32 @test_call_external(i32 %a) {
 ; CHECK-LABEL: test_call_external:
-; CHECK: lui a1, %hi(external_function)
-; CHECK: addi a1, a1, %lo(external_function)
-; CHECK: jalr ra, a1, 0
+; CHECK: call external_function
   %1 = call i32 @external_function(i32 %a) nounwind
   ret i32 %1
 }
@@ -18,9 +16,7 @@ define i32 @defined_function(i32 %a) nounwind noinline {
 
 define i32 @test_call_defined(i32 %a) {
 ; CHECK-LABEL: test_call_defined:
-; CHECK: lui a1, %hi(defined_function)
-; CHECK: addi a1, a1, %lo(defined_function)
-; CHECK: jalr ra, a1, 0
+; CHECK: call defined_function
   %1 = call i32 @defined_function(i32 %a) nounwind
   ret i32 %1
 }
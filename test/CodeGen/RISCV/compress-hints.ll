@@ -0,0 +1,55 @@
+; REQUIRES: asserts
+; RUN: llc -mtriple=riscv32 -mattr=+c -verify-machineinstrs -stats < %s 2>&1 \
+; RUN:   | FileCheck -check-prefixes=CHECK,DEFAULT %s
+; RUN: opt -forceattrs -force-attribute=sub_and:minsize -S < %s \
+; RUN:   | llc -mtriple=riscv32 -mattr=+c -verify-machineinstrs -stats 2>&1 \
+; RUN:   | FileCheck -check-prefixes=CHECK,MINSIZE %s
+
+; At -Os the register allocator is hinted towards registers that let the
+; two-address compressed forms be used. The compression rate is reported by
+; the AsmPrinter statistics.
+
+define i32 @sub_xor(i32 %a, i32 %b, i32 %c) nounwind optsize {
+; CHECK-LABEL: sub_xor:
+; CHECK: c.sub a0, a1
+; CHECK-NEXT: c.xor a0, a2
+; CHECK-NEXT: c.jr ra
+  %1 = sub i32 %a, %b
+  %2 = xor i32 %1, %c
+  ret i32 %2
+}
+
+define i32 @and_minsize(i32 %a, i32 %b, i32 %c) nounwind minsize {
+; CHECK-LABEL: and_minsize:
+; CHECK: c.and a0, a1
+; CHECK-NEXT: c.or a0, a2
+  %1 = and i32 %b, %a
+  %2 = or i32 %c, %1
+  ret i32 %2
+}
+
+; Without the hint %c - %d is given a fresh register and the sub can't be
+; compressed; with it the result is tied to %c.
+define i32 @sub_and(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e) nounwind {
+; CHECK-LABEL: sub_and:
+; DEFAULT: c.sub a0, a1
+; DEFAULT-NEXT: sub a1, a2, a3
+; DEFAULT-NEXT: c.and a1, a4
+; DEFAULT-NEXT: c.or a0, a1
+; MINSIZE: c.sub a0, a1
+; MINSIZE-NEXT: c.sub a2, a3
+; MINSIZE-NEXT: c.and a2, a4
+; MINSIZE-NEXT: c.or a0, a2
+  %1 = sub i32 %c, %d
+  %2 = and i32 %1, %e
+  %3 = sub i32 %a, %b
+  %4 = or i32 %3, %2
+  ret i32 %4
+}
+
+; The second run compiles sub_and at -Oz, where every instruction in the file
+; is compressed.
+; DEFAULT-DAG: 11 asm-printer - Number of instructions emitted{{$}}
+; DEFAULT-DAG: 10 asm-printer - Number of instructions emitted in their compressed form
+; MINSIZE-DAG: 11 asm-printer - Number of instructions emitted{{$}}
+; MINSIZE-DAG: 11 asm-printer - Number of instructions emitted in their compressed form
@@ -0,0 +1,74 @@
+; RUN: llc -mtriple=riscv32 -mattr=+c -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RVC %s
+; RUN: llc -mtriple=riscv64 -mattr=+c -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV64C %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=NORVC %s
+
+; Instructions are selected in their 32-bit form and compressed through the
+; CompressPat table as they are emitted.
+
+define i32 @and_rev(i32 %a, i32 %b) nounwind {
+; RVC-LABEL: and_rev:
+; RVC: c.and a0, a1
+; RVC-NEXT: c.jr ra
+; NORVC-LABEL: and_rev:
+; NORVC: and a0, a1, a0
+; NORVC-NEXT: jalr zero, ra, 0
+  %1 = and i32 %b, %a
+  ret i32 %1
+}
+
+define i32 @add(i32 %a, i32 %b) nounwind {
+; RVC-LABEL: add:
+; RVC: c.add a0, a1
+; RV64C-LABEL: add:
+; RV64C: c.addw a0, a1
+; NORVC-LABEL: add:
+; NORVC: add a0, a0, a1
+  %1 = add i32 %a, %b
+  ret i32 %1
+}
+
+define i32 @li() nounwind {
+; RVC-LABEL: li:
+; RVC: c.li a0, 31
+; NORVC-LABEL: li:
+; NORVC: addi a0, zero, 31
+  ret i32 31
+}
+
+define i32 @addi_big(i32 %a) nounwind {
+; RVC-LABEL: addi_big:
+; RVC: addi a0, a0, 100
+; RVC-NOT: c.addi
+  %1 = add i32 %a, 100
+  ret i32 %1
+}
+
+define i32 @mv(i32 %a, i32 %b) nounwind {
+; RVC-LABEL: mv:
+; RVC: c.mv a0, a1
+; NORVC-LABEL: mv:
+; NORVC: addi a0, a1, 0
+  ret i32 %b
+}
+
+declare void @callee(i32*)
+
+define void @frame() nounwind {
+; RVC-LABEL: frame:
+; RVC: c.addi16sp sp, -16
+; RVC: call callee
+; RVC: c.addi16sp sp, 16
+; RVC-NEXT: c.jr ra
+; RV64C-LABEL: frame:
+; RV64C: c.addi16sp sp, -16
+; RV64C: c.sdsp ra, 8(sp)
+; RV64C: c.ldsp ra, 8(sp)
+; RV64C-NEXT: c.addi16sp sp, 16
+; RV64C-NEXT: c.jr ra
+  %1 = alloca i32
+  call void @callee(i32* %1)
+  ret void
+}
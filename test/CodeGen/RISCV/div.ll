@@ -1,19 +1,34 @@
-; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=riscv32 -mattr=+m -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32IM %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32I %s
 
 define i32 @udiv(i32 %a, i32 %b) {
 ; CHECK-LABEL: udiv:
-; CHECK: divu	a0, a0, a1
-; CHECK: jalr	zero, ra, 0
+; RV32IM: divu a0, a0, a1
+; RV32IM-NEXT: jalr zero, ra, 0
+; RV32I: call __udivsi3
   %1 = udiv i32 %a, %b
   ret i32 %1
 }
 
 define i32 @udiv_constant(i32 %a) {
 ; CHECK-LABEL: udiv_constant:
-; CHECK: lui     a1, 838861
-; CHECK: addi    a1, a1, -819
-; CHECK: mulhu   a0, a0, a1
-; CHECK: srli    a0, a0, 2
+; RV32IM: lui a1, 838861
+; RV32IM-NEXT: addi a1, a1, -819
+; RV32IM-NEXT: mulhu a0, a0, a1
+; RV32IM-NEXT: srli a0, a0, 2
+; RV32IM-NEXT: jalr zero, ra, 0
+; RV32I-NOT: call
+; RV32I: srli a1, a0, 3
+; RV32I-NEXT: srli a2, a0, 4
+; RV32I-NEXT: add a1, a2, a1
+; RV32I: slli a2, a1, 2
+; RV32I-NEXT: add a2, a1, a2
+; RV32I-NEXT: sub a0, a0, a2
+; RV32I: srli a0, a0, 6
+; RV32I-NEXT: add a0, a1, a0
+; RV32I-NEXT: jalr zero, ra, 0
   %1 = udiv i32 %a, 5
   ret i32 %1
 }
@@ -27,41 +42,47 @@ define i32 @udiv_pow2(i32 %a) {
 
 define i64 @udiv64(i64 %a, i64 %b) {
 ; CHECK-LABEL: udiv64:
-; CHECK: lui a4, %hi(__udivdi3)
-; CHECK: addi a4, a4, %lo(__udivdi3)
-; CHECK: jalr ra, a4, 0
+; CHECK: call __udivdi3
   %1 = udiv i64 %a, %b
   ret i64 %1
 }
 
 define i64 @udiv64_constant(i64 %a) {
 ; CHECK-LABEL: udiv64_constant:
-; CHECK: lui a2, %hi(__udivdi3)
-; CHECK: addi a4, a2, %lo(__udivdi3)
 ; CHECK: addi a2, zero, 5
 ; CHECK: addi a3, zero, 0
-; CHECK: jalr ra, a4, 0
+; CHECK: call __udivdi3
   %1 = udiv i64 %a, 5
   ret i64 %1
 }
 
 define i32 @sdiv(i32 %a, i32 %b) {
 ; CHECK-LABEL: sdiv:
-; CHECK: div     a0, a0, a1
-; CHECK: jalr    zero, ra, 0
+; RV32IM: div a0, a0, a1
+; RV32IM-NEXT: jalr zero, ra, 0
+; RV32I: call __divsi3
   %1 = sdiv i32 %a, %b
   ret i32 %1
 }
 
 define i32 @sdiv_constant(i32 %a) {
 ; CHECK-LABEL: sdiv_constant:
-; CHECK: lui     a1, 419430
-; CHECK: addi    a1, a1, 1639
-; CHECK: mulh    a0, a0, a1
-; CHECK: srli    a1, a0, 31
-; CHECK: srai    a0, a0, 1
-; CHECK: add     a0, a0, a1
-; CHECK: jalr    zero, ra, 0
+; RV32IM: lui a1, 419430
+; RV32IM-NEXT: addi a1, a1, 1639
+; RV32IM-NEXT: mulh a0, a0, a1
+; RV32IM-NEXT: srli a1, a0, 31
+; RV32IM-NEXT: srai a0, a0, 1
+; RV32IM-NEXT: add a0, a0, a1
+; RV32IM-NEXT: jalr zero, ra, 0
+; RV32I-NOT: call
+; RV32I: srai a1, a0, 31
+; RV32I-NEXT: xor a0, a0, a1
+; RV32I-NEXT: sub a0, a0, a1
+; RV32I: srli a0, a0, 6
+; RV32I-NEXT: add a0, a2, a0
+; RV32I-NEXT: xor a0, a0, a1
+; RV32I-NEXT: sub a0, a0, a1
+; RV32I-NEXT: jalr zero, ra, 0
   %1 = sdiv i32 %a, 5
   ret i32 %1
 }
@@ -78,20 +99,16 @@ define i32 @sdiv_pow2(i32 %a) {
 
 define i64 @sdiv64(i64 %a, i64 %b) {
 ; CHECK-LABEL: sdiv64:
-; CHECK: lui a4, %hi(__divdi3)
-; CHECK: addi a4, a4, %lo(__divdi3)
-; CHECK: jalr ra, a4, 0
+; CHECK: call __divdi3
   %1 = sdiv i64 %a, %b
   ret i64 %1
 }
 
 define i64 @sdiv64_constant(i64 %a) {
 ; CHECK-LABEL: sdiv64_constant:
-; CHECK: lui a2, %hi(__divdi3)
-; CHECK: addi a4, a2, %lo(__divdi3)
 ; CHECK: addi a2, zero, 5
 ; CHECK: addi a3, zero, 0
-; CHECK: jalr ra, a4, 0
+; CHECK: call __divdi3
   %1 = sdiv i64 %a, 5
   ret i64 %1
 }
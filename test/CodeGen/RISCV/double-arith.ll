@@ -0,0 +1,139 @@
+; RUN: llc -mtriple=riscv32 -mattr=+d -target-abi ilp32d -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32 %s
+; RUN: llc -mtriple=riscv64 -mattr=+d -target-abi lp64d -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV64 %s
+
+define double @fadd_d(double %a, double %b) nounwind {
+; CHECK-LABEL: fadd_d:
+; CHECK: fadd.d fa0, fa0, fa1
+  %1 = fadd double %a, %b
+  ret double %1
+}
+
+define double @fdiv_d(double %a, double %b) nounwind {
+; CHECK-LABEL: fdiv_d:
+; CHECK: fdiv.d fa0, fa0, fa1
+  %1 = fdiv double %a, %b
+  ret double %1
+}
+
+declare double @llvm.fma.f64(double, double, double)
+
+define double @fmadd_d(double %a, double %b, double %c) nounwind {
+; CHECK-LABEL: fmadd_d:
+; CHECK: fmadd.d fa0, fa0, fa1, fa2
+  %1 = call double @llvm.fma.f64(double %a, double %b, double %c)
+  ret double %1
+}
+
+define double @fneg_d(double %a) nounwind {
+; CHECK-LABEL: fneg_d:
+; CHECK: fsgnjn.d fa0, fa0, fa0
+  %1 = fsub double -0.0, %a
+  ret double %1
+}
+
+define i32 @fcmp_olt_d(double %a, double %b) nounwind {
+; CHECK-LABEL: fcmp_olt_d:
+; CHECK: flt.d a0, fa0, fa1
+  %1 = fcmp olt double %a, %b
+  %2 = zext i1 %1 to i32
+  ret i32 %2
+}
+
+define float @fcvt_s_d(double %a) nounwind {
+; CHECK-LABEL: fcvt_s_d:
+; CHECK: fcvt.s.d fa0, fa0
+  %1 = fptrunc double %a to float
+  ret float %1
+}
+
+define double @fcvt_d_s(float %a) nounwind {
+; CHECK-LABEL: fcvt_d_s:
+; CHECK: fcvt.d.s fa0, fa0
+  %1 = fpext float %a to double
+  ret double %1
+}
+
+define i32 @fcvt_w_d(double %a) nounwind {
+; CHECK-LABEL: fcvt_w_d:
+; CHECK: fcvt.w.d a0, fa0, rtz
+  %1 = fptosi double %a to i32
+  ret i32 %1
+}
+
+define double @fcvt_d_wu(i32 %a) nounwind {
+; CHECK-LABEL: fcvt_d_wu:
+; CHECK: fcvt.d.wu fa0, a0
+  %1 = uitofp i32 %a to double
+  ret double %1
+}
+
+define double @zero_d() nounwind {
+; CHECK-LABEL: zero_d:
+; CHECK: fcvt.d.w fa0, zero
+  ret double 0.0
+}
+
+define double @load_store_d(double* %p) nounwind {
+; CHECK-LABEL: load_store_d:
+; CHECK: fld [[R:f[a-z0-9]+]], 8(a0)
+; CHECK: fsd [[R]], 16(a0)
+  %1 = getelementptr double, double* %p, i32 1
+  %2 = load double, double* %1
+  %3 = getelementptr double, double* %p, i32 2
+  store double %2, double* %3
+  ret double %2
+}
+
+; Once fa0-fa7 are used up, doubles are passed in GPRs: a pair of them on
+; RV32, a single one on RV64.
+define double @fpr_exhausted(double %a, double %b, double %c, double %d,
+                             double %e, double %f, double %g, double %h,
+                             double %i) nounwind {
+; CHECK-LABEL: fpr_exhausted:
+; RV32-DAG: sw a0, [[OFF:[0-9]+]](sp)
+; RV32-DAG: sw a1, {{[0-9]+}}(sp)
+; RV32: fld fa0, [[OFF]](sp)
+; RV64: fmv.d.x fa0, a0
+  ret double %i
+}
+
+declare i32 @printf(i8*, ...)
+
+; Variadic doubles are passed in GPRs.
+define void @vararg_double(i8* %fmt, double %a) nounwind {
+; CHECK-LABEL: vararg_double:
+; RV32: fsd fa0, [[OFF:[0-9]+]](sp)
+; RV32-DAG: lw a2, [[OFF]](sp)
+; RV32-DAG: lw a3, {{[0-9]+}}(sp)
+; RV64: fmv.x.d a1, fa0
+; CHECK: call printf
+  %1 = call i32 (i8*, ...) @printf(i8* %fmt, double %a)
+  ret void
+}
+
+; Named doubles before the "..." stay in FPRs, both at the call and in the
+; variadic callee.
+declare void @named_double_var(double, ...)
+
+define void @vararg_named_double() nounwind {
+; CHECK-LABEL: vararg_named_double:
+; CHECK: fld fa0, %lo(.LCPI{{[0-9_]+}})(a0)
+; RV32: addi a0, zero, 0
+; RV32-NEXT: lui a1, 262144
+; RV64: addi a0, zero, 1
+; RV64-NEXT: slli a0, a0, 62
+; CHECK-NEXT: call named_double_var
+  call void (double, ...) @named_double_var(double 1.0, double 2.0)
+  ret void
+}
+
+define double @vararg_named_double_callee(double %a, ...) nounwind {
+; CHECK-LABEL: vararg_named_double_callee:
+; RV32: sw a0, 0(sp)
+; RV64: sd a0, 0(sp)
+; CHECK-NEXT: fadd.d fa0, fa0, fa0
+  %1 = fadd double %a, %a
+  ret double %1
+}
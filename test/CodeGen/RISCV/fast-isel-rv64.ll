@@ -0,0 +1,38 @@
+; RUN: llc -mtriple=riscv64 -O0 -fast-isel-abort=3 -verify-machineinstrs \
+; RUN:   < %s | FileCheck -check-prefix=RV64 %s
+
+; i64 operations selected by FastISel on RV64.
+
+define i64 @arith64(i64 %a, i64 %b) nounwind {
+; RV64-LABEL: arith64:
+; RV64: add
+; RV64: xor
+; RV64: jalr zero, ra, 0
+  %1 = add i64 %a, %b
+  %2 = xor i64 %1, %b
+  ret i64 %2
+}
+
+define i64 @branch64(i64 %a, i64 %b) nounwind {
+; RV64-LABEL: branch64:
+; RV64: bgeu a0, a1, [[BB:.LBB[0-9_]+]]
+; RV64: [[BB]]:
+  %1 = icmp uge i64 %a, %b
+  br i1 %1, label %if.then, label %if.end
+
+if.then:
+  ret i64 %a
+
+if.end:
+  ret i64 %b
+}
+
+define i64 @zext32(i64 %a) nounwind {
+; RV64-LABEL: zext32:
+; RV64: addiw {{.*}}, 0
+; RV64: slli {{.*}}, 32
+; RV64: srli {{.*}}, 32
+  %1 = trunc i64 %a to i32
+  %2 = zext i32 %1 to i64
+  ret i64 %2
+}
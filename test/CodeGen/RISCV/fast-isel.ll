@@ -0,0 +1,166 @@
+; RUN: llc -mtriple=riscv32 -O0 -fast-isel-abort=3 -verify-machineinstrs \
+; RUN:   < %s | FileCheck -check-prefix=RV32 %s
+; RUN: llc -mtriple=riscv64 -O0 -fast-isel-abort=3 -verify-machineinstrs \
+; RUN:   < %s | FileCheck -check-prefix=RV64 %s
+
+; Everything in this file is selected by FastISel; -fast-isel-abort=3 makes
+; any fallback to SelectionDAG, including for arguments, a hard error. The i64
+; cases are in fast-isel-rv64.ll since RV32 passes i64 arguments in pairs.
+
+define i32 @arith(i32 %a, i32 %b) nounwind {
+; RV32-LABEL: arith:
+; RV32: add
+; RV32: sub
+; RV32: slli {{.*}}, 3
+; RV32: jalr zero, ra, 0
+  %1 = add i32 %a, %b
+  %2 = sub i32 %1, %b
+  %3 = shl i32 %2, 3
+  ret i32 %3
+}
+
+define i32* @load_store(i32* %p) nounwind {
+; RV32-LABEL: load_store:
+; RV32: lw [[REG:[a-z0-9]+]], 8(
+; RV32: sw [[REG]], 12(
+; RV32: sw zero, 16(
+; RV64-LABEL: load_store:
+; RV64: ld [[REG:[a-z0-9]+]], 16(
+; RV64: sd [[REG]], 24(
+; RV64: sd zero, 32(
+  %1 = getelementptr i32, i32* %p, i32 2
+  %2 = ptrtoint i32* %1 to i32
+  %3 = bitcast i32* %p to i32**
+  %4 = getelementptr i32*, i32** %3, i32 2
+  %5 = load i32*, i32** %4
+  %6 = getelementptr i32*, i32** %3, i32 3
+  store i32* %5, i32** %6
+  %7 = getelementptr i32*, i32** %3, i32 4
+  store i32* null, i32** %7
+  ret i32* %5
+}
+
+define i8* @byte_ops(i8* %p) nounwind {
+; RV32-LABEL: byte_ops:
+; RV32: lbu [[REG:[a-z0-9]+]], 1(
+; RV32: sb [[REG]], 2(
+; RV64-LABEL: byte_ops:
+; RV64: lbu [[REG:[a-z0-9]+]], 1(
+; RV64: sb [[REG]], 2(
+  %1 = getelementptr i8, i8* %p, i32 1
+  %2 = load i8, i8* %1
+  %3 = getelementptr i8, i8* %p, i32 2
+  store i8 %2, i8* %3
+  ret i8* %p
+}
+
+define i32* @large_offset(i32* %p) nounwind {
+; RV32-LABEL: large_offset:
+; RV32: lui
+; RV32: add
+; RV32: lw {{.*}}, 0(
+  %1 = getelementptr i32, i32* %p, i32 4096
+  %2 = load i32, i32* %1
+  store i32 %2, i32* %p
+  ret i32* %p
+}
+
+define i32 @stack_slot(i32 %a) nounwind {
+; RV32-LABEL: stack_slot:
+; RV32: sw a0, [[OFF:[0-9]+]](sp)
+; RV32: lw a0, [[OFF]](sp)
+  %1 = alloca i32
+  store i32 %a, i32* %1
+  %2 = load i32, i32* %1
+  ret i32 %2
+}
+
+define i32 @compare(i32 %a, i32 %b) nounwind {
+; RV32-LABEL: compare:
+; RV32: slt
+; RV32: xori {{.*}}, 1
+; RV32: sltu
+; RV32: xor
+; RV32: sltiu {{.*}}, 1
+  %1 = icmp sge i32 %a, %b
+  %2 = zext i1 %1 to i32
+  %3 = icmp ult i32 %a, %b
+  %4 = zext i1 %3 to i32
+  %5 = icmp eq i32 %a, %b
+  %6 = zext i1 %5 to i32
+  %7 = add i32 %2, %4
+  %8 = add i32 %7, %6
+  ret i32 %8
+}
+
+define i32 @branch(i32 %a, i32 %b) nounwind {
+; RV32-LABEL: branch:
+; RV32: blt a1, a0, [[BB:.LBB[0-9_]+]]
+; RV32: [[BB]]:
+  %1 = icmp sgt i32 %a, %b
+  br i1 %1, label %if.then, label %if.end
+
+if.then:
+  ret i32 %a
+
+if.end:
+  ret i32 %b
+}
+
+define i32 @branch_on_bool(i32 %a, i32 %b) nounwind {
+; RV32-LABEL: branch_on_bool:
+; RV32: slt
+; RV32: andi {{.*}}, 1
+; RV32: bne {{[a-z0-9]+}}, zero,
+  %1 = icmp slt i32 %a, %b
+  br label %next
+
+next:
+  br i1 %1, label %if.then, label %if.end
+
+if.then:
+  ret i32 %a
+
+if.end:
+  ret i32 %b
+}
+
+define signext i16 @extend(i8 zeroext %a, i16 signext %b) nounwind {
+; RV64-LABEL: extend:
+; RV64: andi {{.*}}, 255
+; RV64: slliw {{.*}}, 16
+; RV64: sraiw {{.*}}, 16
+; RV64: jalr zero, ra, 0
+  %1 = trunc i16 %b to i8
+  %2 = zext i8 %1 to i16
+  %3 = sext i16 %2 to i32
+  %4 = trunc i32 %3 to i16
+  ret i16 %4
+}
+
+@g = global i32 0
+@big = global [64 x i32] zeroinitializer
+
+declare i32 @callee(i32, i32)
+
+define i32 @call(i32 %a) nounwind {
+; RV32-LABEL: call:
+; RV32: addi [[G:[a-z0-9]+]], gp, %gp_rel(g)
+; RV32: lw {{.*}}, 0([[G]])
+; RV32: call callee
+; RV32: lui [[HI:[a-z0-9]+]], %hi(big)
+; RV32: addi {{.*}}, [[HI]], %lo(big)
+; RV32: sw
+  %1 = load i32, i32* @g
+  %2 = call i32 @callee(i32 %a, i32 %1)
+  %3 = getelementptr [64 x i32], [64 x i32]* @big, i32 0, i32 1
+  store i32 %2, i32* %3
+  ret i32 %2
+}
+
+define i32 @call_indirect(i32 (i32, i32)* %f, i32 %a) nounwind {
+; RV32-LABEL: call_indirect:
+; RV32: jalr
+  %1 = call i32 %f(i32 %a, i32 %a)
+  ret i32 %1
+}
@@ -0,0 +1,177 @@
+; RUN: llc -mtriple=riscv32 -mattr=+f -target-abi ilp32f -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s
+; RUN: llc -mtriple=riscv64 -mattr=+f -target-abi lp64f -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s
+
+define float @fadd_s(float %a, float %b) nounwind {
+; CHECK-LABEL: fadd_s:
+; CHECK: fadd.s fa0, fa0, fa1
+  %1 = fadd float %a, %b
+  ret float %1
+}
+
+define float @fsub_s(float %a, float %b) nounwind {
+; CHECK-LABEL: fsub_s:
+; CHECK: fsub.s fa0, fa0, fa1
+  %1 = fsub float %a, %b
+  ret float %1
+}
+
+define float @fmul_s(float %a, float %b) nounwind {
+; CHECK-LABEL: fmul_s:
+; CHECK: fmul.s fa0, fa0, fa1
+  %1 = fmul float %a, %b
+  ret float %1
+}
+
+define float @fdiv_s(float %a, float %b) nounwind {
+; CHECK-LABEL: fdiv_s:
+; CHECK: fdiv.s fa0, fa0, fa1
+  %1 = fdiv float %a, %b
+  ret float %1
+}
+
+declare float @llvm.sqrt.f32(float)
+
+define float @fsqrt_s(float %a) nounwind {
+; CHECK-LABEL: fsqrt_s:
+; CHECK: fsqrt.s fa0, fa0
+  %1 = call float @llvm.sqrt.f32(float %a)
+  ret float %1
+}
+
+define float @fneg_s(float %a) nounwind {
+; CHECK-LABEL: fneg_s:
+; CHECK: fsgnjn.s fa0, fa0, fa0
+  %1 = fsub float -0.0, %a
+  ret float %1
+}
+
+declare float @llvm.fabs.f32(float)
+
+define float @fabs_s(float %a) nounwind {
+; CHECK-LABEL: fabs_s:
+; CHECK: fsgnjx.s fa0, fa0, fa0
+  %1 = call float @llvm.fabs.f32(float %a)
+  ret float %1
+}
+
+declare float @llvm.copysign.f32(float, float)
+
+define float @fsgnj_s(float %a, float %b) nounwind {
+; CHECK-LABEL: fsgnj_s:
+; CHECK: fsgnj.s fa0, fa0, fa1
+  %1 = call float @llvm.copysign.f32(float %a, float %b)
+  ret float %1
+}
+
+declare float @llvm.minnum.f32(float, float)
+declare float @llvm.maxnum.f32(float, float)
+
+define float @fmin_s(float %a, float %b) nounwind {
+; CHECK-LABEL: fmin_s:
+; CHECK: fmin.s fa0, fa0, fa1
+  %1 = call float @llvm.minnum.f32(float %a, float %b)
+  ret float %1
+}
+
+define float @fmax_s(float %a, float %b) nounwind {
+; CHECK-LABEL: fmax_s:
+; CHECK: fmax.s fa0, fa0, fa1
+  %1 = call float @llvm.maxnum.f32(float %a, float %b)
+  ret float %1
+}
+
+declare float @llvm.fma.f32(float, float, float)
+
+define float @fmadd_s(float %a, float %b, float %c) nounwind {
+; CHECK-LABEL: fmadd_s:
+; CHECK: fmadd.s fa0, fa0, fa1, fa2
+  %1 = call float @llvm.fma.f32(float %a, float %b, float %c)
+  ret float %1
+}
+
+define float @fmsub_s(float %a, float %b, float %c) nounwind {
+; CHECK-LABEL: fmsub_s:
+; CHECK: fmsub.s fa0, fa0, fa1, fa2
+  %negc = fsub float -0.0, %c
+  %1 = call float @llvm.fma.f32(float %a, float %b, float %negc)
+  ret float %1
+}
+
+define float @fnmadd_s(float %a, float %b, float %c) nounwind {
+; CHECK-LABEL: fnmadd_s:
+; CHECK: fnmadd.s fa0, fa0, fa1, fa2
+  %nega = fsub float -0.0, %a
+  %negc = fsub float -0.0, %c
+  %1 = call float @llvm.fma.f32(float %nega, float %b, float %negc)
+  ret float %1
+}
+
+define float @fnmsub_s(float %a, float %b, float %c) nounwind {
+; CHECK-LABEL: fnmsub_s:
+; CHECK: fnmsub.s fa0, fa0, fa1, fa2
+  %nega = fsub float -0.0, %a
+  %1 = call float @llvm.fma.f32(float %nega, float %b, float %c)
+  ret float %1
+}
+
+define float @fmuladd_contract(float %a, float %b, float %c) nounwind {
+; CHECK-LABEL: fmuladd_contract:
+; CHECK: fmadd.s fa0, fa0, fa1, fa2
+  %1 = fmul contract float %a, %b
+  %2 = fadd contract float %1, %c
+  ret float %2
+}
+
+define i32 @fcvt_w_s(float %a) nounwind {
+; CHECK-LABEL: fcvt_w_s:
+; CHECK: fcvt.w.s a0, fa0, rtz
+  %1 = fptosi float %a to i32
+  ret i32 %1
+}
+
+define float @fcvt_s_w(i32 %a) nounwind {
+; CHECK-LABEL: fcvt_s_w:
+; CHECK: fcvt.s.w fa0, a0
+  %1 = sitofp i32 %a to float
+  ret float %1
+}
+
+define float @fcvt_s_wu(i32 %a) nounwind {
+; CHECK-LABEL: fcvt_s_wu:
+; CHECK: fcvt.s.wu fa0, a0
+  %1 = uitofp i32 %a to float
+  ret float %1
+}
+
+define i32 @fmv_x_w(float %a) nounwind {
+; CHECK-LABEL: fmv_x_w:
+; CHECK: fmv.x.w a0, fa0
+  %1 = bitcast float %a to i32
+  ret i32 %1
+}
+
+define float @fmv_w_x(i32 %a) nounwind {
+; CHECK-LABEL: fmv_w_x:
+; CHECK: fmv.w.x fa0, a0
+  %1 = bitcast i32 %a to float
+  ret float %1
+}
+
+define float @zero() nounwind {
+; CHECK-LABEL: zero:
+; CHECK: fmv.w.x fa0, zero
+  ret float 0.0
+}
+
+define float @load_store(float* %p) nounwind {
+; CHECK-LABEL: load_store:
+; CHECK: flw [[R:f[a-z0-9]+]], 4(a0)
+; CHECK: fsw [[R]], 8(a0)
+  %1 = getelementptr float, float* %p, i32 1
+  %2 = load float, float* %1
+  %3 = getelementptr float, float* %p, i32 2
+  store float %2, float* %3
+  ret float %2
+}
@@ -0,0 +1,96 @@
+; RUN: llc -mtriple=riscv32 -mattr=+f -target-abi ilp32f -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s
+
+define i32 @fcmp_oeq(float %a, float %b) nounwind {
+; CHECK-LABEL: fcmp_oeq:
+; CHECK: feq.s a0, fa0, fa1
+  %1 = fcmp oeq float %a, %b
+  %2 = zext i1 %1 to i32
+  ret i32 %2
+}
+
+define i32 @fcmp_ogt(float %a, float %b) nounwind {
+; CHECK-LABEL: fcmp_ogt:
+; CHECK: flt.s a0, fa1, fa0
+  %1 = fcmp ogt float %a, %b
+  %2 = zext i1 %1 to i32
+  ret i32 %2
+}
+
+define i32 @fcmp_oge(float %a, float %b) nounwind {
+; CHECK-LABEL: fcmp_oge:
+; CHECK: fle.s a0, fa1, fa0
+  %1 = fcmp oge float %a, %b
+  %2 = zext i1 %1 to i32
+  ret i32 %2
+}
+
+define i32 @fcmp_olt(float %a, float %b) nounwind {
+; CHECK-LABEL: fcmp_olt:
+; CHECK: flt.s a0, fa0, fa1
+  %1 = fcmp olt float %a, %b
+  %2 = zext i1 %1 to i32
+  ret i32 %2
+}
+
+define i32 @fcmp_ole(float %a, float %b) nounwind {
+; CHECK-LABEL: fcmp_ole:
+; CHECK: fle.s a0, fa0, fa1
+  %1 = fcmp ole float %a, %b
+  %2 = zext i1 %1 to i32
+  ret i32 %2
+}
+
+define i32 @fcmp_une(float %a, float %b) nounwind {
+; CHECK-LABEL: fcmp_une:
+; CHECK: feq.s [[R:a[0-9]]], fa0, fa1
+; CHECK: xori a0, [[R]], 1
+  %1 = fcmp une float %a, %b
+  %2 = zext i1 %1 to i32
+  ret i32 %2
+}
+
+define i32 @fcmp_ord(float %a, float %b) nounwind {
+; CHECK-LABEL: fcmp_ord:
+; CHECK-DAG: feq.s [[R1:a[0-9]]], fa1, fa1
+; CHECK-DAG: feq.s [[R2:a[0-9]]], fa0, fa0
+; CHECK: and a0, {{a[0-9]}}, {{a[0-9]}}
+  %1 = fcmp ord float %a, %b
+  %2 = zext i1 %1 to i32
+  ret i32 %2
+}
+
+define i32 @fcmp_uno(float %a, float %b) nounwind {
+; CHECK-LABEL: fcmp_uno:
+; CHECK-DAG: feq.s [[R1:a[0-9]]], fa1, fa1
+; CHECK-DAG: feq.s [[R2:a[0-9]]], fa0, fa0
+; CHECK: and [[R3:a[0-9]]], {{a[0-9]}}, {{a[0-9]}}
+; CHECK: sltiu a0, [[R3]], 1
+  %1 = fcmp uno float %a, %b
+  %2 = zext i1 %1 to i32
+  ret i32 %2
+}
+
+define float @select_fcmp(float %a, float %b) nounwind {
+; CHECK-LABEL: select_fcmp:
+; CHECK: flt.s [[R:a[0-9]]], fa0, fa1
+; CHECK: bne [[R]], zero, .LBB
+  %1 = fcmp olt float %a, %b
+  %2 = select i1 %1, float %a, float %b
+  ret float %2
+}
+
+define void @br_fcmp(float %a, float %b) nounwind {
+; CHECK-LABEL: br_fcmp:
+; CHECK: feq.s [[R:a[0-9]]], fa0, fa1
+; CHECK: b{{eq|ne}} [[R]], zero, .LBB
+  %1 = fcmp oeq float %a, %b
+  br i1 %1, label %if.then, label %if.else
+if.then:
+  ret void
+if.else:
+  tail call void @abort()
+  unreachable
+}
+
+declare void @abort()
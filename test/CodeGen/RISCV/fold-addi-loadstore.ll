@@ -0,0 +1,119 @@
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=riscv64 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV64 %s
+
+; The %lo part of a global address, and the offset of a field within it, are
+; folded into the immediate of the loads and stores that use it, and the
+; accesses share one lui.
+
+%struct.S = type { i32, i32, i32, i32 }
+
+@s = global %struct.S zeroinitializer, align 16
+@table = global [16 x i32] zeroinitializer, align 64
+@bytes = global [16 x i8] zeroinitializer, align 1
+
+%struct.P = type { i32, i32 }
+
+@p = global %struct.P zeroinitializer, align 4
+@small_bytes = global [8 x i8] zeroinitializer, align 1
+
+define i32 @load_fields() nounwind {
+; CHECK-LABEL: load_fields:
+; CHECK: lui [[R:[a-z0-9]+]], %hi(s)
+; CHECK-NOT: lui
+; CHECK-NOT: addi {{[a-z0-9]+}}, [[R]], %lo(s)
+; CHECK-DAG: lw {{[a-z0-9]+}}, %lo(s)([[R]])
+; CHECK-DAG: lw {{[a-z0-9]+}}, %lo(s+4)([[R]])
+; CHECK-DAG: lw {{[a-z0-9]+}}, %lo(s+12)([[R]])
+; RV64-LABEL: load_fields:
+; RV64: lui [[R:[a-z0-9]+]], %hi(s)
+; RV64-NOT: lui
+; RV64-DAG: lw {{[a-z0-9]+}}, %lo(s)([[R]])
+; RV64-DAG: lw {{[a-z0-9]+}}, %lo(s+4)([[R]])
+; RV64-DAG: lw {{[a-z0-9]+}}, %lo(s+12)([[R]])
+  %1 = load i32, i32* getelementptr (%struct.S, %struct.S* @s, i32 0, i32 0)
+  %2 = load i32, i32* getelementptr (%struct.S, %struct.S* @s, i32 0, i32 1)
+  %3 = load i32, i32* getelementptr (%struct.S, %struct.S* @s, i32 0, i32 3)
+  %4 = add i32 %1, %2
+  %5 = add i32 %4, %3
+  ret i32 %5
+}
+
+define void @store_fields(i32 %a) nounwind {
+; CHECK-LABEL: store_fields:
+; CHECK: lui [[R:[a-z0-9]+]], %hi(table)
+; CHECK-NOT: lui
+; CHECK-DAG: sw a0, %lo(table+8)([[R]])
+; CHECK-DAG: sw a0, %lo(table+60)([[R]])
+  store i32 %a, i32* getelementptr ([16 x i32], [16 x i32]* @table, i32 0, i32 2)
+  store i32 %a, i32* getelementptr ([16 x i32], [16 x i32]* @table, i32 0, i32 15)
+  ret void
+}
+
+; Taking the address of a field folds the same way.
+define i32* @addr_field() nounwind {
+; CHECK-LABEL: addr_field:
+; CHECK: lui [[R:[a-z0-9]+]], %hi(s)
+; CHECK-NEXT: addi a0, [[R]], %lo(s+8)
+  ret i32* getelementptr (%struct.S, %struct.S* @s, i32 0, i32 2)
+}
+
+; An offset past the alignment of the object might carry into %hi, so it is
+; left in the load.
+define i8 @load_unaligned_offset() nounwind {
+; CHECK-LABEL: load_unaligned_offset:
+; CHECK: lui [[R:[a-z0-9]+]], %hi(bytes)
+; CHECK: addi [[A:[a-z0-9]+]], [[R]], %lo(bytes)
+; CHECK: lbu a0, 5([[A]])
+  %1 = load i8, i8* getelementptr ([16 x i8], [16 x i8]* @bytes, i32 0, i32 5)
+  ret i8 %1
+}
+
+; Small data is addressed from gp, which reaches the whole object, so any
+; offset inside it is folded into the %gp_rel relocation whatever the
+; alignment.
+define i32 @load_small_fields() nounwind {
+; CHECK-LABEL: load_small_fields:
+; CHECK: lw a0, %gp_rel(p+4)(gp)
+; CHECK-NEXT: lw a1, %gp_rel(p)(gp)
+; RV64-LABEL: load_small_fields:
+; RV64: lw a0, %gp_rel(p+4)(gp)
+; RV64-NEXT: lw a1, %gp_rel(p)(gp)
+  %1 = load i32, i32* getelementptr (%struct.P, %struct.P* @p, i32 0, i32 0)
+  %2 = load i32, i32* getelementptr (%struct.P, %struct.P* @p, i32 0, i32 1)
+  %3 = add i32 %1, %2
+  ret i32 %3
+}
+
+define void @store_small_bytes(i8 %a) nounwind {
+; CHECK-LABEL: store_small_bytes:
+; CHECK: sb a0, %gp_rel(small_bytes+7)(gp)
+; CHECK-NEXT: sb a0, %gp_rel(small_bytes+3)(gp)
+; RV64-LABEL: store_small_bytes:
+; RV64: sb a0, %gp_rel(small_bytes+7)(gp)
+; RV64-NEXT: sb a0, %gp_rel(small_bytes+3)(gp)
+  store i8 %a, i8* getelementptr ([8 x i8], [8 x i8]* @small_bytes, i32 0, i32 3)
+  store i8 %a, i8* getelementptr ([8 x i8], [8 x i8]* @small_bytes, i32 0, i32 7)
+  ret void
+}
+
+define i32* @addr_small_field() nounwind {
+; CHECK-LABEL: addr_small_field:
+; CHECK: addi a0, gp, %gp_rel(p+4)
+; RV64-LABEL: addr_small_field:
+; RV64: addi a0, gp, %gp_rel(p+4)
+  ret i32* getelementptr (%struct.P, %struct.P* @p, i32 0, i32 1)
+}
+
+; An offset outside the object may not be in range of gp, so it is left in
+; the load.
+define i32 @load_small_outside() nounwind {
+; CHECK-LABEL: load_small_outside:
+; CHECK: addi [[A:[a-z0-9]+]], gp, %gp_rel(p)
+; CHECK-NEXT: lw a0, 12([[A]])
+; RV64-LABEL: load_small_outside:
+; RV64: addi [[A:[a-z0-9]+]], gp, %gp_rel(p)
+; RV64-NEXT: lw a0, 12([[A]])
+  %1 = load i32, i32* getelementptr (i32, i32* bitcast (%struct.P* @p to i32*), i32 3)
+  ret i32 %1
+}
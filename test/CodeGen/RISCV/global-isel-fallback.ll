@@ -0,0 +1,19 @@
+; RUN: llc -mtriple=riscv32 -global-isel -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s
+; RUN: not llc -mtriple=riscv32 -global-isel -riscv-global-isel-abort \
+; RUN:   -verify-machineinstrs < %s 2>&1 | FileCheck -check-prefix=ABORT %s
+
+; Functions GlobalISel cannot handle yet are handed back to SelectionDAG,
+; unless -riscv-global-isel-abort is given.
+
+; ABORT: LLVM ERROR: unable to lower arguments
+
+define void @stack_args(i32 %a0, i32 %a1, i32 %a2, i32 %a3, i32 %a4, i32 %a5,
+                        i32 %a6, i32 %a7, i32 %a8, i32* %p) nounwind {
+; CHECK-LABEL: stack_args:
+; CHECK: lw [[REG:[a-z0-9]+]], 4(sp)
+; CHECK: sw {{.*}}, 0([[REG]])
+; CHECK: jalr zero, ra, 0
+  store i32 %a8, i32* %p
+  ret void
+}
@@ -0,0 +1,14 @@
+; RUN: llc -mtriple=riscv64 -global-isel -riscv-global-isel-abort \
+; RUN:   -verify-machineinstrs < %s | FileCheck -check-prefix=RV64 %s
+
+; i64 operations selected by GlobalISel on RV64.
+
+define i64 @arith64(i64 %a, i64 %b) nounwind {
+; RV64-LABEL: arith64:
+; RV64: add
+; RV64: and
+; RV64: jalr zero, ra, 0
+  %1 = add i64 %a, %b
+  %2 = and i64 %1, %b
+  ret i64 %2
+}
@@ -0,0 +1,89 @@
+; RUN: llc -mtriple=riscv32 -global-isel -riscv-global-isel-abort \
+; RUN:   -verify-machineinstrs < %s | FileCheck -check-prefix=RV32 %s
+; RUN: llc -mtriple=riscv64 -global-isel -riscv-global-isel-abort \
+; RUN:   -verify-machineinstrs < %s | FileCheck -check-prefix=RV64 %s
+
+; Everything in this file is selected by GlobalISel; -riscv-global-isel-abort
+; turns any fallback to SelectionDAG into a hard error. The i64 cases are in
+; global-isel-rv64.ll since RV32 passes i64 arguments in pairs.
+
+define i32 @arith(i32 %a, i32 %b) nounwind {
+; RV32-LABEL: arith:
+; RV32: add
+; RV32: sub
+; RV32: xor
+; RV32: jalr zero, ra, 0
+; RV64-LABEL: arith:
+; RV64: addw
+; RV64: subw
+; RV64: xor
+; RV64: jalr zero, ra, 0
+  %1 = add i32 %a, %b
+  %2 = sub i32 %1, %b
+  %3 = xor i32 %2, %a
+  ret i32 %3
+}
+
+define i32 @imm() nounwind {
+; RV32-LABEL: imm:
+; RV32: addi a0, zero, 42
+; RV32: jalr zero, ra, 0
+; RV64-LABEL: imm:
+; RV64: addi a0, zero, 42
+; RV64: jalr zero, ra, 0
+  ret i32 42
+}
+
+define i32 @load_store(i32* %p) nounwind {
+; RV32-LABEL: load_store:
+; RV32: lw [[REG:[a-z0-9]+]], 8(a0)
+; RV32: sw [[REG]], 12(a0)
+; RV64-LABEL: load_store:
+; RV64: lw [[REG:[a-z0-9]+]], 8(a0)
+; RV64: sw [[REG]], 12(a0)
+  %1 = getelementptr i32, i32* %p, i32 2
+  %2 = load i32, i32* %1
+  %3 = getelementptr i32, i32* %p, i32 3
+  store i32 %2, i32* %3
+  ret i32 %2
+}
+
+define i32 @ext(i8 %a, i16 %b) nounwind {
+; RV32-LABEL: ext:
+; RV32: andi {{.*}}, 255
+; RV32: slli {{.*}}, 16
+; RV32: srai {{.*}}, 16
+; RV64-LABEL: ext:
+; RV64: andi {{.*}}, 255
+; RV64: slliw {{.*}}, 16
+; RV64: sraiw {{.*}}, 16
+  %1 = zext i8 %a to i32
+  %2 = sext i16 %b to i32
+  %3 = add i32 %1, %2
+  ret i32 %3
+}
+
+define i32 @branch(i32 %a, i32 %b) nounwind {
+; RV32-LABEL: branch:
+; RV32: bge a0, a1
+; RV64-LABEL: branch:
+; RV64: bge a0, a1
+  %1 = icmp slt i32 %a, %b
+  br i1 %1, label %true, label %false
+true:
+  ret i32 1
+false:
+  ret i32 0
+}
+
+declare i32 @callee(i32, i32)
+
+define i32 @caller(i32 %a) nounwind {
+; RV32-LABEL: caller:
+; RV32: call callee
+; RV64-LABEL: caller:
+; RV64: call callee
+  %1 = call i32 @callee(i32 %a, i32 1)
+  %2 = add i32 %1, %a
+  ret i32 %2
+}
@@ -0,0 +1,6 @@
+; RUN: not llc -mtriple=riscv32 < %s 2>&1 | FileCheck %s
+
+; CHECK: LLVM ERROR: Function interrupt attribute argument not supported!
+define void @foo() "interrupt"="hypervisor" {
+  ret void
+}
@@ -0,0 +1,71 @@
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV32 %s
+; RUN: llc -mtriple=riscv64 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV64 %s
+; RUN: llc -mtriple=riscv32 -O0 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV32 %s
+
+@g = global i32 0
+
+; Only the registers the handler clobbers are saved, and the return
+; instruction matches the privilege level.
+define void @machine() "interrupt"="machine" {
+; RV32-LABEL: machine:
+; RV32: addi sp, sp, -16
+; RV32: sw [[A:[a-z0-9]+]], {{[0-9]+}}(sp)
+; RV32-NOT: sw ra
+; RV32: lw [[A]], {{[0-9]+}}(sp)
+; RV32: addi sp, sp, 16
+; RV32-NEXT: mret
+; RV64-LABEL: machine:
+; RV64: sd {{[a-z0-9]+}}, {{[0-9]+}}(sp)
+; RV64-NOT: sd ra
+; RV64: mret
+  store volatile i32 1, i32* @g
+  ret void
+}
+
+define void @supervisor() "interrupt"="supervisor" {
+; RV32-LABEL: supervisor:
+; RV32: sret
+; RV64-LABEL: supervisor:
+; RV64: sret
+  ret void
+}
+
+define void @user() "interrupt"="user" {
+; RV32-LABEL: user:
+; RV32: uret
+; RV64-LABEL: user:
+; RV64: uret
+  ret void
+}
+
+declare void @callee()
+
+; A call clobbers every caller-saved register, so those are all saved. The
+; stack is realigned for the callee and the call is never turned into a tail
+; call.
+define void @with_call() "interrupt"="machine" {
+; RV32-LABEL: with_call:
+; RV32-DAG: sw ra, {{[0-9]+}}(sp)
+; RV32-DAG: sw t0, {{[0-9]+}}(sp)
+; RV32-DAG: sw t6, {{[0-9]+}}(sp)
+; RV32-DAG: sw a0, {{[0-9]+}}(sp)
+; RV32-DAG: sw a7, {{[0-9]+}}(sp)
+; RV32: and sp, sp,
+; RV32: call callee
+; RV32: addi sp, s0,
+; RV32-DAG: lw ra, {{[0-9]+}}(sp)
+; RV32-DAG: lw a7, {{[0-9]+}}(sp)
+; RV32: mret
+; RV64-LABEL: with_call:
+; RV64-DAG: sd ra, {{[0-9]+}}(sp)
+; RV64-DAG: sd t6, {{[0-9]+}}(sp)
+; RV64-DAG: sd a7, {{[0-9]+}}(sp)
+; RV64: and sp, sp,
+; RV64: call callee
+; RV64: mret
+  tail call void @callee()
+  ret void
+}
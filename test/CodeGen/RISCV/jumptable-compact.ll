@@ -0,0 +1,61 @@
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV32 %s
+; RUN: llc -mtriple=riscv64 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV64 %s
+; RUN: llc -mtriple=riscv32 -mattr=+relax -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RELAX %s
+; RUN: llc -mtriple=riscv32 -mattr=+c -filetype=obj < %s -o %t
+; RUN: llvm-objdump -s -j .rodata %t | FileCheck -check-prefix=RVC-OBJ %s
+
+; Jump tables hold the distance of each case from the first one, in units of
+; the instruction alignment.
+
+define void @switch_small(i32 %in, i32* %out) {
+; RV32-LABEL: switch_small:
+; RV32: add [[P:[a-z0-9]+]], {{[a-z0-9]+}}, {{[a-z0-9]+}}
+; RV32-NEXT: lbu [[P]], 0([[P]])
+; RV32-NEXT: .Lpcrel_hi{{[0-9]+}}:
+; RV32-NEXT: auipc [[B:[a-z0-9]+]], %pcrel_hi([[BASE:.LBB0_[0-9]+]])
+; RV32-NEXT: addi [[B]], [[B]], %pcrel_lo(.Lpcrel_hi{{[0-9]+}})
+; RV32-NEXT: slli [[P]], [[P]], 2
+; RV32-NEXT: add [[D:[a-z0-9]+]], [[B]], [[P]]
+; RV32-NEXT: jalr zero, [[D]], 0
+; RV32: .section .rodata
+; RV32: .LJTI0_0:
+; RV32-NEXT: .byte ([[BASE]]-[[BASE]])>>2
+; RV32-NEXT: .byte (.LBB0_{{[0-9]+}}-[[BASE]])>>2
+; RV64-LABEL: switch_small:
+; RV64: lbu
+; RV64: auipc
+; RV64: .LJTI0_0:
+; RV64-NEXT: .byte
+; RELAX-LABEL: switch_small:
+; RELAX: lw
+; RELAX: .LJTI0_0:
+; RELAX-NEXT: .long .LBB0_{{[0-9]+}}
+; With C the distances are in halfwords, and each entry is a single byte in
+; the object file.
+; RVC-OBJ: Contents of section .rodata:
+; RVC-OBJ-NEXT: 0000 00050204
+entry:
+  switch i32 %in, label %exit [
+    i32 1, label %bb1
+    i32 2, label %bb2
+    i32 3, label %bb3
+    i32 4, label %bb4
+  ]
+bb1:
+  store i32 4, i32* %out
+  br label %exit
+bb2:
+  store i32 3, i32* %out
+  br label %exit
+bb3:
+  store i32 2, i32* %out
+  br label %exit
+bb4:
+  store i32 1, i32* %out
+  br label %exit
+exit:
+  ret void
+}
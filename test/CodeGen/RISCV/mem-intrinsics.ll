@@ -0,0 +1,84 @@
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV32 %s
+; RUN: llc -mtriple=riscv64 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV64 %s
+
+declare void @llvm.memcpy.p0i8.p0i8.i32(i8*, i8*, i32, i32, i1)
+declare void @llvm.memset.p0i8.i32(i8*, i8, i32, i32, i1)
+
+; Short copies are unrolled into loads and stores.
+define void @memcpy_small(i8* %d, i8* %s) {
+; RV32-LABEL: memcpy_small:
+; RV32-NOT: call
+; RV32: lw
+; RV32: sw
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %d, i8* %s, i32 16, i32 4, i1 false)
+  ret void
+}
+
+; Medium-sized aligned copies become a word loop plus a straight-line tail.
+define void @memcpy_loop(i8* %d, i8* %s) {
+; RV32-LABEL: memcpy_loop:
+; RV32-NOT: call
+; RV32: addi [[END:a[0-9]+]], a0, 104
+; RV32: .LBB{{[0-9_]+}}:
+; RV32: lw [[V0:[a-z0-9]+]], 0([[S:a[0-9]+]])
+; RV32: lw [[V1:[a-z0-9]+]], 4([[S]])
+; RV32: sw [[V0]], 0([[D:a[0-9]+]])
+; RV32: sw [[V1]], 4([[D]])
+; RV32: addi [[S]], [[S]], 8
+; RV32: addi [[D]], [[D]], 8
+; RV32: bne [[D]], [[END]], .LBB
+; RV32: lhu {{[a-z0-9]+}}, 104(a1)
+; RV32: sh {{[a-z0-9]+}}, 104(a0)
+; RV64-LABEL: memcpy_loop:
+; RV64-NOT: call
+; RV64: ld
+; RV64: sd
+; RV64: bne
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %d, i8* %s, i32 106, i32 8, i1 false)
+  ret void
+}
+
+; Large copies, copies of unknown alignment and copies at optsize call
+; memcpy.
+define void @memcpy_large(i8* %d, i8* %s) {
+; RV32-LABEL: memcpy_large:
+; RV32: call memcpy
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %d, i8* %s, i32 1024, i32 4, i1 false)
+  ret void
+}
+
+define void @memcpy_unaligned(i8* %d, i8* %s) {
+; RV32-LABEL: memcpy_unaligned:
+; RV32: call memcpy
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %d, i8* %s, i32 64, i32 1, i1 false)
+  ret void
+}
+
+define void @memcpy_optsize(i8* %d, i8* %s) optsize {
+; RV32-LABEL: memcpy_optsize:
+; RV32: call memcpy
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %d, i8* %s, i32 64, i32 4, i1 false)
+  ret void
+}
+
+define void @memset_loop(i8* %d, i8 %v) {
+; RV32-LABEL: memset_loop:
+; RV32-NOT: call
+; RV32: sw {{[a-z0-9]+}}, 0(a0)
+; RV32: sw {{[a-z0-9]+}}, 4(a0)
+; RV32: bne
+  call void @llvm.memset.p0i8.i32(i8* %d, i8 %v, i32 200, i32 4, i1 false)
+  ret void
+}
+
+define void @memset_zero_tail(i8* %d) {
+; RV32-LABEL: memset_zero_tail:
+; RV32-NOT: call
+; RV32: sw zero, 0({{[a-z0-9]+}})
+; RV32: bne
+; RV32: sb zero, 128(a0)
+  call void @llvm.memset.p0i8.i32(i8* %d, i8 0, i32 129, i32 4, i1 false)
+  ret void
+}
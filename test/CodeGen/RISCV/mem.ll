@@ -94,20 +94,19 @@ define void @sw(i32 *%a, i32 %b) nounwind {
   ret void
 }
 
-; Check load and store to a global
+; Check load and store to a global. @G is small data, so it is addressed
+; relative to gp; an offset outside the object is added separately.
 @G = global i32 0
 
 define i32 @lw_sw_global(i32 %a) nounwind {
-; TODO: the addi should be folded in to the lw/sw operations
 ; CHECK-LABEL: lw_sw_global:
-; CHECK: lui {{[a-z0-9]+}}, %hi(G)
-; CHECK: addi {{[a-z0-9]+}}, {{[a-z0-9]+}}, %lo(G)
-; CHECK: lw {{[a-z0-9]+}}, 0(
-; CHECK: sw a0, 0(
-; CHECK: lw      a3, 36(a2)
-; CHECK: sw      a0, 36(a2)
-; CHECK: addi    a0, a1, 0
-; CHECK: jalr    zero, ra, 0
+; CHECK: lw [[V:[a-z0-9]+]], %gp_rel(G)(gp)
+; CHECK: addi [[R:[a-z0-9]+]], gp, %gp_rel(G)
+; CHECK: lw {{[a-z0-9]+}}, 36([[R]])
+; CHECK: sw a0, 36([[R]])
+; CHECK: sw a0, %gp_rel(G)(gp)
+; CHECK: addi a0, [[V]], 0
+; CHECK: jalr zero, ra, 0
   %1 = load volatile i32, i32* @G
   store i32 %a, i32* @G
   %2 = getelementptr i32, i32* @G, i32 9
@@ -118,12 +117,11 @@ define i32 @lw_sw_global(i32 %a) nounwind {
 
 ; Ensure that 1 is added to the high 20 bits if bit 11 of the low part is 1
 define i32 @lw_sw_constant(i32 %a) nounwind {
-; TODO: the addi should be folded in to the lw/sw
 ; CHECK-LABEL: lw_sw_constant:
-; CHECK: lui {{[a-z0-9]+}}, 912092
-; CHECK: addi {{[a-z0-9]+}}, {{[a-z0-9]+}}, -273
-; CHECK: lw {{[a-z0-9]+}}, 0(
-; CHECK: sw a0, 0(
+; CHECK: lui [[R:[a-z0-9]+]], 912092
+; CHECK-NOT: addi {{[a-z0-9]+}}, [[R]], -273
+; CHECK: lw {{[a-z0-9]+}}, -273([[R]])
+; CHECK: sw a0, -273([[R]])
   %1 = inttoptr i32 3735928559 to i32*
   %2 = load volatile i32, i32* %1
   store i32 %a, i32* %1
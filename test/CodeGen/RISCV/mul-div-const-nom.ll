@@ -0,0 +1,111 @@
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV32I %s
+; RUN: llc -mtriple=riscv64 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV64I %s
+; RUN: llc -mtriple=riscv32 -mattr=+m -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV32IM %s
+
+; Without M, multiplications and divisions by constants are expanded into
+; shifts and adds instead of libcalls.
+
+define i32 @mul10(i32 %a) {
+; RV32I-LABEL: mul10:
+; RV32I-NOT: call
+; RV32I-DAG: slli {{a[0-9]+}}, a0, 1
+; RV32I-DAG: slli {{a[0-9]+}}, a0, 3
+; RV32I: add a0
+; RV64I-LABEL: mul10:
+; RV64I-NOT: call
+; RV64I: slliw
+; RV32IM-LABEL: mul10:
+; RV32IM: mul
+  %1 = mul i32 %a, 10
+  ret i32 %1
+}
+
+define i32 @mul_neg7(i32 %a) {
+; RV32I-LABEL: mul_neg7:
+; RV32I-NOT: call
+; RV32I: slli [[S:a[0-9]+]], a0, 3
+; RV32I: sub a0, a0, [[S]]
+  %1 = mul i32 %a, -7
+  ret i32 %1
+}
+
+define i64 @mul_i64(i64 %a) {
+; RV64I-LABEL: mul_i64:
+; RV64I-NOT: call
+; RV64I: slli {{a[0-9]+}}, a0, 4
+  %1 = mul i64 %a, 15
+  ret i64 %1
+}
+
+define i32 @mul_dense(i32 %a) {
+; RV32I-LABEL: mul_dense:
+; RV32I: call __mulsi3
+  %1 = mul i32 %a, 1431655765
+  ret i32 %1
+}
+
+define i32 @udiv10(i32 %a) {
+; RV32I-LABEL: udiv10:
+; RV32I-NOT: call
+; RV32I: srli {{a[0-9]+}}, a0, 4
+; RV32I: srli {{a[0-9]+}}, a0, 5
+; RV32I: srli {{a[0-9]+}}, {{a[0-9]+}}, 8
+; RV32I: srli {{a[0-9]+}}, {{a[0-9]+}}, 16
+; RV64I-LABEL: udiv10:
+; RV64I-NOT: call
+; RV32IM-LABEL: udiv10:
+; RV32IM: mulhu
+  %1 = udiv i32 %a, 10
+  ret i32 %1
+}
+
+define i32 @urem3(i32 %a) {
+; RV32I-LABEL: urem3:
+; RV32I-NOT: call
+; RV32I: srli {{a[0-9]+}}, a0, 2
+; RV32I: sub a0
+  %1 = urem i32 %a, 3
+  ret i32 %1
+}
+
+define i32 @sdiv7(i32 %a) {
+; RV32I-LABEL: sdiv7:
+; RV32I-NOT: call
+; RV32I: srai [[S:a[0-9]+]], a0, 31
+; RV32I: xor {{a[0-9]+}}, a0, [[S]]
+  %1 = sdiv i32 %a, 7
+  ret i32 %1
+}
+
+define i32 @sdiv_neg5(i32 %a) {
+; RV32I-LABEL: sdiv_neg5:
+; RV32I-NOT: call
+; RV32I: srai {{a[0-9]+}}, a0, 31
+  %1 = sdiv i32 %a, -5
+  ret i32 %1
+}
+
+define i64 @udiv_i64(i64 %a) {
+; RV64I-LABEL: udiv_i64:
+; RV64I-NOT: call
+; RV64I: srli {{a[0-9]+}}, {{a[0-9]+}}, 32
+  %1 = udiv i64 %a, 10
+  ret i64 %1
+}
+
+define i32 @udiv_large(i32 %a) {
+; RV32I-LABEL: udiv_large:
+; RV32I: call __udivsi3
+  %1 = udiv i32 %a, 1000
+  ret i32 %1
+}
+
+define i32 @udiv_optsize(i32 %a) optsize {
+; RV32I-LABEL: udiv_optsize:
+; RV32I: call __udivsi3
+  %1 = udiv i32 %a, 10
+  ret i32 %1
+}
@@ -1,23 +1,31 @@
-; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=riscv32 -mattr=+m -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32IM %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32I %s
 
 define i32 @square(i32 %a) {
 ; CHECK-LABEL: square:
-; CHECK: mul     a0, a0, a0
+; RV32IM: mul a0, a0, a0
+; RV32I: addi a1, a0, 0
+; RV32I-NEXT: call __mulsi3
   %1 = mul i32 %a, %a
   ret i32 %1
 }
 
 define i32 @mul(i32 %a, i32 %b) {
 ; CHECK-LABEL: mul:
-; CHECK: mul     a0, a0, a1
+; RV32IM: mul a0, a0, a1
+; RV32I: call __mulsi3
   %1 = mul i32 %a, %b
   ret i32 %1
 }
 
 define i32 @mul_constant(i32 %a) {
 ; CHECK-LABEL: mul_constant:
-; CHECK: addi    a1, zero, 5
-; CHECK: mul     a0, a0, a1
+; RV32IM: addi a1, zero, 5
+; RV32IM-NEXT: mul a0, a0, a1
+; RV32I: slli a1, a0, 2
+; RV32I-NEXT: add a0, a0, a1
   %1 = mul i32 %a, 5
   ret i32 %1
 }
@@ -32,23 +40,30 @@ define i32 @mul_pow2(i32 %a) {
 
 define i64 @mul64(i64 %a, i64 %b) {
 ; CHECK-LABEL: mul64:
-; CHECK: mul     a3, a0, a3
-; CHECK: mulhu   a4, a0, a2
-; CHECK: add     a3, a4, a3
-; CHECK: mul     a1, a1, a2
-; CHECK: add     a1, a3, a1
-; CHECK: mul     a0, a0, a2
+; RV32IM: mul a3, a0, a3
+; RV32IM-NEXT: mulhu a4, a0, a2
+; RV32IM-NEXT: add a3, a4, a3
+; RV32IM-NEXT: mul a1, a1, a2
+; RV32IM-NEXT: add a1, a3, a1
+; RV32IM-NEXT: mul a0, a0, a2
+; RV32I: call __muldi3
   %1 = mul i64 %a, %b
   ret i64 %1
 }
 
 define i64 @mul64_constant(i64 %a) {
 ; CHECK-LABEL: mul64_constant:
-; CHECK: addi    a2, zero, 5
-; CHECK: mul     a1, a1, a2
-; CHECK: mulhu   a3, a0, a2
-; CHECK: add     a1, a3, a1
-; CHECK: mul     a0, a0, a2
+; RV32IM: addi a2, zero, 5
+; RV32IM-NEXT: mul a1, a1, a2
+; RV32IM-NEXT: mulhu a3, a0, a2
+; RV32IM-NEXT: add a1, a3, a1
+; RV32IM-NEXT: mul a0, a0, a2
+; RV32I-NOT: call
+; RV32I: slli a2, a0, 2
+; RV32I-NEXT: add a2, a0, a2
+; RV32I-NEXT: sltu a0, a2, a0
+; RV32I-NEXT: add a1, a1, a0
+; RV32I-NEXT: addi a0, a2, 0
   %1 = mul i64 %a, 5
   ret i64 %1
 }
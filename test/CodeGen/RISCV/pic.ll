@@ -0,0 +1,75 @@
+; RUN: llc -mtriple=riscv32 -relocation-model=pic -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=PIC %s
+; RUN: llc -mtriple=riscv64 -relocation-model=pic -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=PIC64 %s
+; RUN: llc -mtriple=riscv32 -code-model=medium -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=MEDANY %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=STATIC %s
+
+@external = external global i32
+@hidden = hidden global i32 0
+@internal = internal global [4 x i32] zeroinitializer
+
+; A symbol that may be preempted is reached through the GOT.
+define i32 @load_external() nounwind {
+; PIC-LABEL: load_external:
+; PIC: [[L:.Lpcrel_hi[0-9]+]]:
+; PIC-NEXT: auipc [[R:[a-z0-9]+]], %got_pcrel_hi(external)
+; PIC-NEXT: lw [[R]], %pcrel_lo([[L]])([[R]])
+; PIC-NEXT: lw a0, 0([[R]])
+; PIC64-LABEL: load_external:
+; PIC64: [[L:.Lpcrel_hi[0-9]+]]:
+; PIC64-NEXT: auipc [[R:[a-z0-9]+]], %got_pcrel_hi(external)
+; PIC64-NEXT: ld [[R]], %pcrel_lo([[L]])([[R]])
+; MEDANY-LABEL: load_external:
+; MEDANY: [[L:.Lpcrel_hi[0-9]+]]:
+; MEDANY-NEXT: auipc [[R:[a-z0-9]+]], %pcrel_hi(external)
+; MEDANY-NEXT: addi [[R]], [[R]], %pcrel_lo([[L]])
+; STATIC-LABEL: load_external:
+; STATIC: lui [[R:[a-z0-9]+]], %hi(external)
+  %1 = load i32, i32* @external
+  ret i32 %1
+}
+
+; Hidden and internal symbols can't be preempted, so their address is
+; computed directly.
+define i32* @addr_hidden() nounwind {
+; PIC-LABEL: addr_hidden:
+; PIC: [[L:.Lpcrel_hi[0-9]+]]:
+; PIC-NEXT: auipc a0, %pcrel_hi(hidden)
+; PIC-NEXT: addi a0, a0, %pcrel_lo([[L]])
+; PIC64-LABEL: addr_hidden:
+; PIC64: [[L:.Lpcrel_hi[0-9]+]]:
+; PIC64-NEXT: auipc a0, %pcrel_hi(hidden)
+; PIC64-NEXT: addi a0, a0, %pcrel_lo([[L]])
+  ret i32* @hidden
+}
+
+define i32* @addr_internal_offset() nounwind {
+; PIC-LABEL: addr_internal_offset:
+; PIC: [[L:.Lpcrel_hi[0-9]+]]:
+; PIC-NEXT: auipc a0, %pcrel_hi(internal+8)
+; PIC-NEXT: addi a0, a0, %pcrel_lo([[L]])
+  ret i32* getelementptr ([4 x i32], [4 x i32]* @internal, i32 0, i32 2)
+}
+
+; The offset is added after loading the address from the GOT.
+define i32* @addr_external_offset() nounwind {
+; PIC-LABEL: addr_external_offset:
+; PIC: auipc [[R:[a-z0-9]+]], %got_pcrel_hi(external)
+; PIC-NEXT: lw [[R]], %pcrel_lo({{.Lpcrel_hi[0-9]+}})([[R]])
+; PIC-NEXT: addi a0, [[R]], 12
+  ret i32* getelementptr (i32, i32* @external, i32 3)
+}
+
+declare void @external_function()
+
+define void @call_external() nounwind {
+; PIC-LABEL: call_external:
+; PIC: call external_function@plt
+; MEDANY-LABEL: call_external:
+; MEDANY: call external_function
+  call void @external_function()
+  ret void
+}
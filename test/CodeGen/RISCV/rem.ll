@@ -1,15 +1,20 @@
-; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=riscv32 -mattr=+m -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32IM %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32I %s
 
 define i32 @urem(i32 %a, i32 %b) nounwind {
 ; CHECK-LABEL: urem:
-; CHECK: remu    a0, a0, a1
+; RV32IM: remu a0, a0, a1
+; RV32I: call __umodsi3
   %1 = urem i32 %a, %b
   ret i32 %1
 }
 
 define i32 @srem(i32 %a, i32 %b) nounwind {
 ; CHECK-LABEL: srem:
-; CHECK: rem     a0, a0, a1
+; RV32IM: rem a0, a0, a1
+; RV32I: call __modsi3
   %1 = srem i32 %a, %b
   ret i32 %1
 }
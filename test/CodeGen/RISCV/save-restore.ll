@@ -0,0 +1,102 @@
+; RUN: llc -mtriple=riscv32 -mattr=+save-restore -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32 %s
+; RUN: llc -mtriple=riscv64 -mattr=+save-restore -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV64 %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=INLINE %s
+
+declare void @callee(i32*)
+declare i32 @g(i32)
+
+; ra and s1 are saved by __riscv_save_2 through t0 and restored by a tail call
+; to __riscv_restore_2, which returns for us. s0 is reserved for the frame
+; pointer, but the routines only save a prefix of s0-s11 so it is saved too.
+define i32 @save_ra_s1(i32 %a) nounwind {
+; CHECK-LABEL: save_ra_s1:
+; CHECK: call t0, __riscv_save_2
+; CHECK-NOT: s{{[wd]}} ra,
+; CHECK-NOT: s{{[wd]}} s1,
+; CHECK: call g
+; CHECK-NOT: l{{[wd]}} ra,
+; CHECK-NOT: jalr zero, ra, 0
+; CHECK: tail __riscv_restore_2
+; INLINE-LABEL: save_ra_s1:
+; INLINE-NOT: __riscv_save
+; INLINE: sw ra,
+; INLINE: jalr zero, ra, 0
+  %1 = call i32 @g(i32 %a)
+  %2 = add i32 %1, %a
+  %3 = call i32 @g(i32 %2)
+  %4 = add i32 %3, %a
+  ret i32 %4
+}
+
+; The routine always saves ra and a prefix of s0-s11, in an area rounded up to
+; the stack alignment, and also stores the registers that fill the rest of that
+; area. Locals are placed below the whole area.
+define void @save_with_locals(i32 %a, i32 %b, i32 %c) nounwind {
+; CHECK-LABEL: save_with_locals:
+; CHECK: call t0, __riscv_save_4
+; CHECK-NEXT: addi sp, sp, -16
+; CHECK: sw a0, 12(sp)
+; CHECK: call callee
+; CHECK: addi sp, sp, 16
+; CHECK-NEXT: tail __riscv_restore_4
+  %1 = alloca i32
+  store i32 %a, i32* %1
+  call void @callee(i32* %1)
+  store i32 %b, i32* %1
+  call void @callee(i32* %1)
+  store i32 %c, i32* %1
+  call void @callee(i32* %1)
+  call void @callee(i32* %1)
+  ret void
+}
+
+; Functions that end in a tail call keep the inline sequence.
+define i32 @tail_call(i32 %a) nounwind {
+; CHECK-LABEL: tail_call:
+; CHECK-NOT: __riscv_save
+; CHECK: tail g
+  %1 = call i32 @g(i32 %a)
+  %2 = tail call i32 @g(i32 %1)
+  ret i32 %2
+}
+
+; Leaf functions save nothing and call nothing.
+define i32 @leaf(i32 %a) nounwind {
+; CHECK-LABEL: leaf:
+; CHECK-NOT: __riscv
+; CHECK: jalr zero, ra, 0
+  %1 = add i32 %a, 1
+  ret i32 %1
+}
+
+; Optimizing for size enables the routines without the feature.
+define i32 @optsize(i32 %a) nounwind optsize {
+; INLINE-LABEL: optsize:
+; INLINE: call t0, __riscv_save_0
+; INLINE: tail __riscv_restore_0
+  %1 = call i32 @g(i32 %a)
+  %2 = call i32 @g(i32 %1)
+  ret i32 %2
+}
+
+; fastcc passes its first argument in t0, which the call to __riscv_save_N
+; would clobber.
+declare void @use(i32)
+
+define fastcc i32 @fastcc_args(i32 %a, i32 %b) nounwind optsize {
+; CHECK-LABEL: fastcc_args:
+; CHECK-NOT: __riscv_save
+; CHECK: addi s2, t0, 0
+; CHECK: call use
+; CHECK-NOT: __riscv_restore
+; CHECK: jalr zero, ra, 0
+; INLINE-LABEL: fastcc_args:
+; INLINE-NOT: __riscv_save
+; INLINE: jalr zero, ra, 0
+  call void @use(i32 0)
+  %1 = add i32 %a, %b
+  ret i32 %1
+}
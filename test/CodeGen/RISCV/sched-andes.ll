@@ -0,0 +1,36 @@
+; RUN: llc -mtriple=riscv32 -mcpu=andes-n25 -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s
+; RUN: llc -mtriple=riscv32 -mcpu=andes-n45 -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s
+; RUN: llc -mtriple=riscv64 -mcpu=andes-nx45 -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s
+
+; With a machine model, the second load is hoisted above the use of the first
+; so the load-use latency is hidden.
+
+define i32 @load_use(i32* %p, i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: load_use:
+; CHECK: lw [[R1:[a-z0-9]+]], 0(a0)
+; CHECK-NEXT: lw [[R2:[a-z0-9]+]], 4(a0)
+; CHECK: add
+; CHECK: add
+  %1 = load i32, i32* %p
+  %2 = add i32 %1, %a
+  %3 = getelementptr i32, i32* %p, i32 1
+  %4 = load i32, i32* %3
+  %5 = add i32 %4, %b
+  %6 = xor i32 %2, %5
+  ret i32 %6
+}
+
+; The long-latency divide is started before the independent multiply.
+
+define i32 @div_first(i32 %a, i32 %b, i32 %c, i32 %d) nounwind {
+; CHECK-LABEL: div_first:
+; CHECK: div
+; CHECK: mul
+  %1 = mul i32 %c, %d
+  %2 = sdiv i32 %a, %b
+  %3 = add i32 %1, %2
+  ret i32 %3
+}
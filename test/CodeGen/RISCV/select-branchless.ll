@@ -0,0 +1,68 @@
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV32 %s
+; RUN: llc -mtriple=riscv64 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV64 %s
+; RUN: llc -mtriple=riscv32 -riscv-branchless-select-max-insts=0 \
+; RUN:   -riscv-enable-early-ifcvt=false -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=BRANCH %s
+
+; Selects against zero are a compare and a mask.
+
+define i32 @select_slt_zero(i32 %a, i32 %b, i32 %x) {
+; RV32-LABEL: select_slt_zero:
+; RV32-NOT: b{{[a-z]+}} {{.*}}.LBB
+; RV32: slt [[C:a[0-9]+]], a0, a1
+; RV32: sub [[M:a[0-9]+]], zero, [[C]]
+; RV32: and a0, a2, [[M]]
+; RV64-LABEL: select_slt_zero:
+; RV64-NOT: b{{[a-z]+}} {{.*}}.LBB
+; RV64: slt [[C:a[0-9]+]], a0, a1
+; RV64: subw [[M:a[0-9]+]], zero, [[C]]
+; RV64: and a0, a2, [[M]]
+; BRANCH-LABEL: select_slt_zero:
+; BRANCH: blt a0, a1, .LBB
+  %c = icmp slt i32 %a, %b
+  %r = select i1 %c, i32 %x, i32 0
+  ret i32 %r
+}
+
+define i32 @select_uge_zero(i32 %a, i32 %b, i32 %x) {
+; RV32-LABEL: select_uge_zero:
+; RV32-NOT: b{{[a-z]+}} {{.*}}.LBB
+; RV32: sltu [[C:a[0-9]+]], a0, a1
+; RV32: addi [[M:a[0-9]+]], [[C]], -1
+; RV32: and a0, a2, [[M]]
+  %c = icmp uge i32 %a, %b
+  %r = select i1 %c, i32 %x, i32 0
+  ret i32 %r
+}
+
+define i64 @select_eq_zero_i64(i64 %a, i64 %b, i64 %x) {
+; RV64-LABEL: select_eq_zero_i64:
+; RV64-NOT: b{{[a-z]+}} {{.*}}.LBB
+; RV64: xor [[D:a[0-9]+]], a0, a1
+; RV64: sltu [[C:a[0-9]+]], zero, [[D]]
+; RV64: addi [[M:a[0-9]+]], [[C]], -1
+; RV64: and a0, a2, [[M]]
+  %c = icmp eq i64 %a, %b
+  %r = select i1 %c, i64 %x, i64 0
+  ret i64 %r
+}
+
+; A general select is flattened by early if-conversion.
+
+define i32 @select_general(i32 %a, i32 %b, i32 %x, i32 %y) {
+; RV32-LABEL: select_general:
+; RV32-NOT: b{{[a-z]+}} {{.*}}.LBB
+; RV32-DAG: slt [[C:a[0-9]+]], a0, a1
+; RV32-DAG: xor [[D:a[0-9]+]], a2, a3
+; RV32-DAG: sub [[M:a[0-9]+]], zero, [[C]]
+; RV32: and [[A:a[0-9]+]], [[D]], [[M]]
+; RV32: xor a0, a3, [[A]]
+; BRANCH-LABEL: select_general:
+; BRANCH: blt a0, a1, .LBB
+  %c = icmp slt i32 %a, %b
+  %r = select i1 %c, i32 %x, i32 %y
+  ret i32 %r
+}
+
@@ -1,4 +1,5 @@
-; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=riscv32 -riscv-enable-early-ifcvt=false \
+; RUN:   -verify-machineinstrs < %s | FileCheck %s
 
 define i32 @foo(i32 %a, i32 *%b) {
 ; CHECK-LABEL: foo:
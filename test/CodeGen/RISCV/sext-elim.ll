@@ -0,0 +1,56 @@
+; RUN: llc -mtriple=riscv64 -mattr=+m -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s
+; RUN: llc -mtriple=riscv64 -mattr=+m -verify-machineinstrs \
+; RUN:   -riscv-enable-sext-opt=false < %s | FileCheck -check-prefix=NOOPT %s
+
+; The i32 value coming from another block is already sign-extended by the
+; load, so narrowing it again is redundant.
+define i32 @cross_block(i32* %p, i64 %n) nounwind {
+; CHECK-LABEL: cross_block:
+; CHECK: lw [[REG:[a-z0-9]+]], 0(a0)
+; CHECK-NOT: addiw {{[a-z0-9]+}}, {{[a-z0-9]+}}, 0
+; CHECK: addiw a0, [[REG]], 1
+; NOOPT-LABEL: cross_block:
+; NOOPT: addiw {{[a-z0-9]+}}, {{[a-z0-9]+}}, 0
+entry:
+  %v = load i32, i32* %p
+  %w = sext i32 %v to i64
+  %c = icmp eq i64 %n, 0
+  br i1 %c, label %exit, label %body
+
+body:
+  %t = trunc i64 %w to i32
+  %r = add i32 %t, 1
+  ret i32 %r
+
+exit:
+  ret i32 0
+}
+
+; Narrowing a 64-bit product turns the multiplication into mulw.
+define i32 @trunc_mul(i64 %a, i64 %b) nounwind {
+; CHECK-LABEL: trunc_mul:
+; CHECK: mulw a0, a0, a1
+; CHECK-NEXT: jalr zero, ra, 0
+; NOOPT-LABEL: trunc_mul:
+; NOOPT: mul
+; NOOPT: addiw a0, {{[a-z0-9]+}}, 0
+  %m = mul i64 %a, %b
+  %t = trunc i64 %m to i32
+  ret i32 %t
+}
+
+; Sign-extending the low half of a 64-bit sum in register turns the addition
+; into addw.
+define i64 @sext_inreg_add(i64 %a, i64 %b) nounwind {
+; CHECK-LABEL: sext_inreg_add:
+; CHECK: addw a0, a0, a1
+; CHECK-NEXT: jalr zero, ra, 0
+; NOOPT-LABEL: sext_inreg_add:
+; NOOPT: slli
+; NOOPT: srai
+  %s = add i64 %a, %b
+  %l = shl i64 %s, 32
+  %r = ashr i64 %l, 32
+  ret i64 %r
+}
@@ -0,0 +1,55 @@
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=riscv64 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=riscv32 -enable-shrink-wrap=false -verify-machineinstrs \
+; RUN:   < %s | FileCheck -check-prefix=NOSW %s
+
+declare void @slow_path(i32*)
+
+; The frame is only set up on the path that makes the call; the early return
+; does not touch the stack.
+define void @early_return(i32 %a) nounwind {
+; CHECK-LABEL: early_return:
+; CHECK-NOT: addi sp, sp
+; CHECK: b{{[a-z]+}} {{.*}}, [[EXIT:\.[A-Z0-9_]+]]
+; CHECK: addi sp, sp, -16
+; CHECK: s{{[wd]}} ra,
+; CHECK: call slow_path
+; CHECK: l{{[wd]}} ra,
+; CHECK: addi sp, sp, 16
+; CHECK: [[EXIT]]:
+; CHECK-NEXT: jalr zero, ra, 0
+; NOSW-LABEL: early_return:
+; NOSW: addi sp, sp, -16
+; NOSW: b{{[a-z]+}}
+; NOSW: call slow_path
+  %1 = alloca i32
+  %2 = icmp eq i32 %a, 0
+  br i1 %2, label %exit, label %slow
+
+slow:
+  store i32 %a, i32* %1
+  call void @slow_path(i32* %1)
+  br label %exit
+
+exit:
+  ret void
+}
+
+; Without optimization the prologue stays in the entry block.
+define void @optnone(i32 %a) nounwind noinline optnone {
+; CHECK-LABEL: optnone:
+; CHECK: addi sp, sp, -16
+; CHECK: b{{[a-z]+}}
+; CHECK: call slow_path
+  %1 = alloca i32
+  %2 = icmp eq i32 %a, 0
+  br i1 %2, label %exit, label %slow
+
+slow:
+  store i32 %a, i32* %1
+  call void @slow_path(i32* %1)
+  br label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,165 @@
+; RUN: llc -mtriple=riscv32 -mattr=+p -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=RV32,ABI,ABI32 %s
+; RUN: llc -mtriple=riscv64 -mattr=+p -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=RV64,ABI,ABI64 %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=ABI,ABI32 %s
+; RUN: llc -mtriple=riscv64 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=ABI,ABI64 %s
+
+define <4 x i8> @add8(<4 x i8> %a, <4 x i8> %b) nounwind {
+; RV32-LABEL: add8:
+; RV32: add8 a0, a0, a1
+; RV32-NEXT: jalr zero, ra, 0
+  %1 = add <4 x i8> %a, %b
+  ret <4 x i8> %1
+}
+
+define <2 x i16> @sub16(<2 x i16> %a, <2 x i16> %b) nounwind {
+; RV32-LABEL: sub16:
+; RV32: sub16 a0, a0, a1
+; RV32-NEXT: jalr zero, ra, 0
+  %1 = sub <2 x i16> %a, %b
+  ret <2 x i16> %1
+}
+
+define <8 x i8> @add8_64(<8 x i8> %a, <8 x i8> %b) nounwind {
+; RV64-LABEL: add8_64:
+; RV64: add8 a0, a0, a1
+; RV64-NEXT: jalr zero, ra, 0
+  %1 = add <8 x i8> %a, %b
+  ret <8 x i8> %1
+}
+
+define <4 x i16> @smax16_64(<4 x i16> %a, <4 x i16> %b) nounwind {
+; RV64-LABEL: smax16_64:
+; RV64: smax16 a0, a0, a1
+; RV64-NEXT: jalr zero, ra, 0
+  %1 = icmp sgt <4 x i16> %a, %b
+  %2 = select <4 x i1> %1, <4 x i16> %a, <4 x i16> %b
+  ret <4 x i16> %2
+}
+
+define <4 x i8> @umin8(<4 x i8> %a, <4 x i8> %b) nounwind {
+; RV32-LABEL: umin8:
+; RV32: umin8 a0, a0, a1
+; RV32-NEXT: jalr zero, ra, 0
+  %1 = icmp ult <4 x i8> %a, %b
+  %2 = select <4 x i1> %1, <4 x i8> %a, <4 x i8> %b
+  ret <4 x i8> %2
+}
+
+; Greater-than compares swap their operands.
+define <4 x i8> @cmpgt8(<4 x i8> %a, <4 x i8> %b) nounwind {
+; RV32-LABEL: cmpgt8:
+; RV32: scmplt8 a0, a1, a0
+; RV32-NEXT: jalr zero, ra, 0
+  %1 = icmp sgt <4 x i8> %a, %b
+  %2 = sext <4 x i1> %1 to <4 x i8>
+  ret <4 x i8> %2
+}
+
+define <2 x i16> @cmpeq16(<2 x i16> %a, <2 x i16> %b) nounwind {
+; RV32-LABEL: cmpeq16:
+; RV32: cmpeq16 a0, a0, a1
+; RV32-NEXT: jalr zero, ra, 0
+  %1 = icmp eq <2 x i16> %a, %b
+  %2 = sext <2 x i1> %1 to <2 x i16>
+  ret <2 x i16> %2
+}
+
+define <4 x i8> @shl8_imm(<4 x i8> %a) nounwind {
+; RV32-LABEL: shl8_imm:
+; RV32: slli8 a0, a0, 3
+; RV32-NEXT: jalr zero, ra, 0
+  %1 = shl <4 x i8> %a, <i8 3, i8 3, i8 3, i8 3>
+  ret <4 x i8> %1
+}
+
+define <4 x i16> @sra16_imm_64(<4 x i16> %a) nounwind {
+; RV64-LABEL: sra16_imm_64:
+; RV64: srai16 a0, a0, 9
+; RV64-NEXT: jalr zero, ra, 0
+  %1 = ashr <4 x i16> %a, <i16 9, i16 9, i16 9, i16 9>
+  ret <4 x i16> %1
+}
+
+define <2 x i16> @srl16_reg(<2 x i16> %a, i16 %b) nounwind {
+; RV32-LABEL: srl16_reg:
+; RV32: srl16 a0, a0, a1
+; RV32-NEXT: jalr zero, ra, 0
+  %1 = insertelement <2 x i16> undef, i16 %b, i32 0
+  %2 = shufflevector <2 x i16> %1, <2 x i16> undef, <2 x i32> zeroinitializer
+  %3 = lshr <2 x i16> %a, %2
+  ret <2 x i16> %3
+}
+
+define <2 x i16> @swap16(<2 x i16> %a) nounwind {
+; RV32-LABEL: swap16:
+; RV32: pkbt16 a0, a0, a0
+; RV32-NEXT: jalr zero, ra, 0
+  %1 = shufflevector <2 x i16> %a, <2 x i16> undef, <2 x i32> <i32 1, i32 0>
+  ret <2 x i16> %1
+}
+
+define <2 x i16> @build16(i16 %a, i16 %b) nounwind {
+; RV32-LABEL: build16:
+; RV32: pkbb16 a0, a1, a0
+; RV32-NEXT: jalr zero, ra, 0
+  %1 = insertelement <2 x i16> undef, i16 %a, i32 0
+  %2 = insertelement <2 x i16> %1, i16 %b, i32 1
+  ret <2 x i16> %2
+}
+
+define <4 x i8> @and8(<4 x i8> %a, <4 x i8> %b) nounwind {
+; RV32-LABEL: and8:
+; RV32: and a0, a0, a1
+; RV32-NEXT: jalr zero, ra, 0
+  %1 = and <4 x i8> %a, %b
+  ret <4 x i8> %1
+}
+
+define void @load_store8(<4 x i8>* %p, <4 x i8>* %q) nounwind {
+; RV32-LABEL: load_store8:
+; RV32-DAG: lw [[A:[a-z0-9]+]], 0(a0)
+; RV32-DAG: lw [[B:[a-z0-9]+]], 0(a1)
+; RV32: add8 [[C:[a-z0-9]+]], [[A]], [[B]]
+; RV32: sw [[C]], 0(a0)
+  %a = load <4 x i8>, <4 x i8>* %p
+  %b = load <4 x i8>, <4 x i8>* %q
+  %c = add <4 x i8> %a, %b
+  store <4 x i8> %c, <4 x i8>* %p
+  ret void
+}
+
+define i32 @extract16(<2 x i16> %a) nounwind {
+; RV32-LABEL: extract16:
+; RV32: srli a0, a0, 16
+; RV32-NEXT: jalr zero, ra, 0
+  %1 = extractelement <2 x i16> %a, i32 1
+  %2 = zext i16 %1 to i32
+  ret i32 %2
+}
+
+; Vectors are passed like integers of the same size with or without P: the
+; <4 x i8> takes a0, and the <4 x i16> takes a0-a1 on RV32 and a0 on RV64.
+declare <4 x i8> @ext_v4i8(<4 x i8>, i32)
+
+define <4 x i8> @call_v4i8(<4 x i8> %a) nounwind {
+; ABI-LABEL: call_v4i8:
+; ABI: addi a1, zero, 1
+; ABI: call ext_v4i8
+  %1 = call <4 x i8> @ext_v4i8(<4 x i8> %a, i32 1)
+  ret <4 x i8> %1
+}
+
+declare <4 x i16> @ext_v4i16(<4 x i16>, i32)
+
+define <4 x i16> @call_v4i16(<4 x i16> %a) nounwind {
+; ABI-LABEL: call_v4i16:
+; ABI32: addi a2, zero, 1
+; ABI64: addi a1, zero, 1
+; ABI-NEXT: call ext_v4i16
+  %1 = call <4 x i16> @ext_v4i16(<4 x i16> %a, i32 1)
+  ret <4 x i16> %1
+}
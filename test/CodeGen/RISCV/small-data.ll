@@ -0,0 +1,83 @@
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=riscv64 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV64 %s
+; RUN: llc -mtriple=riscv32 -riscv-ssection-threshold=0 \
+; RUN:   -verify-machineinstrs < %s | FileCheck -check-prefix=NOSDATA %s
+; RUN: llc -mtriple=riscv32 -relocation-model=pic -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=PIC %s
+
+@s = global i32 0
+@d = global i32 1
+@pair = internal global [2 x i32] [i32 1, i32 2]
+@big = global [4 x i32] zeroinitializer
+@ext = external global i32
+@wk = weak global i32 0
+@sec = global i32 0, section ".mysec"
+
+define i32 @load_small() nounwind {
+; CHECK-LABEL: load_small:
+; CHECK: lw a0, %gp_rel(s)(gp)
+; CHECK-NEXT: jalr zero, ra, 0
+; RV64-LABEL: load_small:
+; RV64: lw a0, %gp_rel(s)(gp)
+; NOSDATA-LABEL: load_small:
+; NOSDATA: lui [[R:[a-z0-9]+]], %hi(s)
+; PIC-LABEL: load_small:
+; PIC: auipc {{[a-z0-9]+}}, %got_pcrel_hi(s)
+  %1 = load i32, i32* @s
+  ret i32 %1
+}
+
+define void @store_small(i32 %a) nounwind {
+; CHECK-LABEL: store_small:
+; CHECK: sw a0, %gp_rel(d)(gp)
+; RV64-LABEL: store_small:
+; RV64: sw a0, %gp_rel(d)(gp)
+  store i32 %a, i32* @d
+  ret void
+}
+
+; An offset inside the object is folded into the relocation.
+define i32 @load_small_offset() nounwind {
+; CHECK-LABEL: load_small_offset:
+; CHECK: lw a0, %gp_rel(pair+4)(gp)
+  %1 = load i32, i32* getelementptr ([2 x i32], [2 x i32]* @pair, i32 0, i32 1)
+  ret i32 %1
+}
+
+define i32* @addr_small() nounwind {
+; CHECK-LABEL: addr_small:
+; CHECK: addi a0, gp, %gp_rel(s)
+  ret i32* @s
+}
+
+; Globals above the threshold, declarations, globals that may be replaced at
+; link time and globals with an explicit section are addressed as usual.
+define i32 @load_not_small() nounwind {
+; CHECK-LABEL: load_not_small:
+; CHECK-NOT: gp_rel
+; CHECK-DAG: %hi(big)
+; CHECK-DAG: %hi(ext)
+; CHECK-DAG: %hi(wk)
+; CHECK-DAG: %hi(sec)
+; CHECK-NOT: gp_rel
+  %1 = load i32, i32* getelementptr ([4 x i32], [4 x i32]* @big, i32 0, i32 1)
+  %2 = load i32, i32* @ext
+  %3 = load i32, i32* @wk
+  %4 = load i32, i32* @sec
+  %5 = add i32 %1, %2
+  %6 = add i32 %3, %4
+  %7 = add i32 %5, %6
+  ret i32 %7
+}
+
+; CHECK: .section .sbss
+; CHECK: s:
+; CHECK: .section .sdata
+; CHECK: d:
+; CHECK: pair:
+; CHECK-NOT: .section .s{{data|bss}}
+; NOSDATA-NOT: .sdata
+; NOSDATA-NOT: .sbss
+; PIC-NOT: .sdata
+; PIC-NOT: .sbss
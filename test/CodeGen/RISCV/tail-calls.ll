@@ -0,0 +1,159 @@
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs -tailcallopt < %s \
+; RUN:   | FileCheck -check-prefix=GUARANTEED %s
+; RUN: llc -mtriple=riscv64 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=RV64 %s
+
+declare i32 @callee(i32, i32)
+
+; A call in tail position becomes a jump that reuses the caller's return
+; address.
+define i32 @sibcall(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: sibcall:
+; CHECK-NOT: ra
+; CHECK: tail callee
+; RV64-LABEL: sibcall:
+; RV64: tail callee
+  %1 = tail call i32 @callee(i32 %b, i32 %a)
+  ret i32 %1
+}
+
+define void @sibcall_indirect(void (i32)* %f, i32 %a) nounwind {
+; CHECK-LABEL: sibcall_indirect:
+; CHECK: addi [[R:t[0-6]]], a0, 0
+; CHECK: addi a0, a1, 0
+; CHECK: jalr zero, [[R]], 0
+  tail call void %f(i32 %a)
+  ret void
+}
+
+; The frame is torn down before the jump.
+declare void @use(i32*)
+declare void @callee_void()
+
+define void @sibcall_with_frame() nounwind {
+; CHECK-LABEL: sibcall_with_frame:
+; CHECK: call use
+; CHECK: lw ra,
+; CHECK: addi sp, sp,
+; CHECK: tail callee_void
+  %1 = alloca i32
+  call void @use(i32* %1)
+  tail call void @callee_void()
+  ret void
+}
+
+; Calls not marked tail, or whose result is used, stay calls.
+define i32 @not_tail(i32 %a) nounwind {
+; CHECK-LABEL: not_tail:
+; CHECK: call callee
+; CHECK: addi a0, a0, 1
+  %1 = tail call i32 @callee(i32 %a, i32 %a)
+  %2 = add i32 %1, 1
+  ret i32 %2
+}
+
+; The callee needs stack arguments the caller doesn't have.
+declare i32 @callee_many(i32, i32, i32, i32, i32, i32, i32, i32, i32)
+
+define i32 @stack_args(i32 %a) nounwind {
+; CHECK-LABEL: stack_args:
+; CHECK: call callee_many
+  %1 = tail call i32 @callee_many(i32 %a, i32 %a, i32 %a, i32 %a, i32 %a,
+                                  i32 %a, i32 %a, i32 %a, i32 %a)
+  ret i32 %1
+}
+
+; Forwarding the caller's own stack argument in the same slot is fine.
+define i32 @stack_args_forwarded(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e,
+                                 i32 %f, i32 %g, i32 %h, i32 %i) nounwind {
+; CHECK-LABEL: stack_args_forwarded:
+; CHECK-NOT: sw
+; CHECK: tail callee_many
+  %1 = tail call i32 @callee_many(i32 %h, i32 %g, i32 %f, i32 %e, i32 %d,
+                                  i32 %c, i32 %b, i32 %a, i32 %i)
+  ret i32 %1
+}
+
+; Byval arguments live in the caller's frame.
+%struct.S = type { i32, i32, i32, i32, i32, i32, i32, i32, i32, i32 }
+declare void @callee_byval(%struct.S* byval)
+
+define void @byval(%struct.S* %s) nounwind {
+; CHECK-LABEL: byval:
+; CHECK: call callee_byval
+  tail call void @callee_byval(%struct.S* byval %s)
+  ret void
+}
+
+; With -tailcallopt, fastcc callees may overwrite the incoming argument area.
+; fastcc passes the first 14 arguments in registers.
+declare fastcc i32 @fast_callee(i32, i32, i32, i32, i32, i32, i32, i32, i32,
+                                i32, i32, i32, i32, i32, i32, i32)
+
+define fastcc i32 @guaranteed(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e,
+                              i32 %f, i32 %g, i32 %h, i32 %i, i32 %j,
+                              i32 %k, i32 %l, i32 %m, i32 %n, i32 %o,
+                              i32 %p) nounwind {
+; CHECK-LABEL: guaranteed:
+; CHECK: call fast_callee
+; GUARANTEED-LABEL: guaranteed:
+; GUARANTEED: sw {{[a-z0-9]+}}, 4(sp)
+; GUARANTEED: tail fast_callee
+  %1 = add i32 %p, 1
+  %2 = tail call fastcc i32 @fast_callee(i32 %a, i32 %b, i32 %c, i32 %d,
+                                         i32 %e, i32 %f, i32 %g, i32 %h,
+                                         i32 %i, i32 %j, i32 %k, i32 %l,
+                                         i32 %m, i32 %n, i32 %o, i32 %1)
+  ret i32 %2
+}
+
+; t1 holds the callee's address in a direct tail call, so fastcc doesn't pass
+; arguments in it.
+declare fastcc i32 @fast_swap_callee(i32, i32)
+
+define fastcc i32 @fast_swap(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: fast_swap:
+; CHECK-NOT: t1
+; CHECK: addi [[R:[a-z0-9]+]], t0, 0
+; CHECK-NEXT: addi t0, t2, 0
+; CHECK-NEXT: addi t2, [[R]], 0
+; CHECK-NEXT: tail fast_swap_callee
+; RV64-LABEL: fast_swap:
+; RV64-NOT: t1
+; RV64: tail fast_swap_callee
+  %1 = tail call fastcc i32 @fast_swap_callee(i32 %b, i32 %a)
+  ret i32 %1
+}
+
+; The target of an indirect tail call stays clear of the argument registers,
+; even when fastcc uses all of them.
+define fastcc void @fast_indirect(void (i32, i32, i32, i32, i32, i32, i32, i32,
+                                        i32, i32, i32, i32, i32, i32)** %pf,
+                                  i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: fast_indirect:
+; CHECK: addi t6, zero, 12
+; CHECK-NEXT: addi t0, a0, 0
+; CHECK-NEXT: addi a0, t1, 0
+; CHECK-NEXT: lw t1, 12(sp)
+; CHECK-NEXT: addi sp, sp, 16
+; CHECK-NEXT: jalr zero, t1, 0
+; RV64-LABEL: fast_indirect:
+; RV64: ld t1, 8(sp)
+; RV64-NEXT: addi sp, sp, 16
+; RV64-NEXT: jalr zero, t1, 0
+  %f = load void (i32, i32, i32, i32, i32, i32, i32, i32, i32, i32, i32, i32,
+                  i32, i32)*,
+            void (i32, i32, i32, i32, i32, i32, i32, i32, i32, i32, i32, i32,
+                  i32, i32)** %pf
+  tail call fastcc void %f(i32 %b, i32 %a, i32 1, i32 2, i32 3, i32 4, i32 5,
+                           i32 6, i32 7, i32 8, i32 9, i32 10, i32 11, i32 12)
+  ret void
+}
+
+define i32 @musttail(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: musttail:
+; CHECK: tail callee
+  %1 = musttail call i32 @callee(i32 %a, i32 %b)
+  ret i32 %1
+}
@@ -0,0 +1,74 @@
+; RUN: llc -mtriple=riscv32 -relocation-model=pic -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=PIC %s
+; RUN: llc -mtriple=riscv64 -relocation-model=pic -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=PIC64 %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=NOPIC %s
+
+@unspecified = external thread_local global i32
+@ld = external thread_local(localdynamic) global i32
+@ie = external thread_local(initialexec) global i32
+@le = external thread_local(localexec) global i32
+
+define i32* @f1() nounwind {
+; PIC-LABEL: f1:
+; PIC: [[L:.Lpcrel_hi[0-9]+]]:
+; PIC-NEXT: auipc a0, %tls_gd_pcrel_hi(unspecified)
+; PIC-NEXT: addi a0, a0, %pcrel_lo([[L]])
+; PIC-NEXT: call __tls_get_addr@plt
+; PIC64-LABEL: f1:
+; PIC64: [[L:.Lpcrel_hi[0-9]+]]:
+; PIC64-NEXT: auipc a0, %tls_gd_pcrel_hi(unspecified)
+; PIC64-NEXT: addi a0, a0, %pcrel_lo([[L]])
+; PIC64-NEXT: call __tls_get_addr@plt
+; NOPIC-LABEL: f1:
+; NOPIC: [[L:.Lpcrel_hi[0-9]+]]:
+; NOPIC-NEXT: auipc [[R:[a-z0-9]+]], %tls_ie_pcrel_hi(unspecified)
+; NOPIC-NEXT: lw [[R]], %pcrel_lo([[L]])([[R]])
+; NOPIC-NEXT: add a0, [[R]], tp
+  ret i32* @unspecified
+}
+
+; Local-dynamic is handled like general-dynamic.
+define i32* @f2() nounwind {
+; PIC-LABEL: f2:
+; PIC: auipc a0, %tls_gd_pcrel_hi(ld)
+; PIC: call __tls_get_addr@plt
+  ret i32* @ld
+}
+
+define i32* @f3() nounwind {
+; PIC-LABEL: f3:
+; PIC: [[L:.Lpcrel_hi[0-9]+]]:
+; PIC-NEXT: auipc [[R:[a-z0-9]+]], %tls_ie_pcrel_hi(ie)
+; PIC-NEXT: lw [[R]], %pcrel_lo([[L]])([[R]])
+; PIC-NEXT: add a0, [[R]], tp
+; PIC64-LABEL: f3:
+; PIC64: [[L:.Lpcrel_hi[0-9]+]]:
+; PIC64-NEXT: auipc [[R:[a-z0-9]+]], %tls_ie_pcrel_hi(ie)
+; PIC64-NEXT: ld [[R]], %pcrel_lo([[L]])([[R]])
+; PIC64-NEXT: add a0, [[R]], tp
+  ret i32* @ie
+}
+
+define i32* @f4() nounwind {
+; PIC-LABEL: f4:
+; PIC: lui [[R:[a-z0-9]+]], %tprel_hi(le)
+; PIC-NEXT: add [[R]], [[R]], tp, %tprel_add(le)
+; PIC-NEXT: addi a0, [[R]], %tprel_lo(le)
+; NOPIC-LABEL: f4:
+; NOPIC: lui [[R:[a-z0-9]+]], %tprel_hi(le)
+; NOPIC-NEXT: add [[R]], [[R]], tp, %tprel_add(le)
+; NOPIC-NEXT: addi a0, [[R]], %tprel_lo(le)
+  ret i32* @le
+}
+
+; Offsets into a TLS variable are added after computing its address.
+define i32 @f5() nounwind {
+; NOPIC-LABEL: f5:
+; NOPIC: addi [[R:[a-z0-9]+]], {{[a-z0-9]+}}, %tprel_lo(le)
+; NOPIC: lw a0, 8([[R]])
+  %1 = getelementptr i32, i32* @le, i32 2
+  %2 = load i32, i32* %1
+  ret i32 %2
+}
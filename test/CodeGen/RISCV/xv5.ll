@@ -0,0 +1,108 @@
+; RUN: llc -mtriple=riscv32 -mattr=+xv5 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV32 %s
+; RUN: llc -mtriple=riscv64 -mattr=+xv5 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefixes=CHECK,RV64 %s
+; RUN: llc -mtriple=riscv32 -verify-machineinstrs < %s \
+; RUN:   | FileCheck -check-prefix=NOXV5 %s
+
+@s = global i32 0
+@h = global i16 0
+@b = global i8 0
+@pair = global [2 x i32] zeroinitializer
+
+declare void @f()
+
+define void @branch_const(i32 %a) nounwind {
+; CHECK-LABEL: branch_const:
+; CHECK: bnec a0, 42,
+; NOXV5-LABEL: branch_const:
+; NOXV5: addi [[R:[a-z0-9]+]], zero, 42
+; NOXV5: bne a0, [[R]],
+  %1 = icmp eq i32 %a, 42
+  br i1 %1, label %call, label %exit
+
+call:
+  call void @f()
+  br label %exit
+
+exit:
+  ret void
+}
+
+define void @branch_bit(i32 %a) nounwind {
+; CHECK-LABEL: branch_bit:
+; CHECK: bbc a0, 12,
+  %1 = and i32 %a, 4096
+  %2 = icmp ne i32 %1, 0
+  br i1 %2, label %call, label %exit
+
+call:
+  call void @f()
+  br label %exit
+
+exit:
+  ret void
+}
+
+define i32 @extract_zext(i32 %a) nounwind {
+; CHECK-LABEL: extract_zext:
+; CHECK: bfoz a0, a0, 19, 4
+; NOXV5-LABEL: extract_zext:
+; NOXV5: srli
+  %1 = lshr i32 %a, 4
+  %2 = and i32 %1, 65535
+  ret i32 %2
+}
+
+define i32 @extract_sext(i32 %a) nounwind {
+; CHECK-LABEL: extract_sext:
+; CHECK: bfos a0, a0, 15, 0
+  %1 = shl i32 %a, 16
+  %2 = ashr i32 %1, 16
+  ret i32 %2
+}
+
+define i32* @lea_w(i32* %p, i32 %i) nounwind {
+; RV32-LABEL: lea_w:
+; RV32: lea.w a0, a0, a1
+  %1 = getelementptr i32, i32* %p, i32 %i
+  ret i32* %1
+}
+
+define i64* @lea_d(i64* %p, i64 %i) nounwind {
+; RV64-LABEL: lea_d:
+; RV64: lea.d a0, a0, a1
+  %1 = getelementptr i64, i64* %p, i64 %i
+  ret i64* %1
+}
+
+define i32 @load_gp() nounwind {
+; CHECK-LABEL: load_gp:
+; CHECK: lwgp a0, %gp_rel(s)
+; NOXV5-LABEL: load_gp:
+; NOXV5: lw a0, %gp_rel(s)(gp)
+  %1 = load i32, i32* @s
+  ret i32 %1
+}
+
+define i32 @load_gp_offset() nounwind {
+; CHECK-LABEL: load_gp_offset:
+; CHECK: lwgp a0, %gp_rel(pair+4)
+  %1 = load i32, i32* getelementptr ([2 x i32], [2 x i32]* @pair, i32 0, i32 1)
+  ret i32 %1
+}
+
+define void @store_gp(i16 %a, i8 %c) nounwind {
+; CHECK-LABEL: store_gp:
+; CHECK-DAG: shgp a0, %gp_rel(h)
+; CHECK-DAG: sbgp a1, %gp_rel(b)
+  store i16 %a, i16* @h
+  store i8 %c, i8* @b
+  ret void
+}
+
+define i32* @addr_gp() nounwind {
+; CHECK-LABEL: addr_gp:
+; CHECK: addigp a0, %gp_rel(s)
+  ret i32* @s
+}
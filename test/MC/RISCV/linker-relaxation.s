@@ -0,0 +1,72 @@
+# RUN: llvm-mc -triple riscv32 -mattr=+relax < %s -show-encoding \
+# RUN:     | FileCheck -check-prefix=INSTR -check-prefix=FIXUP %s
+# RUN: llvm-mc -filetype=obj -triple riscv32 -mattr=+relax < %s \
+# RUN:     | llvm-readobj -r | FileCheck -check-prefix=RELAX-RELOC %s
+# RUN: llvm-mc -filetype=obj -triple riscv32 -mattr=-relax < %s \
+# RUN:     | llvm-readobj -r | FileCheck -check-prefix=NORELAX-RELOC %s
+# RUN: llvm-mc -filetype=obj -triple riscv32 -mattr=+relax,+c < %s \
+# RUN:     | llvm-readobj -r | FileCheck -check-prefix=RELAX-RVC-RELOC %s
+
+# Check prefixes:
+# RELAX-RELOC - Relocations in the object when linker relaxation is enabled.
+# NORELAX-RELOC - Relocations in the object without linker relaxation.
+# RELAX-RVC-RELOC - Relocations with linker relaxation and compressed nops.
+# FIXUP - Check the fixups on the instruction.
+# INSTR - Check the instruction is handled properly by the ASMPrinter
+
+.text
+call foo
+# INSTR: call foo
+# FIXUP: fixup A - offset: 0, value: foo, kind: fixup_riscv_call
+# FIXUP: fixup B - offset: 0, value: 0, kind: fixup_riscv_relax
+# RELAX-RELOC: R_RISCV_CALL foo 0x0
+# RELAX-RELOC-NEXT: R_RISCV_RELAX - 0x0
+# NORELAX-RELOC: R_RISCV_CALL foo 0x0
+# NORELAX-RELOC-NOT: R_RISCV_RELAX
+
+call foo@plt
+# INSTR: call foo@plt
+# FIXUP: fixup A - offset: 0, value: foo@plt, kind: fixup_riscv_call_plt
+# RELAX-RELOC: R_RISCV_CALL_PLT foo 0x0
+# RELAX-RELOC-NEXT: R_RISCV_RELAX - 0x0
+# NORELAX-RELOC: R_RISCV_CALL_PLT foo 0x0
+
+tail foo
+# INSTR: tail foo
+# FIXUP: fixup A - offset: 0, value: foo, kind: fixup_riscv_call
+# RELAX-RELOC: R_RISCV_CALL foo 0x0
+# RELAX-RELOC-NEXT: R_RISCV_RELAX - 0x0
+# NORELAX-RELOC: R_RISCV_CALL foo 0x0
+
+lui t1, %hi(foo)
+# FIXUP: fixup A - offset: 0, value: %hi(foo), kind: fixup_riscv_hi20
+# FIXUP: fixup B - offset: 0, value: 0, kind: fixup_riscv_relax
+# RELAX-RELOC: R_RISCV_HI20 foo 0x0
+# RELAX-RELOC-NEXT: R_RISCV_RELAX - 0x0
+# NORELAX-RELOC: R_RISCV_HI20 foo 0x0
+
+addi t1, t1, %lo(foo)
+# FIXUP: fixup A - offset: 0, value: %lo(foo), kind: fixup_riscv_lo12_i
+# FIXUP: fixup B - offset: 0, value: 0, kind: fixup_riscv_relax
+# RELAX-RELOC: R_RISCV_LO12_I foo 0x0
+# RELAX-RELOC-NEXT: R_RISCV_RELAX - 0x0
+# NORELAX-RELOC: R_RISCV_LO12_I foo 0x0
+
+# The linker may delete bytes before an alignment point, so it is told where
+# the padding is and how much of it there is.
+.p2align 4
+# RELAX-RELOC: R_RISCV_ALIGN - 0xC
+# RELAX-RVC-RELOC: R_RISCV_ALIGN - 0xE
+# NORELAX-RELOC-NOT: R_RISCV_ALIGN
+a:
+nop
+b:
+
+.data
+# Differences between labels in the relaxed section are resolved by the
+# linker.
+.long b - a
+# RELAX-RELOC: R_RISCV_ADD32 b 0x0
+# RELAX-RELOC-NEXT: R_RISCV_SUB32 a 0x0
+# NORELAX-RELOC-NOT: R_RISCV_ADD32
+# NORELAX-RELOC-NOT: R_RISCV_SUB32
@@ -29,11 +29,48 @@ sb t1, %lo(foo)(a2)
 # INSTR: sb t1, %lo(foo)(a2)
 # FIXUP: fixup A - offset: 0, value: %lo(foo), kind: fixup_riscv_lo12_s
 
+.L0:
 auipc t1, %pcrel_hi(foo)
-# RELOC: R_RISCV_PCREL_HI20
+# RELOC: R_RISCV_PCREL_HI20 foo 0x0
 # INSTR: auipc t1, %pcrel_hi(foo)
 # FIXUP: fixup A - offset: 0, value: %pcrel_hi(foo), kind: fixup_riscv_pcrel_hi20
 
+addi t1, t1, %pcrel_lo(.L0)
+# RELOC: R_RISCV_PCREL_LO12_I .L0 0x0
+# INSTR: addi t1, t1, %pcrel_lo(.L0)
+# FIXUP: fixup A - offset: 0, value: %pcrel_lo(.L0), kind: fixup_riscv_pcrel_lo12_i
+
+sb t1, %pcrel_lo(.L0)(a2)
+# RELOC: R_RISCV_PCREL_LO12_S .L0 0x0
+# INSTR: sb t1, %pcrel_lo(.L0)(a2)
+# FIXUP: fixup A - offset: 0, value: %pcrel_lo(.L0), kind: fixup_riscv_pcrel_lo12_s
+
+.L1:
+auipc t1, %got_pcrel_hi(foo)
+# RELOC: R_RISCV_GOT_HI20 foo 0x0
+# INSTR: auipc t1, %got_pcrel_hi(foo)
+# FIXUP: fixup A - offset: 0, value: %got_pcrel_hi(foo), kind: fixup_riscv_got_hi20
+
+lw t1, %pcrel_lo(.L1)(t1)
+# RELOC: R_RISCV_PCREL_LO12_I .L1 0x0
+# INSTR: lw t1, %pcrel_lo(.L1)(t1)
+# FIXUP: fixup A - offset: 0, value: %pcrel_lo(.L1), kind: fixup_riscv_pcrel_lo12_i
+
+addi t1, gp, %gp_rel(foo)
+# RELOC: R_RISCV_GPREL_I foo 0x0
+# INSTR: addi t1, gp, %gp_rel(foo)
+# FIXUP: fixup A - offset: 0, value: %gp_rel(foo), kind: fixup_riscv_gprel_i
+
+lw t1, %gp_rel(foo+4)(gp)
+# RELOC: R_RISCV_GPREL_I foo 0x4
+# INSTR: lw t1, %gp_rel(foo+4)(gp)
+# FIXUP: fixup A - offset: 0, value: %gp_rel(foo+4), kind: fixup_riscv_gprel_i
+
+sw t1, %gp_rel(foo)(gp)
+# RELOC: R_RISCV_GPREL_S foo 0x0
+# INSTR: sw t1, %gp_rel(foo)(gp)
+# FIXUP: fixup A - offset: 0, value: %gp_rel(foo), kind: fixup_riscv_gprel_s
+
 jal zero, foo
 # RELOC: R_RISCV_JAL
 # INSTR: jal zero, foo
@@ -0,0 +1,134 @@
+# RUN: llvm-mc %s -triple=riscv32 -mattr=+d -show-encoding \
+# RUN:     | FileCheck -check-prefixes=CHECK,CHECK-INST %s
+# RUN: llvm-mc -filetype=obj -triple riscv32 -mattr=+d < %s \
+# RUN:     | llvm-objdump -mattr=+d -d - | FileCheck -check-prefix=CHECK-INST %s
+
+# CHECK-INST: fld ft0, 12(a0)
+# CHECK: encoding: [0x07,0x30,0xc5,0x00]
+fld ft0, 12(a0)
+
+# CHECK-INST: fsd fs11, -8(sp)
+# CHECK: encoding: [0x27,0x3c,0xb1,0xff]
+fsd fs11, -8(sp)
+
+# CHECK-INST: fmadd.d fa0, fa1, fa2, fa3
+# CHECK: encoding: [0x43,0xf5,0xc5,0x6a]
+fmadd.d fa0, fa1, fa2, fa3
+
+# CHECK-INST: fmsub.d fa0, fa1, fa2, fa3
+# CHECK: encoding: [0x47,0xf5,0xc5,0x6a]
+fmsub.d fa0, fa1, fa2, fa3
+
+# CHECK-INST: fnmsub.d fa0, fa1, fa2, fa3
+# CHECK: encoding: [0x4b,0xf5,0xc5,0x6a]
+fnmsub.d fa0, fa1, fa2, fa3
+
+# CHECK-INST: fnmadd.d fa0, fa1, fa2, fa3
+# CHECK: encoding: [0x4f,0xf5,0xc5,0x6a]
+fnmadd.d fa0, fa1, fa2, fa3
+
+# CHECK-INST: fadd.d ft0, ft1, ft2
+# CHECK: encoding: [0x53,0xf0,0x20,0x02]
+fadd.d ft0, ft1, ft2
+
+# CHECK-INST: fsub.d ft0, ft1, ft2
+# CHECK: encoding: [0x53,0xf0,0x20,0x0a]
+fsub.d ft0, ft1, ft2
+
+# CHECK-INST: fmul.d ft0, ft1, ft2
+# CHECK: encoding: [0x53,0xf0,0x20,0x12]
+fmul.d ft0, ft1, ft2
+
+# CHECK-INST: fdiv.d ft0, ft1, ft2
+# CHECK: encoding: [0x53,0xf0,0x20,0x1a]
+fdiv.d ft0, ft1, ft2
+
+# CHECK-INST: fsqrt.d fs2, fs3
+# CHECK: encoding: [0x53,0xf9,0x09,0x5a]
+fsqrt.d fs2, fs3
+
+# CHECK-INST: fsgnj.d ft8, ft9, ft10
+# CHECK: encoding: [0x53,0x8e,0xee,0x23]
+fsgnj.d ft8, ft9, ft10
+
+# CHECK-INST: fsgnjn.d ft8, ft9, ft10
+# CHECK: encoding: [0x53,0x9e,0xee,0x23]
+fsgnjn.d ft8, ft9, ft10
+
+# CHECK-INST: fsgnjx.d ft8, ft9, ft10
+# CHECK: encoding: [0x53,0xae,0xee,0x23]
+fsgnjx.d ft8, ft9, ft10
+
+# CHECK-INST: fmin.d fs10, fs11, ft11
+# CHECK: encoding: [0x53,0x8d,0xfd,0x2b]
+fmin.d fs10, fs11, ft11
+
+# CHECK-INST: fmax.d fs10, fs11, ft11
+# CHECK: encoding: [0x53,0x9d,0xfd,0x2b]
+fmax.d fs10, fs11, ft11
+
+# CHECK-INST: fcvt.s.d fa0, fa1
+# CHECK: encoding: [0x53,0xf5,0x15,0x40]
+fcvt.s.d fa0, fa1
+
+# CHECK-INST: fcvt.d.s fa0, fa1
+# CHECK: encoding: [0x53,0x85,0x05,0x42]
+fcvt.d.s fa0, fa1
+
+# CHECK-INST: feq.d a0, fa0, fa1
+# CHECK: encoding: [0x53,0x25,0xb5,0xa2]
+feq.d a0, fa0, fa1
+
+# CHECK-INST: flt.d a0, fa0, fa1
+# CHECK: encoding: [0x53,0x15,0xb5,0xa2]
+flt.d a0, fa0, fa1
+
+# CHECK-INST: fle.d a0, fa0, fa1
+# CHECK: encoding: [0x53,0x05,0xb5,0xa2]
+fle.d a0, fa0, fa1
+
+# CHECK-INST: fclass.d a2, ft3
+# CHECK: encoding: [0x53,0x96,0x01,0xe2]
+fclass.d a2, ft3
+
+# CHECK-INST: fcvt.w.d a0, ft0, rtz
+# CHECK: encoding: [0x53,0x15,0x00,0xc2]
+fcvt.w.d a0, ft0, rtz
+
+# CHECK-INST: fcvt.wu.d a1, ft1, rtz
+# CHECK: encoding: [0xd3,0x95,0x10,0xc2]
+fcvt.wu.d a1, ft1, rtz
+
+# CHECK-INST: fcvt.d.w ft0, a0
+# CHECK: encoding: [0x53,0x00,0x05,0xd2]
+fcvt.d.w ft0, a0
+
+# CHECK-INST: fcvt.d.wu ft0, a0
+# CHECK: encoding: [0x53,0x00,0x15,0xd2]
+fcvt.d.wu ft0, a0
+
+# CHECK-INST: fsgnj.d ft0, ft1, ft1
+# CHECK: encoding: [0x53,0x80,0x10,0x22]
+fmv.d ft0, ft1
+
+# CHECK-INST: fsgnjx.d ft0, ft1, ft1
+# CHECK: encoding: [0x53,0xa0,0x10,0x22]
+fabs.d ft0, ft1
+
+# CHECK-INST: fsgnjn.d ft0, ft1, ft1
+# CHECK: encoding: [0x53,0x90,0x10,0x22]
+fneg.d ft0, ft1
+
+# Rounding modes. The dynamic rounding mode is the default and isn't printed.
+
+# CHECK-INST: fcvt.w.d a0, fa0
+# CHECK: encoding: [0x53,0x75,0x05,0xc2]
+fcvt.w.d a0, fa0
+
+# CHECK-INST: fcvt.s.d fa0, fa1, rtz
+# CHECK: encoding: [0x53,0x95,0x15,0x40]
+fcvt.s.d fa0, fa1, rtz
+
+# CHECK-INST: fmul.d ft0, ft1, ft2, rne
+# CHECK: encoding: [0x53,0x80,0x20,0x12]
+fmul.d ft0, ft1, ft2, rne
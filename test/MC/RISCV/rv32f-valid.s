@@ -0,0 +1,162 @@
+# RUN: llvm-mc %s -triple=riscv32 -mattr=+f -show-encoding \
+# RUN:     | FileCheck -check-prefixes=CHECK,CHECK-INST %s
+# RUN: llvm-mc -filetype=obj -triple riscv32 -mattr=+f < %s \
+# RUN:     | llvm-objdump -mattr=+f -d - | FileCheck -check-prefix=CHECK-INST %s
+
+# CHECK-INST: flw ft0, 12(a0)
+# CHECK: encoding: [0x07,0x20,0xc5,0x00]
+flw ft0, 12(a0)
+
+# CHECK-INST: flw fs1, -2048(sp)
+# CHECK: encoding: [0x87,0x24,0x01,0x80]
+flw fs1, -2048(sp)
+
+# CHECK-INST: fsw ft1, 0(s0)
+# CHECK: encoding: [0x27,0x20,0x14,0x00]
+fsw ft1, 0(s0)
+
+# CHECK-INST: fsw fa7, 2047(a5)
+# CHECK: encoding: [0xa7,0xaf,0x17,0x7f]
+fsw fa7, 2047(a5)
+
+# CHECK-INST: fmadd.s fa0, fa1, fa2, fa3
+# CHECK: encoding: [0x43,0xf5,0xc5,0x68]
+fmadd.s fa0, fa1, fa2, fa3
+
+# CHECK-INST: fmsub.s fa0, fa1, fa2, fa3
+# CHECK: encoding: [0x47,0xf5,0xc5,0x68]
+fmsub.s fa0, fa1, fa2, fa3
+
+# CHECK-INST: fnmsub.s fa0, fa1, fa2, fa3
+# CHECK: encoding: [0x4b,0xf5,0xc5,0x68]
+fnmsub.s fa0, fa1, fa2, fa3
+
+# CHECK-INST: fnmadd.s fa0, fa1, fa2, fa3
+# CHECK: encoding: [0x4f,0xf5,0xc5,0x68]
+fnmadd.s fa0, fa1, fa2, fa3
+
+# CHECK-INST: fadd.s ft0, ft1, ft2
+# CHECK: encoding: [0x53,0xf0,0x20,0x00]
+fadd.s ft0, ft1, ft2
+
+# CHECK-INST: fsub.s ft0, ft1, ft2
+# CHECK: encoding: [0x53,0xf0,0x20,0x08]
+fsub.s ft0, ft1, ft2
+
+# CHECK-INST: fmul.s ft0, ft1, ft2
+# CHECK: encoding: [0x53,0xf0,0x20,0x10]
+fmul.s ft0, ft1, ft2
+
+# CHECK-INST: fdiv.s ft0, ft1, ft2
+# CHECK: encoding: [0x53,0xf0,0x20,0x18]
+fdiv.s ft0, ft1, ft2
+
+# CHECK-INST: fsqrt.s fs2, fs3
+# CHECK: encoding: [0x53,0xf9,0x09,0x58]
+fsqrt.s fs2, fs3
+
+# CHECK-INST: fsgnj.s ft8, ft9, ft10
+# CHECK: encoding: [0x53,0x8e,0xee,0x21]
+fsgnj.s ft8, ft9, ft10
+
+# CHECK-INST: fsgnjn.s ft8, ft9, ft10
+# CHECK: encoding: [0x53,0x9e,0xee,0x21]
+fsgnjn.s ft8, ft9, ft10
+
+# CHECK-INST: fsgnjx.s ft8, ft9, ft10
+# CHECK: encoding: [0x53,0xae,0xee,0x21]
+fsgnjx.s ft8, ft9, ft10
+
+# CHECK-INST: fmin.s fs10, fs11, ft11
+# CHECK: encoding: [0x53,0x8d,0xfd,0x29]
+fmin.s fs10, fs11, ft11
+
+# CHECK-INST: fmax.s fs10, fs11, ft11
+# CHECK: encoding: [0x53,0x9d,0xfd,0x29]
+fmax.s fs10, fs11, ft11
+
+# CHECK-INST: fcvt.w.s a0, ft0, rtz
+# CHECK: encoding: [0x53,0x15,0x00,0xc0]
+fcvt.w.s a0, ft0, rtz
+
+# CHECK-INST: fcvt.wu.s a1, ft1, rtz
+# CHECK: encoding: [0xd3,0x95,0x10,0xc0]
+fcvt.wu.s a1, ft1, rtz
+
+# CHECK-INST: fmv.x.w t0, fa0
+# CHECK: encoding: [0xd3,0x02,0x05,0xe0]
+fmv.x.w t0, fa0
+
+# CHECK-INST: feq.s a0, fa0, fa1
+# CHECK: encoding: [0x53,0x25,0xb5,0xa0]
+feq.s a0, fa0, fa1
+
+# CHECK-INST: flt.s a0, fa0, fa1
+# CHECK: encoding: [0x53,0x15,0xb5,0xa0]
+flt.s a0, fa0, fa1
+
+# CHECK-INST: fle.s a0, fa0, fa1
+# CHECK: encoding: [0x53,0x05,0xb5,0xa0]
+fle.s a0, fa0, fa1
+
+# CHECK-INST: fclass.s a2, ft3
+# CHECK: encoding: [0x53,0x96,0x01,0xe0]
+fclass.s a2, ft3
+
+# CHECK-INST: fcvt.s.w ft0, a0
+# CHECK: encoding: [0x53,0x70,0x05,0xd0]
+fcvt.s.w ft0, a0
+
+# CHECK-INST: fcvt.s.wu ft0, a0
+# CHECK: encoding: [0x53,0x70,0x15,0xd0]
+fcvt.s.wu ft0, a0
+
+# CHECK-INST: fmv.w.x fs0, s1
+# CHECK: encoding: [0x53,0x84,0x04,0xf0]
+fmv.w.x fs0, s1
+
+# CHECK-INST: fsgnj.s ft0, ft1, ft1
+# CHECK: encoding: [0x53,0x80,0x10,0x20]
+fmv.s ft0, ft1
+
+# CHECK-INST: fsgnjx.s ft0, ft1, ft1
+# CHECK: encoding: [0x53,0xa0,0x10,0x20]
+fabs.s ft0, ft1
+
+# CHECK-INST: fsgnjn.s ft0, ft1, ft1
+# CHECK: encoding: [0x53,0x90,0x10,0x20]
+fneg.s ft0, ft1
+
+# CHECK-INST: fadd.s fa0, fa1, fa2
+# CHECK: encoding: [0x53,0xf5,0xc5,0x00]
+fadd.s f10, f11, f12
+
+# Rounding modes. The dynamic rounding mode is the default and isn't printed.
+
+# CHECK-INST: fcvt.w.s a0, fa0
+# CHECK: encoding: [0x53,0x75,0x05,0xc0]
+fcvt.w.s a0, fa0
+
+# CHECK-INST: fcvt.w.s a0, fa0
+# CHECK: encoding: [0x53,0x75,0x05,0xc0]
+fcvt.w.s a0, fa0, dyn
+
+# CHECK-INST: fcvt.wu.s a0, fa0, rne
+# CHECK: encoding: [0x53,0x05,0x15,0xc0]
+fcvt.wu.s a0, fa0, rne
+
+# CHECK-INST: fadd.s ft0, ft1, ft2, rdn
+# CHECK: encoding: [0x53,0xa0,0x20,0x00]
+fadd.s ft0, ft1, ft2, rdn
+
+# CHECK-INST: fsqrt.s fs2, fs3, rup
+# CHECK: encoding: [0x53,0xb9,0x09,0x58]
+fsqrt.s fs2, fs3, rup
+
+# CHECK-INST: fmadd.s fa0, fa1, fa2, fa3, rmm
+# CHECK: encoding: [0x43,0xc5,0xc5,0x68]
+fmadd.s fa0, fa1, fa2, fa3, rmm
+
+# CHECK-INST: fcvt.s.w ft0, a0, rtz
+# CHECK: encoding: [0x53,0x10,0x05,0xd0]
+fcvt.s.w ft0, a0, rtz
@@ -0,0 +1,74 @@
+# RUN: llvm-mc %s -triple=riscv64 -mattr=+b -show-encoding \
+# RUN:     | FileCheck -check-prefixes=CHECK,CHECK-INST %s
+# RUN: llvm-mc -filetype=obj -triple riscv64 -mattr=+b < %s \
+# RUN:     | llvm-objdump -mattr=+b -d - | FileCheck -check-prefix=CHECK-INST %s
+
+# CHECK-INST: andn a0, a1, a2
+# CHECK: encoding: [0x33,0xf5,0xc5,0x40]
+andn a0, a1, a2
+# CHECK-INST: orn a0, a1, a2
+# CHECK: encoding: [0x33,0xe5,0xc5,0x40]
+orn a0, a1, a2
+# CHECK-INST: xnor a0, a1, a2
+# CHECK: encoding: [0x33,0xc5,0xc5,0x40]
+xnor a0, a1, a2
+# CHECK-INST: min t0, t1, t2
+# CHECK: encoding: [0xb3,0x42,0x73,0x0a]
+min t0, t1, t2
+# CHECK-INST: minu t0, t1, t2
+# CHECK: encoding: [0xb3,0x52,0x73,0x0a]
+minu t0, t1, t2
+# CHECK-INST: max s0, s1, a0
+# CHECK: encoding: [0x33,0xe4,0xa4,0x0a]
+max s0, s1, a0
+# CHECK-INST: maxu s0, s1, a0
+# CHECK: encoding: [0x33,0xf4,0xa4,0x0a]
+maxu s0, s1, a0
+# CHECK-INST: rol a0, a1, a2
+# CHECK: encoding: [0x33,0x95,0xc5,0x60]
+rol a0, a1, a2
+# CHECK-INST: ror a0, a1, a2
+# CHECK: encoding: [0x33,0xd5,0xc5,0x60]
+ror a0, a1, a2
+# CHECK-INST: rori a0, a1, 63
+# CHECK: encoding: [0x13,0xd5,0xf5,0x63]
+rori a0, a1, 63
+# CHECK-INST: clz a0, a1
+# CHECK: encoding: [0x13,0x95,0x05,0x60]
+clz a0, a1
+# CHECK-INST: ctz a0, a1
+# CHECK: encoding: [0x13,0x95,0x15,0x60]
+ctz a0, a1
+# CHECK-INST: cpop a0, a1
+# CHECK: encoding: [0x13,0x95,0x25,0x60]
+cpop a0, a1
+# CHECK-INST: sext.b a0, a1
+# CHECK: encoding: [0x13,0x95,0x45,0x60]
+sext.b a0, a1
+# CHECK-INST: sext.h a0, a1
+# CHECK: encoding: [0x13,0x95,0x55,0x60]
+sext.h a0, a1
+# CHECK-INST: zext.h a0, a1
+# CHECK: encoding: [0x3b,0xc5,0x05,0x08]
+zext.h a0, a1
+# CHECK-INST: rev8 a0, a1
+# CHECK: encoding: [0x13,0xd5,0x85,0x6b]
+rev8 a0, a1
+# CHECK-INST: rolw a0, a1, a2
+# CHECK: encoding: [0x3b,0x95,0xc5,0x60]
+rolw a0, a1, a2
+# CHECK-INST: rorw a0, a1, a2
+# CHECK: encoding: [0x3b,0xd5,0xc5,0x60]
+rorw a0, a1, a2
+# CHECK-INST: roriw a0, a1, 31
+# CHECK: encoding: [0x1b,0xd5,0xf5,0x61]
+roriw a0, a1, 31
+# CHECK-INST: clzw a0, a1
+# CHECK: encoding: [0x1b,0x95,0x05,0x60]
+clzw a0, a1
+# CHECK-INST: ctzw a0, a1
+# CHECK: encoding: [0x1b,0x95,0x15,0x60]
+ctzw a0, a1
+# CHECK-INST: cpopw a0, a1
+# CHECK: encoding: [0x1b,0x95,0x25,0x60]
+cpopw a0, a1
@@ -0,0 +1,72 @@
+# RUN: llvm-mc %s -triple=riscv64 -mattr=+d -show-encoding \
+# RUN:     | FileCheck -check-prefixes=CHECK,CHECK-INST %s
+# RUN: llvm-mc -filetype=obj -triple riscv64 -mattr=+d < %s \
+# RUN:     | llvm-objdump -mattr=+d -d - | FileCheck -check-prefix=CHECK-INST %s
+
+# CHECK-INST: fcvt.l.s a0, ft0, rtz
+# CHECK: encoding: [0x53,0x15,0x20,0xc0]
+fcvt.l.s a0, ft0, rtz
+
+# CHECK-INST: fcvt.lu.s a0, ft0, rtz
+# CHECK: encoding: [0x53,0x15,0x30,0xc0]
+fcvt.lu.s a0, ft0, rtz
+
+# CHECK-INST: fcvt.s.l ft0, a0
+# CHECK: encoding: [0x53,0x70,0x25,0xd0]
+fcvt.s.l ft0, a0
+
+# CHECK-INST: fcvt.s.lu ft0, a0
+# CHECK: encoding: [0x53,0x70,0x35,0xd0]
+fcvt.s.lu ft0, a0
+
+# CHECK-INST: fcvt.l.d a0, ft0, rtz
+# CHECK: encoding: [0x53,0x15,0x20,0xc2]
+fcvt.l.d a0, ft0, rtz
+
+# CHECK-INST: fcvt.lu.d a0, ft0, rtz
+# CHECK: encoding: [0x53,0x15,0x30,0xc2]
+fcvt.lu.d a0, ft0, rtz
+
+# CHECK-INST: fcvt.d.l ft0, a0
+# CHECK: encoding: [0x53,0x70,0x25,0xd2]
+fcvt.d.l ft0, a0
+
+# CHECK-INST: fcvt.d.lu ft0, a0
+# CHECK: encoding: [0x53,0x70,0x35,0xd2]
+fcvt.d.lu ft0, a0
+
+# CHECK-INST: fmv.x.d a0, fa0
+# CHECK: encoding: [0x53,0x05,0x05,0xe2]
+fmv.x.d a0, fa0
+
+# CHECK-INST: fmv.d.x fa0, a0
+# CHECK: encoding: [0x53,0x05,0x05,0xf2]
+fmv.d.x fa0, a0
+
+# CHECK-INST: flw ft0, 12(a0)
+# CHECK: encoding: [0x07,0x20,0xc5,0x00]
+flw ft0, 12(a0)
+
+# CHECK-INST: fsd fs11, -8(sp)
+# CHECK: encoding: [0x27,0x3c,0xb1,0xff]
+fsd fs11, -8(sp)
+
+# CHECK-INST: fcvt.w.s a0, ft0, rtz
+# CHECK: encoding: [0x53,0x15,0x00,0xc0]
+fcvt.w.s a0, ft0, rtz
+
+# CHECK-INST: fmv.x.w t0, fa0
+# CHECK: encoding: [0xd3,0x02,0x05,0xe0]
+fmv.x.w t0, fa0
+
+# CHECK-INST: fadd.d ft0, ft1, ft2
+# CHECK: encoding: [0x53,0xf0,0x20,0x02]
+fadd.d ft0, ft1, ft2
+
+# CHECK-INST: fcvt.l.s a0, fa0, rup
+# CHECK: encoding: [0x53,0x35,0x25,0xc0]
+fcvt.l.s a0, fa0, rup
+
+# CHECK-INST: fcvt.d.lu ft0, a0, rdn
+# CHECK: encoding: [0x53,0x20,0x35,0xd2]
+fcvt.d.lu ft0, a0, rdn
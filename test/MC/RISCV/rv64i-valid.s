@@ -207,6 +207,15 @@ ecall
 # CHECK-INST: ebreak
 # CHECK: encoding: [0x73,0x00,0x10,0x00]
 ebreak
+# CHECK-INST: uret
+# CHECK: encoding: [0x73,0x00,0x20,0x00]
+uret
+# CHECK-INST: sret
+# CHECK: encoding: [0x73,0x00,0x20,0x10]
+sret
+# CHECK-INST: mret
+# CHECK: encoding: [0x73,0x00,0x20,0x30]
+mret
 
 # CHECK-INST: csrrw t0, 4095, t1
 # CHECK: encoding: [0xf3,0x12,0xf3,0xff]
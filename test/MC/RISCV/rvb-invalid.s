@@ -0,0 +1,4 @@
+# RUN: not llvm-mc -triple riscv32 -mattr=+b < %s 2>&1 | FileCheck %s
+
+rori a0, a1, 32 # CHECK: :[[@LINE]]:14: error: immediate must be an integer in the range [0, 31]
+clzw a0, a1 # CHECK: :[[@LINE]]:1: error: instruction use requires an option to be enabled
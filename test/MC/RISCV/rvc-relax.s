@@ -0,0 +1,20 @@
+# RUN: llvm-mc -filetype=obj -triple riscv32 -mattr=+c < %s \
+# RUN:     | llvm-objdump -d - | FileCheck %s
+
+# Compressed branches and jumps whose target is out of range are relaxed to
+# their 32-bit forms.
+
+# CHECK: c.beqz a0, 4
+c.beqz a0, near
+# CHECK-NEXT: c.nop
+c.nop
+near:
+# CHECK: beq a0, zero, 3012
+c.beqz a0, far
+# CHECK-NEXT: bne a1, zero, 3008
+c.bnez a1, far
+# CHECK-NEXT: jal zero, 3004
+c.j far
+.space 3000
+far:
+c.nop
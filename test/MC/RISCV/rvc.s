@@ -20,7 +20,7 @@ c.sw    a5, 8(a3)
 # CHECK:   fixup A - offset: 0, value: .LBB0_3, kind: fixup_riscv_rvc_jump
 c.j     .LBB0_3
 # CHECK-INST: c.j     -16
-# CHECK: encoding: [0xe5,0xbf]
+# CHECK: encoding: [0xc5,0xbf]
 c.j     -16
 
 .LBB0_2:
@@ -30,17 +30,17 @@ c.jr    a7
 # CHECK-INST: c.jalr  a1
 # CHECK: encoding: [0x82,0x95]
 c.jalr  a1
-# CHECK: encoding: [0bAAAAAA01,0b110AAAAA]
+# CHECK: encoding: [0x81'A',0xc2'A']
 # CHECK:   fixup A - offset: 0, value: .LBB0_2, kind: fixup_riscv_rvc_branch
 c.beqz  a3, .LBB0_2
-# CHECK: encoding: [0bAAAAAA01,0b111AAAAA]
+# CHECK: encoding: [0x81'A',0xe3'A']
 # CHECK:   fixup A - offset: 0, value: .LBB0_2, kind: fixup_riscv_rvc_branch
 c.bnez  a5, .LBB0_2
 # CHECK-INST: c.beqz  a3, -8
-# CHECK: encoding: [0xf5,0xde]
+# CHECK: encoding: [0xe5,0xde]
 c.beqz  a3, -8
 # CHECK-INST: c.bnez  a5, -12
-# CHECK: encoding: [0xed,0xff]
+# CHECK: encoding: [0xf5,0xfb]
 c.bnez  a5, -12
 
 # CHECK-INST: c.li  a7, 31
@@ -92,7 +92,7 @@ c.ebreak
 # CHECK:   fixup A - offset: 0, value: func1, kind: fixup_riscv_rvc_jump
 c.jal   func1
 # CHECK-INST: c.jal   256
-# CHECK: encoding: [0x41,0x20]
+# CHECK: encoding: [0x01,0x22]
 c.jal   256
 # CHECK-INST: c.lui   s0, 30
 # CHECK: encoding: [0x79,0x64]
@@ -0,0 +1,7 @@
+# RUN: not llvm-mc -triple riscv32 -mattr=+d < %s 2>&1 | FileCheck %s
+
+# Rounding mode operands
+fcvt.w.s a0, fa0, foo # CHECK: :[[@LINE]]:19: error: operand must be a valid floating point rounding mode mnemonic
+fadd.d ft0, ft1, ft2, rtz, rtz # CHECK: :[[@LINE]]:28: error: invalid operand for instruction
+fcvt.d.s fa0, fa1, rtz # CHECK: :[[@LINE]]:20: error: invalid operand for instruction
+fsgnj.s ft0, ft1, ft2, rne # CHECK: :[[@LINE]]:24: error: invalid operand for instruction
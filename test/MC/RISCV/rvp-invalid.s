@@ -0,0 +1,4 @@
+# RUN: not llvm-mc -triple riscv32 -mattr=+p < %s 2>&1 | FileCheck %s
+
+srli8 a0, a1, 8 # CHECK: :[[@LINE]]:15: error: immediate must be an integer in the range [0, 7]
+slli16 a0, a1, 16 # CHECK: :[[@LINE]]:16: error: immediate must be an integer in the range [0, 15]
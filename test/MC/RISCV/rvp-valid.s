@@ -0,0 +1,68 @@
+# RUN: llvm-mc %s -triple=riscv32 -mattr=+p \
+# RUN:     | FileCheck -check-prefix=CHECK-INST %s
+# RUN: llvm-mc -filetype=obj -triple riscv32 -mattr=+p < %s \
+# RUN:     | llvm-objdump -mattr=+p -d - | FileCheck -check-prefix=CHECK-INST %s
+# RUN: llvm-mc %s -triple=riscv64 -mattr=+p \
+# RUN:     | FileCheck -check-prefix=CHECK-INST %s
+# RUN: llvm-mc -filetype=obj -triple riscv64 -mattr=+p < %s \
+# RUN:     | llvm-objdump -mattr=+p -d - | FileCheck -check-prefix=CHECK-INST %s
+# RUN: not llvm-mc -triple riscv32 < %s 2>&1 \
+# RUN:     | FileCheck -check-prefix=CHECK-NOEXT %s
+
+# CHECK-INST: add8 a0, a1, a2
+# CHECK-NOEXT: :[[@LINE+1]]:1: error: instruction use requires an option to be enabled
+add8 a0, a1, a2
+# CHECK-INST: add16 a0, a1, a2
+add16 a0, a1, a2
+# CHECK-INST: sub8 t0, t1, t2
+sub8 t0, t1, t2
+# CHECK-INST: sub16 s0, s1, a0
+sub16 s0, s1, a0
+
+# CHECK-INST: kadd8 a0, a1, a2
+kadd8 a0, a1, a2
+# CHECK-INST: ukadd16 a3, a4, a5
+ukadd16 a3, a4, a5
+# CHECK-INST: ksub16 a0, a1, a2
+ksub16 a0, a1, a2
+# CHECK-INST: uksub8 a3, a4, a5
+uksub8 a3, a4, a5
+
+# CHECK-INST: smin8 a0, a1, a2
+smin8 a0, a1, a2
+# CHECK-INST: umax16 a0, a1, a2
+umax16 a0, a1, a2
+
+# CHECK-INST: cmpeq8 a0, a1, a2
+cmpeq8 a0, a1, a2
+# CHECK-INST: scmplt16 a0, a1, a2
+scmplt16 a0, a1, a2
+# CHECK-INST: ucmple8 a0, a1, a2
+ucmple8 a0, a1, a2
+
+# CHECK-INST: sll8 a0, a1, a2
+sll8 a0, a1, a2
+# CHECK-INST: sra16 a0, a1, a2
+sra16 a0, a1, a2
+# CHECK-INST: srli8 a0, a1, 7
+srli8 a0, a1, 7
+# CHECK-INST: slli16 a0, a1, 15
+slli16 a0, a1, 15
+# CHECK-INST: srai16 a0, a1, 0
+srai16 a0, a1, 0
+
+# CHECK-INST: smaqa a0, a1, a2
+smaqa a0, a1, a2
+# CHECK-INST: umaqa a0, a1, a2
+umaqa a0, a1, a2
+# CHECK-INST: kmada a0, a1, a2
+kmada a0, a1, a2
+
+# CHECK-INST: pkbb16 a0, a1, a2
+pkbb16 a0, a1, a2
+# CHECK-INST: pkbt16 a0, a1, a2
+pkbt16 a0, a1, a2
+# CHECK-INST: pktb16 a0, a1, a2
+pktb16 a0, a1, a2
+# CHECK-INST: pktt16 a0, a1, a2
+pktt16 a0, a1, a2
@@ -0,0 +1,55 @@
+# RUN: llvm-mc -triple riscv32 < %s -show-encoding \
+# RUN:     | FileCheck -check-prefix=INSTR -check-prefix=FIXUP %s
+# RUN: llvm-mc -filetype=obj -triple riscv32 < %s \
+# RUN:     | llvm-readobj -r -t | FileCheck -check-prefix=RELOC %s
+
+# Check prefixes:
+# RELOC - Check the relocation in the object.
+# FIXUP - Check the fixup on the instruction.
+# INSTR - Check the instruction is handled properly by the ASMPrinter
+
+lui t1, %tprel_hi(foo)
+# RELOC: R_RISCV_TPREL_HI20 foo 0x0
+# INSTR: lui t1, %tprel_hi(foo)
+# FIXUP: fixup A - offset: 0, value: %tprel_hi(foo), kind: fixup_riscv_tprel_hi20
+
+add t1, t1, tp, %tprel_add(foo)
+# RELOC: R_RISCV_TPREL_ADD foo 0x0
+# INSTR: add t1, t1, tp, %tprel_add(foo)
+# FIXUP: fixup A - offset: 0, value: %tprel_add(foo), kind: fixup_riscv_tprel_add
+
+addi t1, t1, %tprel_lo(foo)
+# RELOC: R_RISCV_TPREL_LO12_I foo 0x0
+# INSTR: addi t1, t1, %tprel_lo(foo)
+# FIXUP: fixup A - offset: 0, value: %tprel_lo(foo), kind: fixup_riscv_tprel_lo12_i
+
+sw t1, %tprel_lo(foo)(t0)
+# RELOC: R_RISCV_TPREL_LO12_S foo 0x0
+# INSTR: sw t1, %tprel_lo(foo)(t0)
+# FIXUP: fixup A - offset: 0, value: %tprel_lo(foo), kind: fixup_riscv_tprel_lo12_s
+
+.L0:
+auipc t1, %tls_ie_pcrel_hi(bar)
+# RELOC: R_RISCV_TLS_GOT_HI20 bar 0x0
+# INSTR: auipc t1, %tls_ie_pcrel_hi(bar)
+# FIXUP: fixup A - offset: 0, value: %tls_ie_pcrel_hi(bar), kind: fixup_riscv_tls_got_hi20
+
+lw t1, %pcrel_lo(.L0)(t1)
+# RELOC: R_RISCV_PCREL_LO12_I .L0 0x0
+
+.L1:
+auipc a0, %tls_gd_pcrel_hi(baz)
+# RELOC: R_RISCV_TLS_GD_HI20 baz 0x0
+# INSTR: auipc a0, %tls_gd_pcrel_hi(baz)
+# FIXUP: fixup A - offset: 0, value: %tls_gd_pcrel_hi(baz), kind: fixup_riscv_tls_gd_hi20
+
+addi a0, a0, %pcrel_lo(.L1)
+# RELOC: R_RISCV_PCREL_LO12_I .L1 0x0
+
+# The referenced symbols become TLS symbols.
+# RELOC: Name: bar
+# RELOC: Type: TLS
+# RELOC: Name: baz
+# RELOC: Type: TLS
+# RELOC: Name: foo
+# RELOC: Type: TLS
@@ -0,0 +1,10 @@
+# RUN: not llvm-mc -triple riscv32 -mattr=+xv5 < %s 2>&1 | FileCheck %s
+
+beqc a0, 128, 16 # CHECK: :[[@LINE]]:10: error: immediate must be an integer in the range [0, 127]
+bnec a0, 1, 1024 # CHECK: :[[@LINE]]:13: error: immediate must be a multiple of 2 bytes in the range [-1024, 1022]
+bbc a0, 64, 16 # CHECK: :[[@LINE]]:9: error: immediate must be an integer in the range [0, 63]
+bbs a0, 1, 3 # CHECK: :[[@LINE]]:12: error: immediate must be a multiple of 2 bytes in the range [-1024, 1022]
+lbgp a0, 131072 # CHECK: :[[@LINE]]:10: error: operand must be a symbol or an integer in the range [-131072, 131071]
+lhgp a0, 3 # CHECK: :[[@LINE]]:10: error: operand must be a symbol or a multiple of 2 bytes in the range [-131072, 131070]
+lwgp a0, 2 # CHECK: :[[@LINE]]:10: error: operand must be a symbol or a multiple of 4 bytes in the range [-262144, 262140]
+lea.h a0, a1, 2 # CHECK: :[[@LINE]]:15: error: invalid operand for instruction
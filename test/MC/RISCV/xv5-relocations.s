@@ -0,0 +1,36 @@
+# RUN: llvm-mc -triple riscv32 -mattr=+xv5 < %s -show-encoding \
+# RUN:     | FileCheck -check-prefix=FIXUP %s
+# RUN: llvm-mc -filetype=obj -triple riscv32 -mattr=+xv5 < %s \
+# RUN:     | llvm-readobj -r | FileCheck -check-prefix=RELOC %s
+
+# gp-implied accesses take a bare symbol or a %gp_rel. The relocation
+# depends on the access size, which scales the offset.
+
+addigp a0, foo
+# RELOC: R_RISCV_LGP18S0 foo
+# FIXUP: fixup A - offset: 0, value: foo, kind: fixup_riscv_lgp18s0
+lbgp a0, %gp_rel(foo)
+# RELOC: R_RISCV_LGP18S0 foo
+# FIXUP: fixup A - offset: 0, value: %gp_rel(foo), kind: fixup_riscv_lgp18s0
+lhugp a0, foo
+# RELOC: R_RISCV_LGP17S1 foo
+# FIXUP: fixup A - offset: 0, value: foo, kind: fixup_riscv_lgp17s1
+lwgp a0, foo
+# RELOC: R_RISCV_LGP17S2 foo
+# FIXUP: fixup A - offset: 0, value: foo, kind: fixup_riscv_lgp17s2
+sbgp a0, foo
+# RELOC: R_RISCV_SGP18S0 foo
+# FIXUP: fixup A - offset: 0, value: foo, kind: fixup_riscv_sgp18s0
+shgp a0, foo
+# RELOC: R_RISCV_SGP17S1 foo
+# FIXUP: fixup A - offset: 0, value: foo, kind: fixup_riscv_sgp17s1
+swgp a0, %gp_rel(foo)
+# RELOC: R_RISCV_SGP17S2 foo
+# FIXUP: fixup A - offset: 0, value: %gp_rel(foo), kind: fixup_riscv_sgp17s2
+
+beqc a0, 3, bar
+# RELOC: R_RISCV_10_PCREL bar
+# FIXUP: fixup A - offset: 0, value: bar, kind: fixup_riscv_10_pcrel
+bbs a0, 7, bar
+# RELOC: R_RISCV_10_PCREL bar
+# FIXUP: fixup A - offset: 0, value: bar, kind: fixup_riscv_10_pcrel
@@ -0,0 +1,49 @@
+# RUN: llvm-mc %s -triple=riscv32 -mattr=+xv5 \
+# RUN:     | FileCheck -check-prefix=CHECK-INST %s
+# RUN: llvm-mc -filetype=obj -triple riscv32 -mattr=+xv5 < %s \
+# RUN:     | llvm-objdump -mattr=+xv5 -d - | FileCheck -check-prefix=CHECK-INST %s
+# RUN: llvm-mc %s -triple=riscv64 -mattr=+xv5 \
+# RUN:     | FileCheck -check-prefix=CHECK-INST %s
+# RUN: not llvm-mc -triple riscv32 < %s 2>&1 \
+# RUN:     | FileCheck -check-prefix=CHECK-NOEXT %s
+
+# CHECK-INST: beqc a0, 5, 16
+# CHECK-NOEXT: :[[@LINE+1]]:1: error: instruction use requires an option to be enabled
+beqc a0, 5, 16
+# CHECK-INST: bnec s1, 127, -1024
+bnec s1, 127, -1024
+# CHECK-INST: bbc a2, 31, 1022
+bbc a2, 31, 1022
+# CHECK-INST: bbs t0, 0, -2
+bbs t0, 0, -2
+
+# CHECK-INST: bfoz a0, a1, 15, 8
+bfoz a0, a1, 15, 8
+# CHECK-INST: bfos a0, a1, 31, 0
+bfos a0, a1, 31, 0
+
+# CHECK-INST: lea.h a0, a1, a2
+lea.h a0, a1, a2
+# CHECK-INST: lea.w s0, s1, t0
+lea.w s0, s1, t0
+# CHECK-INST: lea.d a5, a4, a3
+lea.d a5, a4, a3
+
+# CHECK-INST: addigp a0, -131072
+addigp a0, -131072
+# CHECK-INST: lbgp a1, 131071
+lbgp a1, 131071
+# CHECK-INST: lbugp a2, 1
+lbugp a2, 1
+# CHECK-INST: lhgp a3, -131072
+lhgp a3, -131072
+# CHECK-INST: lhugp a4, 131070
+lhugp a4, 131070
+# CHECK-INST: lwgp a5, 262140
+lwgp a5, 262140
+# CHECK-INST: sbgp t0, -1
+sbgp t0, -1
+# CHECK-INST: shgp t1, 2
+shgp t1, 2
+# CHECK-INST: swgp t2, -262144
+swgp t2, -262144
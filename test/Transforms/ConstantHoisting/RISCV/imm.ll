@@ -0,0 +1,28 @@
+; RUN: opt -S -consthoist < %s | FileCheck %s
+target triple = "riscv32"
+
+; Constants that fit in a 12-bit immediate are not worth hoisting.
+
+define i32 @small(i32 %a, i32 %b) {
+; CHECK-LABEL: @small
+; CHECK-NOT: bitcast
+; CHECK: add i32 %a, 2047
+; CHECK: add i32 %b, 2047
+  %1 = add i32 %a, 2047
+  %2 = add i32 %b, 2047
+  %3 = xor i32 %1, %2
+  ret i32 %3
+}
+
+; A LUI+ADDI constant used twice is materialized once.
+
+define i32 @large(i32 %a, i32 %b) {
+; CHECK-LABEL: @large
+; CHECK: %const = bitcast i32 305419896 to i32
+; CHECK: add i32 %a, %const
+; CHECK: add i32 %b, %const
+  %1 = add i32 %a, 305419896
+  %2 = add i32 %b, 305419896
+  %3 = xor i32 %1, %2
+  ret i32 %3
+}
@@ -0,0 +1,30 @@
+; RUN: opt -mtriple=riscv32 -mattr=+p -loop-vectorize -force-vector-interleave=1 \
+; RUN:   -S < %s | FileCheck %s
+; RUN: opt -mtriple=riscv32 -loop-vectorize -force-vector-interleave=1 \
+; RUN:   -S < %s | FileCheck -check-prefix=NOP %s
+
+; With packed-SIMD the loop vectorizer fills a GPR with i8 lanes.
+define void @add_bytes(i8* noalias %a, i8* noalias %b, i32 %n) nounwind {
+; CHECK-LABEL: @add_bytes(
+; CHECK: add <4 x i8>
+; NOP-LABEL: @add_bytes(
+; NOP-NOT: <4 x i8>
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %inc, %loop ]
+  %pa = getelementptr inbounds i8, i8* %a, i32 %i
+  %pb = getelementptr inbounds i8, i8* %b, i32 %i
+  %va = load i8, i8* %pa
+  %vb = load i8, i8* %pb
+  %sum = add i8 %va, %vb
+  store i8 %sum, i8* %pa
+  %inc = add nuw nsw i32 %i, 1
+  %done = icmp eq i32 %inc, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
@@ -0,0 +1,496 @@
+//===- RISCVCompressInstEmitter.cpp - Generator for RISCV Compression -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This backend reads CompressPat records and emits two functions:
+//
+//   bool compressInst(MCInst &OutInst, const MCInst &MI,
+//                     const MCSubtargetInfo &STI,
+//                     const MCRegisterInfo &MRI);
+//   bool uncompressInst(MCInst &OutInst, const MCInst &MI,
+//                       const MCSubtargetInfo &STI,
+//                       const MCRegisterInfo &MRI);
+//
+// compressInst replaces a 32-bit instruction with its 16-bit equivalent when
+// the operands allow it; uncompressInst does the reverse.
+//
+// A CompressPat is written as
+//
+//   def : CompressPat<(ADD GPRNoX0:$rs1, GPRNoX0:$rs1, GPRNoX0:$rs2),
+//                     (CADD GPRNoX0:$rs1, GPRNoX0:$rs2)>;
+//
+// Each argument of the two dags describes one MC operand of the instruction,
+// with complex operands spelled out as their sub-operands. Operands that are
+// tied to an earlier operand of the same instruction are left out. An
+// argument is one of:
+//
+//   - a register class: the operand must be a register in that class;
+//   - a register: the operand must be exactly that register;
+//   - an Operand with an MCOperandPredicate: the predicate must hold;
+//   - an integer: the operand must be exactly that immediate.
+//
+// Named arguments in the output dag are copied from the input argument of the
+// same name, and must satisfy the constraints given on both sides. An input
+// name used more than once requires the operands to be identical.
+//
+// The instruction predicates of the output instruction, and any listed in the
+// pattern, are checked against the subtarget features.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeGenInstruction.h"
+#include "CodeGenTarget.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/TableGen/Error.h"
+#include "llvm/TableGen/Record.h"
+#include "llvm/TableGen/TableGenBackend.h"
+#include <vector>
+using namespace llvm;
+
+#define DEBUG_TYPE "compress-inst-emitter"
+
+namespace {
+class RISCVCompressInstEmitter {
+  /// One MC operand of an instruction, after complex operands have been
+  /// flattened.
+  struct FlatOperand {
+    Record *Type;  // Register class, pointer class or immediate type.
+    int TiedTo;    // Flat index of the operand this one is tied to, or -1.
+  };
+
+  /// What an operand of the source instruction must look like.
+  struct SourceOp {
+    enum MatchKind { Bind, Reg, Imm, Same, Ignore };
+    MatchKind Kind;
+    Record *Check;    // Register class or Operand to test, for Bind.
+    Record *RegDef;   // Register, for Reg.
+    int64_t ImmVal;   // Immediate, for Imm.
+    unsigned SameAs;  // Earlier source operand, for Same.
+  };
+
+  /// Where an operand of the destination instruction comes from.
+  struct DestOp {
+    enum MapKind { Operand, Reg, Imm, Tied };
+    MapKind Kind;
+    Record *Check;    // Extra register class or Operand to test, for Operand.
+    unsigned Index;   // Source operand for Operand, destination for Tied.
+    Record *RegDef;   // Register, for Reg.
+    int64_t ImmVal;   // Immediate, for Imm.
+  };
+
+  struct CompressPat {
+    Record *TheDef;
+    Record *Source;
+    Record *Dest;
+    std::vector<SourceOp> SourceOps;
+    std::vector<DestOp> DestOps;
+    std::vector<Record *> Predicates;
+  };
+
+  RecordKeeper &Records;
+  CodeGenTarget Target;
+
+  std::vector<FlatOperand> getFlatOperands(Record *Inst);
+  static bool isRegisterType(Record *R);
+  void checkArgument(Record *Pat, Init *Arg, const FlatOperand &Op,
+                     Record *Inst);
+  CompressPat evaluatePattern(Record *Pat, DagInit *SourceDag,
+                              DagInit *DestDag);
+  void emitFunction(raw_ostream &OS, StringRef Name,
+                    std::vector<CompressPat> &Patterns);
+
+public:
+  RISCVCompressInstEmitter(RecordKeeper &R) : Records(R), Target(R) {}
+
+  void run(raw_ostream &OS);
+};
+} // end anonymous namespace
+
+std::vector<RISCVCompressInstEmitter::FlatOperand>
+RISCVCompressInstEmitter::getFlatOperands(Record *Inst) {
+  CodeGenInstruction &CGI = Target.getInstruction(Inst);
+  std::vector<FlatOperand> Ops;
+  for (const CGIOperandList::OperandInfo &OI : CGI.Operands) {
+    for (unsigned j = 0; j != OI.MINumOperands; ++j) {
+      FlatOperand Op;
+      Op.Type = OI.Rec;
+      if (OI.MINumOperands > 1)
+        Op.Type = cast<DefInit>(OI.MIOperandInfo->getArg(j))->getDef();
+      Op.TiedTo = -1;
+      if (j < OI.Constraints.size() && OI.Constraints[j].isTied())
+        Op.TiedTo = OI.Constraints[j].getTiedOperand();
+      Ops.push_back(Op);
+    }
+  }
+  return Ops;
+}
+
+bool RISCVCompressInstEmitter::isRegisterType(Record *R) {
+  return R->isSubClassOf("RegisterClass") ||
+         R->isSubClassOf("RegisterOperand") ||
+         R->isSubClassOf("PointerLikeRegClass");
+}
+
+/// Check that a pattern argument can describe an operand of type Op.Type.
+void RISCVCompressInstEmitter::checkArgument(Record *Pat, Init *Arg,
+                                             const FlatOperand &Op,
+                                             Record *Inst) {
+  bool WantReg = isRegisterType(Op.Type);
+  if (isa<IntInit>(Arg)) {
+    if (WantReg)
+      PrintFatalError(Pat->getLoc(), "Integer given for register operand of '" +
+                                         Inst->getName() + "'");
+    return;
+  }
+  DefInit *DI = dyn_cast<DefInit>(Arg);
+  if (!DI)
+    PrintFatalError(Pat->getLoc(), "Unsupported argument '" +
+                                       Arg->getAsString() + "' for '" +
+                                       Inst->getName() + "'");
+  Record *R = DI->getDef();
+  bool IsReg = R->isSubClassOf("Register") || R->isSubClassOf("RegisterClass");
+  if (!IsReg && !R->isSubClassOf("Operand"))
+    PrintFatalError(Pat->getLoc(), "Argument '" + R->getName() + "' of '" +
+                                       Inst->getName() +
+                                       "' is not a register or an operand");
+  if (IsReg != WantReg)
+    PrintFatalError(Pat->getLoc(), "Argument '" + R->getName() +
+                                       "' does not match the kind of its '" +
+                                       Inst->getName() + "' operand");
+
+  // A register class argument must fit the instruction's operand class.
+  if (!R->isSubClassOf("RegisterClass") ||
+      !Op.Type->isSubClassOf("RegisterClass"))
+    return;
+  CodeGenRegBank &RegBank = Target.getRegBank();
+  if (!RegBank.getRegClass(Op.Type)->hasSubClass(RegBank.getRegClass(R)))
+    PrintFatalError(Pat->getLoc(), "Register class '" + R->getName() +
+                                       "' is not a subclass of '" +
+                                       Op.Type->getName() + "' in '" +
+                                       Inst->getName() + "'");
+}
+
+RISCVCompressInstEmitter::CompressPat
+RISCVCompressInstEmitter::evaluatePattern(Record *Pat, DagInit *SourceDag,
+                                          DagInit *DestDag) {
+  CompressPat CP;
+  CP.TheDef = Pat;
+
+  auto getInst = [&](DagInit *Dag) {
+    DefInit *OpDef = dyn_cast<DefInit>(Dag->getOperator());
+    if (!OpDef || !OpDef->getDef()->isSubClassOf("Instruction"))
+      PrintFatalError(Pat->getLoc(), "Operator of '" + Dag->getAsString() +
+                                         "' is not an instruction");
+    return OpDef->getDef();
+  };
+  CP.Source = getInst(SourceDag);
+  CP.Dest = getInst(DestDag);
+
+  // Match the source arguments against the source operands.
+  std::vector<FlatOperand> SourceFlat = getFlatOperands(CP.Source);
+  StringMap<unsigned> Names;
+  unsigned ArgNo = 0;
+  for (unsigned i = 0, e = SourceFlat.size(); i != e; ++i) {
+    SourceOp Op = {SourceOp::Ignore, nullptr, nullptr, 0, 0};
+    if (SourceFlat[i].TiedTo >= 0) {
+      // Equal to an operand that is already matched.
+      CP.SourceOps.push_back(Op);
+      continue;
+    }
+    if (ArgNo == SourceDag->getNumArgs())
+      PrintFatalError(Pat->getLoc(), "Too few operands for '" +
+                                         CP.Source->getName() + "'");
+    Init *Arg = SourceDag->getArg(ArgNo);
+    StringRef Name = SourceDag->getArgNameStr(ArgNo);
+    ++ArgNo;
+    checkArgument(Pat, Arg, SourceFlat[i], CP.Source);
+
+    if (IntInit *II = dyn_cast<IntInit>(Arg)) {
+      Op.Kind = SourceOp::Imm;
+      Op.ImmVal = II->getValue();
+    } else {
+      Record *R = cast<DefInit>(Arg)->getDef();
+      if (R->isSubClassOf("Register")) {
+        Op.Kind = SourceOp::Reg;
+        Op.RegDef = R;
+      } else if (!Name.empty() && Names.count(Name)) {
+        Op.Kind = SourceOp::Same;
+        Op.SameAs = Names[Name];
+      } else {
+        Op.Kind = SourceOp::Bind;
+        Op.Check = R;
+        if (!Name.empty())
+          Names[Name] = i;
+      }
+    }
+    CP.SourceOps.push_back(Op);
+  }
+  if (ArgNo != SourceDag->getNumArgs())
+    PrintFatalError(Pat->getLoc(), "Too many operands for '" +
+                                       CP.Source->getName() + "'");
+
+  // Map the destination operands to source operands or constants.
+  std::vector<FlatOperand> DestFlat = getFlatOperands(CP.Dest);
+  ArgNo = 0;
+  for (unsigned i = 0, e = DestFlat.size(); i != e; ++i) {
+    DestOp Op = {DestOp::Operand, nullptr, 0, nullptr, 0};
+    if (DestFlat[i].TiedTo >= 0) {
+      Op.Kind = DestOp::Tied;
+      Op.Index = DestFlat[i].TiedTo;
+      CP.DestOps.push_back(Op);
+      continue;
+    }
+    if (ArgNo == DestDag->getNumArgs())
+      PrintFatalError(Pat->getLoc(), "Too few operands for '" +
+                                         CP.Dest->getName() + "'");
+    Init *Arg = DestDag->getArg(ArgNo);
+    StringRef Name = DestDag->getArgNameStr(ArgNo);
+    ++ArgNo;
+    checkArgument(Pat, Arg, DestFlat[i], CP.Dest);
+
+    if (IntInit *II = dyn_cast<IntInit>(Arg)) {
+      Op.Kind = DestOp::Imm;
+      Op.ImmVal = II->getValue();
+    } else {
+      Record *R = cast<DefInit>(Arg)->getDef();
+      if (R->isSubClassOf("Register")) {
+        Op.Kind = DestOp::Reg;
+        Op.RegDef = R;
+      } else {
+        StringMap<unsigned>::iterator It = Names.find(Name);
+        if (Name.empty() || It == Names.end())
+          PrintFatalError(Pat->getLoc(),
+                          "Operand '" + Name + "' of '" + CP.Dest->getName() +
+                              "' has no matching source operand");
+        Op.Index = It->second;
+        if (CP.SourceOps[Op.Index].Check != R)
+          Op.Check = R;
+      }
+    }
+    CP.DestOps.push_back(Op);
+  }
+  if (ArgNo != DestDag->getNumArgs())
+    PrintFatalError(Pat->getLoc(), "Too many operands for '" +
+                                       CP.Dest->getName() + "'");
+
+  // The destination must be legal on the subtarget.
+  for (Record *P : CP.Dest->getValueAsListOfDefs("Predicates"))
+    if (P->getValueAsBit("AssemblerMatcherPredicate"))
+      CP.Predicates.push_back(P);
+  for (Record *P : Pat->getValueAsListOfDefs("Predicates"))
+    if (P->getValueAsBit("AssemblerMatcherPredicate") &&
+        !is_contained(CP.Predicates, P))
+      CP.Predicates.push_back(P);
+  return CP;
+}
+
+static std::string getFeatureCheck(StringRef Namespace, Record *Pred) {
+  SmallVector<StringRef, 2> Conds;
+  Pred->getValueAsString("AssemblerCondString").split(Conds, ',');
+  std::string Result;
+  for (StringRef Cond : Conds) {
+    Cond = Cond.trim();
+    bool Negate = Cond.consume_front("!");
+    if (!Result.empty())
+      Result += " &&\n        ";
+    Result += (Twine(Negate ? "!" : "") + "STI.getFeatureBits()[" +
+               Namespace + "::" + Cond + "]").str();
+  }
+  return Result;
+}
+
+static std::string getOperandCode(Record *R) {
+  const RecordVal *RV = R->getValue("MCOperandPredicate");
+  if (!RV)
+    return "";
+  if (CodeInit *CI = dyn_cast<CodeInit>(RV->getValue()))
+    return CI->getValue();
+  if (StringInit *SI = dyn_cast<StringInit>(RV->getValue()))
+    return SI->getValue();
+  return "";
+}
+
+void RISCVCompressInstEmitter::emitFunction(
+    raw_ostream &OS, StringRef Name, std::vector<CompressPat> &Patterns) {
+  StringRef Namespace = Target.getName();
+  std::string ValidateName = ("validateMCOperandFor" + Name).str();
+  std::string GuardName = "GEN_" + Name.upper() + "_INSTR";
+
+  // Number the operand predicates that the patterns use.
+  std::vector<Record *> OperandPreds;
+  auto getPredIndex = [&](Record *R) -> int {
+    if (getOperandCode(R).empty())
+      return -1;
+    auto I = find(OperandPreds, R);
+    if (I != OperandPreds.end())
+      return I - OperandPreds.begin() + 1;
+    OperandPreds.push_back(R);
+    return OperandPreds.size();
+  };
+
+  std::string Cases;
+  raw_string_ostream CaseOS(Cases);
+
+  // Group the patterns by source opcode, keeping the order of definition
+  // within each group.
+  std::vector<Record *> Opcodes;
+  for (const CompressPat &CP : Patterns)
+    if (!is_contained(Opcodes, CP.Source))
+      Opcodes.push_back(CP.Source);
+
+  for (Record *Opc : Opcodes) {
+    CaseOS << "  case " << Namespace << "::" << Opc->getName() << ": {\n";
+    for (const CompressPat &CP : Patterns) {
+      if (CP.Source != Opc)
+        continue;
+      std::vector<std::string> Conds;
+      for (Record *P : CP.Predicates)
+        Conds.push_back(getFeatureCheck(Namespace, P));
+
+      auto addCheck = [&](Record *R, unsigned Idx) {
+        std::string Op = "MI.getOperand(" + utostr(Idx) + ")";
+        if (R->isSubClassOf("RegisterClass")) {
+          Conds.push_back(("MRI.getRegClass(" + Namespace + "::" +
+                           R->getName() + "RegClassID).contains(" + Op +
+                           ".getReg())").str());
+          return;
+        }
+        int PredIdx = getPredIndex(R);
+        if (PredIdx >= 0)
+          Conds.push_back(ValidateName + "(" + Op + ", " + itostr(PredIdx) +
+                          ")");
+      };
+
+      for (unsigned i = 0, e = CP.SourceOps.size(); i != e; ++i) {
+        const SourceOp &Op = CP.SourceOps[i];
+        std::string MCOp = "MI.getOperand(" + utostr(i) + ")";
+        switch (Op.Kind) {
+        case SourceOp::Ignore:
+          break;
+        case SourceOp::Reg:
+          Conds.push_back((MCOp + ".getReg() == " + Namespace + "::" +
+                           Op.RegDef->getName()).str());
+          break;
+        case SourceOp::Imm:
+          Conds.push_back(MCOp + ".isImm() && " + MCOp +
+                          ".getImm() == " + itostr(Op.ImmVal));
+          break;
+        case SourceOp::Same:
+          Conds.push_back(MCOp + ".getReg() == MI.getOperand(" +
+                          utostr(Op.SameAs) + ").getReg()");
+          break;
+        case SourceOp::Bind:
+          addCheck(Op.Check, i);
+          break;
+        }
+      }
+      for (const DestOp &Op : CP.DestOps)
+        if (Op.Kind == DestOp::Operand && Op.Check)
+          addCheck(Op.Check, Op.Index);
+
+      CaseOS << "    if (";
+      if (Conds.empty())
+        CaseOS << "true";
+      for (unsigned i = 0, e = Conds.size(); i != e; ++i)
+        CaseOS << (i ? " &&\n        (" : "(") << Conds[i] << ")";
+      CaseOS << ") {\n";
+      CaseOS << "      // " << CP.Dest->getValueAsString("AsmString") << "\n";
+      CaseOS << "      OutInst.setOpcode(" << Namespace
+             << "::" << CP.Dest->getName() << ");\n";
+      for (const DestOp &Op : CP.DestOps) {
+        switch (Op.Kind) {
+        case DestOp::Operand:
+          CaseOS << "      OutInst.addOperand(MI.getOperand(" << Op.Index
+                 << "));\n";
+          break;
+        case DestOp::Reg:
+          CaseOS << "      OutInst.addOperand(MCOperand::createReg("
+                 << Namespace << "::" << Op.RegDef->getName() << "));\n";
+          break;
+        case DestOp::Imm:
+          CaseOS << "      OutInst.addOperand(MCOperand::createImm("
+                 << Op.ImmVal << "));\n";
+          break;
+        case DestOp::Tied:
+          CaseOS << "      OutInst.addOperand(MCOperand(OutInst.getOperand("
+                 << Op.Index << ")));\n";
+          break;
+        }
+      }
+      CaseOS << "      OutInst.setLoc(MI.getLoc());\n";
+      CaseOS << "      return true;\n";
+      CaseOS << "    }\n";
+    }
+    CaseOS << "    break;\n";
+    CaseOS << "  }\n";
+  }
+  CaseOS.flush();
+
+  OS << "#ifdef " << GuardName << "\n";
+  OS << "#undef " << GuardName << "\n\n";
+
+  OS << "static bool " << ValidateName
+     << "(const MCOperand &MCOp, unsigned PredicateIndex) {\n";
+  OS << "  switch (PredicateIndex) {\n";
+  OS << "  default:\n";
+  OS << "    llvm_unreachable(\"Unknown MCOperandPredicate kind\");\n";
+  for (unsigned i = 0, e = OperandPreds.size(); i != e; ++i) {
+    OS << "  case " << i + 1 << ": {\n";
+    OS << "    // " << OperandPreds[i]->getName() << "\n";
+    std::string Code = getOperandCode(OperandPreds[i]);
+    SmallVector<StringRef, 8> Lines;
+    StringRef(Code).trim("\n").split(Lines, '\n');
+    for (StringRef Line : Lines)
+      OS << "  " << Line << "\n";
+    OS << "  }\n";
+  }
+  OS << "  }\n";
+  OS << "}\n\n";
+
+  OS << "static bool " << Name.lower() << "Inst(MCInst &OutInst, "
+     << "const MCInst &MI,\n"
+     << "                         const MCSubtargetInfo &STI,\n"
+     << "                         const MCRegisterInfo &MRI) {\n";
+  OS << "  switch (MI.getOpcode()) {\n";
+  OS << "  default:\n";
+  OS << "    break;\n";
+  OS << Cases;
+  OS << "  }\n";
+  OS << "  return false;\n";
+  OS << "}\n\n";
+  OS << "#endif // " << GuardName << "\n\n";
+}
+
+void RISCVCompressInstEmitter::run(raw_ostream &OS) {
+  std::vector<CompressPat> Compress, Uncompress;
+  for (Record *Pat : Records.getAllDerivedDefinitions("CompressPat")) {
+    DagInit *Input = Pat->getValueAsDag("Input");
+    DagInit *Output = Pat->getValueAsDag("Output");
+    Compress.push_back(evaluatePattern(Pat, Input, Output));
+    if (!Pat->getValueAsBit("isCompressOnly"))
+      Uncompress.push_back(evaluatePattern(Pat, Output, Input));
+  }
+
+  emitSourceFileHeader("Compress instruction Source Fragment", OS);
+  emitFunction(OS, "Compress", Compress);
+  emitFunction(OS, "Uncompress", Uncompress);
+}
+
+namespace llvm {
+
+void EmitRISCVCompressInst(RecordKeeper &RK, raw_ostream &OS) {
+  RISCVCompressInstEmitter(RK).run(OS);
+}
+
+} // end namespace llvm
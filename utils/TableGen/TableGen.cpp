@@ -48,6 +48,7 @@ enum ActionType {
   GenGlobalISel,
   GenX86EVEX2VEXTables,
   GenRegisterBank,
+  GenRISCVCompressInst,
 };
 
 namespace {
@@ -100,7 +101,9 @@ namespace {
                     clEnumValN(GenX86EVEX2VEXTables, "gen-x86-EVEX2VEX-tables",
                                "Generate X86 EVEX to VEX compress tables"),
                     clEnumValN(GenRegisterBank, "gen-register-bank",
-                               "Generate registers bank descriptions")));
+                               "Generate registers bank descriptions"),
+                    clEnumValN(GenRISCVCompressInst, "gen-riscv-compress-inst",
+                               "Generate RISCV compressed instructions.")));
 
   cl::OptionCategory PrintEnumsCat("Options for -print-enums");
   cl::opt<std::string>
@@ -193,6 +196,9 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
   case GenRegisterBank:
     EmitRegisterBank(Records, OS);
     break;
+  case GenRISCVCompressInst:
+    EmitRISCVCompressInst(Records, OS);
+    break;
   case GenX86EVEX2VEXTables:
     EmitX86EVEX2VEXTables(Records, OS);
     break;
@@ -83,6 +83,7 @@ void EmitSearchableTables(RecordKeeper &RK, raw_ostream &OS);
 void EmitGlobalISel(RecordKeeper &RK, raw_ostream &OS);
 void EmitX86EVEX2VEXTables(RecordKeeper &RK, raw_ostream &OS);
 void EmitRegisterBank(RecordKeeper &RK, raw_ostream &OS);
+void EmitRISCVCompressInst(RecordKeeper &RK, raw_ostream &OS);
 
 } // End llvm namespace
 